@@ -1,4 +1,5 @@
 #include "capture_base.h"
+#include "frame_base.h"
 
 namespace wolf{
 
@@ -9,8 +10,8 @@ CaptureBase::CaptureBase(const std::string& _type, const TimeStamp& _ts, SensorB
         capture_id_(++capture_id_count_),
         time_stamp_(_ts),
         sensor_ptr_(_sensor_ptr),
-        sensor_p_ptr_(sensor_ptr_->getPPtr()),
-        sensor_o_ptr_(sensor_ptr_->getOPtr())
+        sensor_p_ptr_(sensor_ptr_ != nullptr ? sensor_ptr_->getPPtr() : nullptr),
+        sensor_o_ptr_(sensor_ptr_ != nullptr ? sensor_ptr_->getOPtr() : nullptr)
 {
     //
 }
@@ -19,6 +20,26 @@ CaptureBase::CaptureBase(const std::string& _type, const TimeStamp& _ts, SensorB
 CaptureBase::~CaptureBase()
 {
 	//std::cout << "deleting CaptureBase " << nodeId() << std::endl;
+
+    // Remove it from the sensor index of its frame
+    if (getFramePtr() != nullptr && !getFramePtr()->isDeleting())
+        getFramePtr()->unindexCapture(this);
+}
+
+void* CaptureBase::operator new(std::size_t _size)
+{
+    return getPool().allocate(_size);
+}
+
+void CaptureBase::operator delete(void* _ptr, std::size_t _size)
+{
+    getPool().deallocate(_ptr, _size);
+}
+
+NodePool& CaptureBase::getPool()
+{
+    static NodePool pool;
+    return pool;
 }
 
 void CaptureBase::getConstraintList(ConstraintBaseList & _ctr_list)
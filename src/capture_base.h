@@ -12,6 +12,7 @@ class SensorBase;
 #include "wolf.h"
 #include "time_stamp.h"
 #include "node_linked.h"
+#include "node_pool.h"
 
 //std includes
 //
@@ -39,6 +40,9 @@ class CaptureBase : public NodeLinked<FrameBase, FeatureBase>
 
     public:
 
+        /** \brief Constructor
+         * \param _sensor_ptr the sensor of the capture, or nullptr for the captures of no sensor, e.g. the priors left by marginalization
+         **/
         CaptureBase(const std::string& _type, const TimeStamp& _ts, SensorBase* _sensor_ptr);
 
         /** \brief Default destructor (not recommended)
@@ -48,6 +52,12 @@ class CaptureBase : public NodeLinked<FrameBase, FeatureBase>
          **/
         virtual ~CaptureBase();
 
+        /** \brief Allocation in the pool of captures, see NodePool
+         */
+        static void* operator new(std::size_t _size);
+        static void operator delete(void* _ptr, std::size_t _size);
+        static NodePool& getPool();
+
         unsigned int id();
 
         /** \brief Adds a Feature to the down node list
@@ -0,0 +1,98 @@
+/**
+ * \file capture_executor.cpp
+ *
+ *  Created on: Jul 7, 2016
+ *      \author: jsola
+ */
+
+#include "capture_executor.h"
+#include "capture_base.h"
+#include "sensor_base.h"
+#include "processor_base.h"
+#include "thread_pool.h"
+
+// STL includes
+#include <set>
+#include <utility> // pair
+#include <vector>
+
+namespace wolf {
+
+CaptureExecutor::CaptureExecutor(unsigned int _n_threads) :
+        pool_ptr_(_n_threads > 1 ? new ThreadPool(_n_threads) : nullptr), n_pushed_(0), size_(0)
+{
+    //
+}
+
+CaptureExecutor::~CaptureExecutor()
+{
+    delete pool_ptr_;
+}
+
+void CaptureExecutor::push(CaptureBase* _capture_ptr)
+{
+    pipelines_[_capture_ptr->getSensorPtr()].push_back(QueuedCapture({n_pushed_++, _capture_ptr}));
+    size_++;
+}
+
+CaptureExecutor::PipelineMap::iterator CaptureExecutor::oldestPipeline()
+{
+    PipelineMap::iterator oldest_it = pipelines_.end();
+    for (auto pipeline_it = pipelines_.begin(); pipeline_it != pipelines_.end(); pipeline_it++)
+    {
+        if (pipeline_it->second.empty())
+            continue;
+        if (oldest_it == pipelines_.end())
+        {
+            oldest_it = pipeline_it;
+            continue;
+        }
+        const QueuedCapture& front = pipeline_it->second.front();
+        const QueuedCapture& oldest = oldest_it->second.front();
+        TimeStamp ts = front.capture_ptr_->getTimeStamp();
+        TimeStamp ts_oldest = oldest.capture_ptr_->getTimeStamp();
+        if (ts < ts_oldest || (!(ts_oldest < ts) && front.order_ < oldest.order_))
+            oldest_it = pipeline_it;
+    }
+    return oldest_it;
+}
+
+void CaptureExecutor::flush()
+{
+    std::vector<CaptureBase*> round;
+    std::set<SensorBase*> round_sensors;
+    std::vector<std::pair<ProcessorBase*, CaptureBase*> > extractions;
+    while (size_ > 0)
+    {
+        // the oldest captures, one per sensor at most
+        round.clear();
+        round_sensors.clear();
+        for (auto pipeline_it = oldestPipeline(); pipeline_it != pipelines_.end() && round_sensors.insert(pipeline_it->first).second;
+                pipeline_it = oldestPipeline())
+        {
+            round.push_back(pipeline_it->second.front().capture_ptr_);
+            pipeline_it->second.pop_front();
+            size_--;
+        }
+
+        // extract their data, possibly in parallel
+        extractions.clear();
+        for (auto capture_ptr : round)
+            for (auto processor_ptr : *(capture_ptr->getSensorPtr()->getProcessorListPtr()))
+                extractions.push_back(std::make_pair(processor_ptr, capture_ptr));
+        if (pool_ptr_ != nullptr && extractions.size() > 1)
+            pool_ptr_->run(extractions.size(), [&](unsigned int i)
+            {
+                extractions[i].first->extract(extractions[i].second);
+            });
+        else
+            for (auto extraction : extractions)
+                extraction.first->extract(extraction.second);
+
+        // modify the tree, in time stamp order
+        for (auto capture_ptr : round)
+            capture_ptr->process();
+    }
+}
+
+} // namespace wolf
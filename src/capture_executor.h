@@ -0,0 +1,86 @@
+/**
+ * \file capture_executor.h
+ *
+ *  Created on: Jul 7, 2016
+ *      \author: jsola
+ */
+
+#ifndef SRC_CAPTURE_EXECUTOR_H_
+#define SRC_CAPTURE_EXECUTOR_H_
+
+// Fwd refs
+namespace wolf{
+class CaptureBase;
+class SensorBase;
+class ThreadPool;
+}
+
+#include "wolf.h"
+
+// STL includes
+#include <deque>
+#include <map>
+
+namespace wolf {
+
+/** \brief Processes the captures of several sensors, extracting their data concurrently
+ *
+ * Each sensor has its own pipeline, a queue of captures in the order they are pushed.
+ * The captures of one sensor must be pushed in time order.
+ *
+ * flush() processes all the pending captures, in rounds. Each round takes the oldest pending captures of all pipelines,
+ * in time stamp order, as long as no sensor appears twice. Then:
+ *   - all the processors of the sensors extract their capture's data (see ProcessorBase::extract()),
+ *     concurrently if the executor has more than one thread;
+ *   - the captures are processed one after another in time stamp order, which is when the Wolf tree is modified.
+ *
+ * Captures with equal time stamps are processed in the order they were pushed.
+ * The Wolf tree is thus the same as processing each capture with CaptureBase::process() in time stamp order,
+ * whatever the number of threads.
+ */
+class CaptureExecutor
+{
+    public:
+        /** \brief Constructor
+         * \param _n_threads the number of threads extracting the data, including the one calling flush().
+         */
+        CaptureExecutor(unsigned int _n_threads = 1);
+        ~CaptureExecutor();
+
+        /** \brief Queues a capture in the pipeline of its sensor
+         */
+        void push(CaptureBase* _capture_ptr);
+
+        /** \brief Processes all the queued captures
+         */
+        void flush();
+
+        unsigned int size() const; ///< number of queued captures
+
+    private:
+        struct QueuedCapture
+        {
+                unsigned long int order_;   ///< push order, to break time stamp ties
+                CaptureBase* capture_ptr_;
+        };
+
+        typedef std::map<SensorBase*, std::deque<QueuedCapture> > PipelineMap;
+
+        /** \brief The pipeline whose first capture is the oldest, or end() if all are empty
+         */
+        PipelineMap::iterator oldestPipeline();
+
+        ThreadPool* pool_ptr_; ///< threads extracting the data. nullptr: no threads
+        PipelineMap pipelines_;
+        unsigned long int n_pushed_;
+        unsigned int size_;
+};
+
+inline unsigned int CaptureExecutor::size() const
+{
+    return size_;
+}
+
+} // namespace wolf
+
+#endif /* SRC_CAPTURE_EXECUTOR_H_ */
@@ -26,15 +26,8 @@ namespace wolf {
  *
  * The raw data of this type of captures is required to be in the form of a vector --> see attribute data_.
  *
- * It contains a MotionBuffer buffer of Motion pre-integrated motions that is being filled
- * by the motion processors (deriving from ProcessorMotion) --> See Motion, MotionBuffer, and ProcessorMotion.
- *
- * This buffer contains the integrated motion:
- *  - since the last key-Frame
- *  - until the frame of this capture.
- *
- * Once a keyframe is generated, this buffer is frozen and kept in the Capture for eventual later uses.
- * It is then used to compute the factor that links the Frame of this capture to the previous key-frame in the Trajectory.
+ * Captures of this class are the ones fed to the motion processors (deriving from ProcessorMotion).
+ * The processors keep the integrated motion in Captures of the derived class CaptureMotionT --> see below.
  */
 
 class CaptureMotion : public CaptureBase
@@ -56,18 +49,17 @@ class CaptureMotion : public CaptureBase
         void setData(const Eigen::VectorXs& _data);
         void setDataCovariance(const Eigen::MatrixXs& _data_cov);
 
-        MotionBuffer* getBufferPtr();
-        const MotionBuffer* getBufferPtr() const;
-        const Eigen::VectorXs& getDelta() const;
-
         FrameBase* getOriginFramePtr();
         void setOriginFramePtr(FrameBase* _frame_ptr);
 
+        /** \brief Memory of the motion buffer, in bytes. Only the CaptureMotionT have one.
+         */
+        virtual std::size_t getBufferBytes() const;
+
         // member data:
     private:
         Eigen::VectorXs data_;        ///< Motion data in form of vector mandatory
         Eigen::MatrixXs data_cov_;    ///< Motion data in form of vector mandatory
-        MotionBuffer buffer_;         ///< Buffer of motions between this Capture and the next one.
         FrameBase* origin_frame_ptr_; ///< Pointer to the origin frame of the motion
 };
 
@@ -76,7 +68,6 @@ inline CaptureMotion::CaptureMotion(const TimeStamp& _ts, SensorBase* _sensor_pt
         CaptureBase("MOTION", _ts, _sensor_ptr),
         data_(_data),
         data_cov_(Eigen::MatrixXs::Identity(_data.rows(), _data.rows())),
-        buffer_(),
         origin_frame_ptr_(_origin_frame_ptr)
 {
     //
@@ -87,7 +78,6 @@ inline CaptureMotion::CaptureMotion(const TimeStamp& _ts, SensorBase* _sensor_pt
         CaptureBase("MOTION", _ts, _sensor_ptr),
         data_(_data),
         data_cov_(_data_cov),
-        buffer_(),
         origin_frame_ptr_(_origin_frame_ptr)
 {
     //
@@ -118,29 +108,93 @@ inline void CaptureMotion::setDataCovariance(const Eigen::MatrixXs& _data_cov)
     data_cov_ = _data_cov;
 }
 
-inline const wolf::MotionBuffer* CaptureMotion::getBufferPtr() const
+inline std::size_t CaptureMotion::getBufferBytes() const
 {
-    return &buffer_;
+    return 0;
+}
+
+inline wolf::FrameBase* CaptureMotion::getOriginFramePtr()
+{
+    return origin_frame_ptr_;
 }
 
-inline wolf::MotionBuffer* CaptureMotion::getBufferPtr()
+inline void CaptureMotion::setOriginFramePtr(FrameBase* _frame_ptr)
+{
+    origin_frame_ptr_ = _frame_ptr;
+}
+
+
+/** \brief Motion Capture holding a buffer of integrated motion.
+ *
+ * It contains a MotionBufferT buffer of pre-integrated motions of type MotionType that is being filled
+ * by the motion processors (deriving from ProcessorMotionT) --> See MotionT, MotionBufferT, and ProcessorMotionT.
+ *
+ * This buffer contains the integrated motion:
+ *  - since the last key-Frame
+ *  - until the frame of this capture.
+ *
+ * Once a keyframe is generated, this buffer is frozen and kept in the Capture for eventual later uses.
+ * It is then used to compute the factor that links the Frame of this capture to the previous key-frame in the Trajectory.
+ */
+template <class MotionType>
+class CaptureMotionT : public CaptureMotion
+{
+    public:
+        typedef MotionBufferT<MotionType> BufferType;
+
+        CaptureMotionT(const TimeStamp& _ts, SensorBase* _sensor_ptr, const Eigen::VectorXs& _data,
+                       const Eigen::MatrixXs& _data_cov, FrameBase* _origin_frame_ptr = nullptr);
+
+        virtual ~CaptureMotionT();
+
+        BufferType* getBufferPtr();
+        const BufferType* getBufferPtr() const;
+        const typename MotionType::DeltaType& getDelta() const;
+
+        virtual std::size_t getBufferBytes() const;
+
+    private:
+        BufferType buffer_; ///< Buffer of motions between this Capture and the next one.
+};
+
+template <class MotionType>
+inline CaptureMotionT<MotionType>::CaptureMotionT(const TimeStamp& _ts, SensorBase* _sensor_ptr,
+                                                  const Eigen::VectorXs& _data, const Eigen::MatrixXs& _data_cov,
+                                                  FrameBase* _origin_frame_ptr) :
+        CaptureMotion(_ts, _sensor_ptr, _data, _data_cov, _origin_frame_ptr),
+        buffer_()
+{
+    //
+}
+
+template <class MotionType>
+inline CaptureMotionT<MotionType>::~CaptureMotionT()
+{
+    //
+}
+
+template <class MotionType>
+inline const typename CaptureMotionT<MotionType>::BufferType* CaptureMotionT<MotionType>::getBufferPtr() const
 {
     return &buffer_;
 }
 
-inline const Eigen::VectorXs& CaptureMotion::getDelta() const
+template <class MotionType>
+inline typename CaptureMotionT<MotionType>::BufferType* CaptureMotionT<MotionType>::getBufferPtr()
 {
-    return buffer_.get().back().delta_integr_;
+    return &buffer_;
 }
 
-inline wolf::FrameBase* CaptureMotion::getOriginFramePtr()
+template <class MotionType>
+inline std::size_t CaptureMotionT<MotionType>::getBufferBytes() const
 {
-    return origin_frame_ptr_;
+    return buffer_.get().capacity() * sizeof(MotionType);
 }
 
-inline void CaptureMotion::setOriginFramePtr(FrameBase* _frame_ptr)
+template <class MotionType>
+inline const typename MotionType::DeltaType& CaptureMotionT<MotionType>::getDelta() const
 {
-    origin_frame_ptr_ = _frame_ptr;
+    return buffer_.get().back().delta_integr_;
 }
 
 } // namespace wolf
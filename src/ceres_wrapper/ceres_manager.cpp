@@ -1,11 +1,13 @@
 #include "ceres_manager.h"
+#include "../state_arena.h"
 
 namespace wolf {
 
 CeresManager::CeresManager(Problem* _wolf_problem, const ceres::Solver::Options& _ceres_options, const bool _use_wolf_auto_diff) :
     ceres_options_(_ceres_options),
     wolf_problem_(_wolf_problem),
-    use_wolf_auto_diff_(_use_wolf_auto_diff)
+    use_wolf_auto_diff_(_use_wolf_auto_diff),
+    solving_(false)
 {
     ceres::Covariance::Options covariance_options;
     covariance_options.algorithm_type = ceres::SUITE_SPARSE_QR;//ceres::DENSE_SVD;
@@ -18,31 +20,44 @@ CeresManager::CeresManager(Problem* _wolf_problem, const ceres::Solver::Options&
     problem_options.cost_function_ownership = ceres::TAKE_OWNERSHIP;
     problem_options.loss_function_ownership = ceres::TAKE_OWNERSHIP;//ceres::DO_NOT_TAKE_OWNERSHIP;
     problem_options.local_parameterization_ownership = ceres::DO_NOT_TAKE_OWNERSHIP;
+    problem_options.enable_fast_removal = true; // constant time removal of residual blocks, for marginalization and pruning
     ceres_problem_ = new ceres::Problem(problem_options);
 }
 
 CeresManager::~CeresManager()
 {
+    // the problem may be gone already: do not write back
+    if (solver_thread_.joinable())
+        solver_thread_.join();
+
 	std::cout << "ceres residual blocks:   " << ceres_problem_->NumResidualBlocks() << std::endl;
 	std::cout << "ceres parameter blocks:  " << ceres_problem_->NumParameterBlocks() << std::endl;
-    while (!id_2_residual_idx_.empty())
-        removeConstraint(id_2_residual_idx_.begin()->first);
-	std::cout << "all residuals removed! \n";
-    removeAllStateBlocks();
-    std::cout << "all parameter blocks removed! \n";
 
 	delete covariance_;
     //std::cout << "covariance deleted! \n";
+    // the ceres problem owns the cost and loss functions: all residual blocks go at once with it
     delete ceres_problem_;
     //std::cout << "ceres problem deleted! \n";
+    id_2_residual_block_.clear();
+    parameter_buffers_.clear();
+    arena_buffer_.clear();
 }
 
 ceres::Solver::Summary CeresManager::solve()
 {
 	//std::cout << "Residual blocks: " << ceres_problem_->NumResidualBlocks() <<  " Parameter blocks: " << ceres_problem_->NumParameterBlocks() << std::endl;
 
+    finishAsync();
+
+    // bound the problem
+    if (wolf_problem_->isFixedLag())
+        marginalize();
+    if (wolf_problem_->getGraphPrunerPtr() != nullptr && wolf_problem_->getGraphPrunerPtr()->isDue())
+        prune();
+
     // update problem
     update();
+    loadParameters();
 
     //std::cout << "After Update: Residual blocks: " << ceres_problem_->NumResidualBlocks() <<  " Parameter blocks: " << ceres_problem_->NumParameterBlocks() << std::endl;
 
@@ -52,16 +67,106 @@ ceres::Solver::Summary CeresManager::solve()
 	// run Ceres Solver
 	ceres::Solve(ceres_options_, ceres_problem_, &ceres_summary_);
 	//std::cout << "solved" << std::endl;
+	if (wolf_problem_->getGraphPrunerPtr() != nullptr)
+	    wolf_problem_->getGraphPrunerPtr()->notifySolve(ceres_summary_.total_time_in_seconds, ceres_problem_->NumResidualBlocks());
+	storeParameters(std::unordered_set<const Scalar*>());
+	wolf_problem_->solveCallback();
 	//return results
 	return ceres_summary_;
 }
 
+void CeresManager::solveAsync()
+{
+    finishAsync();
+
+    // bound the problem, on the Wolf thread
+    if (wolf_problem_->isFixedLag())
+        marginalize();
+    if (wolf_problem_->getGraphPrunerPtr() != nullptr && wolf_problem_->getGraphPrunerPtr()->isDue())
+        prune();
+
+    // update problem, on the Wolf thread
+    update();
+    loadParameters();
+    FrameBase* last_key_frame_ptr = wolf_problem_->getLastKeyFramePtr();
+    async_time_stamp_ = (last_key_frame_ptr != nullptr ? last_key_frame_ptr->getTimeStamp() : TimeStamp(0));
+
+    // solve on the worker thread, with the options as they are now
+    solving_.store(true, std::memory_order_release);
+    ceres::Solver::Options options = ceres_options_;
+    solver_thread_ = std::thread([this, options]()
+    {
+        ceres::Solve(options, ceres_problem_, &async_summary_);
+        solving_.store(false, std::memory_order_release);
+    });
+}
+
+bool CeresManager::writeBackSolution(ceres::Solver::Summary& _summary, TimeStamp& _ts, bool _wait)
+{
+    if (!solver_thread_.joinable())
+        return false;
+    if (!_wait && isSolving())
+        return false;
+    solver_thread_.join();
+
+    // the state blocks removed during the solve may be deleted already
+    std::unordered_set<const Scalar*> removed;
+    for (auto state_notification : wolf_problem_->getStateBlockNotificationList())
+        if (state_notification.notification_ == REMOVE)
+            removed.insert(state_notification.scalar_ptr_);
+    storeParameters(removed);
+    wolf_problem_->solveCallback();
+
+    _summary = async_summary_;
+    _ts = async_time_stamp_;
+    return true;
+}
+
+void CeresManager::finishAsync()
+{
+    ceres::Solver::Summary summary;
+    TimeStamp ts;
+    writeBackSolution(summary, ts, true);
+}
+
+void CeresManager::loadParameters()
+{
+    // the states in the arena at once
+    if (!arena_buffer_.empty())
+    {
+        Eigen::Map<Eigen::VectorXs> arena_vector = wolf_problem_->getStateArenaPtr()->getVector();
+        std::copy(arena_vector.data(), arena_vector.data() + arena_vector.size(), arena_buffer_.begin());
+    }
+
+    for (auto& parameter_buffer : parameter_buffers_)
+    {
+        ParameterBuffer& buffer = parameter_buffer.second;
+        if (!buffer.in_arena_)
+            std::copy(buffer.state_block_ptr_->getPtr(), buffer.state_block_ptr_->getPtr() + buffer.own_values_.size(), buffer.own_values_.begin());
+        buffer.fixed_ = buffer.state_block_ptr_->isFixed();
+    }
+}
+
+void CeresManager::storeParameters(const std::unordered_set<const Scalar*>& _removed)
+{
+    for (auto& parameter_buffer : parameter_buffers_)
+    {
+        const ParameterBuffer& buffer = parameter_buffer.second;
+        if (buffer.fixed_ || _removed.find(parameter_buffer.first) != _removed.end())
+            continue;
+        std::copy(buffer.values_ptr_, buffer.values_ptr_ + buffer.state_block_ptr_->getSize(), buffer.state_block_ptr_->getPtr());
+    }
+}
+
 void CeresManager::computeCovariances(CovarianceBlocksToBeComputed _blocks)
 {
     //std::cout << "CeresManager: computing covariances..." << std::endl;
 
+    finishAsync();
+
     // update problem
     update();
+    loadParameters();
 
     // CLEAR STORED COVARIANCE BLOCKS IN WOLF PROBLEM
     wolf_problem_->clearCovariance();
@@ -179,119 +284,205 @@ void CeresManager::computeCovariances(CovarianceBlocksToBeComputed _blocks)
     }
     //std::cout << "pairs... " << double_pairs.size() << std::endl;
 
+    // ceres knows the parameter buffers, not the state blocks
+    for (auto& double_pair : double_pairs)
+        double_pair = std::make_pair(getParameterPtr(double_pair.first), getParameterPtr(double_pair.second));
+
     // COMPUTE DESIRED COVARIANCES
     if (covariance_->Compute(double_pairs, ceres_problem_))
     {
-        // STORE DESIRED COVARIANCES
+        // STORE DESIRED COVARIANCES: ceres writes each block directly in the store
+        CovarianceStore* covariance_store_ptr = wolf_problem_->getCovarianceStorePtr();
+        unsigned int n_scalars = 0;
+        for (auto state_block_pair : state_block_pairs)
+            n_scalars += state_block_pair.first->getSize() * state_block_pair.second->getSize();
+        covariance_store_ptr->reserve(state_block_pairs.size(), n_scalars);
         for (unsigned int i = 0; i < double_pairs.size(); i++)
-        {
-            Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> cov(state_block_pairs[i].first->getSize(),state_block_pairs[i].second->getSize());
-            covariance_->GetCovarianceBlock(double_pairs[i].first, double_pairs[i].second, cov.data());
-            wolf_problem_->addCovarianceBlock(state_block_pairs[i].first, state_block_pairs[i].second, cov);
-            //std::cout << "getted covariance " << std::endl << cov << std::endl;
-        }
+            covariance_->GetCovarianceBlock(double_pairs[i].first, double_pairs[i].second,
+                                            covariance_store_ptr->addBlock(state_block_pairs[i].first, state_block_pairs[i].second).data());
     }
     else
         std::cout << "WARNING: Couldn't compute covariances!" << std::endl;
 }
 
+void CeresManager::getStatistics(ProblemStatistics& _statistics) const
+{
+    _statistics.solver_residual_blocks_ = id_2_residual_block_.size();
+    _statistics.solver_parameter_blocks_ = parameter_buffers_.size();
+    std::size_t bytes = arena_buffer_.capacity() * sizeof(double);
+    for (auto& parameter_buffer : parameter_buffers_)
+        bytes += sizeof(ParameterBuffer) + parameter_buffer.second.own_values_.capacity() * sizeof(double);
+    _statistics.solver_bytes_ = bytes;
+}
+
+void CeresManager::marginalize()
+{
+    finishAsync();
+
+    FrameBaseList frame_list;
+    wolf_problem_->getKeyFramesOutOfWindow(frame_list);
+    for (auto frame_ptr : frame_list)
+    {
+        // the cost functions of the new constraints, and of the prior of the previous key frame
+        update();
+
+        std::list<LinearizedConstraint> linearized_list;
+        linearizeKeyFrame(frame_ptr, linearized_list);
+        wolf_problem_->marginalizeKeyFrame(frame_ptr, linearized_list);
+    }
+}
+
+void CeresManager::prune()
+{
+    finishAsync();
+
+    GraphPruner* pruner_ptr = wolf_problem_->getGraphPrunerPtr();
+    FrameBaseList frame_list;
+    pruner_ptr->getCandidateKeyFrames(frame_list);
+    for (auto frame_ptr : frame_list)
+    {
+        // the cost functions of the new constraints, and of the priors of the previous key frames
+        update();
+
+        std::list<LinearizedConstraint> linearized_list;
+        linearizeKeyFrame(frame_ptr, linearized_list);
+        if (pruner_ptr->isRedundant(frame_ptr, linearized_list))
+            pruner_ptr->pruneKeyFrame(frame_ptr, linearized_list);
+    }
+}
+
+void CeresManager::linearizeKeyFrame(FrameBase* _frame_ptr, std::list<LinearizedConstraint>& _linearized_list)
+{
+    ConstraintBaseList ctr_list;
+    wolf_problem_->getConstraintsOnKeyFrame(_frame_ptr, ctr_list);
+    for (auto ctr_ptr : ctr_list)
+    {
+        ceres::CostFunction* cost_function_ptr = id_2_residual_block_.at(ctr_ptr->id()).cost_function_ptr_;
+        std::vector<StateBlock*> state_ptrs = ctr_ptr->getStatePtrVector();
+
+        // ceres jacobians are row major
+        std::vector<const double*> parameter_ptrs;
+        std::vector<Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> > jacobians;
+        std::vector<double*> jacobian_ptrs;
+        for (auto state_ptr : state_ptrs)
+        {
+            parameter_ptrs.push_back(state_ptr->getPtr());
+            jacobians.push_back(Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>(cost_function_ptr->num_residuals(),
+                                                                                                     state_ptr->getSize()));
+        }
+        for (auto& jacobian : jacobians)
+            jacobian_ptrs.push_back(jacobian.data());
+
+        LinearizedConstraint linearized;
+        linearized.constraint_ptr_ = ctr_ptr;
+        linearized.residual_.resize(cost_function_ptr->num_residuals());
+        cost_function_ptr->Evaluate(parameter_ptrs.data(), linearized.residual_.data(), jacobian_ptrs.data());
+        for (auto& jacobian : jacobians)
+            linearized.jacobians_.push_back(jacobian);
+        _linearized_list.push_back(linearized);
+    }
+}
+
 void CeresManager::update()
 {
 	//std::cout << "CeresManager: updating... " << std::endl;
 	//std::cout << wolf_problem_->getStateBlockNotificationList().size() << " state block notifications" << std::endl;
 	//std::cout << wolf_problem_->getConstraintNotificationList().size() << " constraint notifications" << std::endl;
 
-	// REMOVE CONSTRAINTS
-	auto ctr_notification_it = wolf_problem_->getConstraintNotificationList().begin();
-	while ( ctr_notification_it != wolf_problem_->getConstraintNotificationList().end() )
-	{
-		if (ctr_notification_it->notification_ == REMOVE)
-		{
-			removeConstraint(ctr_notification_it->id_);
-			ctr_notification_it = wolf_problem_->getConstraintNotificationList().erase(ctr_notification_it);
-		}
-		else
-			ctr_notification_it++;
-	}
-
-	// REMOVE STATE BLOCKS
-	auto state_notification_it = wolf_problem_->getStateBlockNotificationList().begin();
-	while ( state_notification_it != wolf_problem_->getStateBlockNotificationList().end() )
-	{
-		if (state_notification_it->notification_ == REMOVE)
-		{
-			removeStateBlock((double *)(state_notification_it->scalar_ptr_));
-			state_notification_it = wolf_problem_->getStateBlockNotificationList().erase(state_notification_it);
-		}
-		else
-			state_notification_it++;
-	}
-
-    // ADD/UPDATE STATE BLOCKS
-    while (!wolf_problem_->getStateBlockNotificationList().empty())
+    // take the pending notifications, already coalesced by the problem
+    std::list<ConstraintNotification> ctr_notification_list;
+    std::list<StateBlockNotification> state_notification_list;
+    wolf_problem_->consumeConstraintNotificationList(ctr_notification_list);
+    wolf_problem_->consumeStateBlockNotificationList(state_notification_list);
+
+    // CONSTRAINTS: remove them before their state blocks, and gather the additions for after the new state blocks
+    std::vector<ConstraintBase*> ctr_add_ptrs;
+    ctr_add_ptrs.reserve(ctr_notification_list.size());
+    for (auto& ctr_notification : ctr_notification_list)
     {
-        switch (wolf_problem_->getStateBlockNotificationList().front().notification_)
+        switch (ctr_notification.notification_)
         {
             case ADD:
             {
-                addStateBlock(wolf_problem_->getStateBlockNotificationList().front().state_block_ptr_);
+                ctr_add_ptrs.push_back(ctr_notification.constraint_ptr_);
                 break;
             }
-            case UPDATE:
+            case REMOVE:
             {
-                updateStateBlockStatus(wolf_problem_->getStateBlockNotificationList().front().state_block_ptr_);
+                removeConstraint(ctr_notification.id_);
                 break;
             }
             default:
-                throw std::runtime_error("CeresManager::update: State Block notification must be ADD, UPATE or REMOVE.");
+                throw std::runtime_error("CeresManager::update: Constraint notification must be ADD or REMOVE.");
         }
-        wolf_problem_->getStateBlockNotificationList().pop_front();
     }
-    // ADD CONSTRAINTS
-    while (!wolf_problem_->getConstraintNotificationList().empty())
+
+    // STATE BLOCKS: in their order, so that a removal comes before the addition of a state block at the same address
+    for (auto& state_notification : state_notification_list)
     {
-        switch (wolf_problem_->getConstraintNotificationList().front().notification_)
+        switch (state_notification.notification_)
         {
             case ADD:
             {
-                //std::cout << "adding constraint" << std::endl;
-                addConstraint(wolf_problem_->getConstraintNotificationList().front().constraint_ptr_,wolf_problem_->getConstraintNotificationList().front().id_);
-                //std::cout << "added" << std::endl;
+                addStateBlock(state_notification.state_block_ptr_);
+                break;
+            }
+            case UPDATE:
+            {
+                updateStateBlockStatus(state_notification.state_block_ptr_);
+                break;
+            }
+            case REMOVE:
+            {
+                removeStateBlock((double *)(state_notification.scalar_ptr_));
                 break;
             }
             default:
-                throw std::runtime_error("CeresManager::update: Constraint notification must be ADD or REMOVE.");
+                throw std::runtime_error("CeresManager::update: State Block notification must be ADD, UPATE or REMOVE.");
         }
-        wolf_problem_->getConstraintNotificationList().pop_front();
     }
+
+    // ADD CONSTRAINTS
+    addConstraints(ctr_add_ptrs);
     //std::cout << "all constraints added" << std::endl;
 	//std::cout << "ceres residual blocks:   " << ceres_problem_->NumResidualBlocks() << std::endl;
-    //std::cout << "wrapper residual blocks: " << id_2_residual_idx_.size() << std::endl;
+    //std::cout << "wrapper residual blocks: " << id_2_residual_block_.size() << std::endl;
     //std::cout << "parameter blocks: " << ceres_problem_->NumParameterBlocks() << std::endl;
 
-	assert(ceres_problem_->NumResidualBlocks() == id_2_residual_idx_.size() && "ceres residuals different from wrapper residuals");
+	assert(ceres_problem_->NumResidualBlocks() == id_2_residual_block_.size() && "ceres residuals different from wrapper residuals");
 }
 
-void CeresManager::addConstraint(ConstraintBase* _ctr_ptr, unsigned int _id)
+void CeresManager::addConstraints(const std::vector<ConstraintBase*>& _ctr_ptrs)
 {
-    id_2_costfunction_[_id] = createCostFunction(_ctr_ptr);
-
-    //std::cout << "adding residual " << _ctr_ptr->id() << std::endl;
+    id_2_residual_block_.reserve(id_2_residual_block_.size() + _ctr_ptrs.size());
 
-    if (_ctr_ptr->getApplyLossFunction())
-        id_2_residual_idx_[_id] = ceres_problem_->AddResidualBlock(id_2_costfunction_[_id], new ceres::CauchyLoss(0.5), _ctr_ptr->getStateBlockPtrVector());
-    else
-        id_2_residual_idx_[_id] = ceres_problem_->AddResidualBlock(id_2_costfunction_[_id], NULL, _ctr_ptr->getStateBlockPtrVector());
+    std::vector<Scalar*> parameter_ptrs;
+    for (auto ctr_ptr : _ctr_ptrs)
+    {
+        //std::cout << "adding residual " << ctr_ptr->id() << std::endl;
+        ResidualBlock& residual_block = id_2_residual_block_[ctr_ptr->id()];
+        residual_block.cost_function_ptr_ = createCostFunction(ctr_ptr);
+
+        parameter_ptrs.clear();
+        for (auto st_ptr : ctr_ptr->getStateBlockPtrVector())
+            parameter_ptrs.push_back(getParameterPtr(st_ptr));
+
+        if (ctr_ptr->getApplyLossFunction())
+            residual_block.residual_id_ = ceres_problem_->AddResidualBlock(residual_block.cost_function_ptr_, new ceres::CauchyLoss(0.5), parameter_ptrs);
+        else
+            residual_block.residual_id_ = ceres_problem_->AddResidualBlock(residual_block.cost_function_ptr_, NULL, parameter_ptrs);
+    }
 }
 
 void CeresManager::removeConstraint(const unsigned int& _corr_id)
 {
     //std::cout << "removing constraint " << _corr_id << std::endl;
-    assert(id_2_residual_idx_.find(_corr_id) != id_2_residual_idx_.end());
-	ceres_problem_->RemoveResidualBlock(id_2_residual_idx_[_corr_id]);
+    auto residual_it = id_2_residual_block_.find(_corr_id);
+    assert(residual_it != id_2_residual_block_.end());
+	ceres_problem_->RemoveResidualBlock(residual_it->second.residual_id_);
     //std::cout << "residual block removed!" << std::endl;
-	id_2_residual_idx_.erase(_corr_id);
-	// The cost functions will be deleted by ceres_problem destructor (IT MUST HAVE THE OWNERSHIP)
+	id_2_residual_block_.erase(residual_it);
+	// The cost functions are deleted by ceres_problem (IT MUST HAVE THE OWNERSHIP)
 }
 
 void CeresManager::addStateBlock(StateBlock* _st_ptr)
@@ -300,15 +491,35 @@ void CeresManager::addStateBlock(StateBlock* _st_ptr)
     //std::cout << " size: " <<  _st_ptr->getSize() << std::endl;
     //std::cout << " vector: " <<  _st_ptr->getVector() << std::endl;
 
+    ParameterBuffer& buffer = parameter_buffers_[_st_ptr->getPtr()];
+    buffer.state_block_ptr_ = _st_ptr;
+    StateArena* arena_ptr = wolf_problem_->getStateArenaPtr();
+    buffer.in_arena_ = (arena_ptr != nullptr && arena_ptr->contains(_st_ptr));
+    if (buffer.in_arena_)
+    {
+        // its slice of the copy of the arena
+        if (arena_buffer_.empty())
+            arena_buffer_.resize(arena_ptr->getCapacity());
+        buffer.values_ptr_ = arena_buffer_.data() + arena_ptr->getOffset(_st_ptr);
+        buffer.own_values_.clear();
+    }
+    else
+    {
+        buffer.own_values_.resize(_st_ptr->getSize());
+        buffer.values_ptr_ = buffer.own_values_.data();
+    }
+    std::copy(_st_ptr->getPtr(), _st_ptr->getPtr() + _st_ptr->getSize(), buffer.values_ptr_);
+    buffer.fixed_ = _st_ptr->isFixed();
+
     if (_st_ptr->hasLocalParametrization())
     {
         //std::cout << "Local Parametrization to be added:" << _st_ptr->getLocalParametrizationPtr() << std::endl;
-        ceres_problem_->AddParameterBlock(_st_ptr->getPtr(), _st_ptr->getSize(), new LocalParametrizationWrapper(_st_ptr->getLocalParametrizationPtr()));
+        ceres_problem_->AddParameterBlock(buffer.values_ptr_, _st_ptr->getSize(), new LocalParametrizationWrapper(_st_ptr->getLocalParametrizationPtr()));
     }
     else
     {
         //std::cout << "No Local Parametrization to be added" << std::endl;
-        ceres_problem_->AddParameterBlock(_st_ptr->getPtr(), _st_ptr->getSize(), nullptr);
+        ceres_problem_->AddParameterBlock(buffer.values_ptr_, _st_ptr->getSize(), nullptr);
     }
     if (_st_ptr->isFixed())
         updateStateBlockStatus(_st_ptr);
@@ -318,26 +529,17 @@ void CeresManager::removeStateBlock(double* _st_ptr)
 {
     //std::cout << "Removing State Block " << _st_ptr << std::endl;
 	assert(_st_ptr != nullptr);
-    ceres_problem_->RemoveParameterBlock(_st_ptr);
-}
-
-void CeresManager::removeAllStateBlocks()
-{
-	std::vector<double*> parameter_blocks;
-
-	ceres_problem_->GetParameterBlocks(&parameter_blocks);
-
-	for (unsigned int i = 0; i< parameter_blocks.size(); i++)
-		ceres_problem_->RemoveParameterBlock(parameter_blocks[i]);
+    ceres_problem_->RemoveParameterBlock(getParameterPtr(_st_ptr));
+    parameter_buffers_.erase(_st_ptr);
 }
 
 void CeresManager::updateStateBlockStatus(StateBlock* _st_ptr)
 {
 	assert(_st_ptr != nullptr);
 	if (_st_ptr->isFixed())
-		ceres_problem_->SetParameterBlockConstant(_st_ptr->getPtr());
+		ceres_problem_->SetParameterBlockConstant(getParameterPtr(_st_ptr->getPtr()));
 	else
-		ceres_problem_->SetParameterBlockVariable(_st_ptr->getPtr());
+		ceres_problem_->SetParameterBlockVariable(getParameterPtr(_st_ptr->getPtr()));
 }
 
 ceres::CostFunction* CeresManager::createCostFunction(ConstraintBase* _corrPtr)
@@ -11,8 +11,20 @@
 #include "local_parametrization_wrapper.h"
 #include "../wolf.h"
 #include "../state_block.h"
+#include "../covariance_store.h"
+#include "../constraint_marginalization.h"
+#include "../graph_pruner.h"
+#include "../problem_statistics.h"
 #include "create_auto_diff_cost_function.h"
 #include "create_numeric_diff_cost_function.h"
+#include "../time_stamp.h"
+
+// STL includes
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace wolf {
 
@@ -32,19 +44,54 @@ typedef enum
 
 /** \brief Ceres manager for WOLF
  *
+ * Ceres optimizes its own copy of the state blocks, the parameter buffers.
+ * They are loaded from the state blocks when the solver takes the problem changes (see update())
+ * and written back to the state blocks when the solution is ready.
+ *
+ * When the problem has a StateArena (see Problem::enableStateArena()), the parameter buffers of the state blocks
+ * in the arena are slices of a single copy of the arena, with the same layout.
+ * They are loaded with one copy of the arena, and Ceres finds the states of consecutive frames next to each other.
+ *
+ * This allows solving asynchronously, see solveAsync(): the optimization runs on a worker thread
+ * while the Wolf thread keeps processing captures, creating frames and reading or writing their states.
+ * The new state blocks and constraints are queued in the Problem and taken by the next solve.
+ * The solution is written back at a safe point chosen by the Wolf thread, see writeBackSolution().
+ *
+ * While a solve is running, the state blocks and constraints known by the solver must not be destructed,
+ * because Ceres evaluates the constraints. Pruning must wait for writeBackSolution().
  */
 
 class CeresManager
 {
 	protected:
-		std::map<unsigned int, ceres::ResidualBlockId> id_2_residual_idx_;
-        std::map<unsigned int, ceres::CostFunction*> id_2_costfunction_;
+		struct ResidualBlock
+		{
+			ceres::ResidualBlockId residual_id_;
+			ceres::CostFunction* cost_function_ptr_; ///< owned by the ceres problem
+		};
+		std::unordered_map<unsigned int, ResidualBlock> id_2_residual_block_; ///< Ceres' residual block of each constraint, by constraint id
 		ceres::Problem* ceres_problem_;
 		ceres::Solver::Options ceres_options_;
 		ceres::Covariance* covariance_;
 		Problem* wolf_problem_;
 		bool use_wolf_auto_diff_;
 
+		struct ParameterBuffer
+		{
+			StateBlock* state_block_ptr_;
+			double* values_ptr_;                ///< in arena_buffer_, or in own_values_
+			std::vector<double> own_values_;    ///< for the state blocks out of the arena
+			bool in_arena_;
+			bool fixed_;    ///< constant in the last solve: nothing to write back
+		};
+		std::unordered_map<const Scalar*, ParameterBuffer> parameter_buffers_; ///< Ceres' copy of each state block, by state block data
+		std::vector<double> arena_buffer_; ///< Ceres' copy of the state arena. Allocated once, to the arena capacity, so that its slices do not move
+
+		std::thread solver_thread_;
+		std::atomic<bool> solving_;
+		ceres::Solver::Summary async_summary_;
+		TimeStamp async_time_stamp_;   ///< time stamp of the last key frame when the running solve started
+
 	public:
         CeresManager(Problem* _wolf_problem, const ceres::Solver::Options& _ceres_options = ceres::Solver::Options(), const bool _use_wolf_auto_diff = true);
 
@@ -52,8 +99,58 @@ class CeresManager
 
 		ceres::Solver::Summary solve();
 
+		/** \brief Starts solving on a worker thread
+		 *
+		 * Takes the pending problem changes and the current values of the state blocks, and returns without waiting.
+		 * If a solve was already running, waits for it and writes back its solution first.
+		 */
+		void solveAsync();
+
+		/** \brief Whether the asynchronous solve is running
+		 */
+		bool isSolving() const;
+
+		/** \brief Writes the solution of the asynchronous solve back to the state blocks. Wolf thread only.
+		 *
+		 * Call it at a point where the Wolf thread can take the state change, e.g. between two captures.
+		 * The states of the ProcessorMotion are composed on top of their origin key frame,
+		 * so they are re-propagated from the solution as soon as it is written back.
+		 * The state blocks removed from the problem during the solve are skipped.
+		 * Then the processors are told with Problem::solveCallback(), as after solve().
+		 *
+		 * \param _summary the summary of the solve
+		 * \param _ts the time stamp of the last key frame when the solve started: the solution includes all data up to it
+		 * \param _wait whether to wait for the solve to finish
+		 * \return false if there was no solution to write back, i.e. no solve started or, if not _wait, still running.
+		 */
+		bool writeBackSolution(ceres::Solver::Summary& _summary, TimeStamp& _ts, bool _wait = true);
+
 		void computeCovariances(CovarianceBlocksToBeComputed _blocks = ROBOT_LANDMARKS);
 
+		/** \brief Marginalizes the key frames out of the fixed-lag window of the problem, see Problem::setFixedLagWindow()
+		 *
+		 * The constraints on each key frame are linearized at the current state, with their cost functions,
+		 * and the problem replaces the key frame by the prior they leave on the other states, see Problem::marginalizeKeyFrame().
+		 * solve() and solveAsync() call it first, when the problem has a window.
+		 */
+		void marginalize();
+
+		/** \brief Prunes the redundant key frames of the problem, see Problem::enableGraphPruning()
+		 *
+		 * The constraints on each candidate key frame are linearized at the current state, with their cost functions,
+		 * and the pruner decides whether the key frame is redundant and replaces it, see GraphPruner.
+		 * Only the key frames added since the previous pruning are candidates, so only their constraints are linearized.
+		 * solve() and solveAsync() call it first, when the pruning is due.
+		 */
+		void prune();
+
+		/** \brief Fills the solver statistics: residual and parameter blocks, and the memory of the copies of the states. Wolf thread only.
+		 *
+		 * They are read from the bookkeeping of this class, so they are valid while an asynchronous solve runs.
+		 * See Problem::getStatistics() for the others.
+		 */
+		void getStatistics(ProblemStatistics& _statistics) const;
+
         ceres::Solver::Options& getSolverOptions();
 
         void setUseWolfAutoDiff(bool _use_wolf_auto_diff);
@@ -62,7 +159,23 @@ class CeresManager
 
 		void update();
 
-		void addConstraint(ConstraintBase* _corr_ptr, unsigned int _id);
+		/** \brief Linearizes the constraints on a key frame at the current state, with their cost functions
+		 */
+		void linearizeKeyFrame(FrameBase* _frame_ptr, std::list<LinearizedConstraint>& _linearized_list);
+
+		/** \brief Waits for the asynchronous solve, if any, and writes its solution back
+		 */
+		void finishAsync();
+
+		double* getParameterPtr(const Scalar* _st_ptr);
+
+		void loadParameters();
+
+		void storeParameters(const std::unordered_set<const Scalar*>& _removed);
+
+		/** \brief Adds the residual blocks of a batch of constraints, whose state blocks are already in the solver
+		 */
+		void addConstraints(const std::vector<ConstraintBase*>& _ctr_ptrs);
 
 		void removeConstraint(const unsigned int& _corr_idx);
 
@@ -70,13 +183,23 @@ class CeresManager
 
 		void removeStateBlock(double* _st_ptr);
 
-		void removeAllStateBlocks();
-
 		void updateStateBlockStatus(StateBlock* _st_ptr);
 
 		ceres::CostFunction* createCostFunction(ConstraintBase* _corrPtr);
 };
 
+inline bool CeresManager::isSolving() const
+{
+    return solving_.load(std::memory_order_acquire);
+}
+
+inline double* CeresManager::getParameterPtr(const Scalar* _st_ptr)
+{
+    auto buffer_it = parameter_buffers_.find(_st_ptr);
+    assert(buffer_it != parameter_buffers_.end() && "CeresManager: unknown state block");
+    return buffer_it->second.values_ptr_;
+}
+
 inline ceres::Solver::Options& CeresManager::getSolverOptions()
 {
     return ceres_options_;
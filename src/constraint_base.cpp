@@ -91,6 +91,22 @@ ConstraintBase::~ConstraintBase()
     //std::cout << "removed constraints to " << std::endl;
 }
 
+void* ConstraintBase::operator new(std::size_t _size)
+{
+    return getPool().allocate(_size);
+}
+
+void ConstraintBase::operator delete(void* _ptr, std::size_t _size)
+{
+    getPool().deallocate(_ptr, _size);
+}
+
+NodePool& ConstraintBase::getPool()
+{
+    static NodePool pool;
+    return pool;
+}
+
 const Eigen::VectorXs& ConstraintBase::getMeasurement() const
 {
     return getFeaturePtr()->getMeasurement();
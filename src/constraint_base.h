@@ -10,6 +10,7 @@ class NodeTerminus;
 //Wolf includes
 #include "wolf.h"
 #include "node_linked.h"
+#include "node_pool.h"
 
 //std includes
 //
@@ -57,6 +58,12 @@ class ConstraintBase : public NodeLinked<FeatureBase, NodeTerminus>
          **/
         virtual ~ConstraintBase();
 
+        /** \brief Allocation in the pool of constraints, see NodePool
+         */
+        static void* operator new(std::size_t _size);
+        static void operator delete(void* _ptr, std::size_t _size);
+        static NodePool& getPool();
+
         unsigned int id();
 
         /** \brief Returns the constraint type
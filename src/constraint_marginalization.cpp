@@ -0,0 +1,529 @@
+/**
+ * \file constraint_marginalization.cpp
+ *
+ *  Created on: Jul 14, 2016
+ *      \author: jsola
+ */
+
+#include "constraint_marginalization.h"
+#include "state_block.h"
+#include "local_parametrization_base.h"
+#include "frame_base.h"
+#include "feature_base.h"
+#include "landmark_base.h"
+
+// STL includes
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+
+namespace wolf {
+
+namespace {
+
+/** \brief Jacobian P of the plus operation of a state block at its current value: d(global) = P * d(local)
+ */
+Eigen::MatrixXs computePlusJacobian(StateBlock* _state_ptr)
+{
+    if (!_state_ptr->hasLocalParametrization())
+        return Eigen::MatrixXs::Identity(_state_ptr->getSize(), _state_ptr->getSize());
+
+    LocalParametrizationBase* local_param_ptr = _state_ptr->getLocalParametrizationPtr();
+    Eigen::MatrixXs P(local_param_ptr->getGlobalSize(), local_param_ptr->getLocalSize());
+    Eigen::Map<Eigen::MatrixXs> plus_jacobian(P.data(), P.rows(), P.cols());
+    local_param_ptr->computeJacobian(Eigen::Map<const Eigen::VectorXs>(_state_ptr->getPtr(), _state_ptr->getSize()), plus_jacobian);
+    return P;
+}
+
+/** \brief Jacobian w.r.t. the global state from the one w.r.t. the local state: d(local) = (P^T * P)^-1 * P^T * d(global)
+ */
+Eigen::MatrixXs toGlobalJacobian(StateBlock* _state_ptr, const Eigen::MatrixXs& _P, const Eigen::MatrixXs& _local_jacobian)
+{
+    if (!_state_ptr->hasLocalParametrization())
+        return _local_jacobian;
+    return _local_jacobian * (_P.transpose() * _P).inverse() * _P.transpose();
+}
+
+/** \brief Log-determinant of a symmetric positive definite matrix
+ */
+Scalar logDeterminant(const Eigen::MatrixXs& _M)
+{
+    Eigen::LLT<Eigen::MatrixXs> llt(_M);
+    return 2 * llt.matrixL().toDenseMatrix().diagonal().array().log().sum();
+}
+
+} // namespace
+
+ConstraintMarginalization::ConstraintMarginalization(const std::vector<StateBlock*>& _state_ptrs, const Eigen::MatrixXs& _jacobian,
+                                                     const Eigen::VectorXs& _residual, const std::list<FrameBase*>& _frame_ptrs,
+                                                     const std::list<LandmarkBase*>& _landmark_ptrs) :
+        ConstraintAnalytic(CTR_MARGINALIZATION, false, CTR_ACTIVE, _state_ptrs.front()),
+        state_offsets_(_state_ptrs.size()),
+        jacobian_(_jacobian),
+        residual_lin_(_residual),
+        frame_ptr_list_(_frame_ptrs),
+        landmark_ptr_list_(_landmark_ptrs)
+{
+    setType("MARGINALIZATION");
+
+    // any number of state blocks
+    state_ptr_vector_ = _state_ptrs;
+    state_block_sizes_vector_.clear();
+    unsigned int size = 0;
+    for (unsigned int i = 0; i < state_ptr_vector_.size(); i++)
+    {
+        state_offsets_[i] = size;
+        state_block_sizes_vector_.push_back(state_ptr_vector_[i]->getSize());
+        size += state_ptr_vector_[i]->getSize();
+    }
+    assert(jacobian_.rows() == residual_lin_.size() && jacobian_.cols() == size && "ConstraintMarginalization: wrong jacobian size");
+
+    state_lin_.resize(size);
+    for (unsigned int i = 0; i < state_ptr_vector_.size(); i++)
+        state_lin_.segment(state_offsets_[i], state_block_sizes_vector_[i]) = state_ptr_vector_[i]->getVector();
+
+    for (auto frame_ptr : frame_ptr_list_)
+        frame_ptr->addConstrainedBy(this);
+    for (auto landmark_ptr : landmark_ptr_list_)
+        landmark_ptr->addConstrainedBy(this);
+}
+
+ConstraintMarginalization::~ConstraintMarginalization()
+{
+    // the frame or landmark being destructed, if any, is waiting for this to leave its list
+    for (auto frame_ptr : frame_ptr_list_)
+        frame_ptr->removeConstrainedBy(this);
+    for (auto landmark_ptr : landmark_ptr_list_)
+        landmark_ptr->removeConstrainedBy(this);
+}
+
+const std::vector<Scalar*> ConstraintMarginalization::getStateBlockPtrVector()
+{
+    std::vector<Scalar*> state_block_ptrs;
+    for (auto state_ptr : state_ptr_vector_)
+        state_block_ptrs.push_back(state_ptr->getPtr());
+    return state_block_ptrs;
+}
+
+Eigen::VectorXs ConstraintMarginalization::evaluateResiduals(const std::vector<Eigen::Map<const Eigen::VectorXs> >& _st_vector) const
+{
+    Eigen::VectorXs residual = residual_lin_;
+    for (unsigned int i = 0; i < state_ptr_vector_.size(); i++)
+        residual += jacobian_.middleCols(state_offsets_[i], state_block_sizes_vector_[i])
+                * (_st_vector[i] - state_lin_.segment(state_offsets_[i], state_block_sizes_vector_[i]));
+    return residual;
+}
+
+void ConstraintMarginalization::evaluateJacobians(const std::vector<Eigen::Map<const Eigen::VectorXs> >& _st_vector,
+                                                  std::vector<Eigen::Map<Eigen::MatrixXs> >& jacobians,
+                                                  const std::vector<bool>& _compute_jacobian) const
+{
+    for (unsigned int i = 0; i < state_ptr_vector_.size(); i++)
+        if (_compute_jacobian[i])
+            jacobians[i] = jacobian_.middleCols(state_offsets_[i], state_block_sizes_vector_[i]);
+}
+
+void ConstraintMarginalization::evaluatePureJacobians(std::vector<Eigen::MatrixXs>& jacobians) const
+{
+    jacobians.resize(state_ptr_vector_.size());
+    for (unsigned int i = 0; i < state_ptr_vector_.size(); i++)
+        jacobians[i] = jacobian_.middleCols(state_offsets_[i], state_block_sizes_vector_[i]);
+}
+
+ConstraintMarginalization* ConstraintMarginalization::marginalize(FrameBase* _frame_ptr,
+                                                                  const std::list<LinearizedConstraint>& _linearized_constraints)
+{
+    // The estimated state blocks: the ones of the frame first, then the boundary ones
+    std::vector<StateBlock*> state_ptrs;
+    std::unordered_map<StateBlock*, unsigned int> state_index;
+    for (auto state_ptr : _frame_ptr->getStateBlockVector())
+        if (!state_ptr->isFixed() && state_index.find(state_ptr) == state_index.end())
+        {
+            state_index[state_ptr] = state_ptrs.size();
+            state_ptrs.push_back(state_ptr);
+        }
+    unsigned int n_marginal_blocks = state_ptrs.size();
+    for (auto& linearized : _linearized_constraints)
+        for (auto state_ptr : linearized.constraint_ptr_->getStatePtrVector())
+            if (!state_ptr->isFixed() && state_index.find(state_ptr) == state_index.end())
+            {
+                state_index[state_ptr] = state_ptrs.size();
+                state_ptrs.push_back(state_ptr);
+            }
+    if (state_ptrs.size() == n_marginal_blocks)
+        return nullptr;
+
+    // The problem is solved in the local (tangent) spaces: d(global) = P * d(local)
+    std::vector<unsigned int> local_offsets(state_ptrs.size() + 1, 0);
+    std::vector<Eigen::MatrixXs> plus_jacobians(state_ptrs.size());
+    for (unsigned int i = 0; i < state_ptrs.size(); i++)
+    {
+        plus_jacobians[i] = computePlusJacobian(state_ptrs[i]);
+        local_offsets[i + 1] = local_offsets[i] + plus_jacobians[i].cols();
+    }
+    unsigned int size = local_offsets.back();
+    unsigned int marginal_size = local_offsets[n_marginal_blocks];
+    unsigned int boundary_size = size - marginal_size;
+
+    // Information matrix and vector of the linearized constraints: H = J^T * J, g = J^T * r
+    Eigen::MatrixXs H = Eigen::MatrixXs::Zero(size, size);
+    Eigen::VectorXs g = Eigen::VectorXs::Zero(size);
+    for (auto& linearized : _linearized_constraints)
+    {
+        std::vector<StateBlock*> constraint_state_ptrs = linearized.constraint_ptr_->getStatePtrVector();
+        std::vector<unsigned int> indices;
+        std::vector<Eigen::MatrixXs> local_jacobians;
+        for (unsigned int i = 0; i < constraint_state_ptrs.size(); i++)
+            if (!constraint_state_ptrs[i]->isFixed())
+            {
+                indices.push_back(state_index[constraint_state_ptrs[i]]);
+                local_jacobians.push_back(linearized.jacobians_[i] * plus_jacobians[indices.back()]);
+            }
+        for (unsigned int i = 0; i < indices.size(); i++)
+        {
+            g.segment(local_offsets[indices[i]], local_jacobians[i].cols()) += local_jacobians[i].transpose() * linearized.residual_;
+            for (unsigned int j = 0; j < indices.size(); j++)
+                H.block(local_offsets[indices[i]], local_offsets[indices[j]], local_jacobians[i].cols(), local_jacobians[j].cols()) +=
+                        local_jacobians[i].transpose() * local_jacobians[j];
+        }
+    }
+
+    // Schur complement of the frame state, with a pseudo-inverse since it may be unobservable from these constraints alone
+    Eigen::MatrixXs H_bb = H.bottomRightCorner(boundary_size, boundary_size);
+    Eigen::VectorXs g_b = g.tail(boundary_size);
+    if (marginal_size > 0)
+    {
+        Eigen::SelfAdjointEigenSolver<Eigen::MatrixXs> marginal_eigen(H.topLeftCorner(marginal_size, marginal_size));
+        Scalar threshold = 1e-10 * std::max(Scalar(1), marginal_eigen.eigenvalues().cwiseAbs().maxCoeff());
+        Eigen::VectorXs inverse_eigenvalues = (marginal_eigen.eigenvalues().array() > threshold).select(
+                marginal_eigen.eigenvalues().cwiseInverse(), 0);
+        Eigen::MatrixXs H_mm_inverse = marginal_eigen.eigenvectors() * inverse_eigenvalues.asDiagonal() * marginal_eigen.eigenvectors().transpose();
+        Eigen::MatrixXs H_bm = H.bottomLeftCorner(boundary_size, marginal_size);
+        H_bb -= H_bm * H_mm_inverse * H_bm.transpose();
+        g_b -= H_bm * H_mm_inverse * g.head(marginal_size);
+    }
+
+    // Square root of the information left: H_bb = J^T * J, g_b = J^T * r
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXs> boundary_eigen(H_bb);
+    Scalar threshold = 1e-10 * std::max(Scalar(1), boundary_eigen.eigenvalues().cwiseAbs().maxCoeff());
+    std::vector<unsigned int> ranks;
+    for (unsigned int k = 0; k < boundary_size; k++)
+        if (boundary_eigen.eigenvalues()(k) > threshold)
+            ranks.push_back(k);
+    if (ranks.empty())
+        return nullptr;
+    Eigen::MatrixXs local_jacobian(ranks.size(), boundary_size);
+    Eigen::VectorXs residual(ranks.size());
+    for (unsigned int r = 0; r < ranks.size(); r++)
+    {
+        Scalar sqrt_eigenvalue = std::sqrt(boundary_eigen.eigenvalues()(ranks[r]));
+        local_jacobian.row(r) = sqrt_eigenvalue * boundary_eigen.eigenvectors().col(ranks[r]).transpose();
+        residual(r) = boundary_eigen.eigenvectors().col(ranks[r]).dot(g_b) / sqrt_eigenvalue;
+    }
+
+    // Back to the global sizes: d(local) = (P^T * P)^-1 * P^T * d(global)
+    std::vector<StateBlock*> boundary_ptrs(state_ptrs.begin() + n_marginal_blocks, state_ptrs.end());
+    unsigned int global_size = 0;
+    for (auto state_ptr : boundary_ptrs)
+        global_size += state_ptr->getSize();
+    Eigen::MatrixXs jacobian(ranks.size(), global_size);
+    unsigned int global_offset = 0;
+    for (unsigned int i = n_marginal_blocks; i < state_ptrs.size(); i++)
+    {
+        const Eigen::MatrixXs& P = plus_jacobians[i];
+        jacobian.middleCols(global_offset, P.rows()) = toGlobalJacobian(state_ptrs[i], P,
+                                                                        local_jacobian.middleCols(local_offsets[i] - marginal_size, P.cols()));
+        global_offset += P.rows();
+    }
+
+    // The frames and landmarks owning the boundary states, as far as the constraints tell
+    std::unordered_map<StateBlock*, FrameBase*> frame_of_state;
+    std::unordered_map<StateBlock*, LandmarkBase*> landmark_of_state;
+    auto add_frame = [&](FrameBase* _owner_ptr)
+    {
+        if (_owner_ptr != nullptr && _owner_ptr != _frame_ptr)
+            for (auto state_ptr : _owner_ptr->getStateBlockVector())
+                frame_of_state[state_ptr] = _owner_ptr;
+    };
+    auto add_landmark = [&](LandmarkBase* _owner_ptr)
+    {
+        if (_owner_ptr != nullptr)
+            for (auto state_ptr : _owner_ptr->getStateBlockVector())
+                landmark_of_state[state_ptr] = _owner_ptr;
+    };
+    for (auto& linearized : _linearized_constraints)
+    {
+        ConstraintBase* ctr_ptr = linearized.constraint_ptr_;
+        if (ctr_ptr->getFeaturePtr() != nullptr && ctr_ptr->getFeaturePtr()->getCapturePtr() != nullptr)
+            add_frame(ctr_ptr->getFeaturePtr()->getFramePtr());
+        add_frame(ctr_ptr->getFrameOtherPtr());
+        if (ctr_ptr->getFeatureOtherPtr() != nullptr)
+            add_frame(ctr_ptr->getFeatureOtherPtr()->getFramePtr());
+        add_landmark(ctr_ptr->getLandmarkOtherPtr());
+        if (ctr_ptr->getTypeId() == CTR_MARGINALIZATION)
+        {
+            for (auto frame_ptr : ((ConstraintMarginalization*)ctr_ptr)->getFramePtrList())
+                add_frame(frame_ptr);
+            for (auto landmark_ptr : ((ConstraintMarginalization*)ctr_ptr)->getLandmarkPtrList())
+                add_landmark(landmark_ptr);
+        }
+    }
+    std::list<FrameBase*> frame_ptrs;
+    std::list<LandmarkBase*> landmark_ptrs;
+    for (auto state_ptr : boundary_ptrs)
+    {
+        auto frame_it = frame_of_state.find(state_ptr);
+        if (frame_it != frame_of_state.end() && std::find(frame_ptrs.begin(), frame_ptrs.end(), frame_it->second) == frame_ptrs.end())
+            frame_ptrs.push_back(frame_it->second);
+        auto landmark_it = landmark_of_state.find(state_ptr);
+        if (landmark_it != landmark_of_state.end()
+                && std::find(landmark_ptrs.begin(), landmark_ptrs.end(), landmark_it->second) == landmark_ptrs.end())
+            landmark_ptrs.push_back(landmark_it->second);
+    }
+
+    return new ConstraintMarginalization(boundary_ptrs, jacobian, residual, frame_ptrs, landmark_ptrs);
+}
+
+std::list<ConstraintMarginalization*> ConstraintMarginalization::sparsify(ConstraintMarginalization* _prior_ptr)
+{
+    const std::vector<StateBlock*>& state_ptrs = _prior_ptr->state_ptr_vector_;
+
+    // The variables of the tree: the state blocks of each frame and landmark together, and each other state block alone
+    struct Group
+    {
+            std::vector<unsigned int> blocks;
+            FrameBase* frame_ptr;
+            LandmarkBase* landmark_ptr;
+    };
+    std::vector<Group> groups;
+    std::vector<bool> grouped(state_ptrs.size(), false);
+    auto add_group = [&](const std::vector<StateBlock*>& _owner_state_ptrs, FrameBase* _frame_ptr, LandmarkBase* _landmark_ptr)
+    {
+        Group group = {{}, _frame_ptr, _landmark_ptr};
+        for (unsigned int i = 0; i < state_ptrs.size(); i++)
+            if (!grouped[i] && std::find(_owner_state_ptrs.begin(), _owner_state_ptrs.end(), state_ptrs[i]) != _owner_state_ptrs.end())
+            {
+                group.blocks.push_back(i);
+                grouped[i] = true;
+            }
+        if (!group.blocks.empty())
+            groups.push_back(group);
+    };
+    for (auto frame_ptr : _prior_ptr->frame_ptr_list_)
+        add_group(frame_ptr->getStateBlockVector(), frame_ptr, nullptr);
+    for (auto landmark_ptr : _prior_ptr->landmark_ptr_list_)
+        add_group(landmark_ptr->getStateBlockVector(), nullptr, landmark_ptr);
+    for (unsigned int i = 0; i < state_ptrs.size(); i++)
+        if (!grouped[i])
+            add_group({state_ptrs[i]}, nullptr, nullptr);
+
+    // a tree on two variables is the prior itself
+    if (groups.size() <= 2)
+        return {_prior_ptr};
+
+    // Information matrix and vector, in the local spaces
+    std::vector<Eigen::MatrixXs> plus_jacobians(state_ptrs.size());
+    std::vector<unsigned int> local_offsets(state_ptrs.size() + 1, 0);
+    for (unsigned int i = 0; i < state_ptrs.size(); i++)
+    {
+        plus_jacobians[i] = computePlusJacobian(state_ptrs[i]);
+        local_offsets[i + 1] = local_offsets[i] + plus_jacobians[i].cols();
+    }
+    Eigen::MatrixXs local_jacobian(_prior_ptr->jacobian_.rows(), local_offsets.back());
+    for (unsigned int i = 0; i < state_ptrs.size(); i++)
+        local_jacobian.middleCols(local_offsets[i], plus_jacobians[i].cols()) =
+                _prior_ptr->jacobian_.middleCols(_prior_ptr->state_offsets_[i], plus_jacobians[i].rows()) * plus_jacobians[i];
+    Eigen::MatrixXs H = local_jacobian.transpose() * local_jacobian;
+    Eigen::VectorXs g = local_jacobian.transpose() * _prior_ptr->residual_lin_;
+
+    // the local coordinates of each group
+    std::vector<std::vector<unsigned int> > coordinates(groups.size());
+    for (unsigned int k = 0; k < groups.size(); k++)
+        for (auto i : groups[k].blocks)
+            for (unsigned int c = local_offsets[i]; c < local_offsets[i + 1]; c++)
+                coordinates[k].push_back(c);
+
+    // Relative information (e.g. odometry and loop closures only) leaves the directions of a gauge N unobservable.
+    // The variables are then shifted to a root group g, y_k = x_k - N_k * N_g^-1 * x_g, which is observable (generic linear constraints).
+    // It requires a root with N_g square and invertible, e.g. a frame for the rigid motions of a pose graph.
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXs> eigen(H);
+    Scalar threshold = 1e-10 * std::max(Scalar(1), eigen.eigenvalues().cwiseAbs().maxCoeff());
+    unsigned int gauge_size = 0;
+    while (gauge_size < H.rows() && eigen.eigenvalues()(gauge_size) <= threshold)
+        gauge_size++;
+    Eigen::MatrixXs N = eigen.eigenvectors().leftCols(gauge_size);
+    int root = -1;
+    Eigen::MatrixXs shift; // N_g^-1
+    if (gauge_size > 0)
+    {
+        Scalar best_condition = 0;
+        for (unsigned int k = 0; k < groups.size(); k++)
+            if (coordinates[k].size() == gauge_size)
+            {
+                Eigen::MatrixXs N_k(gauge_size, gauge_size);
+                for (unsigned int r = 0; r < gauge_size; r++)
+                    N_k.row(r) = N.row(coordinates[k][r]);
+                Eigen::JacobiSVD<Eigen::MatrixXs> svd(N_k);
+                Scalar condition = svd.singularValues().minCoeff() / svd.singularValues().maxCoeff();
+                if (condition > best_condition)
+                {
+                    best_condition = condition;
+                    root = k;
+                    shift = N_k.inverse();
+                }
+            }
+        if (root < 0 || best_condition < 1e-6)
+            return {_prior_ptr};
+    }
+
+    // the variables of the tree, and their information: the rows and columns of H out of the root
+    std::vector<unsigned int> variables;
+    std::vector<unsigned int> variable_offsets(1, 0);
+    std::vector<unsigned int> y_coordinates;
+    for (unsigned int k = 0; k < groups.size(); k++)
+        if ((int)k != root)
+        {
+            variables.push_back(k);
+            variable_offsets.push_back(variable_offsets.back() + coordinates[k].size());
+            y_coordinates.insert(y_coordinates.end(), coordinates[k].begin(), coordinates[k].end());
+        }
+    unsigned int y_size = y_coordinates.size();
+    Eigen::MatrixXs H_y(y_size, y_size);
+    Eigen::VectorXs g_y(y_size);
+    for (unsigned int r = 0; r < y_size; r++)
+    {
+        g_y(r) = g(y_coordinates[r]);
+        for (unsigned int c = 0; c < y_size; c++)
+            H_y(r, c) = H(y_coordinates[r], y_coordinates[c]);
+    }
+    Eigen::LDLT<Eigen::MatrixXs> H_y_ldlt(H_y);
+    if (H_y_ldlt.info() != Eigen::Success || H_y_ldlt.vectorD().minCoeff() <= threshold)
+        return {_prior_ptr};
+    Eigen::MatrixXs Sigma = H_y_ldlt.solve(Eigen::MatrixXs::Identity(y_size, y_size));
+    Eigen::VectorXs mean = -Sigma * g_y;
+
+    // Chow-Liu tree: the maximum spanning tree of the mutual informations between the variables (Prim)
+    auto sigma_block = [&](unsigned int _a, unsigned int _b)
+    {
+        return Sigma.block(variable_offsets[_a], variable_offsets[_b], variable_offsets[_a + 1] - variable_offsets[_a],
+                           variable_offsets[_b + 1] - variable_offsets[_b]);
+    };
+    unsigned int n = variables.size();
+    Eigen::MatrixXs mutual_information = Eigen::MatrixXs::Zero(n, n);
+    std::vector<Scalar> log_det(n);
+    for (unsigned int a = 0; a < n; a++)
+        log_det[a] = logDeterminant(sigma_block(a, a));
+    for (unsigned int a = 0; a < n; a++)
+        for (unsigned int b = a + 1; b < n; b++)
+        {
+            unsigned int size_a = variable_offsets[a + 1] - variable_offsets[a], size_b = variable_offsets[b + 1] - variable_offsets[b];
+            Eigen::MatrixXs Sigma_ab(size_a + size_b, size_a + size_b);
+            Sigma_ab << sigma_block(a, a), sigma_block(a, b), sigma_block(b, a), sigma_block(b, b);
+            mutual_information(a, b) = mutual_information(b, a) = 0.5 * (log_det[a] + log_det[b] - logDeterminant(Sigma_ab));
+        }
+    std::vector<int> parent(n, -1);
+    std::vector<bool> in_tree(n, false);
+    std::vector<Scalar> best_information(n, -std::numeric_limits<Scalar>::infinity());
+    in_tree[0] = true;
+    for (unsigned int b = 1; b < n; b++)
+    {
+        best_information[b] = mutual_information(0, b);
+        parent[b] = 0;
+    }
+    for (unsigned int step = 1; step < n; step++)
+    {
+        unsigned int next = 0;
+        Scalar best = -std::numeric_limits<Scalar>::infinity();
+        for (unsigned int b = 0; b < n; b++)
+            if (!in_tree[b] && best_information[b] > best)
+            {
+                best = best_information[b];
+                next = b;
+            }
+        in_tree[next] = true;
+        for (unsigned int b = 0; b < n; b++)
+            if (!in_tree[b] && mutual_information(next, b) > best_information[b])
+            {
+                best_information[b] = mutual_information(next, b);
+                parent[b] = next;
+            }
+    }
+
+    // One factor per variable: p(y_0) for the first one, p(y_b | y_parent) for the others.
+    // Each one is r = U * (y_b - mean_b - A * (y_p - mean_p)), with A = Sigma_bp * Sigma_pp^-1 and U^T * U = (Sigma_bb - A * Sigma_pb)^-1
+    std::list<ConstraintMarginalization*> factor_ptrs;
+    for (unsigned int b = 0; b < n; b++)
+    {
+        unsigned int size_b = variable_offsets[b + 1] - variable_offsets[b];
+        Eigen::MatrixXs conditional_covariance = sigma_block(b, b);
+        Eigen::VectorXs conditional_mean = mean.segment(variable_offsets[b], size_b);
+        Eigen::MatrixXs A;
+        if (parent[b] >= 0)
+        {
+            unsigned int p = parent[b], size_p = variable_offsets[p + 1] - variable_offsets[p];
+            A = sigma_block(b, p) * sigma_block(p, p).inverse();
+            conditional_covariance -= A * sigma_block(p, b);
+            conditional_mean -= A * mean.segment(variable_offsets[p], size_p);
+        }
+        Eigen::MatrixXs conditional_information = conditional_covariance.inverse();
+        Eigen::LLT<Eigen::MatrixXs> llt(0.5 * (conditional_information + conditional_information.transpose()));
+        Eigen::MatrixXs U = llt.matrixU();
+
+        // the jacobians w.r.t. the local coordinates of the groups: y_k = x_k - N_k * N_g^-1 * x_g
+        std::vector<std::pair<unsigned int, Eigen::MatrixXs> > group_jacobians;
+        group_jacobians.push_back(std::make_pair(variables[b], U));
+        if (parent[b] >= 0)
+            group_jacobians.push_back(std::make_pair(variables[parent[b]], Eigen::MatrixXs(-U * A)));
+        if (root >= 0)
+        {
+            Eigen::MatrixXs root_jacobian = Eigen::MatrixXs::Zero(size_b, gauge_size);
+            for (auto& group_jacobian : group_jacobians)
+            {
+                Eigen::MatrixXs N_k(coordinates[group_jacobian.first].size(), gauge_size);
+                for (unsigned int r = 0; r < N_k.rows(); r++)
+                    N_k.row(r) = N.row(coordinates[group_jacobian.first][r]);
+                root_jacobian -= group_jacobian.second * N_k * shift;
+            }
+            group_jacobians.push_back(std::make_pair(root, root_jacobian));
+        }
+
+        // to the state blocks of the groups, in their global sizes
+        std::vector<StateBlock*> factor_state_ptrs;
+        std::list<FrameBase*> factor_frame_ptrs;
+        std::list<LandmarkBase*> factor_landmark_ptrs;
+        std::vector<Eigen::MatrixXs> block_jacobians;
+        unsigned int global_size = 0;
+        for (auto& group_jacobian : group_jacobians)
+        {
+            const Group& group = groups[group_jacobian.first];
+            unsigned int local_offset = 0;
+            for (auto i : group.blocks)
+            {
+                const Eigen::MatrixXs& P = plus_jacobians[i];
+                factor_state_ptrs.push_back(state_ptrs[i]);
+                block_jacobians.push_back(toGlobalJacobian(state_ptrs[i], P, group_jacobian.second.middleCols(local_offset, P.cols())));
+                local_offset += P.cols();
+                global_size += P.rows();
+            }
+            if (group.frame_ptr != nullptr)
+                factor_frame_ptrs.push_back(group.frame_ptr);
+            if (group.landmark_ptr != nullptr)
+                factor_landmark_ptrs.push_back(group.landmark_ptr);
+        }
+        Eigen::MatrixXs jacobian(size_b, global_size);
+        unsigned int global_offset = 0;
+        for (auto& block_jacobian : block_jacobians)
+        {
+            jacobian.middleCols(global_offset, block_jacobian.cols()) = block_jacobian;
+            global_offset += block_jacobian.cols();
+        }
+
+        factor_ptrs.push_back(new ConstraintMarginalization(factor_state_ptrs, jacobian, -U * conditional_mean, factor_frame_ptrs,
+                                                            factor_landmark_ptrs));
+    }
+
+    delete _prior_ptr;
+    return factor_ptrs;
+}
+
+} // namespace wolf
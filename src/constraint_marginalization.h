@@ -0,0 +1,136 @@
+/**
+ * \file constraint_marginalization.h
+ *
+ *  Created on: Jul 14, 2016
+ *      \author: jsola
+ */
+
+#ifndef CONSTRAINT_MARGINALIZATION_H_
+#define CONSTRAINT_MARGINALIZATION_H_
+
+// Fwd refs
+namespace wolf{
+class FrameBase;
+class LandmarkBase;
+}
+
+//Wolf includes
+#include "constraint_analytic.h"
+
+// STL includes
+#include <list>
+#include <vector>
+
+namespace wolf {
+
+/** \brief A constraint linearized at the current state, as the solver evaluates it
+ */
+struct LinearizedConstraint
+{
+        ConstraintBase* constraint_ptr_;
+        Eigen::VectorXs residual_;                  ///< the residual, weighted by the square root information
+        std::vector<Eigen::MatrixXs> jacobians_;    ///< of the residual w.r.t. each state block of the constraint, in its global size
+};
+
+/** \brief Dense Gaussian prior left by the marginalization of a key frame
+ *
+ * When a key frame is marginalized, the constraints on its state are linearized and its state is eliminated from them (Schur complement).
+ * The result is a Gaussian on the other states of those constraints, the boundary states, which this constraint keeps:
+ *
+ *   r = r_lin + J * (x - x_lin)
+ *
+ * with x the stacked boundary states, x_lin their values at the marginalization,
+ * and J^T * J and J^T * r_lin the information matrix and vector left by the marginalized state.
+ *
+ * It constrains any number of state blocks, and it is constrained by all the frames and landmarks owning them:
+ * when one of them is destructed, the prior is destructed as well.
+ */
+class ConstraintMarginalization : public ConstraintAnalytic
+{
+    protected:
+        std::vector<unsigned int> state_offsets_;   ///< position of each state block in x
+        Eigen::VectorXs state_lin_;                 ///< x_lin
+        Eigen::MatrixXs jacobian_;                  ///< J
+        Eigen::VectorXs residual_lin_;              ///< r_lin
+        std::list<FrameBase*> frame_ptr_list_;       ///< frames owning some of the state blocks
+        std::list<LandmarkBase*> landmark_ptr_list_; ///< landmarks owning some of the state blocks
+
+    public:
+        /** \brief Constructor
+         * \param _state_ptrs the state blocks, linearized at their current values
+         * \param _jacobian J, with the columns of the state blocks one after the other, in their global sizes
+         * \param _residual r_lin
+         * \param _frame_ptrs the frames owning some of the state blocks
+         * \param _landmark_ptrs the landmarks owning some of the state blocks
+         */
+        ConstraintMarginalization(const std::vector<StateBlock*>& _state_ptrs, const Eigen::MatrixXs& _jacobian,
+                                  const Eigen::VectorXs& _residual, const std::list<FrameBase*>& _frame_ptrs = {},
+                                  const std::list<LandmarkBase*>& _landmark_ptrs = {});
+
+        /** \brief Default destructor (not recommended)
+         *
+         * Default destructor (please use destruct() instead of delete for guaranteeing the wolf tree integrity)
+         **/
+        virtual ~ConstraintMarginalization();
+
+        /** \brief Marginalizes the state of a key frame out of the constraints on it
+         *
+         * The state blocks of the frame, and the fixed state blocks, are eliminated. The others are the boundary states of the new prior.
+         * The frames and landmarks linked to the prior are the ones owning the boundary states, as far as the constraints tell.
+         *
+         * \param _frame_ptr the key frame
+         * \param _linearized_constraints all the constraints on the state of the frame, linearized at the current state
+         * \return the prior on the boundary states, not yet in the Wolf tree, or nullptr if they get no information
+         */
+        static ConstraintMarginalization* marginalize(FrameBase* _frame_ptr, const std::list<LinearizedConstraint>& _linearized_constraints);
+
+        /** \brief Sparsifies a dense prior into a Chow-Liu tree of smaller priors
+         *
+         * The variables of the tree are the frames and landmarks of the prior, and its other state blocks alone.
+         * The tree is the maximum spanning tree of the mutual informations between them, and it keeps one prior per variable:
+         * the marginal of the first one, and the conditional of each other one on its parent.
+         * This is the tree-structured Gaussian closest to the prior (Kullback-Leibler), with the same mean.
+         *
+         * Relative information, e.g. of a pose graph without absolute reference, leaves a gauge unobservable.
+         * Then the variables are relative to a root variable, which all the priors of the tree involve as well (generic linear constraints).
+         *
+         * \param _prior_ptr a prior just given by marginalize(), linearized at the current state, not yet in the Wolf tree
+         * \return the priors of the tree, not yet in the Wolf tree. They replace _prior_ptr, which is deleted.
+         * If there are two variables or less, or no root makes the information invertible, just _prior_ptr.
+         */
+        static std::list<ConstraintMarginalization*> sparsify(ConstraintMarginalization* _prior_ptr);
+
+        virtual const std::vector<Scalar*> getStateBlockPtrVector();
+
+        virtual unsigned int getSize() const;
+
+        virtual Eigen::VectorXs evaluateResiduals(const std::vector<Eigen::Map<const Eigen::VectorXs> >& _st_vector) const;
+
+        virtual void evaluateJacobians(const std::vector<Eigen::Map<const Eigen::VectorXs> >& _st_vector,
+                                       std::vector<Eigen::Map<Eigen::MatrixXs> >& jacobians,
+                                       const std::vector<bool>& _compute_jacobian) const;
+
+        virtual void evaluatePureJacobians(std::vector<Eigen::MatrixXs>& jacobians) const;
+
+        const std::list<FrameBase*>& getFramePtrList() const;
+        const std::list<LandmarkBase*>& getLandmarkPtrList() const;
+};
+
+inline unsigned int ConstraintMarginalization::getSize() const
+{
+    return residual_lin_.size();
+}
+
+inline const std::list<FrameBase*>& ConstraintMarginalization::getFramePtrList() const
+{
+    return frame_ptr_list_;
+}
+
+inline const std::list<LandmarkBase*>& ConstraintMarginalization::getLandmarkPtrList() const
+{
+    return landmark_ptr_list_;
+}
+
+} // namespace wolf
+
+#endif /* CONSTRAINT_MARGINALIZATION_H_ */
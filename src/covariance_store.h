@@ -0,0 +1,190 @@
+/**
+ * \file covariance_store.h
+ *
+ *  Created on: Jul 4, 2016
+ *      \author: jsola
+ */
+
+#ifndef SRC_COVARIANCE_STORE_H_
+#define SRC_COVARIANCE_STORE_H_
+
+#include "wolf.h"
+#include "state_block.h"
+
+// STL includes
+#include <functional>
+#include <unordered_map>
+#include <utility> // pair
+#include <vector>
+
+namespace wolf {
+
+/** \brief Symmetric block-sparse covariance matrix
+ *
+ * Stores the blocks of the covariance between pairs of state blocks.
+ * The covariance is symmetric, so each unordered pair {A, B} is stored once:
+ * the block (B, A) is read as the transpose of the block (A, B).
+ *
+ * The blocks live one after the other in a single arena, row major, the format of Ceres' covariance blocks.
+ * The index is a hash table from the pair of state blocks to the position of its block in the arena.
+ * Reading a block gives an Eigen::Map on the arena, transposed by means of the map strides if necessary, so nothing is copied.
+ *
+ * clear() keeps the memory, so that recomputing the covariances after each solve does not allocate once the sizes are known.
+ * Adding blocks may reallocate the arena, which invalidates the maps previously read. Use reserve() to avoid it.
+ */
+class CovarianceStore
+{
+    public:
+        typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> MatrixRowMajor;
+        typedef Eigen::Map<MatrixRowMajor> BlockMap;
+        typedef Eigen::Map<const MatrixRowMajor, 0, Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic> > ConstBlockMap;
+
+        CovarianceStore();
+        ~CovarianceStore();
+
+        /** \brief Removes all blocks, keeping the memory
+         */
+        void clear();
+
+        /** \brief Reserves memory for a number of blocks and of scalars
+         */
+        void reserve(unsigned int _n_blocks, unsigned int _n_scalars);
+
+        /** \brief Makes room for the block (_state1, _state2)
+         * \return a map on the block, _state1 size x _state2 size, to be written by the caller.
+         *
+         * If the block (_state1, _state2) or (_state2, _state1) already existed, its memory is reused.
+         */
+        BlockMap addBlock(StateBlock* _state1, StateBlock* _state2);
+
+        /** \brief Stores the block (_state1, _state2)
+         */
+        template<typename Derived>
+        void addBlock(StateBlock* _state1, StateBlock* _state2, const Eigen::MatrixBase<Derived>& _cov);
+
+        /** \brief Gets a view of the block (_state1, _state2), whichever the order it was stored with
+         * \return a map on the block, _state1 size x _state2 size. Its data() is nullptr if the block is not stored.
+         */
+        ConstBlockMap getBlock(StateBlock* _state1, StateBlock* _state2) const;
+
+        bool hasBlock(StateBlock* _state1, StateBlock* _state2) const;
+
+        unsigned int size() const;          ///< number of blocks
+        unsigned int scalarsSize() const;   ///< number of scalars in all blocks
+
+    private:
+        typedef std::pair<StateBlock*, StateBlock*> Key;
+        struct KeyHash
+        {
+                std::size_t operator()(const Key& _key) const
+                {
+                    std::size_t h1 = std::hash<StateBlock*>()(_key.first);
+                    std::size_t h2 = std::hash<StateBlock*>()(_key.second);
+                    return h1 ^ (h2 + 0x9e3779b9 + (h1 << 6) + (h1 >> 2));
+                }
+        };
+        struct Block
+        {
+                std::size_t offset_;        ///< position of the first scalar in the arena
+                StateBlock* row_state_ptr_; ///< the state block of the rows, as stored
+                unsigned int rows_;
+                unsigned int cols_;
+        };
+
+        static Key makeKey(StateBlock* _state1, StateBlock* _state2);
+
+        std::unordered_map<Key, Block, KeyHash> blocks_;
+        std::vector<Scalar> arena_;
+};
+
+inline CovarianceStore::CovarianceStore()
+{
+    //
+}
+
+inline CovarianceStore::~CovarianceStore()
+{
+    //
+}
+
+inline CovarianceStore::Key CovarianceStore::makeKey(StateBlock* _state1, StateBlock* _state2)
+{
+    return std::less<StateBlock*>()(_state1, _state2) ? Key(_state1, _state2) : Key(_state2, _state1);
+}
+
+inline void CovarianceStore::clear()
+{
+    blocks_.clear();
+    arena_.clear();
+}
+
+inline void CovarianceStore::reserve(unsigned int _n_blocks, unsigned int _n_scalars)
+{
+    blocks_.reserve(_n_blocks);
+    arena_.reserve(_n_scalars);
+}
+
+inline CovarianceStore::BlockMap CovarianceStore::addBlock(StateBlock* _state1, StateBlock* _state2)
+{
+    unsigned int rows = _state1->getSize();
+    unsigned int cols = _state2->getSize();
+
+    auto inserted = blocks_.emplace(makeKey(_state1, _state2), Block());
+    Block& block = inserted.first->second;
+    if (inserted.second)
+    {
+        block.offset_ = arena_.size();
+        arena_.resize(arena_.size() + rows * cols);
+    }
+    else
+        assert(block.rows_ * block.cols_ == rows * cols && "CovarianceStore::addBlock: state block sizes changed");
+    block.row_state_ptr_ = _state1;
+    block.rows_ = rows;
+    block.cols_ = cols;
+
+    return BlockMap(arena_.data() + block.offset_, rows, cols);
+}
+
+template<typename Derived>
+inline void CovarianceStore::addBlock(StateBlock* _state1, StateBlock* _state2, const Eigen::MatrixBase<Derived>& _cov)
+{
+    assert(_state1->getSize() == (unsigned int)_cov.rows() && "CovarianceStore::addBlock: wrong covariance block size");
+    assert(_state2->getSize() == (unsigned int)_cov.cols() && "CovarianceStore::addBlock: wrong covariance block size");
+
+    addBlock(_state1, _state2) = _cov;
+}
+
+inline CovarianceStore::ConstBlockMap CovarianceStore::getBlock(StateBlock* _state1, StateBlock* _state2) const
+{
+    typedef Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic> Stride;
+
+    auto block_it = blocks_.find(makeKey(_state1, _state2));
+    if (block_it == blocks_.end())
+        return ConstBlockMap(nullptr, 0, 0, Stride(0, 0));
+
+    const Block& block = block_it->second;
+    const Scalar* data = arena_.data() + block.offset_;
+    if (block.row_state_ptr_ == _state1)
+        return ConstBlockMap(data, block.rows_, block.cols_, Stride(block.cols_, 1));
+    else // stored the other way round: the transpose is the same data with the strides swapped
+        return ConstBlockMap(data, block.cols_, block.rows_, Stride(1, block.cols_));
+}
+
+inline bool CovarianceStore::hasBlock(StateBlock* _state1, StateBlock* _state2) const
+{
+    return blocks_.find(makeKey(_state1, _state2)) != blocks_.end();
+}
+
+inline unsigned int CovarianceStore::size() const
+{
+    return blocks_.size();
+}
+
+inline unsigned int CovarianceStore::scalarsSize() const
+{
+    return arena_.size();
+}
+
+} // namespace wolf
+
+#endif /* SRC_COVARIANCE_STORE_H_ */
@@ -0,0 +1,210 @@
+/**
+ * \file test_capture_executor.cpp
+ *
+ *  Created on: Jul 7, 2016
+ *      \author: jsola
+ */
+
+// Classes under test
+#include "capture_executor.h"
+#include "processor_tracker_feature.h"
+
+// Wolf includes
+#include "wolf.h"
+#include "problem.h"
+#include "sensor_base.h"
+#include "trajectory_base.h"
+#include "frame_base.h"
+#include "capture_void.h"
+#include "constraint_epipolar.h"
+#include "state_block.h"
+
+// STL includes
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+// General includes
+#include <iostream>
+
+using namespace wolf;
+
+/** A feature tracker whose extraction takes some time.
+ * The features of a capture are computed from its time stamp, and every 5 captures it votes for a key frame.
+ */
+class ProcessorTrackerFeatureExtract : public ProcessorTrackerFeature
+{
+    public:
+        ProcessorTrackerFeatureExtract(Scalar _extraction_time) :
+                ProcessorTrackerFeature(PRC_TRACKER_DUMMY, "TRACKER FEATURE EXTRACT", 3), extraction_time_(_extraction_time), n_tracked_(0)
+        {
+            //
+        }
+
+    protected:
+        Scalar extraction_time_;
+        unsigned int n_tracked_;
+        std::vector<Scalar> values_incoming_;
+
+        virtual void extractIncoming(CaptureBase* _incoming_ptr)
+        {
+            // the extraction time, e.g. of the corners of a laser scan
+            std::this_thread::sleep_for(std::chrono::duration<Scalar>(extraction_time_));
+            values_incoming_.clear();
+            for (unsigned int i = 0; i < 3; i++)
+                values_incoming_.push_back(_incoming_ptr->getTimeStamp().get() * 100 + i);
+        }
+
+        virtual unsigned int trackFeatures(const FeatureBaseList& _feature_list_in, FeatureBaseList& _feature_list_out,
+                                           FeatureMatchMap& _feature_correspondences)
+        {
+            unsigned int i = 0;
+            for (auto feature_in_ptr : _feature_list_in)
+            {
+                _feature_list_out.push_back(new FeatureBase(FEATURE_POINT_IMAGE, "POINT IMAGE",
+                                                            Eigen::Vector1s::Constant(values_incoming_[i++ % 3]),
+                                                            Eigen::MatrixXs::Ones(1, 1)));
+                _feature_correspondences[_feature_list_out.back()] = FeatureMatch({feature_in_ptr, 0});
+            }
+            n_tracked_++;
+            return _feature_list_out.size();
+        }
+
+        virtual bool correctFeatureDrift(const FeatureBase* _origin_feature, const FeatureBase* _last_feature, FeatureBase* _incoming_feature)
+        {
+            return true;
+        }
+
+        virtual bool voteForKeyFrame()
+        {
+            return n_tracked_ % 5 == 0;
+        }
+
+        virtual unsigned int detectNewFeatures(const unsigned int& _max_features)
+        {
+            for (unsigned int i = 0; i < _max_features; i++)
+                new_features_last_.push_back(new FeatureBase(FEATURE_POINT_IMAGE, "POINT IMAGE",
+                                                             Eigen::Vector1s::Constant(last_ptr_->getTimeStamp().get() * 100 + 10 + i),
+                                                             Eigen::MatrixXs::Ones(1, 1)));
+            return new_features_last_.size();
+        }
+
+        virtual ConstraintBase* createConstraint(FeatureBase* _feature_ptr, FeatureBase* _feature_other_ptr)
+        {
+            return new ConstraintEpipolar(_feature_ptr, _feature_other_ptr);
+        }
+};
+
+/** Processes the captures of _n_sensors sensors with different rates, during _n_periods periods of the fastest,
+ * through a CaptureExecutor of _n_threads threads, or through CaptureBase::process() if _n_threads is 0.
+ * Returns the resulting trajectory in text form, and the processing time per capture.
+ */
+std::string run(unsigned int _n_threads, unsigned int _n_sensors, unsigned int _n_periods, Scalar _extraction_time,
+                Scalar& _time_per_capture)
+{
+    Scalar dt = 0.01;
+    Problem* problem_ptr = new Problem(FRM_PO_2D);
+    std::map<SensorBase*, unsigned int> sensor_index;
+    std::vector<CaptureBase*> captures;
+    for (unsigned int i = 0; i < _n_sensors; i++)
+    {
+        SensorBase* sensor_ptr = new SensorBase(SEN_ODOM_2D, "ODOM 2D", new StateBlock(Eigen::Vector2s::Zero(), true),
+                                                new StateBlock(Eigen::Vector1s::Zero(), true),
+                                                new StateBlock(Eigen::VectorXs::Zero(0), true), 0);
+        problem_ptr->addSensor(sensor_ptr);
+        sensor_ptr->addProcessor(new ProcessorTrackerFeatureExtract(_extraction_time));
+        sensor_index[sensor_ptr] = i;
+        // odd sensors have half the rate, and the time stamps of even sensors are shifted by dt/2
+        Scalar period = (i % 2 + 1) * dt;
+        Scalar offset = (i % 2 == 0 && i > 0 ? dt / 2 : 0);
+        for (unsigned int k = 0; k * period < _n_periods * dt; k++)
+            captures.push_back(new CaptureVoid(TimeStamp(offset + k * period), sensor_ptr));
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    if (_n_threads == 0)
+    {
+        // one capture after the other, in time stamp order, ties in order of creation
+        std::stable_sort(captures.begin(), captures.end(), [](CaptureBase* _c1, CaptureBase* _c2)
+        {
+            return _c1->getTimeStamp() < _c2->getTimeStamp();
+        });
+        for (auto capture_ptr : captures)
+            capture_ptr->process();
+    }
+    else
+    {
+        CaptureExecutor executor(_n_threads);
+        for (auto capture_ptr : captures)
+            executor.push(capture_ptr);
+        executor.flush();
+    }
+    _time_per_capture = std::chrono::duration<Scalar>(std::chrono::steady_clock::now() - begin).count() / captures.size();
+
+    // the trajectory, in text form
+    std::stringstream trajectory;
+    for (auto frame_ptr : *(problem_ptr->getTrajectoryPtr()->getFrameListPtr()))
+    {
+        trajectory << (frame_ptr->isKey() ? "key frame " : "frame ") << frame_ptr->getTimeStamp().get() << ":";
+        for (auto capture_ptr : *(frame_ptr->getCaptureListPtr()))
+        {
+            trajectory << " sensor " << sensor_index[capture_ptr->getSensorPtr()] << " at " << capture_ptr->getTimeStamp().get() << " [";
+            for (auto feature_ptr : *(capture_ptr->getFeatureListPtr()))
+                trajectory << " " << feature_ptr->getMeasurement()(0) << "/" << feature_ptr->getConstraintListPtr()->size();
+            trajectory << " ]";
+        }
+        trajectory << std::endl;
+    }
+
+    problem_ptr->destruct();
+    return trajectory.str();
+}
+
+int main()
+{
+    bool all_ok = true;
+    bool ok;
+
+    std::cout << std::endl << "==================== Capture executor test ======================" << std::endl;
+
+    unsigned int n_sensors = 4;
+    unsigned int n_periods = 60;
+    Scalar extraction_time = 0.002;
+    Scalar time_process, time_sequential, time_parallel;
+
+    std::string trajectory_process = run(0, n_sensors, n_periods, extraction_time, time_process);
+    std::string trajectory_sequential = run(1, n_sensors, n_periods, extraction_time, time_sequential);
+    std::string trajectory_parallel = run(n_sensors, n_sensors, n_periods, extraction_time, time_parallel);
+
+    std::cout << "Key frames created... ";
+    ok = trajectory_process.find("key frame") != std::string::npos;
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Same tree with one thread as processing in time stamp order... ";
+    ok = (trajectory_sequential == trajectory_process);
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Same tree with " << n_sensors << " threads as with one... ";
+    ok = (trajectory_parallel == trajectory_sequential);
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Extractions overlapped... ";
+    ok = time_parallel < 0.6 * time_sequential;
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Time per capture, " << n_sensors << " sensors extracting in " << extraction_time * 1e3 << " ms:" << std::endl;
+    std::cout << "    CaptureBase::process(): " << time_process * 1e3 << " ms" << std::endl;
+    std::cout << "    executor, 1 thread:     " << time_sequential * 1e3 << " ms" << std::endl;
+    std::cout << "    executor, " << n_sensors << " threads:    " << time_parallel * 1e3 << " ms" << std::endl;
+
+    std::cout << (all_ok ? "All tests passed" : "Some tests FAILED") << std::endl;
+
+    return all_ok ? 0 : 1;
+}
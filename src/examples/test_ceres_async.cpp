@@ -0,0 +1,162 @@
+/**
+ * \file test_ceres_async.cpp
+ *
+ *  Created on: Jul 5, 2016
+ *      \author: jsola
+ */
+
+// Classes under test
+#include "ceres_wrapper/ceres_manager.h"
+
+// Wolf includes
+#include "wolf.h"
+#include "problem.h"
+#include "processor_odom_2D.h"
+#include "capture_fix.h"
+#include "state_block.h"
+
+// STL includes
+#include <chrono>
+
+// General includes
+#include <iostream>
+
+using namespace wolf;
+
+struct Latencies
+{
+        Scalar mean_;
+        Scalar max_;
+        Scalar solve_;
+        unsigned int n_solves_;
+};
+
+/** Drives a robot with 2D odometry and absolute pose fixes at every key frame,
+ * solving every _solve_period steps, either inline or asynchronously.
+ * Returns the latencies of the front-end steps, and the final pose of the last key frame.
+ */
+Latencies run(bool _async, unsigned int _N, unsigned int _solve_period, Eigen::VectorXs& _x_last_key_frame)
+{
+    Scalar dt = 0.01;
+    Eigen::Vector3s x0(0, 0, 0);
+    Eigen::Matrix3s fix_cov = Eigen::Matrix3s::Identity() * 0.01;
+    Eigen::VectorXs data(2);
+    data << 0.01, 0.001;
+    Eigen::MatrixXs data_cov = Eigen::MatrixXs::Identity(2, 2) * 1e-4;
+
+    Problem* problem_ptr = new Problem(FRM_PO_2D);
+    SensorBase* sensor_odom_ptr = new SensorBase(SEN_ODOM_2D, "ODOM 2D", new StateBlock(Eigen::Vector2s::Zero(), true),
+                                                 new StateBlock(Eigen::Vector1s::Zero(), true),
+                                                 new StateBlock(Eigen::VectorXs::Zero(0), true), 0);
+    SensorBase* sensor_fix_ptr = new SensorBase(SEN_ABSOLUTE_POSE, "ABSOLUTE POSE", nullptr, nullptr, nullptr, 0);
+    ProcessorOdom2D* odom2d_ptr = new ProcessorOdom2D(1e9, 1e9, 10 * dt - dt / 2); // a key frame every 10 steps
+    sensor_odom_ptr->addProcessor(odom2d_ptr);
+    problem_ptr->addSensor(sensor_odom_ptr);
+    problem_ptr->addSensor(sensor_fix_ptr);
+
+    ceres::Solver::Options ceres_options;
+    ceres_options.max_num_iterations = 100;
+    CeresManager* ceres_manager_ptr = new CeresManager(problem_ptr, ceres_options);
+
+    FrameBase* origin_frame_ptr = problem_ptr->createFrame(KEY_FRAME, x0, TimeStamp(0));
+    CaptureFix* fix_ptr = new CaptureFix(TimeStamp(0), sensor_fix_ptr, x0, fix_cov);
+    origin_frame_ptr->addCapture(fix_ptr);
+    fix_ptr->process();
+    odom2d_ptr->setOrigin(origin_frame_ptr);
+
+    CaptureMotion* capture_ptr = new CaptureMotion(TimeStamp(0), sensor_odom_ptr, data, data_cov, nullptr);
+    FrameBase* last_key_frame_ptr = origin_frame_ptr;
+    Eigen::Vector3s x_true = x0;
+    Latencies latencies = {0, 0, 0, 0};
+    ceres::Solver::Summary summary;
+    TimeStamp ts_solved;
+    for (unsigned int i = 1; i <= _N; i++)
+    {
+        auto begin = std::chrono::steady_clock::now();
+
+        // front-end: odometry, and a noisy absolute pose at each new key frame
+        capture_ptr->setTimeStamp(TimeStamp(i * dt));
+        odom2d_ptr->process(capture_ptr);
+        x_true(0) += cos(x_true(2) + data(1) / 2) * data(0);
+        x_true(1) += sin(x_true(2) + data(1) / 2) * data(0);
+        x_true(2) += data(1);
+        if (problem_ptr->getLastKeyFramePtr() != last_key_frame_ptr)
+        {
+            last_key_frame_ptr = problem_ptr->getLastKeyFramePtr();
+            Eigen::Vector3s x_fix = x_true + Eigen::Vector3s::Random() * 0.1;
+            fix_ptr = new CaptureFix(last_key_frame_ptr->getTimeStamp(), sensor_fix_ptr, x_fix, fix_cov);
+            last_key_frame_ptr->addCapture(fix_ptr);
+            fix_ptr->process();
+        }
+
+        // back-end
+        if (_async)
+        {
+            if (ceres_manager_ptr->writeBackSolution(summary, ts_solved, false))
+                latencies.solve_ += summary.total_time_in_seconds;
+            if (i % _solve_period == 0 && !ceres_manager_ptr->isSolving())
+            {
+                ceres_manager_ptr->solveAsync();
+                latencies.n_solves_++;
+            }
+        }
+        else if (i % _solve_period == 0)
+        {
+            summary = ceres_manager_ptr->solve();
+            latencies.solve_ += summary.total_time_in_seconds;
+            latencies.n_solves_++;
+        }
+
+        Scalar latency = std::chrono::duration<Scalar>(std::chrono::steady_clock::now() - begin).count();
+        latencies.mean_ += latency / _N;
+        latencies.max_ = std::max(latencies.max_, latency);
+    }
+    if (_async && ceres_manager_ptr->writeBackSolution(summary, ts_solved, true))
+        latencies.solve_ += summary.total_time_in_seconds;
+    latencies.solve_ /= latencies.n_solves_;
+
+    // a last solve, for both runs to end at the optimum
+    ceres_manager_ptr->solve();
+    _x_last_key_frame = problem_ptr->getLastKeyFramePtr()->getState();
+
+    delete ceres_manager_ptr;
+    problem_ptr->destruct();
+    return latencies;
+}
+
+int main()
+{
+    bool all_ok = true;
+    bool ok;
+
+    std::cout << std::endl << "==================== Asynchronous solver test ======================" << std::endl;
+
+    unsigned int N = 20000;
+    unsigned int solve_period = 500;
+    Eigen::VectorXs x_sync(3), x_async(3);
+
+    std::srand(0);
+    Latencies latencies_sync = run(false, N, solve_period, x_sync);
+    std::srand(0);
+    Latencies latencies_async = run(true, N, solve_period, x_async);
+
+    std::cout << "Same solution as the inline solver... ";
+    ok = (x_async - x_sync).isZero(1e-4);
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Front-end not stalled by the solver... ";
+    ok = latencies_async.max_ < latencies_sync.max_;
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Front-end latency per step, over " << N << " steps:" << std::endl;
+    std::cout << "    inline solver:       mean " << latencies_sync.mean_ * 1e6 << " us, max " << latencies_sync.max_ * 1e3
+            << " ms, " << latencies_sync.n_solves_ << " solves of " << latencies_sync.solve_ * 1e3 << " ms" << std::endl;
+    std::cout << "    asynchronous solver: mean " << latencies_async.mean_ * 1e6 << " us, max " << latencies_async.max_ * 1e3
+            << " ms, " << latencies_async.n_solves_ << " solves of " << latencies_async.solve_ * 1e3 << " ms" << std::endl;
+
+    std::cout << (all_ok ? "All tests passed" : "Some tests FAILED") << std::endl;
+
+    return all_ok ? 0 : 1;
+}
@@ -0,0 +1,194 @@
+/**
+ * \file test_ceres_graph_build.cpp
+ *
+ *  Created on: Jul 17, 2016
+ *      \author: jsola
+ */
+
+// Classes under test
+#include "ceres_wrapper/ceres_manager.h"
+
+// Wolf includes
+#include "wolf.h"
+#include "problem.h"
+#include "trajectory_base.h"
+#include "frame_base.h"
+#include "capture_void.h"
+#include "capture_fix.h"
+#include "feature_base.h"
+#include "constraint_odom_2D.h"
+#include "state_block.h"
+
+// STL includes
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+// General includes
+#include <iostream>
+
+using namespace wolf;
+
+struct Vertex
+{
+        unsigned int index_;
+        Eigen::Vector3s pose_;
+};
+
+struct Edge
+{
+        unsigned int from_;
+        unsigned int to_;
+        Eigen::Vector3s measurement_;
+        Eigen::Matrix3s information_;
+};
+
+/** Reads the vertices and edges of a TORO .graph file
+ */
+bool loadGraph(const std::string& _file_path, std::vector<Vertex>& _vertices, std::vector<Edge>& _edges)
+{
+    std::ifstream file(_file_path.c_str(), std::ifstream::in);
+    if (!file.is_open())
+        return false;
+
+    std::string line, tag;
+    while (std::getline(file, line))
+    {
+        std::istringstream line_stream(line);
+        line_stream >> tag;
+        if (tag == "VERTEX2")
+        {
+            Vertex vertex;
+            line_stream >> vertex.index_ >> vertex.pose_(0) >> vertex.pose_(1) >> vertex.pose_(2);
+            _vertices.push_back(vertex);
+        }
+        else if (tag == "EDGE2")
+        {
+            // information: xx xy yy thth xth yth
+            Edge edge;
+            line_stream >> edge.from_ >> edge.to_ >> edge.measurement_(0) >> edge.measurement_(1) >> edge.measurement_(2)
+                    >> edge.information_(0, 0) >> edge.information_(0, 1) >> edge.information_(1, 1) >> edge.information_(2, 2)
+                    >> edge.information_(0, 2) >> edge.information_(1, 2);
+            edge.information_(1, 0) = edge.information_(0, 1);
+            edge.information_(2, 0) = edge.information_(0, 2);
+            edge.information_(2, 1) = edge.information_(1, 2);
+            _edges.push_back(edge);
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    bool all_ok = true;
+    bool ok;
+
+    std::cout << std::endl << "==================== Ceres graph build benchmark ======================" << std::endl;
+
+    // run from bin/, or give the path of the graph
+    std::string file_path = (argc > 1 ? argv[1] : "../src/examples/input_M3500b_toro.graph");
+    std::vector<Vertex> vertices;
+    std::vector<Edge> edges;
+    if (!loadGraph(file_path, vertices, edges) || vertices.empty())
+    {
+        std::cout << "Could not load the graph " << file_path << std::endl;
+        std::cout << "Please call me with: [./test_ceres_graph_build FILE_PATH]" << std::endl;
+        return 1;
+    }
+    std::cout << "Graph " << file_path << ": " << vertices.size() << " vertices and " << edges.size() << " edges" << std::endl;
+
+    Problem* problem_ptr = new Problem(FRM_PO_2D);
+    SensorBase* sensor_odom_ptr = new SensorBase(SEN_ODOM_2D, "ODOM 2D", new StateBlock(Eigen::Vector2s::Zero(), true),
+                                                 new StateBlock(Eigen::Vector1s::Zero(), true),
+                                                 new StateBlock(Eigen::VectorXs::Zero(0), true), 0);
+    SensorBase* sensor_fix_ptr = new SensorBase(SEN_ABSOLUTE_POSE, "ABSOLUTE POSE", nullptr, nullptr, nullptr, 0);
+    problem_ptr->addSensor(sensor_odom_ptr);
+    problem_ptr->addSensor(sensor_fix_ptr);
+
+    ceres::Solver::Options ceres_options;
+    ceres_options.max_num_iterations = 5; // the bookkeeping is under test, not the convergence
+    CeresManager* ceres_manager_ptr = new CeresManager(problem_ptr, ceres_options);
+
+    // Replay the build of the graph: the vertices in order, each one with the edges to the previous ones,
+    // and the solver taking the new ones every solve_period vertices
+    unsigned int solve_period = 100;
+    unsigned int n_solves = 0;
+    Scalar t_solve = 0, t_ceres = 0, t_build = 0;
+    std::vector<FrameBase*> index_2_frame_ptr;
+    auto edge_it = edges.begin();
+    ceres::Solver::Summary summary;
+    for (auto& vertex : vertices)
+    {
+        auto begin = std::chrono::steady_clock::now();
+
+        if (vertex.index_ >= index_2_frame_ptr.size())
+            index_2_frame_ptr.resize(vertex.index_ + 1, nullptr);
+        FrameBase* frame_ptr = problem_ptr->getTrajectoryPtr()->addFrame(new FrameBase(KEY_FRAME, TimeStamp(vertex.index_),
+                                                                                       new StateBlock(vertex.pose_.head(2)),
+                                                                                       new StateBlock(vertex.pose_.tail(1))));
+        index_2_frame_ptr[vertex.index_] = frame_ptr;
+
+        // the prior, on the first vertex
+        if (&vertex == &vertices.front())
+        {
+            CaptureFix* fix_ptr = new CaptureFix(frame_ptr->getTimeStamp(), sensor_fix_ptr, vertex.pose_, Eigen::Matrix3s::Identity() * 0.01);
+            frame_ptr->addCapture(fix_ptr);
+            fix_ptr->process();
+        }
+
+        // the edges whose vertices are all there. The file lists them by their newest vertex.
+        while (edge_it != edges.end() && edge_it->from_ < index_2_frame_ptr.size() && edge_it->to_ < index_2_frame_ptr.size()
+                && index_2_frame_ptr[edge_it->from_] != nullptr && index_2_frame_ptr[edge_it->to_] != nullptr)
+        {
+            FrameBase* frame_from_ptr = index_2_frame_ptr[edge_it->from_];
+            FrameBase* frame_to_ptr = index_2_frame_ptr[edge_it->to_];
+            CaptureBase* capture_ptr = frame_to_ptr->addCapture(new CaptureVoid(frame_to_ptr->getTimeStamp(), sensor_odom_ptr));
+            FeatureBase* feature_ptr = capture_ptr->addFeature(new FeatureBase(FEATURE_FIX, "FIX", edge_it->measurement_,
+                                                                               edge_it->information_.inverse()));
+            feature_ptr->addConstraint(new ConstraintOdom2D(feature_ptr, frame_from_ptr));
+            edge_it++;
+        }
+        t_build += std::chrono::duration<Scalar>(std::chrono::steady_clock::now() - begin).count();
+
+        if ((vertex.index_ + 1) % solve_period == 0 || &vertex == &vertices.back())
+        {
+            begin = std::chrono::steady_clock::now();
+            summary = ceres_manager_ptr->solve();
+            t_solve += std::chrono::duration<Scalar>(std::chrono::steady_clock::now() - begin).count();
+            t_ceres += summary.total_time_in_seconds;
+            n_solves++;
+        }
+    }
+
+    ProblemStatistics statistics;
+    ceres_manager_ptr->getStatistics(statistics);
+
+    std::cout << "All the edges in the solver... ";
+    ok = edge_it == edges.end() && statistics.solver_residual_blocks_ == edges.size() + 1
+            && statistics.solver_parameter_blocks_ == problem_ptr->getStateListPtr()->size();
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Final solve... ";
+    ok = summary.IsSolutionUsable();
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    auto begin = std::chrono::steady_clock::now();
+    delete ceres_manager_ptr;
+    Scalar t_teardown = std::chrono::duration<Scalar>(std::chrono::steady_clock::now() - begin).count();
+
+    std::cout << "Build of " << vertices.size() << " vertices and " << edges.size() << " edges, " << n_solves << " solves:" << std::endl;
+    std::cout << "    wolf tree:           " << t_build * 1e3 << " ms" << std::endl;
+    std::cout << "    solves:              " << t_solve * 1e3 << " ms" << std::endl;
+    std::cout << "    ... in ceres:        " << t_ceres * 1e3 << " ms" << std::endl;
+    std::cout << "    ... in the wrapper:  " << (t_solve - t_ceres) * 1e3 << " ms (update and copies of the states)" << std::endl;
+    std::cout << "    solver teardown:     " << t_teardown * 1e3 << " ms" << std::endl;
+
+    problem_ptr->destruct();
+
+    std::cout << (all_ok ? "All tests passed" : "Some tests FAILED") << std::endl;
+
+    return all_ok ? 0 : 1;
+}
@@ -0,0 +1,152 @@
+/**
+ * \file test_covariance_store.cpp
+ *
+ *  Created on: Jul 4, 2016
+ *      \author: jsola
+ */
+
+// Classes under test
+#include "covariance_store.h"
+#include "problem.h"
+
+// Wolf includes
+#include "wolf.h"
+#include "trajectory_base.h"
+#include "frame_base.h"
+#include "state_block.h"
+
+// STL includes
+#include <ctime>
+#include <map>
+#include <vector>
+
+// General includes
+#include <iostream>
+
+using namespace wolf;
+
+/** The former storage of Problem, for comparison: a map of ordered pairs, searched in both orders
+ */
+class CovarianceMap
+{
+    public:
+        std::map<std::pair<StateBlock*, StateBlock*>, Eigen::MatrixXs> covariances_;
+
+        bool getCovarianceBlock(StateBlock* _state1, StateBlock* _state2, Eigen::MatrixXs& _cov, const int _row, const int _col)
+        {
+            if (covariances_.find(std::pair<StateBlock*, StateBlock*>(_state1, _state2)) != covariances_.end())
+                _cov.block(_row, _col, _state1->getSize(), _state2->getSize()) =
+                        covariances_[std::pair<StateBlock*, StateBlock*>(_state1, _state2)];
+            else if (covariances_.find(std::pair<StateBlock*, StateBlock*>(_state2, _state1)) != covariances_.end())
+                _cov.block(_row, _col, _state1->getSize(), _state2->getSize()) =
+                        covariances_[std::pair<StateBlock*, StateBlock*>(_state2, _state1)].transpose();
+            else
+                return false;
+            return true;
+        }
+
+        bool getFrameCovariance(FrameBase* _frame_ptr, Eigen::MatrixXs& _covariance)
+        {
+            return getCovarianceBlock(_frame_ptr->getPPtr(), _frame_ptr->getPPtr(), _covariance, 0, 0) &&
+            getCovarianceBlock(_frame_ptr->getPPtr(), _frame_ptr->getOPtr(), _covariance, 0,_frame_ptr->getPPtr()->getSize()) &&
+            getCovarianceBlock(_frame_ptr->getOPtr(), _frame_ptr->getPPtr(), _covariance, _frame_ptr->getPPtr()->getSize(), 0) &&
+            getCovarianceBlock(_frame_ptr->getOPtr(), _frame_ptr->getOPtr(), _covariance, _frame_ptr->getPPtr()->getSize() ,_frame_ptr->getPPtr()->getSize());
+        }
+};
+
+int main()
+{
+    bool all_ok = true;
+    bool ok;
+
+    std::cout << std::endl << "==================== Covariance store test ======================" << std::endl;
+
+    StateBlock A(Eigen::Vector3s::Zero());
+    StateBlock B(Eigen::Vector2s::Zero());
+    Eigen::MatrixXs cov_AB = Eigen::MatrixXs::Random(3, 2);
+    Eigen::MatrixXs cov_AA = Eigen::MatrixXs::Random(3, 3);
+
+    CovarianceStore store;
+    std::cout << "Blocks read in both orders... ";
+    store.addBlock(&A, &B, cov_AB);
+    store.addBlock(&A, &A, cov_AA);
+    ok = (store.getBlock(&A, &B) == cov_AB) && (store.getBlock(&B, &A) == cov_AB.transpose())
+            && (store.getBlock(&A, &A) == cov_AA) && (store.getBlock(&B, &B).data() == nullptr)
+            && store.hasBlock(&B, &A) && !store.hasBlock(&B, &B);
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Each pair stored once, in place... ";
+    const Scalar* data_AB = store.getBlock(&A, &B).data();
+    store.addBlock(&B, &A, cov_AB.transpose() * 2);
+    ok = (store.size() == 2) && (store.scalarsSize() == 15) && (store.getBlock(&A, &B).data() == data_AB)
+            && (store.getBlock(&A, &B) == cov_AB * 2) && (store.getBlock(&B, &A) == cov_AB.transpose() * 2);
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Memory kept after clear... ";
+    store.clear();
+    ok = (store.size() == 0) && !store.hasBlock(&A, &B);
+    store.addBlock(&A, &B) = cov_AB;
+    ok = ok && (store.getBlock(&A, &B).data() == data_AB) && (store.getBlock(&A, &B) == cov_AB);
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    // Frame covariances through the Problem, against the former storage
+    unsigned int N = 2000;
+    Problem* problem_ptr = new Problem(FRM_PO_3D);
+    CovarianceMap covariance_map;
+    std::vector<FrameBase*> frames;
+    for (unsigned int i = 0; i < N; i++)
+    {
+        FrameBase* frame_ptr = problem_ptr->createFrame(KEY_FRAME, (Eigen::VectorXs(7) << 0,0,0, 0,0,0,1).finished(), TimeStamp(i));
+        Eigen::MatrixXs M = Eigen::MatrixXs::Random(7, 7);
+        Eigen::MatrixXs cov = M * M.transpose();
+        // the solver computes the upper triangle of the blocks, as CeresManager::computeCovariances()
+        problem_ptr->addCovarianceBlock(frame_ptr->getPPtr(), frame_ptr->getPPtr(), cov.topLeftCorner(3, 3));
+        problem_ptr->addCovarianceBlock(frame_ptr->getPPtr(), frame_ptr->getOPtr(), cov.topRightCorner(3, 4));
+        problem_ptr->addCovarianceBlock(frame_ptr->getOPtr(), frame_ptr->getOPtr(), cov.bottomRightCorner(4, 4));
+        covariance_map.covariances_[std::make_pair(frame_ptr->getPPtr(), frame_ptr->getPPtr())] = cov.topLeftCorner(3, 3);
+        covariance_map.covariances_[std::make_pair(frame_ptr->getPPtr(), frame_ptr->getOPtr())] = cov.topRightCorner(3, 4);
+        covariance_map.covariances_[std::make_pair(frame_ptr->getOPtr(), frame_ptr->getOPtr())] = cov.bottomRightCorner(4, 4);
+        frames.push_back(frame_ptr);
+    }
+
+    std::cout << "Frame covariances equal to the former ones... ";
+    ok = true;
+    Eigen::MatrixXs cov_store(7, 7), cov_map(7, 7);
+    for (auto frame_ptr : frames)
+        ok = ok && problem_ptr->getFrameCovariance(frame_ptr, cov_store) && covariance_map.getFrameCovariance(frame_ptr, cov_map)
+                && (cov_store == cov_map);
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    // Timing of the frame covariance reads
+    unsigned int n_rounds = 20;
+    Scalar sum = 0;
+    clock_t begin = clock();
+    for (unsigned int r = 0; r < n_rounds; r++)
+        for (auto frame_ptr : frames)
+        {
+            covariance_map.getFrameCovariance(frame_ptr, cov_map);
+            sum += cov_map(0, 0);
+        }
+    Scalar time_map = double(clock() - begin) / CLOCKS_PER_SEC / (n_rounds * N) * 1e9;
+    begin = clock();
+    for (unsigned int r = 0; r < n_rounds; r++)
+        for (auto frame_ptr : frames)
+        {
+            problem_ptr->getFrameCovariance(frame_ptr, cov_store);
+            sum += cov_store(0, 0);
+        }
+    Scalar time_store = double(clock() - begin) / CLOCKS_PER_SEC / (n_rounds * N) * 1e9;
+    std::cout << "Time per frame covariance among " << N << " frames:" << std::endl;
+    std::cout << "    std::map of ordered pairs: " << time_map << " ns" << std::endl;
+    std::cout << "    covariance store:          " << time_store << " ns (" << sum << ")" << std::endl;
+
+    problem_ptr->destruct();
+
+    std::cout << (all_ok ? "All tests passed" : "Some tests FAILED") << std::endl;
+
+    return all_ok ? 0 : 1;
+}
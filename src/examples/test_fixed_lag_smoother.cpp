@@ -0,0 +1,356 @@
+/**
+ * \file test_fixed_lag_smoother.cpp
+ *
+ *  Created on: Jul 14, 2016
+ *      \author: jsola
+ */
+
+// Classes under test
+#include "constraint_marginalization.h"
+#include "problem.h"
+#include "processor_odom_2D.h"
+
+// Wolf includes
+#include "wolf.h"
+#include "trajectory_base.h"
+#include "map_base.h"
+#include "frame_base.h"
+#include "capture_void.h"
+#include "constraint_odom_2D.h"
+#include "feature_base.h"
+#include "landmark_corner_2D.h"
+#include "sensor_base.h"
+#include "state_block.h"
+
+// STL includes
+#include <algorithm>
+#include <ctime>
+#include <list>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+// General includes
+#include <iostream>
+
+using namespace wolf;
+
+std::mt19937 generator(1);
+
+FrameBase* addKeyFrame(Problem* _problem_ptr, Scalar _ts)
+{
+    return _problem_ptr->getTrajectoryPtr()->addFrame(new FrameBase(KEY_FRAME, TimeStamp(_ts), new StateBlock(Eigen::Vector2s::Zero()),
+                                                                     new StateBlock(Eigen::Vector1s::Zero())));
+}
+
+/** A linear constraint r + J * (x - x_now) on some state blocks, hosted by a frame, with random J and r.
+ * A ConstraintMarginalization is a linear constraint already, so this uses it.
+ */
+ConstraintBase* addLinearConstraint(FrameBase* _host_ptr, const std::vector<StateBlock*>& _state_ptrs, unsigned int _size,
+                                    const std::list<FrameBase*>& _frame_ptrs, const std::list<LandmarkBase*>& _landmark_ptrs = {})
+{
+    std::normal_distribution<Scalar> distribution;
+    unsigned int state_size = 0;
+    for (auto state_ptr : _state_ptrs)
+        state_size += state_ptr->getSize();
+    Eigen::MatrixXs jacobian(_size, state_size);
+    Eigen::VectorXs residual(_size);
+    for (unsigned int i = 0; i < _size; i++)
+    {
+        residual(i) = distribution(generator);
+        for (unsigned int j = 0; j < state_size; j++)
+            jacobian(i, j) = distribution(generator);
+    }
+    CaptureBase* capture_ptr = _host_ptr->addCapture(new CaptureVoid(_host_ptr->getTimeStamp(), nullptr));
+    FeatureBase* feature_ptr = capture_ptr->addFeature(new FeatureBase(FEATURE_MARGINALIZATION, "LINEAR", _size));
+    return feature_ptr->addConstraint(new ConstraintMarginalization(_state_ptrs, jacobian, residual, _frame_ptrs, _landmark_ptrs));
+}
+
+/** What the solver does: evaluate the residual and the jacobians of the constraint at the current state
+ */
+LinearizedConstraint linearize(ConstraintBase* _ctr_ptr)
+{
+    ConstraintAnalytic* ctr_ptr = (ConstraintAnalytic*)_ctr_ptr;
+    std::vector<Eigen::Map<const Eigen::VectorXs> > states;
+    LinearizedConstraint linearized;
+    linearized.constraint_ptr_ = _ctr_ptr;
+    for (auto state_ptr : ctr_ptr->getStatePtrVector())
+    {
+        states.push_back(Eigen::Map<const Eigen::VectorXs>(state_ptr->getPtr(), state_ptr->getSize()));
+        linearized.jacobians_.push_back(Eigen::MatrixXs(ctr_ptr->getSize(), state_ptr->getSize()));
+    }
+    std::vector<Eigen::Map<Eigen::MatrixXs> > jacobians;
+    for (auto& jacobian : linearized.jacobians_)
+        jacobians.push_back(Eigen::Map<Eigen::MatrixXs>(jacobian.data(), jacobian.rows(), jacobian.cols()));
+    linearized.residual_ = ctr_ptr->evaluateResiduals(states);
+    ctr_ptr->evaluateJacobians(states, jacobians, std::vector<bool>(states.size(), true));
+    return linearized;
+}
+
+/** The same for the odometry constraints, by finite differences
+ */
+LinearizedConstraint linearizeOdom2D(ConstraintBase* _ctr_ptr)
+{
+    const ConstraintOdom2D& constraint = *((ConstraintOdom2D*)_ctr_ptr);
+    std::vector<StateBlock*> state_ptrs = _ctr_ptr->getStatePtrVector();
+    auto evaluate = [&](Eigen::Vector3s& _residual)
+    {
+        constraint(state_ptrs[0]->getPtr(), state_ptrs[1]->getPtr(), state_ptrs[2]->getPtr(), state_ptrs[3]->getPtr(), _residual.data());
+    };
+    LinearizedConstraint linearized;
+    linearized.constraint_ptr_ = _ctr_ptr;
+    Eigen::Vector3s residual, residual_plus;
+    evaluate(residual);
+    linearized.residual_ = residual;
+    const Scalar eps = 1e-7;
+    for (auto state_ptr : state_ptrs)
+    {
+        linearized.jacobians_.push_back(Eigen::MatrixXs(3, state_ptr->getSize()));
+        for (unsigned int j = 0; j < state_ptr->getSize(); j++)
+        {
+            state_ptr->getPtr()[j] += eps;
+            evaluate(residual_plus);
+            state_ptr->getPtr()[j] -= eps;
+            linearized.jacobians_.back().col(j) = (residual_plus - residual) / eps;
+        }
+    }
+    return linearized;
+}
+
+/** What CeresManager::marginalize() does, without Ceres
+ */
+void marginalizeOutOfWindow(Problem* _problem_ptr)
+{
+    FrameBaseList frame_list;
+    _problem_ptr->getKeyFramesOutOfWindow(frame_list);
+    for (auto frame_ptr : frame_list)
+    {
+        ConstraintBaseList ctr_list;
+        _problem_ptr->getConstraintsOnKeyFrame(frame_ptr, ctr_list);
+        std::list<LinearizedConstraint> linearized_list;
+        for (auto ctr_ptr : ctr_list)
+            linearized_list.push_back(ctr_ptr->getType() == "ODOM 2D" ? linearizeOdom2D(ctr_ptr) : linearize(ctr_ptr));
+        _problem_ptr->marginalizeKeyFrame(frame_ptr, linearized_list);
+    }
+}
+
+/** Information matrix and vector of all the constraints of the problem, on the given state blocks
+ */
+void computeInformation(Problem* _problem_ptr, const std::vector<StateBlock*>& _state_ptrs, Eigen::MatrixXs& _H, Eigen::VectorXs& _g)
+{
+    std::unordered_map<StateBlock*, unsigned int> offsets;
+    unsigned int size = 0;
+    for (auto state_ptr : _state_ptrs)
+    {
+        offsets[state_ptr] = size;
+        size += state_ptr->getSize();
+    }
+    _H = Eigen::MatrixXs::Zero(size, size);
+    _g = Eigen::VectorXs::Zero(size);
+    ConstraintBaseList ctr_list;
+    _problem_ptr->getTrajectoryPtr()->getConstraintList(ctr_list);
+    for (auto ctr_ptr : ctr_list)
+    {
+        LinearizedConstraint linearized = linearize(ctr_ptr);
+        std::vector<StateBlock*> state_ptrs = ctr_ptr->getStatePtrVector();
+        for (unsigned int i = 0; i < state_ptrs.size(); i++)
+        {
+            _g.segment(offsets.at(state_ptrs[i]), state_ptrs[i]->getSize()) += linearized.jacobians_[i].transpose() * linearized.residual_;
+            for (unsigned int j = 0; j < state_ptrs.size(); j++)
+                _H.block(offsets.at(state_ptrs[i]), offsets.at(state_ptrs[j]), state_ptrs[i]->getSize(), state_ptrs[j]->getSize()) +=
+                        linearized.jacobians_[i].transpose() * linearized.jacobians_[j];
+        }
+    }
+}
+
+int main()
+{
+    bool all_ok = true;
+    bool ok;
+
+    std::cout << std::endl << "==================== Fixed-lag smoother test ======================" << std::endl;
+
+    // Five key frames with odometry, a prior on the first one, a loop closure and a landmark
+    Problem* problem_ptr = new Problem(FRM_PO_2D);
+    std::vector<FrameBase*> frames;
+    for (unsigned int i = 0; i < 5; i++)
+        frames.push_back(addKeyFrame(problem_ptr, i));
+    LandmarkBase* landmark_ptr = problem_ptr->addLandmark(new LandmarkCorner2D(new StateBlock(Eigen::Vector2s::Zero()),
+                                                                               new StateBlock(Eigen::Vector1s::Zero())));
+    addLinearConstraint(frames[0], {frames[0]->getPPtr(), frames[0]->getOPtr()}, 3, {});
+    for (unsigned int i = 1; i < 5; i++)
+        addLinearConstraint(frames[i], {frames[i - 1]->getPPtr(), frames[i - 1]->getOPtr(), frames[i]->getPPtr(), frames[i]->getOPtr()}, 3,
+                            {frames[i - 1]});
+    addLinearConstraint(frames[3], {frames[0]->getPPtr(), frames[0]->getOPtr(), frames[3]->getPPtr(), frames[3]->getOPtr()}, 3,
+                        {frames[0]});
+    for (unsigned int i = 0; i < 2; i++)
+        addLinearConstraint(frames[i], {frames[i]->getPPtr(), frames[i]->getOPtr(), landmark_ptr->getPPtr()}, 2, {}, {landmark_ptr});
+
+    // the information expected on the states left: Schur complement of the first two frames in the whole problem
+    std::vector<StateBlock*> all_states, states_left;
+    for (auto frame_ptr : frames)
+        for (auto state_ptr : frame_ptr->getStateBlockVector())
+            all_states.push_back(state_ptr);
+    all_states.push_back(landmark_ptr->getPPtr());
+    states_left.assign(all_states.begin() + 4, all_states.end());
+    Eigen::MatrixXs H;
+    Eigen::VectorXs g;
+    computeInformation(problem_ptr, all_states, H, g);
+    unsigned int m = 6, b = H.rows() - 6;
+    Eigen::MatrixXs H_mm_inverse = H.topLeftCorner(m, m).inverse();
+    Eigen::MatrixXs H_expected = H.bottomRightCorner(b, b) - H.bottomLeftCorner(b, m) * H_mm_inverse * H.topRightCorner(m, b);
+    Eigen::VectorXs g_expected = g.tail(b) - H.bottomLeftCorner(b, m) * H_mm_inverse * g.head(m);
+
+    std::cout << "Key frames out of the window, by count and by time... ";
+    FrameBaseList out_list;
+    problem_ptr->getKeyFramesOutOfWindow(out_list);
+    ok = !problem_ptr->isFixedLag() && out_list.empty();
+    problem_ptr->setFixedLagWindow(3);
+    problem_ptr->getKeyFramesOutOfWindow(out_list);
+    ok = ok && out_list == FrameBaseList({frames[0], frames[1]});
+    out_list.clear();
+    problem_ptr->setFixedLagWindow(0, 2.5);
+    problem_ptr->getKeyFramesOutOfWindow(out_list);
+    ok = ok && out_list == FrameBaseList({frames[0], frames[1]});
+    out_list.clear();
+    problem_ptr->setFixedLagWindow(4, 3.5);
+    problem_ptr->getKeyFramesOutOfWindow(out_list);
+    ok = ok && out_list == FrameBaseList({frames[0]});
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Marginalized key frames out of the tree, priors on the others... ";
+    problem_ptr->setFixedLagWindow(3);
+    marginalizeOutOfWindow(problem_ptr);
+    ConstraintBaseList ctr_list;
+    problem_ptr->getTrajectoryPtr()->getConstraintList(ctr_list);
+    ConstraintMarginalization* prior_ptr = nullptr;
+    unsigned int n_priors = 0;
+    for (auto ctr_ptr : ctr_list)
+        if (ctr_ptr->getCapturePtr()->getFramePtr() == frames[2] && ctr_ptr->getFeaturePtr()->getType() == "MARGINALIZATION")
+        {
+            prior_ptr = (ConstraintMarginalization*)ctr_ptr;
+            n_priors++;
+        }
+    ok = problem_ptr->getTrajectoryPtr()->getKeyFramesCount() == 3
+            && problem_ptr->getTrajectoryPtr()->getFrameListPtr()->front() == frames[2] && n_priors == 1 && ctr_list.size() == 3;
+    ok = ok && prior_ptr->getStatePtrVector().size() == 5 && prior_ptr->getLandmarkPtrList().front() == landmark_ptr
+            && prior_ptr->getFramePtrList().size() == 2
+            && std::find(prior_ptr->getFramePtrList().begin(), prior_ptr->getFramePtrList().end(), frames[2]) != prior_ptr->getFramePtrList().end()
+            && std::find(prior_ptr->getFramePtrList().begin(), prior_ptr->getFramePtrList().end(), frames[3]) != prior_ptr->getFramePtrList().end()
+            && problem_ptr->getStateListPtr()->size() == 8;
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Same information on the states left as the whole problem... ";
+    Eigen::MatrixXs H_left;
+    Eigen::VectorXs g_left;
+    computeInformation(problem_ptr, states_left, H_left, g_left);
+    ok = (H_left - H_expected).cwiseAbs().maxCoeff() < 1e-8 * H_expected.cwiseAbs().maxCoeff()
+            && (g_left - g_expected).cwiseAbs().maxCoeff() < 1e-8 * g_expected.cwiseAbs().maxCoeff();
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Prior destructed with one of its landmarks... ";
+    landmark_ptr->destruct();
+    ctr_list.clear();
+    problem_ptr->getTrajectoryPtr()->getConstraintList(ctr_list);
+    ok = ctr_list.size() == 2 && frames[2]->getConstrainedByListPtr()->size() == 1 && frames[3]->getConstrainedByListPtr()->size() == 1;
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    problem_ptr->destruct();
+
+    // A long run with a window of 10 key frames: the problem stays bounded
+    unsigned int n_key_frames = 2000;
+    unsigned int window = 10;
+    problem_ptr = new Problem(FRM_PO_2D);
+    problem_ptr->setFixedLagWindow(window);
+    FrameBase* previous_ptr = addKeyFrame(problem_ptr, 0);
+    addLinearConstraint(previous_ptr, {previous_ptr->getPPtr(), previous_ptr->getOPtr()}, 3, {});
+    unsigned int max_frames = 0, max_constraints = 0, max_states = 0;
+    Scalar time_first = 0, time_last = 0;
+    clock_t begin = clock();
+    for (unsigned int i = 1; i < n_key_frames; i++)
+    {
+        FrameBase* frame_ptr = addKeyFrame(problem_ptr, i);
+        addLinearConstraint(frame_ptr, {previous_ptr->getPPtr(), previous_ptr->getOPtr(), frame_ptr->getPPtr(), frame_ptr->getOPtr()},
+                            3, {previous_ptr});
+        marginalizeOutOfWindow(problem_ptr);
+        previous_ptr = frame_ptr;
+
+        ctr_list.clear();
+        problem_ptr->getTrajectoryPtr()->getConstraintList(ctr_list);
+        max_frames = std::max(max_frames, (unsigned int)(problem_ptr->getTrajectoryPtr()->getFrameListPtr()->size()));
+        max_constraints = std::max(max_constraints, (unsigned int)(ctr_list.size()));
+        max_states = std::max(max_states, (unsigned int)(problem_ptr->getStateListPtr()->size()));
+        if (i == 100)
+        {
+            time_first = double(clock() - begin) / CLOCKS_PER_SEC / 100;
+            begin = clock();
+        }
+    }
+    time_last = double(clock() - begin) / CLOCKS_PER_SEC / (n_key_frames - 101);
+
+    std::cout << "Bounded problem along " << n_key_frames << " key frames... ";
+    ok = max_frames == window && max_constraints == window && max_states == 2 * window;
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Key frame and marginalization, window of " << window << " key frames:" << std::endl;
+    std::cout << "    first 100 key frames:  " << time_first * 1e6 << " us" << std::endl;
+    std::cout << "    the others:            " << time_last * 1e6 << " us" << std::endl;
+
+    problem_ptr->destruct();
+
+    // 2D odometry with a key frame every second, and a window of 3 key frames
+    const Scalar dt = 0.01;
+    const unsigned int n_samples = 1000;
+    problem_ptr = new Problem(FRM_PO_2D);
+    problem_ptr->setFixedLagWindow(3);
+    SensorBase* sensor_ptr = new SensorBase(SEN_ODOM_2D, "ODOM 2D", new StateBlock(Eigen::Vector2s::Zero(), true),
+                                            new StateBlock(Eigen::Vector1s::Zero(), true),
+                                            new StateBlock(Eigen::VectorXs::Zero(0), true), 0);
+    ProcessorOdom2D* processor_ptr = new ProcessorOdom2D(1e9, 1e9, 1 - dt / 2);
+    sensor_ptr->addProcessor(processor_ptr);
+    problem_ptr->addSensor(sensor_ptr);
+    processor_ptr->setOrigin(Eigen::Vector3s::Zero(), TimeStamp(0));
+    Eigen::VectorXs data(2);
+    data << 0.01, 0.001;
+    CaptureMotion* capture_ptr = new CaptureMotion(TimeStamp(0), sensor_ptr, data, Eigen::MatrixXs::Identity(2, 2) * 0.01, nullptr);
+    for (unsigned int i = 1; i <= n_samples; i++)
+    {
+        capture_ptr->setTimeStamp(TimeStamp(i * dt));
+        processor_ptr->process(capture_ptr);
+        marginalizeOutOfWindow(problem_ptr);
+    }
+
+    std::cout << "Motion queries in the marginalized interval... ";
+    TimeStamp ts_window = problem_ptr->getTrajectoryPtr()->getFrameListPtr()->front()->getTimeStamp();
+    ok = problem_ptr->getTrajectoryPtr()->getKeyFramesCount() == 3;
+    for (Scalar t = dt / 3; t < n_samples * dt; t += 0.037)
+    {
+        TimeStamp ts(t);
+        if (ts <= ts_window)
+        {
+            // no motion left there: the state of the oldest key frame
+            ok = ok && processor_ptr->findCaptureContainingTimeStamp(ts) == nullptr;
+            ok = ok && (problem_ptr->getStateAtTimeStamp(ts) - problem_ptr->getTrajectoryPtr()->getFrameListPtr()->front()->getState()).isZero(1e-12);
+        }
+        else
+        {
+            ProcessorOdom2D::CaptureType* found_ptr = processor_ptr->findCaptureContainingTimeStamp(ts);
+            ok = ok && found_ptr != nullptr && found_ptr->getFramePtr() != nullptr && found_ptr->getOriginFramePtr()->isKey();
+            ok = ok && processor_ptr->getMotion(ts).ts_ <= ts;
+        }
+    }
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    capture_ptr->destruct();
+    problem_ptr->destruct();
+
+    std::cout << (all_ok ? "All tests passed" : "Some tests FAILED") << std::endl;
+
+    return all_ok ? 0 : 1;
+}
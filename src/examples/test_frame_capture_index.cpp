@@ -0,0 +1,150 @@
+/**
+ * \file test_frame_capture_index.cpp
+ *
+ *  Created on: Jul 13, 2016
+ *      \author: jsola
+ */
+
+// Classes under test
+#include "frame_base.h"
+#include "capture_base.h"
+
+// Wolf includes
+#include "wolf.h"
+#include "problem.h"
+#include "sensor_base.h"
+#include "trajectory_base.h"
+#include "capture_void.h"
+#include "state_block.h"
+
+// STL includes
+#include <ctime>
+#include <vector>
+
+// General includes
+#include <iostream>
+
+using namespace wolf;
+
+SensorBase* newSensor(Problem* _problem_ptr)
+{
+    SensorBase* sensor_ptr = new SensorBase(SEN_ODOM_2D, "ODOM 2D", new StateBlock(Eigen::Vector2s::Zero(), true),
+                                            new StateBlock(Eigen::Vector1s::Zero(), true),
+                                            new StateBlock(Eigen::VectorXs::Zero(0), true), 0);
+    _problem_ptr->addSensor(sensor_ptr);
+    return sensor_ptr;
+}
+
+FrameBase* newFrame(Problem* _problem_ptr, Scalar _ts)
+{
+    return _problem_ptr->getTrajectoryPtr()->addFrame(new FrameBase(KEY_FRAME, TimeStamp(_ts), new StateBlock(Eigen::Vector2s::Zero()),
+                                                                    new StateBlock(Eigen::Vector1s::Zero())));
+}
+
+/** The former FrameBase::hasCaptureOf(), visiting the captures of the frame
+ */
+CaptureBase* hasCaptureOfByScan(FrameBase* _frame_ptr, const SensorBase* _sensor_ptr)
+{
+    for (auto capture_ptr : *_frame_ptr->getCaptureListPtr())
+        if (capture_ptr->getSensorPtr() == _sensor_ptr)
+            return capture_ptr;
+    return nullptr;
+}
+
+int main()
+{
+    bool all_ok = true;
+    bool ok;
+
+    std::cout << std::endl << "==================== Frame capture index test ======================" << std::endl;
+
+    Problem* problem_ptr = new Problem(FRM_PO_2D);
+    std::vector<SensorBase*> sensors;
+    for (unsigned int s = 0; s < 4; s++)
+        sensors.push_back(newSensor(problem_ptr));
+    FrameBase* frame_ptr = newFrame(problem_ptr, 1);
+    CaptureBase* capture_0_ptr = frame_ptr->addCapture(new CaptureVoid(TimeStamp(1), sensors[0]));
+    CaptureBase* capture_1_ptr = frame_ptr->addCapture(new CaptureVoid(TimeStamp(1), sensors[1]));
+    CaptureBase* capture_1b_ptr = frame_ptr->addCapture(new CaptureVoid(TimeStamp(1), sensors[1]));
+    CaptureBase* capture_2_ptr = frame_ptr->addCapture(new CaptureVoid(TimeStamp(1), sensors[2]));
+
+    std::cout << "Captures found by sensor, the first one of each... ";
+    ok = frame_ptr->hasCaptureOf(sensors[0]) == capture_0_ptr && frame_ptr->hasCaptureOf(sensors[1]) == capture_1_ptr
+            && frame_ptr->hasCaptureOf(sensors[2]) == capture_2_ptr && frame_ptr->hasCaptureOf(sensors[3]) == nullptr;
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Index kept up to date on removal and destruction... ";
+    capture_1_ptr->destruct();
+    ok = frame_ptr->hasCaptureOf(sensors[1]) == capture_1b_ptr;
+    frame_ptr->removeCapture(capture_1b_ptr);
+    ok = ok && frame_ptr->hasCaptureOf(sensors[1]) == nullptr;
+    for (auto capture_it = frame_ptr->getCaptureListPtr()->begin(); capture_it != frame_ptr->getCaptureListPtr()->end(); capture_it++)
+        if (*capture_it == capture_0_ptr)
+        {
+            frame_ptr->removeCapture(capture_it);
+            break;
+        }
+    ok = ok && frame_ptr->hasCaptureOf(sensors[0]) == nullptr && frame_ptr->hasCaptureOf(sensors[2]) == capture_2_ptr;
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Index follows a capture moved to another frame... ";
+    FrameBase* other_frame_ptr = newFrame(problem_ptr, 2);
+    frame_ptr->unlinkCapture(capture_2_ptr);
+    other_frame_ptr->addCapture(capture_2_ptr);
+    ok = frame_ptr->hasCaptureOf(sensors[2]) == nullptr && other_frame_ptr->hasCaptureOf(sensors[2]) == capture_2_ptr
+            && capture_2_ptr->getFramePtr() == other_frame_ptr && frame_ptr->getCaptureListPtr()->empty();
+    other_frame_ptr->destruct();
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    problem_ptr->destruct();
+
+    // Lookups in many frames with a capture of each of 8 sensors
+    unsigned int n_frames = 10000;
+    unsigned int n_sensors = 8;
+    problem_ptr = new Problem(FRM_PO_2D);
+    sensors.clear();
+    for (unsigned int s = 0; s < n_sensors; s++)
+        sensors.push_back(newSensor(problem_ptr));
+    std::vector<FrameBase*> frames;
+    for (unsigned int i = 0; i < n_frames; i++)
+    {
+        frames.push_back(newFrame(problem_ptr, i * 0.1));
+        for (auto sensor_ptr : sensors)
+            frames.back()->addCapture(new CaptureVoid(TimeStamp(i * 0.1), sensor_ptr));
+    }
+
+    unsigned int n_repetitions = 10;
+    std::vector<CaptureBase*> found_index, found_scan;
+    found_index.reserve(n_repetitions * n_frames * n_sensors);
+    found_scan.reserve(n_repetitions * n_frames * n_sensors);
+    clock_t begin = clock();
+    for (unsigned int n = 0; n < n_repetitions; n++)
+        for (auto frm_ptr : frames)
+            for (auto sensor_ptr : sensors)
+                found_index.push_back(frm_ptr->hasCaptureOf(sensor_ptr));
+    Scalar time_index = double(clock() - begin) / CLOCKS_PER_SEC / (n_repetitions * n_frames * n_sensors);
+    begin = clock();
+    for (unsigned int n = 0; n < n_repetitions; n++)
+        for (auto frm_ptr : frames)
+            for (auto sensor_ptr : sensors)
+                found_scan.push_back(hasCaptureOfByScan(frm_ptr, sensor_ptr));
+    Scalar time_scan = double(clock() - begin) / CLOCKS_PER_SEC / (n_repetitions * n_frames * n_sensors);
+
+    std::cout << "Same captures found with the index and by scanning... ";
+    ok = found_index == found_scan && found_index.front() != nullptr;
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Capture of a sensor in a frame of " << n_sensors << " captures:" << std::endl;
+    std::cout << "    index:  " << time_index * 1e9 << " ns" << std::endl;
+    std::cout << "    scan:   " << time_scan * 1e9 << " ns" << std::endl;
+
+    problem_ptr->destruct();
+
+    std::cout << (all_ok ? "All tests passed" : "Some tests FAILED") << std::endl;
+
+    return all_ok ? 0 : 1;
+}
@@ -0,0 +1,449 @@
+/**
+ * \file test_graph_pruner.cpp
+ *
+ *  Created on: Jul 15, 2016
+ *      \author: jsola
+ */
+
+// Classes under test
+#include "graph_pruner.h"
+#include "constraint_marginalization.h"
+
+// Wolf includes
+#include "wolf.h"
+#include "problem.h"
+#include "trajectory_base.h"
+#include "frame_base.h"
+#include "capture_void.h"
+#include "feature_base.h"
+#include "covariance_store.h"
+#include "state_block.h"
+
+// STL includes
+#include <algorithm>
+#include <cmath>
+#include <list>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+// General includes
+#include <iostream>
+
+using namespace wolf;
+
+std::mt19937 generator(1);
+
+FrameBase* addKeyFrame(Problem* _problem_ptr, Scalar _ts, Scalar _x = 0)
+{
+    return _problem_ptr->getTrajectoryPtr()->addFrame(new FrameBase(KEY_FRAME, TimeStamp(_ts), new StateBlock(Eigen::Vector2s(_x, 0)),
+                                                                     new StateBlock(Eigen::Vector1s::Zero())));
+}
+
+Eigen::MatrixXs randomMatrix(unsigned int _rows, unsigned int _cols)
+{
+    std::normal_distribution<Scalar> distribution;
+    Eigen::MatrixXs M(_rows, _cols);
+    for (unsigned int i = 0; i < _rows; i++)
+        for (unsigned int j = 0; j < _cols; j++)
+            M(i, j) = distribution(generator);
+    return M;
+}
+
+std::vector<StateBlock*> statesOf(const std::vector<FrameBase*>& _frame_ptrs)
+{
+    std::vector<StateBlock*> state_ptrs;
+    for (auto frame_ptr : _frame_ptrs)
+        for (auto state_ptr : frame_ptr->getStateBlockVector())
+            state_ptrs.push_back(state_ptr);
+    return state_ptrs;
+}
+
+/** A linear constraint r + J * (x - x_now) on the states of some frames, hosted by a frame.
+ * A ConstraintMarginalization is a linear constraint already, so this uses it.
+ */
+ConstraintBase* addLinearConstraint(FrameBase* _host_ptr, const std::vector<FrameBase*>& _frame_ptrs, const Eigen::MatrixXs& _jacobian,
+                                    const Eigen::VectorXs& _residual)
+{
+    std::list<FrameBase*> other_ptrs;
+    for (auto frame_ptr : _frame_ptrs)
+        if (frame_ptr != _host_ptr)
+            other_ptrs.push_back(frame_ptr);
+    CaptureBase* capture_ptr = _host_ptr->addCapture(new CaptureVoid(_host_ptr->getTimeStamp(), nullptr));
+    FeatureBase* feature_ptr = capture_ptr->addFeature(new FeatureBase(FEATURE_MARGINALIZATION, "LINEAR", _residual.size()));
+    return feature_ptr->addConstraint(new ConstraintMarginalization(statesOf(_frame_ptrs), _jacobian, _residual, other_ptrs));
+}
+
+/** A relative linear constraint M * (x_to - x_from) + r, which is blind to a common shift of both frames
+ */
+ConstraintBase* addRelativeConstraint(FrameBase* _from_ptr, FrameBase* _to_ptr, const Eigen::MatrixXs& _M)
+{
+    Eigen::MatrixXs jacobian(3, 6);
+    jacobian << -_M, _M;
+    return addLinearConstraint(_to_ptr, {_from_ptr, _to_ptr}, jacobian, randomMatrix(3, 1));
+}
+
+/** What the solver does: evaluate the residual and the jacobians of the constraint at the current state
+ */
+LinearizedConstraint linearize(ConstraintBase* _ctr_ptr)
+{
+    ConstraintAnalytic* ctr_ptr = (ConstraintAnalytic*)_ctr_ptr;
+    std::vector<Eigen::Map<const Eigen::VectorXs> > states;
+    LinearizedConstraint linearized;
+    linearized.constraint_ptr_ = _ctr_ptr;
+    for (auto state_ptr : ctr_ptr->getStatePtrVector())
+    {
+        states.push_back(Eigen::Map<const Eigen::VectorXs>(state_ptr->getPtr(), state_ptr->getSize()));
+        linearized.jacobians_.push_back(Eigen::MatrixXs(ctr_ptr->getSize(), state_ptr->getSize()));
+    }
+    std::vector<Eigen::Map<Eigen::MatrixXs> > jacobians;
+    for (auto& jacobian : linearized.jacobians_)
+        jacobians.push_back(Eigen::Map<Eigen::MatrixXs>(jacobian.data(), jacobian.rows(), jacobian.cols()));
+    linearized.residual_ = ctr_ptr->evaluateResiduals(states);
+    ctr_ptr->evaluateJacobians(states, jacobians, std::vector<bool>(states.size(), true));
+    return linearized;
+}
+
+/** Information matrix and vector of some constraints, on the given state blocks
+ */
+void computeInformation(const std::list<ConstraintBase*>& _ctr_list, const std::vector<StateBlock*>& _state_ptrs, Eigen::MatrixXs& _H,
+                        Eigen::VectorXs& _g)
+{
+    std::unordered_map<StateBlock*, unsigned int> offsets;
+    unsigned int size = 0;
+    for (auto state_ptr : _state_ptrs)
+    {
+        offsets[state_ptr] = size;
+        size += state_ptr->getSize();
+    }
+    _H = Eigen::MatrixXs::Zero(size, size);
+    _g = Eigen::VectorXs::Zero(size);
+    for (auto ctr_ptr : _ctr_list)
+    {
+        LinearizedConstraint linearized = linearize(ctr_ptr);
+        std::vector<StateBlock*> state_ptrs = ctr_ptr->getStatePtrVector();
+        for (unsigned int i = 0; i < state_ptrs.size(); i++)
+        {
+            _g.segment(offsets.at(state_ptrs[i]), state_ptrs[i]->getSize()) += linearized.jacobians_[i].transpose() * linearized.residual_;
+            for (unsigned int j = 0; j < state_ptrs.size(); j++)
+                _H.block(offsets.at(state_ptrs[i]), offsets.at(state_ptrs[j]), state_ptrs[i]->getSize(), state_ptrs[j]->getSize()) +=
+                        linearized.jacobians_[i].transpose() * linearized.jacobians_[j];
+        }
+    }
+}
+
+void computeInformation(Problem* _problem_ptr, const std::vector<StateBlock*>& _state_ptrs, Eigen::MatrixXs& _H, Eigen::VectorXs& _g)
+{
+    ConstraintBaseList ctr_list;
+    _problem_ptr->getTrajectoryPtr()->getConstraintList(ctr_list);
+    computeInformation(ctr_list, _state_ptrs, _H, _g);
+}
+
+/** Dense prior on the frames left when marginalizing the first one
+ */
+ConstraintMarginalization* marginalizeFirst(Problem* _problem_ptr, const std::vector<FrameBase*>& _frame_ptrs)
+{
+    ConstraintBaseList ctr_list;
+    _problem_ptr->getConstraintsOnKeyFrame(_frame_ptrs.front(), ctr_list);
+    std::list<LinearizedConstraint> linearized_list;
+    for (auto ctr_ptr : ctr_list)
+        linearized_list.push_back(linearize(ctr_ptr));
+    return ConstraintMarginalization::marginalize(_frame_ptrs.front(), linearized_list);
+}
+
+/** What CeresManager::prune() does, without Ceres. Gives the candidate key frames.
+ */
+void prune(Problem* _problem_ptr, FrameBaseList& _frame_list)
+{
+    GraphPruner* pruner_ptr = _problem_ptr->getGraphPrunerPtr();
+    pruner_ptr->getCandidateKeyFrames(_frame_list);
+    FrameBaseList frame_list(_frame_list);
+    for (auto frame_ptr : frame_list)
+    {
+        ConstraintBaseList ctr_list;
+        _problem_ptr->getConstraintsOnKeyFrame(frame_ptr, ctr_list);
+        std::list<LinearizedConstraint> linearized_list;
+        for (auto ctr_ptr : ctr_list)
+            linearized_list.push_back(linearize(ctr_ptr));
+        if (pruner_ptr->isRedundant(frame_ptr, linearized_list))
+            pruner_ptr->pruneKeyFrame(frame_ptr, linearized_list);
+    }
+}
+
+bool near(const Eigen::MatrixXs& _A, const Eigen::MatrixXs& _B, Scalar _tolerance = 1e-8)
+{
+    return (_A - _B).cwiseAbs().maxCoeff() <= _tolerance * std::max(Scalar(1), _B.cwiseAbs().maxCoeff());
+}
+
+int main()
+{
+    bool all_ok = true;
+    bool ok;
+
+    std::cout << std::endl << "==================== Graph pruner test ======================" << std::endl;
+
+    // Chow-Liu tree of a tree-structured prior: exact
+    {
+        Problem* problem_ptr = new Problem(FRM_PO_2D);
+        std::vector<FrameBase*> frames;
+        for (unsigned int i = 0; i < 4; i++)
+            frames.push_back(addKeyFrame(problem_ptr, i));
+        Eigen::MatrixXs jacobian = Eigen::MatrixXs::Zero(12, 12);
+        jacobian.block(0, 0, 3, 3) = randomMatrix(3, 3);
+        jacobian.block(3, 0, 3, 6) = randomMatrix(3, 6);
+        jacobian.block(6, 3, 3, 6) = randomMatrix(3, 6);
+        jacobian.block(9, 3, 3, 3) = randomMatrix(3, 3);
+        jacobian.block(9, 9, 3, 3) = randomMatrix(3, 3);
+        std::vector<StateBlock*> state_ptrs = statesOf(frames);
+        std::list<ConstraintBase*> dense_list({new ConstraintMarginalization(state_ptrs, jacobian, randomMatrix(12, 1),
+                                                                             {frames.begin(), frames.end()})});
+        Eigen::MatrixXs H_dense, H_sparse;
+        Eigen::VectorXs g_dense, g_sparse;
+        computeInformation(dense_list, state_ptrs, H_dense, g_dense);
+        std::list<ConstraintMarginalization*> factor_list = ConstraintMarginalization::sparsify((ConstraintMarginalization*)dense_list.front());
+        std::list<ConstraintBase*> sparse_list(factor_list.begin(), factor_list.end());
+        computeInformation(sparse_list, state_ptrs, H_sparse, g_sparse);
+
+        std::cout << "Chow-Liu tree of a tree-structured prior is the prior... ";
+        ok = factor_list.size() == 4 && near(H_sparse, H_dense) && near(g_sparse, g_dense);
+        for (auto factor_ptr : factor_list)
+            ok = ok && factor_ptr->getFramePtrList().size() <= 2;
+        std::cout << (ok ? "OK" : "FAILED") << std::endl;
+        all_ok = all_ok && ok;
+
+        for (auto factor_ptr : factor_list)
+            delete factor_ptr;
+        problem_ptr->destruct();
+    }
+
+    // Chow-Liu tree of relative information, e.g. a pose graph without absolute reference
+    {
+        Problem* problem_ptr = new Problem(FRM_PO_2D);
+        std::vector<FrameBase*> frames;
+        for (unsigned int i = 0; i < 6; i++)
+            frames.push_back(addKeyFrame(problem_ptr, i));
+
+        // three neighbors: the tree of two variables, relative to the root, is exact
+        for (unsigned int i = 1; i < 4; i++)
+            addRelativeConstraint(frames[0], frames[i], randomMatrix(3, 3));
+        std::vector<StateBlock*> state_ptrs = statesOf({frames[1], frames[2], frames[3]});
+        ConstraintMarginalization* prior_ptr = marginalizeFirst(problem_ptr, frames);
+        std::list<ConstraintBase*> dense_list({prior_ptr});
+        Eigen::MatrixXs H_dense, H_sparse;
+        Eigen::VectorXs g_dense, g_sparse;
+        computeInformation(dense_list, state_ptrs, H_dense, g_dense);
+        std::list<ConstraintMarginalization*> factor_list = ConstraintMarginalization::sparsify(prior_ptr);
+        std::list<ConstraintBase*> sparse_list(factor_list.begin(), factor_list.end());
+        computeInformation(sparse_list, state_ptrs, H_sparse, g_sparse);
+
+        std::cout << "Chow-Liu tree of relative information, three variables... ";
+        ok = factor_list.size() == 2 && near(H_sparse, H_dense) && near(g_sparse, g_dense);
+        std::cout << (ok ? "OK" : "FAILED") << std::endl;
+        all_ok = all_ok && ok;
+        for (auto factor_ptr : factor_list)
+            delete factor_ptr;
+
+        // five neighbors: an approximation, still blind to the gauge and with the same mean
+        addRelativeConstraint(frames[0], frames[4], randomMatrix(3, 3));
+        addRelativeConstraint(frames[0], frames[5], randomMatrix(3, 3));
+        state_ptrs = statesOf({frames[1], frames[2], frames[3], frames[4], frames[5]});
+        prior_ptr = marginalizeFirst(problem_ptr, frames);
+        dense_list.assign({prior_ptr});
+        computeInformation(dense_list, state_ptrs, H_dense, g_dense);
+        factor_list = ConstraintMarginalization::sparsify(prior_ptr);
+        sparse_list.assign(factor_list.begin(), factor_list.end());
+        computeInformation(sparse_list, state_ptrs, H_sparse, g_sparse);
+        Eigen::MatrixXs gauge(15, 3);
+        for (unsigned int i = 0; i < 5; i++)
+            gauge.middleRows(3 * i, 3) = Eigen::Matrix3s::Identity();
+        Eigen::VectorXs mean = -H_dense.completeOrthogonalDecomposition().solve(g_dense);
+
+        std::cout << "Chow-Liu tree of relative information, five variables... ";
+        ok = factor_list.size() == 4 && near(H_sparse * gauge, Eigen::MatrixXs::Zero(15, 3), 1e-8)
+                && near(H_sparse * mean + g_sparse, Eigen::VectorXs::Zero(15), 1e-8)
+                && !near(H_sparse, H_dense, 1e-3);
+        for (auto factor_ptr : factor_list)
+            ok = ok && factor_ptr->getFramePtrList().size() <= 3;
+        std::cout << (ok ? "OK" : "FAILED") << std::endl;
+        all_ok = all_ok && ok;
+
+        for (auto factor_ptr : factor_list)
+            delete factor_ptr;
+        problem_ptr->destruct();
+    }
+
+    // Spatial redundancy on an odometry chain
+    {
+        Problem* problem_ptr = new Problem(FRM_PO_2D);
+        std::vector<Scalar> positions({0, 1, 1.05, 1.1, 3, 4, 4.02, 6, 7, 8});
+        std::vector<FrameBase*> frames;
+        for (unsigned int i = 0; i < positions.size(); i++)
+            frames.push_back(addKeyFrame(problem_ptr, i, positions[i]));
+        addLinearConstraint(frames[0], {frames[0]}, randomMatrix(3, 3), randomMatrix(3, 1));
+        for (unsigned int i = 1; i < frames.size(); i++)
+            addLinearConstraint(frames[i], {frames[i - 1], frames[i]}, randomMatrix(3, 6), randomMatrix(3, 1));
+
+        // the information expected on the frames left: Schur complement of the pruned ones in the whole problem
+        std::vector<FrameBase*> pruned_frames({frames[2], frames[3], frames[6]});
+        std::vector<FrameBase*> frames_left;
+        for (auto frame_ptr : frames)
+            if (std::find(pruned_frames.begin(), pruned_frames.end(), frame_ptr) == pruned_frames.end())
+                frames_left.push_back(frame_ptr);
+        std::vector<StateBlock*> state_ptrs = statesOf(pruned_frames), states_left = statesOf(frames_left);
+        state_ptrs.insert(state_ptrs.end(), states_left.begin(), states_left.end());
+        Eigen::MatrixXs H;
+        Eigen::VectorXs g;
+        computeInformation(problem_ptr, state_ptrs, H, g);
+        unsigned int m = 9, b = H.rows() - 9;
+        Eigen::MatrixXs H_mm_inverse = H.topLeftCorner(m, m).inverse();
+        Eigen::MatrixXs H_expected = H.bottomRightCorner(b, b) - H.bottomLeftCorner(b, m) * H_mm_inverse * H.topRightCorner(m, b);
+        Eigen::VectorXs g_expected = g.tail(b) - H.bottomLeftCorner(b, m) * H_mm_inverse * g.head(m);
+
+        std::cout << "Spatially redundant key frames... ";
+        problem_ptr->enableGraphPruning({3, 0.5, 0.1, 0, false});
+        GraphPruner* pruner_ptr = problem_ptr->getGraphPrunerPtr();
+        ok = pruner_ptr->isDue();
+        FrameBaseList candidate_list;
+        prune(problem_ptr, candidate_list);
+        ok = ok && candidate_list == FrameBaseList(pruned_frames.begin(), pruned_frames.end()) && !pruner_ptr->isDue();
+        std::cout << (ok ? "OK" : "FAILED") << std::endl;
+        all_ok = all_ok && ok;
+
+        std::cout << "Pruned key frames out of the tree, same information on the others... ";
+        Eigen::MatrixXs H_left;
+        Eigen::VectorXs g_left;
+        computeInformation(problem_ptr, states_left, H_left, g_left);
+        const GraphPrunerMetrics& metrics = pruner_ptr->getMetrics();
+        ok = problem_ptr->getTrajectoryPtr()->getKeyFramesCount() == 7 && near(H_left, H_expected) && near(g_left, g_expected);
+        ok = ok && metrics.prunings_ == 1 && metrics.key_frames_removed_ == 3 && metrics.constraints_removed_ == 6
+                && metrics.constraints_added_ == 3;
+        std::cout << (ok ? "OK" : "FAILED") << std::endl;
+        all_ok = all_ok && ok;
+
+        std::cout << "Pruning due after three new key frames, solve time saved... ";
+        FrameBase* previous_ptr = frames.back();
+        for (unsigned int i = 0; i < 3; i++)
+        {
+            ok = ok && !pruner_ptr->isDue();
+            FrameBase* frame_ptr = addKeyFrame(problem_ptr, 10 + i, 9 + i);
+            addLinearConstraint(frame_ptr, {previous_ptr, frame_ptr}, randomMatrix(3, 6), randomMatrix(3, 1));
+            previous_ptr = frame_ptr;
+        }
+        ok = ok && pruner_ptr->isDue();
+        pruner_ptr->notifySolve(1.0, 10);
+        ok = ok && std::abs(metrics.solve_time_ - 1.0) < 1e-12 && std::abs(metrics.solve_time_saved_ - 0.3) < 1e-12;
+        std::cout << (ok ? "OK" : "FAILED") << std::endl;
+        all_ok = all_ok && ok;
+
+        std::cout << "Only the key frames added since the previous pruning... ";
+        std::vector<FrameBase*> new_frames;
+        for (unsigned int i = 0; i < 3; i++)
+        {
+            new_frames.push_back(addKeyFrame(problem_ptr, 13 + i, 11 + 0.1 * i));
+            addLinearConstraint(new_frames.back(), {previous_ptr, new_frames.back()}, randomMatrix(3, 6), randomMatrix(3, 1));
+            previous_ptr = new_frames.back();
+        }
+        candidate_list.clear();
+        prune(problem_ptr, candidate_list);
+        ok = candidate_list == FrameBaseList({new_frames[0], new_frames[1]}) && metrics.prunings_ == 2
+                && problem_ptr->getTrajectoryPtr()->getKeyFramesCount() == 11;
+        std::cout << (ok ? "OK" : "FAILED") << std::endl;
+        all_ok = all_ok && ok;
+
+        problem_ptr->destruct();
+    }
+
+    // Information redundancy: every odometry step measured twice
+    {
+        Problem* problem_ptr = new Problem(FRM_PO_2D);
+        std::vector<FrameBase*> frames;
+        for (unsigned int i = 0; i < 4; i++)
+            frames.push_back(addKeyFrame(problem_ptr, i, i));
+        addLinearConstraint(frames[0], {frames[0]}, randomMatrix(3, 3), randomMatrix(3, 1));
+        for (unsigned int i = 1; i < 4; i++)
+        {
+            Eigen::MatrixXs M = randomMatrix(3, 3);
+            addRelativeConstraint(frames[i - 1], frames[i], M);
+            if (i < 3)
+                addRelativeConstraint(frames[i - 1], frames[i], M);
+        }
+
+        // the covariances the solver would compute
+        std::vector<StateBlock*> state_ptrs = statesOf(frames);
+        std::vector<unsigned int> offsets(1, 0);
+        for (auto state_ptr : state_ptrs)
+            offsets.push_back(offsets.back() + state_ptr->getSize());
+        Eigen::MatrixXs H;
+        Eigen::VectorXs g;
+        computeInformation(problem_ptr, state_ptrs, H, g);
+        Eigen::MatrixXs S = H.inverse();
+        for (unsigned int i = 0; i < state_ptrs.size(); i++)
+            for (unsigned int j = i; j < state_ptrs.size(); j++)
+                problem_ptr->getCovarianceStorePtr()->addBlock(state_ptrs[i], state_ptrs[j],
+                                                               S.block(offsets[i], offsets[j], state_ptrs[i]->getSize(),
+                                                                       state_ptrs[j]->getSize()));
+
+        std::cout << "Information gain of duplicated constraints... ";
+        problem_ptr->enableGraphPruning({0, 0, 0, 1.1, false});
+        GraphPruner* pruner_ptr = problem_ptr->getGraphPrunerPtr();
+        ConstraintBaseList ctr_list;
+        problem_ptr->getConstraintsOnKeyFrame(frames[1], ctr_list);
+        std::list<LinearizedConstraint> linearized_list;
+        for (auto ctr_ptr : ctr_list)
+            linearized_list.push_back(linearize(ctr_ptr));
+        Scalar gain = pruner_ptr->computeInformationGain(linearized_list);
+        ok = ctr_list.size() == 4 && std::abs(gain - 1.5 * log(2)) < 1e-6;
+        ctr_list.clear();
+        problem_ptr->getConstraintsOnKeyFrame(frames[2], ctr_list);
+        linearized_list.clear();
+        for (auto ctr_ptr : ctr_list)
+            linearized_list.push_back(linearize(ctr_ptr));
+        ok = ok && pruner_ptr->computeInformationGain(linearized_list) > 10;
+        std::cout << (ok ? "OK" : "FAILED") << std::endl;
+        all_ok = all_ok && ok;
+
+        std::cout << "Redundant key frames by their information... ";
+        problem_ptr->getCovarianceStorePtr()->clear();
+        ok = std::isinf(pruner_ptr->computeInformationGain(linearized_list));
+        problem_ptr->getCovarianceStorePtr()->clear();
+        for (unsigned int i = 0; i < state_ptrs.size(); i++)
+            for (unsigned int j = i; j < state_ptrs.size(); j++)
+                problem_ptr->getCovarianceStorePtr()->addBlock(state_ptrs[i], state_ptrs[j],
+                                                               S.block(offsets[i], offsets[j], state_ptrs[i]->getSize(),
+                                                                       state_ptrs[j]->getSize()));
+        FrameBaseList candidate_list;
+        prune(problem_ptr, candidate_list);
+        ok = ok && candidate_list == FrameBaseList({frames[1], frames[2]});
+        ok = ok && problem_ptr->getTrajectoryPtr()->getKeyFramesCount() == 3
+                && problem_ptr->getGraphPrunerPtr()->getMetrics().key_frames_removed_ == 1;
+        std::cout << (ok ? "OK" : "FAILED") << std::endl;
+        all_ok = all_ok && ok;
+
+        std::cout << "Stale covariances after a pruning, until computed again... ";
+        // a step measured twice more, on a state of the prior
+        Eigen::MatrixXs M = randomMatrix(3, 3);
+        linearized_list.clear();
+        linearized_list.push_back(linearize(addRelativeConstraint(frames[2], frames[3], M)));
+        addRelativeConstraint(frames[2], frames[3], M);
+        ok = std::isinf(pruner_ptr->computeInformationGain(linearized_list));
+        std::vector<FrameBase*> frames_left({frames[0], frames[2], frames[3]});
+        std::vector<StateBlock*> states_left = statesOf(frames_left);
+        computeInformation(problem_ptr, states_left, H, g);
+        S = H.inverse();
+        problem_ptr->clearCovariance();
+        for (unsigned int i = 0, offset_i = 0; i < states_left.size(); offset_i += states_left[i++]->getSize())
+            for (unsigned int j = i, offset_j = offset_i; j < states_left.size(); offset_j += states_left[j++]->getSize())
+                problem_ptr->getCovarianceStorePtr()->addBlock(states_left[i], states_left[j],
+                                                               S.block(offset_i, offset_j, states_left[i]->getSize(),
+                                                                       states_left[j]->getSize()));
+        ok = ok && !std::isinf(pruner_ptr->computeInformationGain(linearized_list));
+        std::cout << (ok ? "OK" : "FAILED") << std::endl;
+        all_ok = all_ok && ok;
+
+        problem_ptr->destruct();
+    }
+
+    std::cout << (all_ok ? "All tests passed" : "Some tests FAILED") << std::endl;
+
+    return all_ok ? 0 : 1;
+}
@@ -0,0 +1,158 @@
+/**
+ * \file test_imu_bias_correction.cpp
+ *
+ *  Created on: Jun 24, 2016
+ *      \author: jsola
+ */
+
+// Classes under test
+#include "processor_imu.h"
+
+// Wolf includes
+#include "wolf.h"
+#include "problem.h"
+#include "frame_imu.h"
+#include "state_block.h"
+
+// STL includes
+#include <vector>
+
+// General includes
+#include <iostream>
+
+using namespace wolf;
+
+ProcessorIMU* newProcessorIMU(Problem* _problem_ptr, const Eigen::VectorXs& _x0)
+{
+    Eigen::VectorXs IMU_extrinsics(7);
+    IMU_extrinsics << 0,0,0, 0,0,0,1;
+    _problem_ptr->installSensor("IMU", "Main IMU", IMU_extrinsics, nullptr);
+    _problem_ptr->installProcessor("IMU", "IMU pre-integrator", "Main IMU", "");
+    ProcessorIMU* processor_ptr = (ProcessorIMU*)(_problem_ptr->getProcessorMotionPtr());
+    processor_ptr->setOrigin(_x0, TimeStamp(0));
+    return processor_ptr;
+}
+
+int main()
+{
+    bool all_ok = true;
+    unsigned int N = 1000;
+    const Scalar dt = 0.001;
+
+    std::cout << std::endl << "==================== IMU bias correction test ======================" << std::endl;
+
+    // Synthetic IMU data: 1s at 1kHz
+    std::vector<TimeStamp> time_stamps(N);
+    Eigen::MatrixXs data(6, N);
+    for (unsigned int i = 0; i < N; i++)
+    {
+        time_stamps[i] = TimeStamp((i + 1) * dt);
+        data.col(i) << 0.1 * sin(i * dt), 0.2, 9.8, 0.1, -0.2, 0.3 * cos(i * dt);
+    }
+    Eigen::MatrixXs data_cov = Eigen::MatrixXs::Identity(6, 6) * 1e-4;
+
+    Eigen::VectorXs x0(16);
+    x0 << 0,0,0,  1,0,0,  0,0,0,1,  .01,.02,.03,  .001,.002,.003;
+    Eigen::Vector3s acc_bias_change(.01, -.02, .01);
+    Eigen::Vector3s gyro_bias_change(.002, .001, -.002);
+    Eigen::VectorXs x0_new(x0);
+    x0_new.segment(10, 3) += acc_bias_change;
+    x0_new.segment(13, 3) += gyro_bias_change;
+
+    // Reference: integration with the new biases from the start
+    Problem* problem_ref_ptr = new Problem(FRM_PVQBB_3D);
+    ProcessorIMU* processor_ref_ptr = newProcessorIMU(problem_ref_ptr, x0_new);
+    processor_ref_ptr->processBatch(time_stamps, data, data_cov);
+    Eigen::VectorXs delta_ref = processor_ref_ptr->getMotion().delta_integr_;
+
+    // First order correction
+    Problem* problem_ptr = new Problem(FRM_PVQBB_3D);
+    ProcessorIMU* processor_ptr = newProcessorIMU(problem_ptr, x0);
+    processor_ptr->processBatch(time_stamps, data, data_cov);
+    Scalar error_before = (processor_ptr->getMotion().delta_integr_ - delta_ref).norm();
+    FrameIMU* origin_ptr = (FrameIMU*)(problem_ptr->getLastKeyFramePtr());
+    origin_ptr->getBAPtr()->setVector(x0_new.segment(10, 3));
+    origin_ptr->getBGPtr()->setVector(x0_new.segment(13, 3));
+    bool reintegrated = processor_ptr->correctBias();
+    Scalar error_after = (processor_ptr->getMotion().delta_integr_ - delta_ref).norm();
+    std::cout << "First order correction: error " << error_before << " --> " << error_after << "... ";
+    bool ok = !reintegrated && (error_after < 1e-2 * error_before);
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    // Full re-integration
+    Problem* problem_full_ptr = new Problem(FRM_PVQBB_3D);
+    ProcessorIMU* processor_full_ptr = newProcessorIMU(problem_full_ptr, x0);
+    processor_full_ptr->setBiasCorrectionThreshold(0);
+    processor_full_ptr->processBatch(time_stamps, data, data_cov);
+    origin_ptr = (FrameIMU*)(problem_full_ptr->getLastKeyFramePtr());
+    origin_ptr->getBAPtr()->setVector(x0_new.segment(10, 3));
+    origin_ptr->getBGPtr()->setVector(x0_new.segment(13, 3));
+    reintegrated = processor_full_ptr->correctBias();
+    error_after = (processor_full_ptr->getMotion().delta_integr_ - delta_ref).norm();
+    Scalar cov_error = (processor_full_ptr->getMotion().delta_integr_cov_ - processor_ref_ptr->getMotion().delta_integr_cov_).norm();
+    std::cout << "Full re-integration: error " << error_before << " --> " << error_after << "... ";
+    ok = reintegrated && (error_after < 1e-9) && (cov_error < 1e-9);
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    // Integration goes on with the new biases
+    std::cout << "Integration after correction... ";
+    for (unsigned int i = 0; i < N; i++)
+        time_stamps[i] += N * dt;
+    processor_ref_ptr->processBatch(time_stamps, data, data_cov);
+    processor_full_ptr->processBatch(time_stamps, data, data_cov);
+    ok = (processor_full_ptr->getMotion().delta_integr_ - processor_ref_ptr->getMotion().delta_integr_).norm() < 1e-9;
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    // Reference over the first second again
+    for (unsigned int i = 0; i < N; i++)
+        time_stamps[i] = TimeStamp((i + 1) * dt);
+    Problem* problem_ref2_ptr = new Problem(FRM_PVQBB_3D);
+    ProcessorIMU* processor_ref2_ptr = newProcessorIMU(problem_ref2_ptr, x0_new);
+    processor_ref2_ptr->processBatch(time_stamps, data, data_cov);
+
+    // First order correction after a solve, half way, then a re-integration
+    std::cout << "Re-integration after a first order correction... ";
+    std::vector<TimeStamp> time_stamps_1(time_stamps.begin(), time_stamps.begin() + N / 2);
+    std::vector<TimeStamp> time_stamps_2(time_stamps.begin() + N / 2, time_stamps.end());
+    Problem* problem_half_ptr = new Problem(FRM_PVQBB_3D);
+    ProcessorIMU* processor_half_ptr = newProcessorIMU(problem_half_ptr, x0);
+    processor_half_ptr->processBatch(time_stamps_1, data.leftCols(N / 2), data_cov);
+    origin_ptr = (FrameIMU*)(problem_half_ptr->getLastKeyFramePtr());
+    origin_ptr->getBAPtr()->setVector(x0.segment(10, 3) + acc_bias_change / 2);
+    origin_ptr->getBGPtr()->setVector(x0.segment(13, 3) + gyro_bias_change / 2);
+    problem_half_ptr->solveCallback();
+    processor_half_ptr->processBatch(time_stamps_2, data.rightCols(N - N / 2), data_cov);
+    origin_ptr->getBAPtr()->setVector(x0_new.segment(10, 3));
+    origin_ptr->getBGPtr()->setVector(x0_new.segment(13, 3));
+    processor_half_ptr->setBiasCorrectionThreshold(0);
+    reintegrated = processor_half_ptr->correctBias();
+    error_after = (processor_half_ptr->getMotion().delta_integr_ - processor_ref2_ptr->getMotion().delta_integr_).norm();
+    ok = reintegrated && error_after < 1e-9;
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    // First order correction, then a state in the buffer
+    std::cout << "Motions of the buffer corrected when needed... ";
+    Problem* problem_lazy_ptr = new Problem(FRM_PVQBB_3D);
+    ProcessorIMU* processor_lazy_ptr = newProcessorIMU(problem_lazy_ptr, x0);
+    processor_lazy_ptr->processBatch(time_stamps, data, data_cov);
+    origin_ptr = (FrameIMU*)(problem_lazy_ptr->getLastKeyFramePtr());
+    origin_ptr->getBAPtr()->setVector(x0_new.segment(10, 3));
+    origin_ptr->getBGPtr()->setVector(x0_new.segment(13, 3));
+    problem_lazy_ptr->solveCallback();
+    ok = (processor_lazy_ptr->getMotion().delta_integr_ - processor_ref2_ptr->getMotion().delta_integr_).norm() < 1e-2 * error_before;
+    Eigen::VectorXs x_lazy(16), x_ref(16);
+    processor_lazy_ptr->getState(TimeStamp(N * dt / 2), x_lazy);
+    processor_ref2_ptr->getState(TimeStamp(N * dt / 2), x_ref);
+    ok = ok && (x_lazy.head(10) - x_ref.head(10)).norm() < 1e-9
+            && (processor_lazy_ptr->getMotion().delta_integr_ - processor_ref2_ptr->getMotion().delta_integr_).norm() < 1e-9;
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << (all_ok ? "All tests passed" : "Some tests FAILED") << std::endl;
+
+    return all_ok ? 0 : 1;
+}
@@ -0,0 +1,118 @@
+/**
+ * \file test_imu_tools.cpp
+ *
+ *  Created on: Jul 2, 2016
+ *      \author: jsola
+ */
+
+// Classes under test
+#include "imu_tools.h"
+
+// Wolf includes
+#include "wolf.h"
+
+// STL includes
+#include <ctime>
+
+// General includes
+#include <iostream>
+
+using namespace wolf;
+
+typedef Eigen::Matrix<Scalar, 10, 1> Vector10s;
+typedef Eigen::Matrix<Scalar, 9, 9> Matrix9s;
+
+/** One integration step with the dense covariance propagation, as done by ProcessorMotionT::deltaCovPlusDeltaCov()
+ */
+template<typename VectorType, typename MatrixType>
+void integrateDense(VectorType& _Delta, MatrixType& _Delta_cov, const VectorType& _delta, const MatrixType& _delta_cov,
+                    const Scalar _dt, MatrixType& _J1, MatrixType& _J2)
+{
+    imuDeltaPlusDeltaJacobians(_Delta, _delta, _dt, _J1, _J2);
+    imuDeltaPlusDelta(_Delta, _delta, _dt, _Delta);
+    _Delta_cov = _J1 * _Delta_cov * _J1.transpose() + _J2 * _delta_cov * _J2.transpose();
+}
+
+/** One integration step with the structured covariance propagation, as done by ProcessorIMU::deltaCovPlusDeltaCov()
+ */
+template<typename VectorType, typename MatrixType>
+void integrateStructured(VectorType& _Delta, MatrixType& _Delta_cov, const VectorType& _delta, const MatrixType& _delta_cov,
+                         const Scalar _dt, MatrixType& _J1, MatrixType& _J2)
+{
+    imuDeltaPlusDeltaJacobians(_Delta, _delta, _dt, _J1, _J2);
+    imuDeltaPlusDelta(_Delta, _delta, _dt, _Delta);
+    imuDeltaCovPlusDeltaCov(_Delta_cov, _delta_cov, _J1, _J2, _Delta_cov);
+}
+
+/** Integrates N times the same delta. Returns the time per step in ns.
+ */
+template<typename VectorType, typename MatrixType>
+Scalar benchmark(bool _structured, const Vector10s& _delta, const Matrix9s& _delta_cov, const Scalar _dt, unsigned int _N,
+                 Vector10s& _Delta_out, Matrix9s& _Delta_cov_out)
+{
+    VectorType delta(_delta), Delta(_delta);
+    MatrixType delta_cov(_delta_cov), Delta_cov(_delta_cov), J1(9, 9), J2(9, 9);
+    clock_t begin = clock();
+    for (unsigned int i = 0; i < _N; i++)
+    {
+        if (_structured)
+            integrateStructured(Delta, Delta_cov, delta, delta_cov, _dt, J1, J2);
+        else
+            integrateDense(Delta, Delta_cov, delta, delta_cov, _dt, J1, J2);
+    }
+    Scalar elapsed = double(clock() - begin) / CLOCKS_PER_SEC;
+    _Delta_out = Delta;
+    _Delta_cov_out = Delta_cov;
+    return elapsed / _N * 1e9;
+}
+
+int main()
+{
+    bool all_ok = true;
+    bool ok;
+    unsigned int N = 100000;
+    const Scalar dt = 0.001;
+
+    std::cout << std::endl << "==================== IMU tools test ======================" << std::endl;
+
+    // a typical IMU step, and a full covariance for it
+    Vector10s delta;
+    delta.head<3>() = Eigen::Vector3s(0.1, 0.2, 9.8) * dt * dt / 2;
+    delta.segment<3>(3) = Eigen::Vector3s(0.1, 0.2, 9.8) * dt;
+    delta.segment<4>(6) = v2q(Eigen::Vector3s(0.01, -0.02, 0.3) * dt).coeffs();
+    Matrix9s A = Matrix9s::Random();
+    Matrix9s delta_cov = A * A.transpose() * 1e-8;
+
+    // reference: dense products on dynamic-size matrices
+    Vector10s Delta_ref, Delta;
+    Matrix9s Delta_cov_ref, Delta_cov;
+    Scalar t_dynamic_dense = benchmark<Eigen::VectorXs, Eigen::MatrixXs>(false, delta, delta_cov, dt, N, Delta_ref, Delta_cov_ref);
+
+    std::cout << "Fixed-size dense kernels, same delta and covariance... ";
+    Scalar t_fixed_dense = benchmark<Vector10s, Matrix9s>(false, delta, delta_cov, dt, N, Delta, Delta_cov);
+    ok = (Delta - Delta_ref).isZero(1e-12) && Delta_cov.isApprox(Delta_cov_ref, 1e-12);
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Dynamic-size structured kernels, same delta and covariance... ";
+    Scalar t_dynamic_structured = benchmark<Eigen::VectorXs, Eigen::MatrixXs>(true, delta, delta_cov, dt, N, Delta, Delta_cov);
+    ok = (Delta - Delta_ref).isZero(1e-12) && Delta_cov.isApprox(Delta_cov_ref, 1e-12);
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Fixed-size structured kernels, same delta and covariance... ";
+    Scalar t_fixed_structured = benchmark<Vector10s, Matrix9s>(true, delta, delta_cov, dt, N, Delta, Delta_cov);
+    ok = (Delta - Delta_ref).isZero(1e-12) && Delta_cov.isApprox(Delta_cov_ref, 1e-12);
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Time per integration step:" << std::endl;
+    std::cout << "    dynamic size, dense covariance:      " << t_dynamic_dense << " ns" << std::endl;
+    std::cout << "    dynamic size, structured covariance: " << t_dynamic_structured << " ns" << std::endl;
+    std::cout << "    fixed size,   dense covariance:      " << t_fixed_dense << " ns" << std::endl;
+    std::cout << "    fixed size,   structured covariance: " << t_fixed_structured << " ns" << std::endl;
+
+    std::cout << (all_ok ? "All tests passed" : "Some tests FAILED") << std::endl;
+
+    return all_ok ? 0 : 1;
+}
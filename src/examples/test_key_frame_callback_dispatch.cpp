@@ -0,0 +1,187 @@
+/**
+ * \file test_key_frame_callback_dispatch.cpp
+ *
+ *  Created on: Jul 6, 2016
+ *      \author: jsola
+ */
+
+// Classes under test
+#include "problem.h"
+#include "processor_tracker_feature.h"
+
+// Wolf includes
+#include "wolf.h"
+#include "sensor_base.h"
+#include "trajectory_base.h"
+#include "frame_base.h"
+#include "capture_void.h"
+#include "constraint_epipolar.h"
+#include "state_block.h"
+
+// STL includes
+#include <chrono>
+#include <map>
+#include <sstream>
+#include <thread>
+
+// General includes
+#include <iostream>
+
+using namespace wolf;
+
+/** A feature tracker whose detection takes some time, and which never votes for key frames
+ */
+class ProcessorTrackerFeatureSlow : public ProcessorTrackerFeature
+{
+    public:
+        ProcessorTrackerFeatureSlow(Scalar _detection_time) :
+                ProcessorTrackerFeature(PRC_TRACKER_DUMMY, "TRACKER FEATURE SLOW", 5), detection_time_(_detection_time), n_feature_(0)
+        {
+            //
+        }
+
+    protected:
+        Scalar detection_time_;
+        unsigned int n_feature_;
+
+        virtual unsigned int trackFeatures(const FeatureBaseList& _feature_list_in, FeatureBaseList& _feature_list_out,
+                                           FeatureMatchMap& _feature_correspondences)
+        {
+            for (auto feature_in_ptr : _feature_list_in)
+            {
+                _feature_list_out.push_back(new FeatureBase(FEATURE_POINT_IMAGE, "POINT IMAGE", feature_in_ptr->getMeasurement(),
+                                                            feature_in_ptr->getMeasurementCovariance()));
+                _feature_correspondences[_feature_list_out.back()] = FeatureMatch({feature_in_ptr, 0});
+            }
+            return _feature_list_out.size();
+        }
+
+        virtual bool correctFeatureDrift(const FeatureBase* _origin_feature, const FeatureBase* _last_feature, FeatureBase* _incoming_feature)
+        {
+            return true;
+        }
+
+        virtual bool voteForKeyFrame()
+        {
+            return false;
+        }
+
+        virtual unsigned int detectNewFeatures(const unsigned int& _max_features)
+        {
+            // the detection latency, e.g. waiting for the image pipeline
+            std::this_thread::sleep_for(std::chrono::duration<Scalar>(detection_time_));
+            for (unsigned int i = 0; i < _max_features; i++)
+                new_features_last_.push_back(new FeatureBase(FEATURE_POINT_IMAGE, "POINT IMAGE", Eigen::Vector1s::Constant(n_feature_++),
+                                                             Eigen::MatrixXs::Ones(1, 1)));
+            return new_features_last_.size();
+        }
+
+        virtual ConstraintBase* createConstraint(FeatureBase* _feature_ptr, FeatureBase* _feature_other_ptr)
+        {
+            return new ConstraintEpipolar(_feature_ptr, _feature_other_ptr);
+        }
+};
+
+/** Creates _n_key_frames key frames taken by _n_processors trackers.
+ * Returns the resulting key frames in text form, and the time per key frame callback.
+ */
+std::string run(unsigned int _n_threads, unsigned int _n_processors, unsigned int _n_key_frames, Scalar _detection_time,
+                Scalar& _time_per_callback)
+{
+    Scalar dt = 0.1;
+    Problem* problem_ptr = new Problem(FRM_PO_2D);
+    problem_ptr->setKeyFrameCallbackThreads(_n_threads);
+    std::map<SensorBase*, unsigned int> sensor_index;
+    std::vector<ProcessorTrackerFeatureSlow*> processors;
+    for (unsigned int i = 0; i < _n_processors; i++)
+    {
+        SensorBase* sensor_ptr = new SensorBase(SEN_ODOM_2D, "ODOM 2D", new StateBlock(Eigen::Vector2s::Zero(), true),
+                                                new StateBlock(Eigen::Vector1s::Zero(), true),
+                                                new StateBlock(Eigen::VectorXs::Zero(0), true), 0);
+        processors.push_back(new ProcessorTrackerFeatureSlow(_detection_time));
+        problem_ptr->addSensor(sensor_ptr);
+        sensor_ptr->addProcessor(processors.back());
+        sensor_index[sensor_ptr] = i;
+    }
+    // the processor creating the key frames, out of the tree
+    ProcessorTrackerFeatureSlow* master_ptr = new ProcessorTrackerFeatureSlow(0);
+
+    // two captures each, to have a last capture in a non-key frame
+    for (unsigned int k = 0; k < 2; k++)
+        for (auto processor_ptr : processors)
+            processor_ptr->process(new CaptureVoid(TimeStamp(k * dt), processor_ptr->getSensorPtr()));
+
+    Scalar elapsed = 0;
+    for (unsigned int k = 1; k <= _n_key_frames; k++)
+    {
+        FrameBase* key_frame_ptr = problem_ptr->createFrame(KEY_FRAME, Eigen::Vector3s::Zero(), TimeStamp(k * dt));
+        auto begin = std::chrono::steady_clock::now();
+        problem_ptr->keyFrameCallback(key_frame_ptr, master_ptr, dt / 10);
+        elapsed += std::chrono::duration<Scalar>(std::chrono::steady_clock::now() - begin).count();
+        for (auto processor_ptr : processors)
+            processor_ptr->process(new CaptureVoid(TimeStamp((k + 1) * dt), processor_ptr->getSensorPtr()));
+    }
+    _time_per_callback = elapsed / _n_key_frames;
+
+    // the key frames, in text form
+    std::stringstream key_frames;
+    for (auto frame_ptr : *(problem_ptr->getTrajectoryPtr()->getFrameListPtr()))
+    {
+        if (!frame_ptr->isKey())
+            continue;
+        key_frames << "frame " << frame_ptr->getTimeStamp().get() << ":";
+        for (auto capture_ptr : *(frame_ptr->getCaptureListPtr()))
+        {
+            key_frames << " sensor " << sensor_index[capture_ptr->getSensorPtr()] << " [";
+            for (auto feature_ptr : *(capture_ptr->getFeatureListPtr()))
+                key_frames << " " << feature_ptr->getMeasurement()(0) << "/" << feature_ptr->getConstraintListPtr()->size();
+            key_frames << " ]";
+        }
+        key_frames << std::endl;
+    }
+
+    delete master_ptr;
+    problem_ptr->destruct();
+    return key_frames.str();
+}
+
+int main()
+{
+    bool all_ok = true;
+    bool ok;
+
+    std::cout << std::endl << "==================== Key frame callback dispatch test ======================" << std::endl;
+
+    unsigned int n_processors = 4;
+    unsigned int n_key_frames = 20;
+    Scalar detection_time = 0.005;
+    Scalar time_sequential, time_parallel;
+
+    std::string key_frames_sequential = run(1, n_processors, n_key_frames, detection_time, time_sequential);
+    std::string key_frames_parallel = run(n_processors, n_processors, n_key_frames, detection_time, time_parallel);
+
+    std::cout << "All processors took all key frames... ";
+    ok = key_frames_sequential.find("[ ]") == std::string::npos;
+    for (unsigned int i = 0; i < n_processors; i++)
+        ok = ok && key_frames_sequential.find("sensor " + std::to_string(i)) != std::string::npos;
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Same tree with " << n_processors << " threads as with one... ";
+    ok = (key_frames_parallel == key_frames_sequential);
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Detections overlapped... ";
+    ok = time_parallel < 0.6 * time_sequential;
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Time per key frame callback, " << n_processors << " processors detecting in " << detection_time * 1e3 << " ms:" << std::endl;
+    std::cout << "    1 thread:  " << time_sequential * 1e3 << " ms" << std::endl;
+    std::cout << "    " << n_processors << " threads: " << time_parallel * 1e3 << " ms" << std::endl;
+
+    std::cout << (all_ok ? "All tests passed" : "Some tests FAILED") << std::endl;
+
+    return all_ok ? 0 : 1;
+}
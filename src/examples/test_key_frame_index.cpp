@@ -0,0 +1,243 @@
+/**
+ * \file test_key_frame_index.cpp
+ *
+ *  Created on: Jul 12, 2016
+ *      \author: jsola
+ */
+
+// Classes under test
+#include "trajectory_base.h"
+
+// Wolf includes
+#include "wolf.h"
+#include "problem.h"
+#include "frame_base.h"
+#include "state_block.h"
+
+// STL includes
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <random>
+#include <vector>
+
+// General includes
+#include <iostream>
+
+using namespace wolf;
+
+FrameBase* newFrame(FrameKeyType _key, Scalar _ts)
+{
+    return new FrameBase(_key, TimeStamp(_ts), new StateBlock(Eigen::Vector2s::Zero()), new StateBlock(Eigen::Vector1s::Zero()));
+}
+
+/** The former TrajectoryBase::closestKeyFrameToTimeStamp(), scanning the frame list backwards
+ */
+FrameBase* closestKeyFrameByScan(TrajectoryBase* _trajectory_ptr, const TimeStamp& _ts)
+{
+    FrameBase* closest_kf = nullptr;
+    Scalar min_dt = 1e9;
+    for (auto frm_rit = _trajectory_ptr->getFrameListPtr()->rbegin(); frm_rit != _trajectory_ptr->getFrameListPtr()->rend(); frm_rit++)
+        if ((*frm_rit)->isKey())
+        {
+            if (std::abs((*frm_rit)->getTimeStamp().get() - _ts.get()) < min_dt)
+            {
+                min_dt = std::abs((*frm_rit)->getTimeStamp().get() - _ts.get());
+                closest_kf = *frm_rit;
+            }
+            else
+                break;
+        }
+    return closest_kf;
+}
+
+/** The former TrajectoryBase::computeFrameOrder(), scanning a frame list backwards
+ */
+FrameBaseIter frameOrderByScan(FrameBaseList& _frame_list, FrameBase* _frame_ptr)
+{
+    for (auto frm_rit = _frame_list.rbegin(); frm_rit != _frame_list.rend(); frm_rit++)
+        if ((*frm_rit) != _frame_ptr && (*frm_rit)->isKey() && (*frm_rit)->getTimeStamp() < _frame_ptr->getTimeStamp())
+            return frm_rit.base();
+    return _frame_list.begin();
+}
+
+bool isSorted(TrajectoryBase* _trajectory_ptr)
+{
+    FrameBase* previous_ptr = nullptr;
+    for (auto frame_ptr : *(_trajectory_ptr->getFrameListPtr()))
+    {
+        if (!frame_ptr->isKey())
+            continue;
+        if (previous_ptr != nullptr && frame_ptr->getTimeStamp() < previous_ptr->getTimeStamp())
+            return false;
+        previous_ptr = frame_ptr;
+    }
+    return true;
+}
+
+int main()
+{
+    bool all_ok = true;
+    bool ok;
+
+    std::cout << std::endl << "==================== Key frame index test ======================" << std::endl;
+
+    std::mt19937 generator(1);
+
+    // A trajectory of key frames added out of order, and a few non-key frames
+    Problem* problem_ptr = new Problem(FRM_PO_2D);
+    TrajectoryBase* trajectory_ptr = problem_ptr->getTrajectoryPtr();
+    std::vector<unsigned int> order(200);
+    for (unsigned int i = 0; i < order.size(); i++)
+        order[i] = i;
+    std::shuffle(order.begin(), order.end(), generator);
+    for (auto i : order)
+        trajectory_ptr->addFrame(newFrame(KEY_FRAME, i));
+    FrameBase* non_key_ptr = trajectory_ptr->addFrame(newFrame(NON_KEY_FRAME, 50.5));
+    trajectory_ptr->addFrame(newFrame(NON_KEY_FRAME, 300));
+
+    std::cout << "Key frames sorted by time stamp, before the others... ";
+    ok = isSorted(trajectory_ptr) && trajectory_ptr->getFrameListPtr()->front()->getTimeStamp().get() == 0
+            && trajectory_ptr->getLastKeyFramePtr()->getTimeStamp().get() == 199 && !trajectory_ptr->getLastFramePtr()->isKey();
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Closest key frame as by scanning the frames... ";
+    ok = true;
+    std::uniform_real_distribution<Scalar> time_distribution(-10, 210);
+    for (unsigned int i = 0; i < 1000; i++)
+    {
+        TimeStamp ts(time_distribution(generator));
+        ok = ok && trajectory_ptr->closestKeyFrameToTimeStamp(ts) == closestKeyFrameByScan(trajectory_ptr, ts);
+    }
+    ok = ok && trajectory_ptr->closestKeyFrameToTimeStamp(TimeStamp(20.5))->getTimeStamp().get() == 21; // the newest of two
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Key frames in a time window... ";
+    FrameBaseList window;
+    trajectory_ptr->getKeyFrameList(TimeStamp(10), TimeStamp(14.5), window);
+    ok = window.size() == 5 && window.front()->getTimeStamp().get() == 10 && window.back()->getTimeStamp().get() == 14;
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "New key frame sorted, destructed key frames out of the index... ";
+    non_key_ptr->setKey();
+    ok = isSorted(trajectory_ptr) && trajectory_ptr->closestKeyFrameToTimeStamp(TimeStamp(50.6)) == non_key_ptr;
+    trajectory_ptr->getLastKeyFramePtr()->destruct();
+    trajectory_ptr->closestKeyFrameToTimeStamp(TimeStamp(50.6))->destruct();
+    ok = ok && trajectory_ptr->getLastKeyFramePtr()->getTimeStamp().get() == 198
+            && trajectory_ptr->closestKeyFrameToTimeStamp(TimeStamp(50.6))->getTimeStamp().get() == 51;
+    window.clear();
+    trajectory_ptr->getKeyFrameList(TimeStamp(0), TimeStamp(1000), window);
+    ok = ok && window.size() == 199 && isSorted(trajectory_ptr);
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Key frame sorted again after its time stamp changed... ";
+    FrameBase* moved_ptr = trajectory_ptr->closestKeyFrameToTimeStamp(TimeStamp(20));
+    moved_ptr->setTimeStamp(TimeStamp(120.5));
+    trajectory_ptr->sortFrame(moved_ptr, TimeStamp(20));
+    ok = isSorted(trajectory_ptr) && trajectory_ptr->closestKeyFrameToTimeStamp(TimeStamp(120.6)) == moved_ptr
+            && trajectory_ptr->closestKeyFrameToTimeStamp(TimeStamp(20))->getTimeStamp().get() == 21;
+    moved_ptr->destruct();
+    window.clear();
+    trajectory_ptr->getKeyFrameList(TimeStamp(0), TimeStamp(1000), window);
+    ok = ok && window.size() == 198 && trajectory_ptr->closestKeyFrameToTimeStamp(TimeStamp(120.6))->getTimeStamp().get() == 121;
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    problem_ptr->destruct();
+
+    // 100k key frames, added in random order
+    unsigned int n_key_frames = 100000;
+    order.resize(n_key_frames);
+    for (unsigned int i = 0; i < n_key_frames; i++)
+        order[i] = i;
+    std::shuffle(order.begin(), order.end(), generator);
+    problem_ptr = new Problem(FRM_PO_2D);
+    trajectory_ptr = problem_ptr->getTrajectoryPtr();
+    std::vector<FrameBase*> frames;
+    for (auto i : order)
+        frames.push_back(newFrame(KEY_FRAME, i * 0.1));
+    clock_t begin = clock();
+    for (auto frame_ptr : frames)
+        trajectory_ptr->addFrame(frame_ptr);
+    Scalar time_insert_index = double(clock() - begin) / CLOCKS_PER_SEC / n_key_frames;
+
+    // the former insertion, on a separate list of the same frames
+    unsigned int n_scan_inserts = 10000;
+    FrameBaseList frame_list;
+    begin = clock();
+    for (unsigned int i = 0; i < n_scan_inserts; i++)
+        frame_list.insert(frameOrderByScan(frame_list, frames[i]), frames[i]);
+    Scalar time_insert_scan = double(clock() - begin) / CLOCKS_PER_SEC / n_scan_inserts;
+
+    std::cout << "Sorted insertion of " << n_key_frames << " key frames... ";
+    ok = isSorted(trajectory_ptr) && trajectory_ptr->getFrameListPtr()->size() == n_key_frames;
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    // non-key frames made key, as the processors do, in the past of the last key frame
+    unsigned int n_set_keys = 1000;
+    std::vector<FrameBase*> non_key_frames;
+    for (unsigned int i = 0; i < n_set_keys; i++)
+        non_key_frames.push_back(newFrame(NON_KEY_FRAME, (n_key_frames - n_set_keys + i) * 0.1 - 0.05));
+    begin = clock();
+    for (auto frame_ptr : non_key_frames)
+    {
+        trajectory_ptr->addFrame(frame_ptr);
+        frame_ptr->setKey();
+    }
+    Scalar time_set_key = double(clock() - begin) / CLOCKS_PER_SEC / n_set_keys;
+
+    std::cout << "Non-key frames made key... ";
+    ok = isSorted(trajectory_ptr) && trajectory_ptr->getKeyFramesCount() == n_key_frames + n_set_keys
+            && trajectory_ptr->closestKeyFrameToTimeStamp(non_key_frames.back()->getTimeStamp()) == non_key_frames.back();
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    // queries at random times
+    unsigned int n_queries = 1000;
+    std::uniform_real_distribution<Scalar> query_distribution(0, n_key_frames * 0.1);
+    std::vector<TimeStamp> queries;
+    for (unsigned int i = 0; i < n_queries; i++)
+        queries.push_back(TimeStamp(query_distribution(generator)));
+    std::vector<FrameBase*> closest_index, closest_scan;
+    begin = clock();
+    for (auto ts : queries)
+        closest_index.push_back(trajectory_ptr->closestKeyFrameToTimeStamp(ts));
+    Scalar time_closest_index = double(clock() - begin) / CLOCKS_PER_SEC / n_queries;
+    begin = clock();
+    for (auto ts : queries)
+        closest_scan.push_back(closestKeyFrameByScan(trajectory_ptr, ts));
+    Scalar time_closest_scan = double(clock() - begin) / CLOCKS_PER_SEC / n_queries;
+    begin = clock();
+    unsigned int n_in_windows = 0;
+    for (auto ts : queries)
+    {
+        window.clear();
+        trajectory_ptr->getKeyFrameList(ts, ts + 1.0, window);
+        n_in_windows += window.size();
+    }
+    Scalar time_window = double(clock() - begin) / CLOCKS_PER_SEC / n_queries;
+
+    std::cout << "Same closest key frames as by scanning... ";
+    ok = closest_index == closest_scan && n_in_windows >= 9 * n_queries;
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Times with " << n_key_frames << " key frames:" << std::endl;
+    std::cout << "    insertion out of order, index:  " << time_insert_index * 1e6 << " us" << std::endl;
+    std::cout << "    insertion out of order, scan:   " << time_insert_scan * 1e6 << " us (of " << n_scan_inserts << " frames only)" << std::endl;
+    std::cout << "    non-key frame made key:         " << time_set_key * 1e6 << " us" << std::endl;
+    std::cout << "    closest key frame, index:       " << time_closest_index * 1e6 << " us" << std::endl;
+    std::cout << "    closest key frame, scan:        " << time_closest_scan * 1e6 << " us" << std::endl;
+    std::cout << "    key frames in a 1 s window:     " << time_window * 1e6 << " us" << std::endl;
+
+    problem_ptr->destruct();
+
+    std::cout << (all_ok ? "All tests passed" : "Some tests FAILED") << std::endl;
+
+    return all_ok ? 0 : 1;
+}
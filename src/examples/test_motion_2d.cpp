@@ -210,7 +210,7 @@ int main()
     odom2d_ptr->keyFrameCallback(new_keyframe_ptr, 0);
 
     std::cout << "New buffer: oldest part:   < ";
-    for (const auto &s : ((CaptureMotion*)(new_keyframe_ptr->getCaptureListPtr()->front()))->getBufferPtr()->get())
+    for (const auto &s : ((ProcessorOdom2D::CaptureType*)(new_keyframe_ptr->getCaptureListPtr()->front()))->getBufferPtr()->get())
         std::cout << s.ts_ - t0 << ' ';
     std::cout << ">" << std::endl;
 
@@ -268,7 +268,7 @@ int main()
 
 
     std::cout << "All in one row:            < ";
-    for (const auto &s : ((CaptureMotion*)(new_keyframe_ptr->getCaptureListPtr()->front()))->getBufferPtr()->get())
+    for (const auto &s : ((ProcessorOdom2D::CaptureType*)(new_keyframe_ptr->getCaptureListPtr()->front()))->getBufferPtr()->get())
         std::cout << s.ts_ - t0 << ' ';
     std::cout << "> " << t_split - t0 << " < ";
     for (const auto &s : odom2d_ptr->getBufferPtr()->get())
@@ -0,0 +1,132 @@
+/**
+ * \file test_motion_allocations.cpp
+ *
+ *  Created on: Jun 22, 2016
+ *      \author: jsola
+ */
+
+// Classes under test
+#include "processor_imu.h"
+#include "processor_odom_2D.h"
+#include "processor_odom_3D.h"
+
+// Wolf includes
+#include "wolf.h"
+#include "problem.h"
+#include "sensor_base.h"
+#include "capture_imu.h"
+#include "state_block.h"
+
+// STL includes
+#include <cstdlib>
+#include <new>
+
+// General includes
+#include <iostream>
+
+// Allocation counter: all heap allocations of this program go through here
+static unsigned long int n_allocations = 0;
+
+void* operator new(std::size_t _size)
+{
+    n_allocations++;
+    void* ptr = std::malloc(_size == 0 ? 1 : _size);
+    if (ptr == nullptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void operator delete(void* _ptr) noexcept
+{
+    std::free(_ptr);
+}
+
+using namespace wolf;
+
+/** Integrates _n_samples times the data in _capture_ptr, at 1kHz, and returns the number of heap allocations performed.
+ *
+ * The buffer of the processor is given enough room beforehand, as it happens after the first key-frame.
+ */
+template <class ProcessorType>
+unsigned long int countAllocations(ProcessorType* _processor_ptr, CaptureMotion* _capture_ptr, unsigned int _n_samples)
+{
+    TimeStamp t = _processor_ptr->getBufferPtr()->get().back().ts_;
+    _processor_ptr->getBufferPtr()->get().reserve(_n_samples + 1);
+
+    unsigned long int n_allocations_before = n_allocations;
+    for (unsigned int i = 0; i < _n_samples; i++)
+    {
+        t += 0.001;
+        _capture_ptr->setTimeStamp(t);
+        _processor_ptr->process(_capture_ptr);
+    }
+    return n_allocations - n_allocations_before;
+}
+
+int main()
+{
+    bool all_ok = true;
+    unsigned int N = 1000;
+
+    std::cout << std::endl << "==================== Motion allocations test ======================" << std::endl;
+
+    // IMU
+    Problem* problem_imu_ptr = new Problem(FRM_PVQBB_3D);
+    Eigen::VectorXs IMU_extrinsics(7);
+    IMU_extrinsics << 0,0,0, 0,0,0,1;
+    SensorBase* sensor_imu_ptr = problem_imu_ptr->installSensor("IMU", "Main IMU", IMU_extrinsics, nullptr);
+    problem_imu_ptr->installProcessor("IMU", "IMU pre-integrator", "Main IMU", "");
+    ProcessorIMU* processor_imu_ptr = (ProcessorIMU*)(problem_imu_ptr->getProcessorMotionPtr());
+    Eigen::VectorXs x0_imu(16);
+    x0_imu << 0,0,0,  0,0,0,  0,0,0,1,  0,0,.001,  0,0,.002;
+    processor_imu_ptr->setOrigin(x0_imu, TimeStamp(0));
+    Eigen::Vector6s data_imu;
+    data_imu << 0.1, 0, 9.8, 0, 0, 0.2;
+    CaptureIMU* capture_imu_ptr = new CaptureIMU(TimeStamp(0), sensor_imu_ptr, data_imu);
+
+    unsigned long int n = countAllocations(processor_imu_ptr, capture_imu_ptr, N);
+    std::cout << "IMU:     " << n << " allocations in " << N << " integrations " << (n == 0 ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && (n == 0);
+
+    // 2D odometry
+    Problem* problem_2D_ptr = new Problem(FRM_PO_2D);
+    SensorBase* sensor_odom_2D_ptr = new SensorBase(SEN_ODOM_2D, "ODOM 2D", new StateBlock(Eigen::Vector2s::Zero(), true),
+                                                    new StateBlock(Eigen::Vector1s::Zero(), true),
+                                                    new StateBlock(Eigen::VectorXs::Zero(0), true), 0);
+    ProcessorOdom2D* processor_odom_2D_ptr = new ProcessorOdom2D(1e9, 1e9, 1e9); // never vote for key-frames
+    sensor_odom_2D_ptr->addProcessor(processor_odom_2D_ptr);
+    problem_2D_ptr->addSensor(sensor_odom_2D_ptr);
+    processor_odom_2D_ptr->setOrigin(Eigen::Vector3s::Zero(), TimeStamp(0));
+    Eigen::VectorXs data_odom_2D(2);
+    data_odom_2D << 0.001, 0.001;
+    CaptureMotion* capture_odom_2D_ptr = new CaptureMotion(TimeStamp(0), sensor_odom_2D_ptr, data_odom_2D,
+                                                           Eigen::MatrixXs::Identity(2, 2) * 0.01, nullptr);
+
+    n = countAllocations(processor_odom_2D_ptr, capture_odom_2D_ptr, N);
+    std::cout << "Odom 2D: " << n << " allocations in " << N << " integrations " << (n == 0 ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && (n == 0);
+
+    // 3D odometry
+    Problem* problem_3D_ptr = new Problem(FRM_PO_3D);
+    SensorBase* sensor_odom_3D_ptr = new SensorBase(SEN_ODOM_3D, "ODOM 3D", new StateBlock(Eigen::Vector3s::Zero(), true),
+                                                    new StateBlock(Eigen::Vector4s(0, 0, 0, 1), true),
+                                                    new StateBlock(Eigen::VectorXs::Zero(0), true), 0);
+    ProcessorOdom3D* processor_odom_3D_ptr = new ProcessorOdom3D();
+    sensor_odom_3D_ptr->addProcessor(processor_odom_3D_ptr);
+    problem_3D_ptr->addSensor(sensor_odom_3D_ptr);
+    Eigen::VectorXs x0_3D(7);
+    x0_3D << 0,0,0,  0,0,0,1;
+    processor_odom_3D_ptr->setOrigin(x0_3D, TimeStamp(0));
+    Eigen::VectorXs data_odom_3D(6);
+    data_odom_3D << 0.001, 0, 0,  0, 0, 0.001;
+    CaptureMotion* capture_odom_3D_ptr = new CaptureMotion(TimeStamp(0), sensor_odom_3D_ptr, data_odom_3D,
+                                                           Eigen::MatrixXs::Identity(6, 6) * 0.01, nullptr);
+
+    n = countAllocations(processor_odom_3D_ptr, capture_odom_3D_ptr, N);
+    std::cout << "Odom 3D: " << n << " allocations in " << N << " integrations " << (n == 0 ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && (n == 0);
+
+    std::cout << (all_ok ? "All tests passed" : "Some tests FAILED") << std::endl;
+
+    return all_ok ? 0 : 1;
+}
@@ -0,0 +1,113 @@
+/**
+ * \file test_motion_batch.cpp
+ *
+ *  Created on: Jun 23, 2016
+ *      \author: jsola
+ */
+
+// Classes under test
+#include "processor_imu.h"
+
+// Wolf includes
+#include "wolf.h"
+#include "problem.h"
+#include "capture_imu.h"
+#include "state_block.h"
+
+// STL includes
+#include <ctime>
+#include <vector>
+
+// General includes
+#include <iostream>
+
+using namespace wolf;
+
+ProcessorIMU* newProcessorIMU(Problem* _problem_ptr, const TimeStamp& _t0)
+{
+    Eigen::VectorXs IMU_extrinsics(7);
+    IMU_extrinsics << 0,0,0, 0,0,0,1;
+    _problem_ptr->installSensor("IMU", "Main IMU", IMU_extrinsics, nullptr);
+    _problem_ptr->installProcessor("IMU", "IMU pre-integrator", "Main IMU", "");
+    ProcessorIMU* processor_ptr = (ProcessorIMU*)(_problem_ptr->getProcessorMotionPtr());
+    Eigen::VectorXs x0(16);
+    x0 << 0,0,0,  1,0,0,  0,0,0,1,  0,0,.001,  0,0,.002;
+    processor_ptr->setOrigin(x0, _t0);
+    return processor_ptr;
+}
+
+int main()
+{
+    bool all_ok = true;
+    unsigned int N = 16000;
+    unsigned int block_size = 20;
+    const Scalar dt = 0.001;
+    TimeStamp t0(0);
+
+    std::cout << std::endl << "==================== Motion batch processing test ======================" << std::endl;
+
+    // Synthetic IMU data: 16s at 1kHz
+    std::vector<TimeStamp> time_stamps(N);
+    Eigen::MatrixXs data(6, N);
+    for (unsigned int i = 0; i < N; i++)
+    {
+        time_stamps[i] = TimeStamp((i + 1) * dt);
+        data.col(i) << 0.1 * sin(i * dt), 0.2, 9.8, 0.01, -0.02, 0.3 * cos(i * dt);
+    }
+
+    // One Capture per sample
+    Problem* problem_ptr = new Problem(FRM_PVQBB_3D);
+    ProcessorIMU* processor_ptr = newProcessorIMU(problem_ptr, t0);
+    SensorBase* sensor_ptr = processor_ptr->getSensorPtr();
+    clock_t begin = clock();
+    for (unsigned int i = 0; i < N; i++)
+    {
+        CaptureIMU* imu_ptr = new CaptureIMU(time_stamps[i], sensor_ptr, data.col(i));
+        imu_ptr->process();
+        delete imu_ptr;
+    }
+    Scalar elapsed_captures = double(clock() - begin) / CLOCKS_PER_SEC;
+
+    // Blocks of samples
+    Problem* problem_batch_ptr = new Problem(FRM_PVQBB_3D);
+    ProcessorIMU* processor_batch_ptr = newProcessorIMU(problem_batch_ptr, t0);
+    Eigen::MatrixXs data_cov = Eigen::MatrixXs::Identity(6, 6);
+    std::vector<TimeStamp> block_time_stamps(block_size);
+    Eigen::MatrixXs block_data(6, block_size);
+    begin = clock();
+    for (unsigned int i = 0; i < N; i += block_size)
+    {
+        std::copy(time_stamps.begin() + i, time_stamps.begin() + i + block_size, block_time_stamps.begin());
+        block_data = data.middleCols(i, block_size);
+        processor_batch_ptr->processBatch(block_time_stamps, block_data, data_cov);
+    }
+    Scalar elapsed_batch = double(clock() - begin) / CLOCKS_PER_SEC;
+
+    // Both integrations must be the same
+    std::cout << "Same number of motions... ";
+    bool ok = (processor_ptr->getBufferPtr()->get().size() == processor_batch_ptr->getBufferPtr()->get().size());
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Same integrated delta... ";
+    ok = (processor_ptr->getMotion().delta_integr_ - processor_batch_ptr->getMotion().delta_integr_).isZero(1e-10);
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Same integrated covariance... ";
+    ok = (processor_ptr->getMotion().delta_integr_cov_ - processor_batch_ptr->getMotion().delta_integr_cov_).isZero(1e-10);
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Same state... ";
+    ok = (processor_ptr->getCurrentState() - processor_batch_ptr->getCurrentState()).isZero(1e-10);
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Time per sample with one capture per sample: " << elapsed_captures / N * 1e6 << " us" << std::endl;
+    std::cout << "Time per sample with blocks of " << block_size << " samples: " << elapsed_batch / N * 1e6 << " us" << std::endl;
+
+    std::cout << (all_ok ? "All tests passed" : "Some tests FAILED") << std::endl;
+
+    return all_ok ? 0 : 1;
+}
@@ -0,0 +1,100 @@
+/**
+ * \file test_motion_buffer.cpp
+ *
+ *  Created on: Jun 20, 2016
+ *      \author: jsola
+ */
+
+// Classes under test
+#include "../time_stamp.h"
+#include "../motion_buffer.h"
+
+// STL includes
+#include <ctime>
+
+// General includes
+#include <iostream>
+
+using namespace wolf;
+
+Motion newMotion(const TimeStamp& _ts, Scalar _value)
+{
+    return Motion({_ts,
+                   Eigen::VectorXs::Constant(3, _value),
+                   Eigen::VectorXs::Constant(3, _value),
+                   Eigen::MatrixXs::Zero(3, 3),
+                   Eigen::MatrixXs::Zero(3, 3),
+                   Eigen::MatrixXs::Zero(3, 3),
+                   Eigen::MatrixXs::Zero(3, 3)});
+}
+
+// Reference implementation of the query: reverse linear search
+const Motion& linearQuery(const MotionBuffer& _buffer, const TimeStamp& _ts)
+{
+    auto previous = std::find_if(_buffer.get().rbegin(), _buffer.get().rend(), [&](const Motion& m)
+    {
+        return m.ts_ <= _ts;
+    });
+    if (previous == _buffer.get().rend())
+        previous--;
+    return *previous;
+}
+
+int main()
+{
+    bool all_ok = true;
+    const Scalar dt = 0.001;
+
+    std::cout << std::endl << "==================== MotionBuffer test ======================" << std::endl;
+
+    // Fill a buffer with 10 seconds of 1kHz data
+    MotionBuffer buffer;
+    unsigned int N = 10000;
+    for (unsigned int i = 0; i < N; i++)
+        buffer.get().push_back(newMotion(TimeStamp(i * dt), i));
+
+    // Queries: before the buffer, exactly on samples, between samples and after the buffer
+    std::cout << "Queries... ";
+    for (Scalar t = -0.01; t < N * dt + 0.01; t += 0.0007)
+    {
+        if (&buffer.getMotion(TimeStamp(t)) != &linearQuery(buffer, TimeStamp(t)))
+        {
+            std::cout << std::endl << "  wrong motion at t = " << t;
+            all_ok = false;
+        }
+    }
+    if (&buffer.getMotion(TimeStamp(5 * dt)) != &buffer.get()[5])
+        all_ok = false;
+    std::cout << (all_ok ? "OK" : "FAILED") << std::endl;
+
+    // Split close to the end: the whole storage is handed over
+    std::cout << "Split at the end... ";
+    MotionBuffer old_part;
+    buffer.split(TimeStamp((N - 3) * dt + dt / 2), old_part);
+    bool split_ok = (old_part.get().size() == N - 2) && (buffer.get().size() == 2)
+            && (old_part.get().back().ts_.get() == (N - 3) * dt) && (buffer.get().front().ts_.get() == (N - 2) * dt);
+    std::cout << (split_ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && split_ok;
+
+    // Split close to the beginning: only the oldest part is moved
+    std::cout << "Split at the beginning... ";
+    MotionBuffer older_part;
+    old_part.split(TimeStamp(2 * dt), older_part);
+    split_ok = (older_part.get().size() == 3) && (old_part.get().size() == N - 5)
+            && (older_part.get().back().ts_.get() == 2 * dt) && (old_part.get().front().ts_.get() == 3 * dt);
+    std::cout << (split_ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && split_ok;
+
+    // Timing of queries
+    unsigned int n_queries = 100000;
+    Scalar sum = 0;
+    clock_t begin = clock();
+    for (unsigned int i = 0; i < n_queries; i++)
+        sum += old_part.getMotion(TimeStamp((i % N) * dt)).delta_(0);
+    Scalar elapsed = double(clock() - begin) / CLOCKS_PER_SEC;
+    std::cout << "Query time with " << old_part.get().size() << " motions: " << elapsed / n_queries * 1e6 << " us (" << sum << ")" << std::endl;
+
+    std::cout << (all_ok ? "All tests passed" : "Some tests FAILED") << std::endl;
+
+    return all_ok ? 0 : 1;
+}
@@ -0,0 +1,145 @@
+/**
+ * \file test_motion_capture_index.cpp
+ *
+ *  Created on: Jun 28, 2016
+ *      \author: jsola
+ */
+
+// Classes under test
+#include "processor_odom_2D.h"
+
+// Wolf includes
+#include "wolf.h"
+#include "problem.h"
+#include "sensor_base.h"
+#include "state_block.h"
+
+// STL includes
+#include <ctime>
+
+// General includes
+#include <iostream>
+
+using namespace wolf;
+
+typedef ProcessorOdom2D::CaptureType CaptureType;
+
+/** Reference lookup: visits all key-frames and returns the capture of _sensor_ptr with the newest first Motion older than _ts
+ */
+CaptureType* findCaptureBruteForce(Problem* _problem_ptr, SensorBase* _sensor_ptr, const TimeStamp& _ts)
+{
+    CaptureType* found_ptr = nullptr;
+    for (auto frame_ptr : *(_problem_ptr->getTrajectoryPtr()->getFrameListPtr()))
+    {
+        CaptureType* capture_ptr = (CaptureType*)(frame_ptr->hasCaptureOf(_sensor_ptr));
+        if (capture_ptr == nullptr || capture_ptr->getBufferPtr()->get().empty())
+            continue;
+        const TimeStamp& ts_front = capture_ptr->getBufferPtr()->get().front().ts_;
+        if (ts_front < _ts && (found_ptr == nullptr || found_ptr->getBufferPtr()->get().front().ts_ < ts_front))
+            found_ptr = capture_ptr;
+    }
+    return found_ptr;
+}
+
+int main()
+{
+    bool all_ok = true;
+    unsigned int N = 20000;
+    const Scalar dt = 0.01;
+
+    std::cout << std::endl << "==================== Motion capture index test ======================" << std::endl;
+
+    // 2D odometry with a key-frame every second
+    Problem* problem_ptr = new Problem(FRM_PO_2D);
+    SensorBase* sensor_ptr = new SensorBase(SEN_ODOM_2D, "ODOM 2D", new StateBlock(Eigen::Vector2s::Zero(), true),
+                                            new StateBlock(Eigen::Vector1s::Zero(), true),
+                                            new StateBlock(Eigen::VectorXs::Zero(0), true), 0);
+    ProcessorOdom2D* processor_ptr = new ProcessorOdom2D(1e9, 1e9, 1 - dt / 2);
+    sensor_ptr->addProcessor(processor_ptr);
+    problem_ptr->addSensor(sensor_ptr);
+    processor_ptr->setOrigin(Eigen::Vector3s::Zero(), TimeStamp(0));
+
+    Eigen::VectorXs data(2);
+    data << 0.01, 0.001;
+    CaptureMotion* capture_ptr = new CaptureMotion(TimeStamp(0), sensor_ptr, data, Eigen::MatrixXs::Identity(2, 2) * 0.01, nullptr);
+    for (unsigned int i = 1; i <= N; i++)
+    {
+        capture_ptr->setTimeStamp(TimeStamp(i * dt));
+        processor_ptr->process(capture_ptr);
+    }
+    std::cout << "Key-frames: " << problem_ptr->getTrajectoryPtr()->getFrameListPtr()->size() << std::endl;
+
+    // Lookups at past time stamps must match the ones from the full search
+    std::cout << "Same motions as the full search... ";
+    bool ok = true;
+    unsigned int n_lookups = 0;
+    clock_t begin = clock();
+    for (Scalar t = dt / 3; t < N * dt; t += 0.37)
+    {
+        CaptureType* capture_ref_ptr = findCaptureBruteForce(problem_ptr, sensor_ptr, TimeStamp(t));
+        Eigen::VectorXs delta_ref = capture_ref_ptr->getBufferPtr()->getMotion(TimeStamp(t)).delta_integr_;
+        ok = ok && (processor_ptr->getMotion(TimeStamp(t)).delta_integr_ - delta_ref).isZero(1e-12);
+        n_lookups++;
+    }
+    Scalar elapsed_brute_force = double(clock() - begin) / CLOCKS_PER_SEC;
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    // Key-frame in the past: the index must follow the split of the buffer
+    std::cout << "Key-frame callback in the past... ";
+    TimeStamp ts_kf(N * dt - 0.505);
+    FrameBase* key_frame_ptr = problem_ptr->createFrame(KEY_FRAME, processor_ptr->getState(ts_kf), ts_kf);
+    processor_ptr->keyFrameCallback(key_frame_ptr, 0.001);
+    ok = true;
+    for (Scalar t = N * dt - 2.0; t < N * dt; t += 0.013)
+    {
+        CaptureType* capture_ref_ptr = findCaptureBruteForce(problem_ptr, sensor_ptr, TimeStamp(t));
+        Eigen::VectorXs delta_ref = capture_ref_ptr->getBufferPtr()->getMotion(TimeStamp(t)).delta_integr_;
+        ok = ok && (processor_ptr->getMotion(TimeStamp(t)).delta_integr_ - delta_ref).isZero(1e-12);
+    }
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    // Timing of the indexed lookups alone
+    begin = clock();
+    Scalar sum = 0;
+    for (Scalar t = dt / 3; t < N * dt; t += 0.37)
+        sum += processor_ptr->getMotion(TimeStamp(t)).delta_integr_(0);
+    Scalar elapsed_index = double(clock() - begin) / CLOCKS_PER_SEC;
+    std::cout << "Time per lookup with the full search: " << elapsed_brute_force / n_lookups * 1e6 << " us" << std::endl;
+    std::cout << "Time per lookup with the index:       " << elapsed_index / n_lookups * 1e6 << " us (" << sum << ")" << std::endl;
+
+    // Key-frame removed: its motion, to and from it, cannot be found any longer
+    std::cout << "Key-frame removed... ";
+    FrameBase* removed_ptr = problem_ptr->getTrajectoryPtr()->closestKeyFrameToTimeStamp(TimeStamp(N * dt / 2));
+    TimeStamp ts_removed = removed_ptr->getTimeStamp();
+    FrameBase* previous_ptr = problem_ptr->getTrajectoryPtr()->closestKeyFrameToTimeStamp(TimeStamp(ts_removed.get() - 1));
+    FrameBase* next_ptr = problem_ptr->getTrajectoryPtr()->closestKeyFrameToTimeStamp(TimeStamp(ts_removed.get() + 1));
+    TimeStamp ts_previous = previous_ptr->getTimeStamp();
+    TimeStamp ts_next = next_ptr->getTimeStamp();
+    problem_ptr->removeKeyFrameCallback(removed_ptr);
+    removed_ptr->destruct();
+    ok = true;
+    for (Scalar t = dt / 3; t < N * dt; t += 0.37)
+    {
+        TimeStamp ts(t);
+        if (ts_previous < ts && ts <= ts_next)
+        {
+            // no stale capture, and the state of the closest key frame
+            FrameBase* closest_ptr = problem_ptr->getTrajectoryPtr()->closestKeyFrameToTimeStamp(ts);
+            ok = ok && processor_ptr->findCaptureContainingTimeStamp(ts) == nullptr;
+            ok = ok && (processor_ptr->getState(ts) - closest_ptr->getState()).isZero(1e-12);
+        }
+        else
+        {
+            CaptureType* capture_ref_ptr = findCaptureBruteForce(problem_ptr, sensor_ptr, ts);
+            ok = ok && processor_ptr->findCaptureContainingTimeStamp(ts) == capture_ref_ptr;
+        }
+    }
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << (all_ok ? "All tests passed" : "Some tests FAILED") << std::endl;
+
+    return all_ok ? 0 : 1;
+}
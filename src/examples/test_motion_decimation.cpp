@@ -0,0 +1,192 @@
+/**
+ * \file test_motion_decimation.cpp
+ *
+ *  Created on: Jun 30, 2016
+ *      \author: jsola
+ */
+
+// Classes under test
+#include "processor_odom_2D.h"
+#include "processor_imu.h"
+
+// Wolf includes
+#include "wolf.h"
+#include "problem.h"
+#include "sensor_base.h"
+#include "frame_imu.h"
+#include "state_block.h"
+
+// STL includes
+#include <vector>
+
+// General includes
+#include <iostream>
+
+using namespace wolf;
+
+ProcessorOdom2D* newProcessorOdom2D(Problem* _problem_ptr)
+{
+    SensorBase* sensor_ptr = new SensorBase(SEN_ODOM_2D, "ODOM 2D", new StateBlock(Eigen::Vector2s::Zero(), true),
+                                            new StateBlock(Eigen::Vector1s::Zero(), true),
+                                            new StateBlock(Eigen::VectorXs::Zero(0), true), 0);
+    ProcessorOdom2D* processor_ptr = new ProcessorOdom2D(1e9, 1e9, 1e9); // never vote for key-frames
+    sensor_ptr->addProcessor(processor_ptr);
+    _problem_ptr->addSensor(sensor_ptr);
+    processor_ptr->setOrigin(Eigen::Vector3s::Zero(), TimeStamp(0));
+    return processor_ptr;
+}
+
+ProcessorIMU* newProcessorIMU(Problem* _problem_ptr)
+{
+    Eigen::VectorXs IMU_extrinsics(7);
+    IMU_extrinsics << 0,0,0, 0,0,0,1;
+    _problem_ptr->installSensor("IMU", "Main IMU", IMU_extrinsics, nullptr);
+    _problem_ptr->installProcessor("IMU", "IMU pre-integrator", "Main IMU", "");
+    ProcessorIMU* processor_ptr = (ProcessorIMU*)(_problem_ptr->getProcessorMotionPtr());
+    Eigen::VectorXs x0(16);
+    x0 << 0,0,0,  1,0,0,  0,0,0,1,  0,0,.001,  0,0,.002;
+    processor_ptr->setOrigin(x0, TimeStamp(0));
+    return processor_ptr;
+}
+
+int main()
+{
+    bool all_ok = true;
+    bool ok;
+
+    std::cout << std::endl << "==================== Motion decimation test ======================" << std::endl;
+
+    // 2D odometry: 500 s stationary, then 500 s moving slowly, at 100 Hz, without key-frames
+    unsigned int N = 100000;
+    const Scalar dt = 0.01;
+    Problem* problem_ref_ptr = new Problem(FRM_PO_2D);
+    ProcessorOdom2D* processor_ref_ptr = newProcessorOdom2D(problem_ref_ptr);
+    Problem* problem_ptr = new Problem(FRM_PO_2D);
+    ProcessorOdom2D* processor_ptr = newProcessorOdom2D(problem_ptr);
+    processor_ptr->setMotionDecimation({DEC_ERROR, 500, 1e-4});
+
+    Eigen::VectorXs data(2);
+    Eigen::MatrixXs data_cov = Eigen::MatrixXs::Identity(2, 2) * 1e-4;
+    CaptureMotion* capture_ref_ptr = new CaptureMotion(TimeStamp(0), processor_ref_ptr->getSensorPtr(), data, data_cov, nullptr);
+    CaptureMotion* capture_ptr = new CaptureMotion(TimeStamp(0), processor_ptr->getSensorPtr(), data, data_cov, nullptr);
+    std::size_t max_size = 0;
+    for (unsigned int i = 1; i <= N; i++)
+    {
+        if (i <= N / 2)
+            data << 0, 0;
+        else
+            data << 0.001, 0.0002;
+        capture_ref_ptr->setData(data);
+        capture_ref_ptr->setTimeStamp(TimeStamp(i * dt));
+        processor_ref_ptr->process(capture_ref_ptr);
+        capture_ptr->setData(data);
+        capture_ptr->setTimeStamp(TimeStamp(i * dt));
+        processor_ptr->process(capture_ptr);
+        max_size = std::max(max_size, processor_ptr->getBufferPtr()->get().size());
+    }
+
+    std::cout << "Odom 2D, error-bounded: buffer of " << processor_ptr->getBufferPtr()->get().size() << " Motions instead of "
+            << processor_ref_ptr->getBufferPtr()->get().size() << "... ";
+    ok = (max_size <= 500);
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Same integrated delta and covariance... ";
+    ok = (processor_ptr->getMotion().delta_integr_ - processor_ref_ptr->getMotion().delta_integr_).isZero(1e-12)
+            && (processor_ptr->getMotion().delta_integr_cov_ - processor_ref_ptr->getMotion().delta_integr_cov_).isZero(1e-12);
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    Scalar max_error_stationary = 0, max_error_moving = 0;
+    for (Scalar t = dt / 2; t < N * dt; t += 0.173)
+    {
+        Scalar error = (processor_ptr->getMotion(TimeStamp(t)).delta_integr_
+                - processor_ref_ptr->getMotion(TimeStamp(t)).delta_integr_).norm();
+        if (t < N * dt / 2)
+            max_error_stationary = std::max(max_error_stationary, error);
+        else
+            max_error_moving = std::max(max_error_moving, error);
+    }
+    std::cout << "Query errors: stationary " << max_error_stationary << ", moving " << max_error_moving << "... ";
+    ok = (max_error_stationary == 0) && (max_error_moving < 0.5); // about 250 Motions left for a path of 50 m and 5 rad
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    // 2D odometry: the merged Motions must reintegrate to the same result after a key-frame in the past
+    problem_ref_ptr = new Problem(FRM_PO_2D);
+    processor_ref_ptr = newProcessorOdom2D(problem_ref_ptr);
+    problem_ptr = new Problem(FRM_PO_2D);
+    processor_ptr = newProcessorOdom2D(problem_ptr);
+    processor_ptr->setMotionDecimation({DEC_COUNT, 100, 0});
+    data << 0.01, 0.02;
+    capture_ref_ptr = new CaptureMotion(TimeStamp(0), processor_ref_ptr->getSensorPtr(), data, data_cov, nullptr);
+    capture_ptr = new CaptureMotion(TimeStamp(0), processor_ptr->getSensorPtr(), data, data_cov, nullptr);
+    for (unsigned int i = 1; i <= 1000; i++)
+    {
+        capture_ref_ptr->setTimeStamp(TimeStamp(i * dt));
+        processor_ref_ptr->process(capture_ref_ptr);
+        capture_ptr->setTimeStamp(TimeStamp(i * dt));
+        processor_ptr->process(capture_ptr);
+    }
+    TimeStamp ts_kf = processor_ptr->getBufferPtr()->get()[processor_ptr->getBufferPtr()->get().size() / 4].ts_;
+    processor_ref_ptr->keyFrameCallback(problem_ref_ptr->createFrame(KEY_FRAME, processor_ref_ptr->getState(ts_kf), ts_kf), 1e-4);
+    processor_ptr->keyFrameCallback(problem_ptr->createFrame(KEY_FRAME, processor_ptr->getState(ts_kf), ts_kf), 1e-4);
+    std::cout << "Odom 2D, count-based: buffer of " << processor_ptr->getBufferPtr()->get().size()
+            << " Motions after key-frame, same re-integrated delta and covariance... ";
+    ok = (processor_ptr->getMotion().delta_integr_ - processor_ref_ptr->getMotion().delta_integr_).isZero(1e-12)
+            && (processor_ptr->getMotion().delta_integr_cov_ - processor_ref_ptr->getMotion().delta_integr_cov_).isZero(1e-12);
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    // IMU: the merged Motions must reintegrate to the same delta
+    N = 20000;
+    const Scalar dt_imu = 0.001;
+    std::vector<TimeStamp> time_stamps(N);
+    Eigen::MatrixXs data_imu(6, N);
+    for (unsigned int i = 0; i < N; i++)
+    {
+        time_stamps[i] = TimeStamp((i + 1) * dt_imu);
+        data_imu.col(i) << 0.1 * sin(i * dt_imu), 0.2, 9.8, 0.01, -0.02, 0.3 * cos(i * dt_imu);
+    }
+    Eigen::MatrixXs data_cov_imu = Eigen::MatrixXs::Identity(6, 6) * 1e-4;
+
+    MotionDecimation decimations[2] = { {DEC_COUNT, 1000, 0}, {DEC_TIME, 1000, 0.01} };
+    std::string names[2] = {"count", "time"};
+    for (unsigned int d = 0; d < 2; d++)
+    {
+        Problem* problem_imu_ref_ptr = new Problem(FRM_PVQBB_3D);
+        ProcessorIMU* processor_imu_ref_ptr = newProcessorIMU(problem_imu_ref_ptr);
+        processor_imu_ref_ptr->processBatch(time_stamps, data_imu, data_cov_imu, 1);
+
+        Problem* problem_imu_ptr = new Problem(FRM_PVQBB_3D);
+        ProcessorIMU* processor_imu_ptr = newProcessorIMU(problem_imu_ptr);
+        processor_imu_ptr->setMotionDecimation(decimations[d]);
+        processor_imu_ptr->processBatch(time_stamps, data_imu, data_cov_imu, 1);
+
+        std::cout << "IMU, " << names[d] << "-based: buffer of " << processor_imu_ptr->getBufferPtr()->get().size()
+                << " Motions, same integrated delta and covariance... ";
+        ok = (processor_imu_ptr->getBufferPtr()->get().size() <= 1000)
+                && (processor_imu_ptr->getMotion().delta_integr_ - processor_imu_ref_ptr->getMotion().delta_integr_).isZero(1e-12)
+                && (processor_imu_ptr->getMotion().delta_integr_cov_ - processor_imu_ref_ptr->getMotion().delta_integr_cov_).isZero(1e-12);
+        std::cout << (ok ? "OK" : "FAILED") << std::endl;
+        all_ok = all_ok && ok;
+
+        // a negligible bias change makes both processors re-integrate their buffers from the first Motion
+        for (ProcessorIMU* prc_ptr : {processor_imu_ptr, processor_imu_ref_ptr})
+        {
+            FrameIMU* origin_ptr = (FrameIMU*)(prc_ptr->getProblem()->getLastKeyFramePtr());
+            origin_ptr->getBAPtr()->setVector(origin_ptr->getBAPtr()->getVector().array() + 1e-12);
+            prc_ptr->setBiasCorrectionThreshold(0);
+            prc_ptr->correctBias();
+        }
+        Scalar delta_error = (processor_imu_ptr->getMotion().delta_integr_ - processor_imu_ref_ptr->getMotion().delta_integr_).norm();
+        std::cout << "    re-integration of the merged Motions: delta error " << delta_error << "... ";
+        ok = (delta_error < 1e-9);
+        std::cout << (ok ? "OK" : "FAILED") << std::endl;
+        all_ok = all_ok && ok;
+    }
+
+    std::cout << (all_ok ? "All tests passed" : "Some tests FAILED") << std::endl;
+
+    return all_ok ? 0 : 1;
+}
@@ -0,0 +1,107 @@
+/**
+ * \file test_motion_lazy_covariance.cpp
+ *
+ *  Created on: Jun 27, 2016
+ *      \author: jsola
+ */
+
+// Classes under test
+#include "processor_imu.h"
+
+// Wolf includes
+#include "wolf.h"
+#include "problem.h"
+#include "state_block.h"
+
+// STL includes
+#include <ctime>
+#include <vector>
+
+// General includes
+#include <iostream>
+
+using namespace wolf;
+
+ProcessorIMU* newProcessorIMU(Problem* _problem_ptr, bool _lazy)
+{
+    Eigen::VectorXs IMU_extrinsics(7);
+    IMU_extrinsics << 0,0,0, 0,0,0,1;
+    _problem_ptr->installSensor("IMU", "Main IMU", IMU_extrinsics, nullptr);
+    _problem_ptr->installProcessor("IMU", "IMU pre-integrator", "Main IMU", "");
+    ProcessorIMU* processor_ptr = (ProcessorIMU*)(_problem_ptr->getProcessorMotionPtr());
+    processor_ptr->setLazyCovariance(_lazy);
+    Eigen::VectorXs x0(16);
+    x0 << 0,0,0,  1,0,0,  0,0,0,1,  0,0,.001,  0,0,.002;
+    processor_ptr->setOrigin(x0, TimeStamp(0));
+    return processor_ptr;
+}
+
+int main()
+{
+    bool all_ok = true;
+    unsigned int N = 16000;
+    const Scalar dt = 0.001;
+
+    std::cout << std::endl << "==================== Motion lazy covariance test ======================" << std::endl;
+
+    // Synthetic IMU data: 16s at 1kHz
+    std::vector<TimeStamp> time_stamps(N);
+    Eigen::MatrixXs data(6, N);
+    for (unsigned int i = 0; i < N; i++)
+    {
+        time_stamps[i] = TimeStamp((i + 1) * dt);
+        data.col(i) << 0.1 * sin(i * dt), 0.2, 9.8, 0.01, -0.02, 0.3 * cos(i * dt);
+    }
+    Eigen::MatrixXs data_cov = Eigen::MatrixXs::Identity(6, 6) * 1e-4;
+
+    // Eager propagation
+    Problem* problem_eager_ptr = new Problem(FRM_PVQBB_3D);
+    ProcessorIMU* processor_eager_ptr = newProcessorIMU(problem_eager_ptr, false);
+    clock_t begin = clock();
+    processor_eager_ptr->processBatch(time_stamps, data, data_cov);
+    Scalar elapsed_eager = double(clock() - begin) / CLOCKS_PER_SEC;
+
+    // Lazy propagation
+    Problem* problem_lazy_ptr = new Problem(FRM_PVQBB_3D);
+    ProcessorIMU* processor_lazy_ptr = newProcessorIMU(problem_lazy_ptr, true);
+    begin = clock();
+    processor_lazy_ptr->processBatch(time_stamps, data, data_cov);
+    Scalar elapsed_lazy = double(clock() - begin) / CLOCKS_PER_SEC;
+    begin = clock();
+    processor_lazy_ptr->integrateCovariance();
+    Scalar elapsed_materialize = double(clock() - begin) / CLOCKS_PER_SEC;
+
+    std::cout << "Same integrated delta... ";
+    bool ok = (processor_eager_ptr->getMotion().delta_integr_ - processor_lazy_ptr->getMotion().delta_integr_).isZero(1e-10);
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Same integrated covariance... ";
+    ok = (processor_eager_ptr->getMotion().delta_integr_cov_ - processor_lazy_ptr->getMotion().delta_integr_cov_).isZero(1e-10);
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Same covariance at intermediate time... ";
+    TimeStamp t_half = time_stamps[N / 2 - 1];
+    ok = (processor_eager_ptr->getMotion(t_half).delta_integr_cov_ - processor_lazy_ptr->getMotion(t_half).delta_integr_cov_).isZero(1e-10);
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    // Integration goes on after the covariance has been materialized
+    std::cout << "Same covariance after further integration... ";
+    for (unsigned int i = 0; i < N; i++)
+        time_stamps[i] += N * dt;
+    processor_eager_ptr->processBatch(time_stamps, data, data_cov);
+    processor_lazy_ptr->processBatch(time_stamps, data, data_cov);
+    ok = (processor_eager_ptr->getMotion().delta_integr_cov_ - processor_lazy_ptr->getMotion().delta_integr_cov_).isZero(1e-10);
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Time per sample with eager covariance: " << elapsed_eager / N * 1e6 << " us" << std::endl;
+    std::cout << "Time per sample with lazy covariance:  " << elapsed_lazy / N * 1e6 << " us" << std::endl;
+    std::cout << "Time to materialize " << N << " covariances: " << elapsed_materialize * 1e3 << " ms" << std::endl;
+
+    std::cout << (all_ok ? "All tests passed" : "Some tests FAILED") << std::endl;
+
+    return all_ok ? 0 : 1;
+}
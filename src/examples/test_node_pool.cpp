@@ -0,0 +1,186 @@
+/**
+ * \file test_node_pool.cpp
+ *
+ *  Created on: Jul 8, 2016
+ *      \author: jsola
+ */
+
+// Classes under test
+#include "node_pool.h"
+#include "frame_base.h"
+#include "capture_base.h"
+#include "feature_base.h"
+#include "constraint_base.h"
+
+// Wolf includes
+#include "wolf.h"
+#include "problem.h"
+#include "sensor_base.h"
+#include "processor_tracker_feature.h"
+#include "capture_void.h"
+#include "constraint_epipolar.h"
+#include "state_block.h"
+
+// STL includes
+#include <ctime>
+#include <new>
+
+// General includes
+#include <iostream>
+
+using namespace wolf;
+
+/** A feature tracker that keeps tracking the same features, and never votes for key frames
+ */
+class ProcessorTrackerFeatureSteady : public ProcessorTrackerFeature
+{
+    public:
+        ProcessorTrackerFeatureSteady() :
+                ProcessorTrackerFeature(PRC_TRACKER_DUMMY, "TRACKER FEATURE STEADY", 10)
+        {
+            //
+        }
+
+    protected:
+        virtual unsigned int trackFeatures(const FeatureBaseList& _feature_list_in, FeatureBaseList& _feature_list_out,
+                                           FeatureMatchMap& _feature_correspondences)
+        {
+            for (auto feature_in_ptr : _feature_list_in)
+            {
+                _feature_list_out.push_back(new FeatureBase(FEATURE_POINT_IMAGE, "POINT IMAGE", feature_in_ptr->getMeasurement(),
+                                                            feature_in_ptr->getMeasurementCovariance()));
+                _feature_correspondences[_feature_list_out.back()] = FeatureMatch({feature_in_ptr, 0});
+            }
+            return _feature_list_out.size();
+        }
+
+        virtual bool correctFeatureDrift(const FeatureBase* _origin_feature, const FeatureBase* _last_feature, FeatureBase* _incoming_feature)
+        {
+            return true;
+        }
+
+        virtual bool voteForKeyFrame()
+        {
+            return false;
+        }
+
+        virtual unsigned int detectNewFeatures(const unsigned int& _max_features)
+        {
+            for (unsigned int i = 0; i < _max_features; i++)
+                new_features_last_.push_back(new FeatureBase(FEATURE_POINT_IMAGE, "POINT IMAGE", Eigen::Vector1s::Constant(i),
+                                                             Eigen::MatrixXs::Ones(1, 1)));
+            return new_features_last_.size();
+        }
+
+        virtual ConstraintBase* createConstraint(FeatureBase* _feature_ptr, FeatureBase* _feature_other_ptr)
+        {
+            return new ConstraintEpipolar(_feature_ptr, _feature_other_ptr);
+        }
+};
+
+unsigned long int systemAllocations()
+{
+    return FrameBase::getPool().getSystemAllocationsCount() + CaptureBase::getPool().getSystemAllocationsCount()
+            + FeatureBase::getPool().getSystemAllocationsCount() + ConstraintBase::getPool().getSystemAllocationsCount();
+}
+
+unsigned long int allocations()
+{
+    return FrameBase::getPool().getAllocationsCount() + CaptureBase::getPool().getAllocationsCount()
+            + FeatureBase::getPool().getAllocationsCount() + ConstraintBase::getPool().getAllocationsCount();
+}
+
+int main()
+{
+    bool all_ok = true;
+    bool ok;
+
+    std::cout << std::endl << "==================== Node pool test ======================" << std::endl;
+
+    NodePool pool(4);
+    std::cout << "Blocks recycled by size class... ";
+    void* a = pool.allocate(40);
+    void* b = pool.allocate(100);
+    pool.deallocate(a, 40);
+    ok = (pool.allocate(33) == a) && (pool.getInUseCount() == 2) && (pool.getSystemAllocationsCount() == 2)
+            && (pool.getFreeCount() == 6);
+    void* c = pool.allocate(2000);
+    pool.deallocate(c, 2000);
+    ok = ok && (pool.getSystemAllocationsCount() == 3) && (pool.getAllocationsCount() == 4) && (pool.getInUseCount() == 2);
+    pool.deallocate(a, 33);
+    pool.deallocate(b, 100);
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    // A tracker in steady state: a new capture with its features for every incoming capture
+    Problem* problem_ptr = new Problem(FRM_PO_2D);
+    SensorBase* sensor_ptr = new SensorBase(SEN_ODOM_2D, "ODOM 2D", new StateBlock(Eigen::Vector2s::Zero(), true),
+                                            new StateBlock(Eigen::Vector1s::Zero(), true),
+                                            new StateBlock(Eigen::VectorXs::Zero(0), true), 0);
+    ProcessorTrackerFeatureSteady* processor_ptr = new ProcessorTrackerFeatureSteady();
+    problem_ptr->addSensor(sensor_ptr);
+    sensor_ptr->addProcessor(processor_ptr);
+
+    unsigned int n_warm_up = 100;
+    unsigned int N = 10000;
+    for (unsigned int i = 0; i < n_warm_up; i++)
+        processor_ptr->process(new CaptureVoid(TimeStamp(i * 0.01), sensor_ptr));
+    unsigned long int system_allocations_before = systemAllocations();
+    unsigned long int allocations_before = allocations();
+    for (unsigned int i = n_warm_up; i < n_warm_up + N; i++)
+        processor_ptr->process(new CaptureVoid(TimeStamp(i * 0.01), sensor_ptr));
+
+    std::cout << "Nodes created at each capture... ";
+    ok = allocations() - allocations_before >= N * 11; // one capture and 10 features
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "No system allocation of nodes in steady state... ";
+    ok = systemAllocations() == system_allocations_before;
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Node allocations over " << N << " captures:" << std::endl;
+    std::cout << "    frames:      " << FrameBase::getPool().getAllocationsCount() << " allocated, "
+            << FrameBase::getPool().getSystemAllocationsCount() << " from the system, " << FrameBase::getPool().getInUseCount() << " alive" << std::endl;
+    std::cout << "    captures:    " << CaptureBase::getPool().getAllocationsCount() << " allocated, "
+            << CaptureBase::getPool().getSystemAllocationsCount() << " from the system, " << CaptureBase::getPool().getInUseCount() << " alive" << std::endl;
+    std::cout << "    features:    " << FeatureBase::getPool().getAllocationsCount() << " allocated, "
+            << FeatureBase::getPool().getSystemAllocationsCount() << " from the system, " << FeatureBase::getPool().getInUseCount() << " alive" << std::endl;
+    std::cout << "    constraints: " << ConstraintBase::getPool().getAllocationsCount() << " allocated, "
+            << ConstraintBase::getPool().getSystemAllocationsCount() << " from the system, " << ConstraintBase::getPool().getInUseCount() << " alive" << std::endl;
+
+    problem_ptr->destruct();
+
+    std::cout << "All nodes returned to the pools... ";
+    ok = (FrameBase::getPool().getInUseCount() == 0) && (CaptureBase::getPool().getInUseCount() == 0)
+            && (FeatureBase::getPool().getInUseCount() == 0) && (ConstraintBase::getPool().getInUseCount() == 0);
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    // Timing of a feature's creation and destruction
+    Eigen::Vector1s measurement = Eigen::Vector1s::Ones();
+    Eigen::MatrixXs covariance = Eigen::MatrixXs::Ones(1, 1);
+    unsigned int n_features = 200000;
+    clock_t begin = clock();
+    for (unsigned int i = 0; i < n_features; i++)
+    {
+        // the global allocator
+        void* memory = ::operator new(sizeof(FeatureBase));
+        FeatureBase* feature_ptr = ::new (memory) FeatureBase(FEATURE_POINT_IMAGE, "POINT IMAGE", measurement, covariance);
+        feature_ptr->~FeatureBase();
+        ::operator delete(memory);
+    }
+    Scalar time_global = double(clock() - begin) / CLOCKS_PER_SEC / n_features * 1e9;
+    begin = clock();
+    for (unsigned int i = 0; i < n_features; i++)
+        delete new FeatureBase(FEATURE_POINT_IMAGE, "POINT IMAGE", measurement, covariance);
+    Scalar time_pool = double(clock() - begin) / CLOCKS_PER_SEC / n_features * 1e9;
+    std::cout << "Time to create and delete a feature:" << std::endl;
+    std::cout << "    global allocator: " << time_global << " ns" << std::endl;
+    std::cout << "    node pool:        " << time_pool << " ns" << std::endl;
+
+    std::cout << (all_ok ? "All tests passed" : "Some tests FAILED") << std::endl;
+
+    return all_ok ? 0 : 1;
+}
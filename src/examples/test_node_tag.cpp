@@ -0,0 +1,126 @@
+/**
+ * \file test_node_tag.cpp
+ *
+ *  Created on: Jul 10, 2016
+ *      \author: jsola
+ */
+
+// Classes under test
+#include "node_tag.h"
+#include "node_base.h"
+
+// Wolf includes
+#include "wolf.h"
+#include "feature_base.h"
+#include "constraint_base.h"
+
+// STL includes
+#include <ctime>
+#include <string>
+#include <thread>
+#include <vector>
+
+// General includes
+#include <iostream>
+
+using namespace wolf;
+
+int main()
+{
+    bool all_ok = true;
+    bool ok;
+
+    std::cout << std::endl << "==================== Node tag test ======================" << std::endl;
+
+    std::cout << "Same text, same tag... ";
+    NodeTag tag_1("POINT IMAGE");
+    NodeTag tag_2(std::string("POINT ") + "IMAGE");
+    NodeTag tag_3("CORNER 2D");
+    ok = tag_1 == tag_2 && tag_1 != tag_3 && tag_1.str() == "POINT IMAGE" && tag_3.str() == "CORNER 2D";
+    ok = ok && NodeTag().id() == 0 && NodeTag("") == NodeTag() && NodeTag().str().empty();
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Texts of the nodes kept... ";
+    FeatureBase* feature_ptr = new FeatureBase(FEATURE_POINT_IMAGE, "POINT IMAGE", Eigen::Vector1s::Ones(), Eigen::MatrixXs::Ones(1, 1));
+    feature_ptr->setName("my feature");
+    ok = feature_ptr->getClass() == "FEATURE" && feature_ptr->getType() == "POINT IMAGE" && feature_ptr->getName() == "my feature";
+    ok = ok && feature_ptr->getTypeTag() == tag_1 && feature_ptr->getClassTag() == NodeTag("FEATURE")
+            && feature_ptr->getNameTag() == NodeTag("my feature");
+    feature_ptr->setType("CORNER 2D");
+    ok = ok && feature_ptr->getTypeTag() == tag_3 && feature_ptr->getType() == "CORNER 2D";
+    delete feature_ptr;
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Concurrent interning... ";
+    unsigned int n_threads = 4;
+    unsigned int n_texts = 200;
+    unsigned int table_size = NodeTag::getTableSize();
+    std::vector<std::vector<unsigned int> > ids(n_threads, std::vector<unsigned int>(n_texts));
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < n_threads; t++)
+        threads.push_back(std::thread([&ids, t, n_texts]()
+        {
+            for (unsigned int i = 0; i < n_texts; i++)
+                ids[t][i] = NodeTag("TYPE " + std::to_string((i + 37 * t) % n_texts)).id();
+        }));
+    for (auto& thread : threads)
+        thread.join();
+    ok = NodeTag::getTableSize() == table_size + n_texts;
+    for (unsigned int t = 0; t < n_threads; t++)
+        for (unsigned int i = 0; i < n_texts; i++)
+            ok = ok && ids[t][i] == ids[0][(i + 37 * t) % n_texts]
+                    && NodeTag("TYPE " + std::to_string((i + 37 * t) % n_texts)).id() == ids[t][i];
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    // Footprint
+    unsigned int saved = 3 * (sizeof(std::string) - sizeof(NodeTag));
+    std::cout << "Node footprint, with tags (and with std::string labels):" << std::endl;
+    std::cout << "    NodeBase:       " << sizeof(NodeBase) << " bytes (" << sizeof(NodeBase) + saved << ")" << std::endl;
+    std::cout << "    FeatureBase:    " << sizeof(FeatureBase) << " bytes (" << sizeof(FeatureBase) + saved << ")" << std::endl;
+    std::cout << "    ConstraintBase: " << sizeof(ConstraintBase) << " bytes (" << sizeof(ConstraintBase) + saved << ")" << std::endl;
+
+    // Type dispatch over many features of a few types
+    std::vector<std::string> types({"POINT IMAGE", "CORNER 2D", "POLYLINE 2D", "GPS PSEUDORANGE"});
+    std::vector<FeatureBase*> features;
+    unsigned int n_features = 100000;
+    for (unsigned int i = 0; i < n_features; i++)
+        features.push_back(new FeatureBase(FEATURE_POINT_IMAGE, types[(i * i) % types.size()], Eigen::Vector1s::Ones(),
+                                           Eigen::MatrixXs::Ones(1, 1)));
+
+    unsigned int n_repetitions = 10;
+    unsigned int n_text = 0, n_tag = 0;
+    clock_t begin = clock();
+    for (unsigned int n = 0; n < n_repetitions; n++)
+        for (auto ft_ptr : features)
+            if (ft_ptr->getType() == "CORNER 2D")
+                n_text++;
+    Scalar time_text = double(clock() - begin) / CLOCKS_PER_SEC / n_repetitions / n_features;
+    begin = clock();
+    for (unsigned int n = 0; n < n_repetitions; n++)
+    {
+        const NodeTag corner_tag("CORNER 2D");
+        for (auto ft_ptr : features)
+            if (ft_ptr->getTypeTag() == corner_tag)
+                n_tag++;
+    }
+    Scalar time_tag = double(clock() - begin) / CLOCKS_PER_SEC / n_repetitions / n_features;
+
+    std::cout << "Same features found by text and by tag... ";
+    ok = n_text == n_tag && n_tag > 0;
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Type check of a feature:" << std::endl;
+    std::cout << "    getType() == text:   " << time_text * 1e9 << " ns" << std::endl;
+    std::cout << "    getTypeTag() == tag: " << time_tag * 1e9 << " ns" << std::endl;
+
+    for (auto ft_ptr : features)
+        delete ft_ptr;
+
+    std::cout << (all_ok ? "All tests passed" : "Some tests FAILED") << std::endl;
+
+    return all_ok ? 0 : 1;
+}
@@ -0,0 +1,220 @@
+/**
+ * \file test_node_traversal.cpp
+ *
+ *  Created on: Jul 9, 2016
+ *      \author: jsola
+ */
+
+// Classes under test
+#include "node_list.h"
+#include "node_linked.h"
+
+// Wolf includes
+#include "wolf.h"
+#include "problem.h"
+#include "sensor_base.h"
+#include "trajectory_base.h"
+#include "frame_base.h"
+#include "capture_void.h"
+#include "feature_base.h"
+#include "constraint_epipolar.h"
+#include "state_block.h"
+
+// STL includes
+#include <ctime>
+#include <list>
+#include <vector>
+
+// General includes
+#include <iostream>
+
+using namespace wolf;
+
+/** An element of a NodeList, for the tests of the list alone
+ */
+struct Item : public NodeListHook
+{
+        Item(int _value) : value_(_value) { }
+        int value_;
+};
+
+bool contains(const NodeList<Item>& _list, const std::vector<int>& _values)
+{
+    if (_list.size() != _values.size())
+        return false;
+    unsigned int i = 0;
+    for (auto item_ptr : _list)
+        if (item_ptr->value_ != _values[i++])
+            return false;
+    return true;
+}
+
+int main()
+{
+    bool all_ok = true;
+    bool ok;
+
+    std::cout << std::endl << "==================== Node traversal test ======================" << std::endl;
+
+    // The intrusive list alone
+    std::vector<Item> items({0, 1, 2, 3, 4});
+    NodeList<Item> list, other;
+
+    std::cout << "Insertion and traversal... ";
+    list.push_back(&items[1]);
+    list.push_back(&items[3]);
+    list.push_front(&items[0]);
+    auto it = list.begin();
+    it++;
+    it++;
+    list.insert(it, &items[2]);
+    ok = contains(list, {0, 1, 2, 3}) && list.front() == &items[0] && list.back() == &items[3] && items[2].isLinked()
+            && !items[4].isLinked();
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Removal... ";
+    list.remove(&items[2]);
+    list.remove(&items[4]); // not in the list: does nothing
+    it = list.erase(list.begin());
+    ok = contains(list, {1, 3}) && *it == &items[1] && !items[0].isLinked() && !items[2].isLinked();
+    list.pop_back();
+    list.pop_front();
+    ok = ok && list.empty() && list.begin() == list.end();
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Splice and clear... ";
+    list.push_back(&items[0]);
+    list.push_back(&items[3]);
+    other.push_back(&items[1]);
+    other.push_back(&items[2]);
+    list.splice(++list.begin(), other);
+    ok = contains(list, {0, 1, 2, 3}) && other.empty() && *(--list.end()) == &items[3];
+    list.clear();
+    ok = ok && list.empty() && !items[0].isLinked() && !items[3].isLinked();
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    // A tree of 100k constraints: 1000 frames of one capture with 10 features, each with 10 constraints
+    unsigned int n_frames = 1000;
+    unsigned int n_features = 10;
+    unsigned int n_constraints = 10;
+    Problem* problem_ptr = new Problem(FRM_PO_2D);
+    SensorBase* sensor_ptr = new SensorBase(SEN_ODOM_2D, "ODOM 2D", new StateBlock(Eigen::Vector2s::Zero(), true),
+                                            new StateBlock(Eigen::Vector1s::Zero(), true),
+                                            new StateBlock(Eigen::VectorXs::Zero(0), true), 0);
+    problem_ptr->addSensor(sensor_ptr);
+    std::vector<FeatureBase*> features;
+    std::vector<std::list<ConstraintBase*>> constraint_lists; // the former container of the constraints, for comparison
+    constraint_lists.reserve(n_frames * n_features);
+    for (unsigned int i = 0; i < n_frames; i++)
+    {
+        FrameBase* frame_ptr = problem_ptr->getTrajectoryPtr()->addFrame(new FrameBase(TimeStamp(i * 0.1),
+                                                                                       new StateBlock(Eigen::Vector2s::Zero()),
+                                                                                       new StateBlock(Eigen::Vector1s::Zero())));
+        CaptureBase* capture_ptr = frame_ptr->addCapture(new CaptureVoid(TimeStamp(i * 0.1), sensor_ptr));
+        for (unsigned int j = 0; j < n_features; j++)
+        {
+            FeatureBase* feature_ptr = capture_ptr->addFeature(new FeatureBase(FEATURE_POINT_IMAGE, "POINT IMAGE",
+                                                                               Eigen::Vector1s::Constant(j),
+                                                                               Eigen::MatrixXs::Ones(1, 1)));
+            constraint_lists.push_back(std::list<ConstraintBase*>());
+            for (unsigned int k = 0; k < n_constraints && !features.empty(); k++)
+            {
+                FeatureBase* feature_other_ptr = features[(features.size() * 7 + k * 131) % features.size()];
+                constraint_lists.back().push_back(feature_ptr->addConstraint(new ConstraintEpipolar(feature_ptr, feature_other_ptr)));
+            }
+            features.push_back(feature_ptr);
+        }
+    }
+
+    ConstraintBaseList constraint_list;
+    problem_ptr->getTrajectoryPtr()->getConstraintList(constraint_list);
+    unsigned int n_total = constraint_list.size();
+    std::cout << "Tree of " << n_total << " constraints built... ";
+    ok = n_total == n_frames * n_features * n_constraints - n_constraints;
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    // Full traversals of the tree, down to the constraints
+    unsigned int n_traversals = 20;
+    unsigned long int sum_tree = 0, sum_std_list = 0;
+    clock_t begin = clock();
+    for (unsigned int n = 0; n < n_traversals; n++)
+        for (auto frame_ptr : *(problem_ptr->getTrajectoryPtr()->getFrameListPtr()))
+            for (auto capture_ptr : *(frame_ptr->getCaptureListPtr()))
+                for (auto feature_ptr : *(capture_ptr->getFeatureListPtr()))
+                    for (auto constraint_ptr : *(feature_ptr->getConstraintListPtr()))
+                        sum_tree += constraint_ptr->nodeId();
+    Scalar time_tree = double(clock() - begin) / CLOCKS_PER_SEC / n_traversals;
+    begin = clock();
+    for (unsigned int n = 0; n < n_traversals; n++)
+        for (auto& list : constraint_lists)
+            for (auto constraint_ptr : list)
+                sum_std_list += constraint_ptr->nodeId();
+    Scalar time_std_list = double(clock() - begin) / CLOCKS_PER_SEC / n_traversals;
+    begin = clock();
+    for (unsigned int n = 0; n < n_traversals; n++)
+    {
+        constraint_list.clear();
+        problem_ptr->getTrajectoryPtr()->getConstraintList(constraint_list);
+    }
+    Scalar time_get_list = double(clock() - begin) / CLOCKS_PER_SEC / n_traversals;
+
+    std::cout << "Same constraints in the tree as in the std::lists... ";
+    ok = sum_tree == sum_std_list && constraint_list.size() == n_total;
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Removal of a constraint unlinks it from its feature... ";
+    FeatureBase* feature_ptr = features.back();
+    ConstraintBase* constraint_ptr = *(++feature_ptr->getConstraintListPtr()->begin());
+    constraint_ptr->destruct();
+    ok = feature_ptr->getConstraintListPtr()->size() == n_constraints - 1;
+    for (auto ctr_ptr : *(feature_ptr->getConstraintListPtr()))
+        ok = ok && ctr_ptr != constraint_ptr;
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Full traversal of " << n_total << " constraints:" << std::endl;
+    std::cout << "    frames, captures, features, constraints: " << time_tree * 1e3 << " ms" << std::endl;
+    std::cout << "    constraints in std::lists only:          " << time_std_list * 1e3 << " ms" << std::endl;
+    std::cout << "    TrajectoryBase::getConstraintList():     " << time_get_list * 1e3 << " ms" << std::endl;
+
+    problem_ptr->destruct();
+
+    // Removal of nodes from the middle of their list
+    unsigned int n_items = 2000;
+    std::vector<Item> many_items;
+    for (unsigned int i = 0; i < n_items; i++)
+        many_items.push_back(Item(i));
+    NodeList<Item> node_list;
+    std::list<Item*> std_list;
+    for (auto& item : many_items)
+    {
+        node_list.push_back(&item);
+        std_list.push_back(&item);
+    }
+    begin = clock();
+    for (unsigned int i = 0; i < n_items; i++)
+        node_list.remove(&many_items[(i * 7) % n_items]);
+    Scalar time_remove_node_list = double(clock() - begin) / CLOCKS_PER_SEC / n_items;
+    begin = clock();
+    for (unsigned int i = 0; i < n_items; i++)
+        std_list.remove(&many_items[(i * 7) % n_items]);
+    Scalar time_remove_std_list = double(clock() - begin) / CLOCKS_PER_SEC / n_items;
+
+    std::cout << "All nodes removed... ";
+    ok = node_list.empty() && std_list.empty();
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Removal of a node from a list of " << n_items << ":" << std::endl;
+    std::cout << "    NodeList:  " << time_remove_node_list * 1e9 << " ns" << std::endl;
+    std::cout << "    std::list: " << time_remove_std_list * 1e9 << " ns" << std::endl;
+
+    std::cout << (all_ok ? "All tests passed" : "Some tests FAILED") << std::endl;
+
+    return all_ok ? 0 : 1;
+}
@@ -0,0 +1,164 @@
+/**
+ * \file test_problem_notifications.cpp
+ *
+ *  Created on: Jul 3, 2016
+ *      \author: jsola
+ */
+
+// Classes under test
+#include "problem.h"
+
+// Wolf includes
+#include "wolf.h"
+#include "sensor_base.h"
+#include "trajectory_base.h"
+#include "frame_base.h"
+#include "capture_void.h"
+#include "feature_base.h"
+#include "constraint_odom_2D.h"
+#include "state_block.h"
+
+// STL includes
+#include <ctime>
+#include <vector>
+
+// General includes
+#include <iostream>
+
+using namespace wolf;
+
+/** Appends a chain of _N key-frames linked by odometry constraints
+ */
+std::vector<FrameBase*> makeChain(Problem* _problem_ptr, SensorBase* _sensor_ptr, unsigned int _N)
+{
+    std::vector<FrameBase*> frames;
+    for (unsigned int i = 0; i < _N; i++)
+    {
+        FrameBase* frame_ptr = new FrameBase(KEY_FRAME, TimeStamp(i), new StateBlock(Eigen::Vector2s::Zero()),
+                                             new StateBlock(Eigen::Vector1s::Zero()));
+        _problem_ptr->getTrajectoryPtr()->addFrame(frame_ptr);
+        if (!frames.empty())
+        {
+            CaptureVoid* capture_ptr = new CaptureVoid(TimeStamp(i), _sensor_ptr);
+            FeatureBase* feature_ptr = new FeatureBase(FEATURE_FIX, "FIX", Eigen::Vector3s::Zero(), Eigen::Matrix3s::Identity());
+            frame_ptr->addCapture(capture_ptr);
+            capture_ptr->addFeature(feature_ptr);
+            feature_ptr->addConstraint(new ConstraintOdom2D(feature_ptr, frames.back()));
+        }
+        frames.push_back(frame_ptr);
+    }
+    return frames;
+}
+
+unsigned int count(const std::list<StateBlockNotification>& _list, Notification _notification)
+{
+    unsigned int n = 0;
+    for (auto notification : _list)
+        n += (notification.notification_ == _notification);
+    return n;
+}
+
+int main()
+{
+    bool all_ok = true;
+    bool ok;
+
+    std::cout << std::endl << "==================== Problem notifications test ======================" << std::endl;
+
+    Problem* problem_ptr = new Problem(FRM_PO_2D);
+    SensorBase* sensor_ptr = new SensorBase(SEN_ODOM_2D, "ODOM 2D", new StateBlock(Eigen::Vector2s::Zero(), true),
+                                            new StateBlock(Eigen::Vector1s::Zero(), true),
+                                            new StateBlock(Eigen::VectorXs::Zero(0), true), 0);
+    problem_ptr->addSensor(sensor_ptr);
+    std::list<StateBlockNotification> state_notifications;
+    std::list<ConstraintNotification> ctr_notifications;
+    problem_ptr->consumeStateBlockNotificationList(state_notifications);
+    state_notifications.clear();
+    std::size_t n_sensor_states = problem_ptr->getStateListPtr()->size();
+
+    std::cout << "Updates coalesced into the pending additions... ";
+    FrameBase* frame_ptr = problem_ptr->createFrame(KEY_FRAME, Eigen::Vector3s::Zero(), TimeStamp(0));
+    frame_ptr->fix();
+    frame_ptr->unfix();
+    ok = (problem_ptr->getStateBlockNotificationList().size() == 2)
+            && (count(problem_ptr->getStateBlockNotificationList(), ADD) == 2);
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Consumed in order... ";
+    problem_ptr->consumeStateBlockNotificationList(state_notifications);
+    ok = problem_ptr->getStateBlockNotificationList().empty() && (state_notifications.size() == 2)
+            && (state_notifications.front().state_block_ptr_ == frame_ptr->getPPtr())
+            && (state_notifications.back().state_block_ptr_ == frame_ptr->getOPtr());
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "One update per state block... ";
+    frame_ptr->fix();
+    frame_ptr->unfix();
+    frame_ptr->fix();
+    ok = (problem_ptr->getStateBlockNotificationList().size() == 2)
+            && (count(problem_ptr->getStateBlockNotificationList(), UPDATE) == 2);
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Removals replace the pending updates... ";
+    frame_ptr->destruct();
+    ok = (problem_ptr->getStateBlockNotificationList().size() == 2)
+            && (count(problem_ptr->getStateBlockNotificationList(), REMOVE) == 2)
+            && (problem_ptr->getStateListPtr()->size() == n_sensor_states);
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+    state_notifications.clear();
+    problem_ptr->consumeStateBlockNotificationList(state_notifications);
+
+    // Pruning between two solves: frames and constraints created and removed before the solver sees them
+    unsigned int N = 2000;
+    std::vector<FrameBase*> frames = makeChain(problem_ptr, sensor_ptr, N);
+    for (unsigned int i = 0; i < N - 1; i++)
+        frames[i]->destruct();
+    std::cout << "Pruning " << N - 1 << " of " << N << " frames before solving, only the last one notified... ";
+    state_notifications.clear();
+    problem_ptr->consumeStateBlockNotificationList(state_notifications);
+    problem_ptr->consumeConstraintNotificationList(ctr_notifications);
+    ok = (state_notifications.size() == 2) && (count(state_notifications, ADD) == 2) && ctr_notifications.empty()
+            && (problem_ptr->getStateListPtr()->size() == n_sensor_states + 2);
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Removal of the frame known by the solver notified... ";
+    frames.back()->destruct();
+    state_notifications.clear();
+    problem_ptr->consumeStateBlockNotificationList(state_notifications);
+    ok = (state_notifications.size() == 2) && (count(state_notifications, REMOVE) == 2);
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    // Timing of the bookkeeping alone: the cost per state block must not grow with the number of state blocks
+    unsigned int sizes[2] = {10000, 40000};
+    Scalar time_per_block[2];
+    for (unsigned int s = 0; s < 2; s++)
+    {
+        std::vector<StateBlock*> state_blocks(sizes[s]);
+        for (auto& state_block_ptr : state_blocks)
+            state_block_ptr = new StateBlock(Eigen::Vector2s::Zero());
+        clock_t begin = clock();
+        for (auto state_block_ptr : state_blocks)
+        {
+            problem_ptr->addStateBlockPtr(state_block_ptr);
+            problem_ptr->updateStateBlockPtr(state_block_ptr);
+        }
+        for (auto state_block_ptr : state_blocks)
+            problem_ptr->removeStateBlockPtr(state_block_ptr);
+        time_per_block[s] = double(clock() - begin) / CLOCKS_PER_SEC / sizes[s] * 1e9;
+        for (auto state_block_ptr : state_blocks)
+            delete state_block_ptr;
+        all_ok = all_ok && problem_ptr->getStateBlockNotificationList().empty();
+    }
+    std::cout << "Time to add, update and remove a state block: " << time_per_block[0] << " ns among " << sizes[0] << ", "
+            << time_per_block[1] << " ns among " << sizes[1] << std::endl;
+
+    std::cout << (all_ok ? "All tests passed" : "Some tests FAILED") << std::endl;
+
+    return all_ok ? 0 : 1;
+}
@@ -0,0 +1,182 @@
+/**
+ * \file test_problem_statistics.cpp
+ *
+ *  Created on: Jul 16, 2016
+ *      \author: jsola
+ */
+
+// Classes under test
+#include "problem_statistics.h"
+#include "problem.h"
+
+// Wolf includes
+#include "wolf.h"
+#include "processor_odom_2D.h"
+#include "sensor_base.h"
+#include "trajectory_base.h"
+#include "map_base.h"
+#include "frame_base.h"
+#include "capture_void.h"
+#include "feature_base.h"
+#include "landmark_corner_2D.h"
+#include "constraint_marginalization.h"
+#include "state_block.h"
+
+// STL includes
+#include <ctime>
+#include <list>
+
+// General includes
+#include <iostream>
+
+using namespace wolf;
+
+ProcessorOdom2D* newProcessorOdom2D(Problem* _problem_ptr)
+{
+    SensorBase* sensor_ptr = new SensorBase(SEN_ODOM_2D, "ODOM 2D", new StateBlock(Eigen::Vector2s::Zero(), true),
+                                            new StateBlock(Eigen::Vector1s::Zero(), true),
+                                            new StateBlock(Eigen::VectorXs::Zero(0), true), 0);
+    ProcessorOdom2D* processor_ptr = new ProcessorOdom2D(1e9, 1e9, 1.0); // a key-frame each second
+    processor_ptr->setName("Main odometry");
+    sensor_ptr->addProcessor(processor_ptr);
+    _problem_ptr->addSensor(sensor_ptr);
+    processor_ptr->setOrigin(Eigen::Vector3s::Zero(), TimeStamp(0));
+    return processor_ptr;
+}
+
+/** Key frames with a capture each, two features each, and a constraint on the previous key frame on each feature
+ */
+void addKeyFrames(Problem* _problem_ptr, unsigned int _n, Scalar _ts)
+{
+    FrameBase* previous_ptr = _problem_ptr->getLastKeyFramePtr();
+    for (unsigned int i = 0; i < _n; i++)
+    {
+        FrameBase* frame_ptr = _problem_ptr->getTrajectoryPtr()->addFrame(new FrameBase(KEY_FRAME, TimeStamp(_ts + i),
+                                                                                        new StateBlock(Eigen::Vector2s::Zero()),
+                                                                                        new StateBlock(Eigen::Vector1s::Zero())));
+        CaptureBase* capture_ptr = frame_ptr->addCapture(new CaptureVoid(frame_ptr->getTimeStamp(), nullptr));
+        for (unsigned int j = 0; j < 2; j++)
+        {
+            FeatureBase* feature_ptr = capture_ptr->addFeature(new FeatureBase(FEATURE_MARGINALIZATION, "LINEAR", 3));
+            feature_ptr->addConstraint(new ConstraintMarginalization({previous_ptr->getPPtr(), previous_ptr->getOPtr(),
+                                                                      frame_ptr->getPPtr(), frame_ptr->getOPtr()},
+                                                                     Eigen::MatrixXs::Identity(3, 6), Eigen::VectorXs::Zero(3),
+                                                                     {previous_ptr}));
+        }
+        previous_ptr = frame_ptr;
+    }
+}
+
+int main()
+{
+    bool all_ok = true;
+    bool ok;
+
+    std::cout << std::endl << "==================== Problem statistics test ======================" << std::endl;
+
+    // 2D odometry at 100 Hz during 10.5 s, then key frames with constraints, and landmarks
+    Problem* problem_ptr = new Problem(FRM_PO_2D);
+    ProcessorOdom2D* processor_ptr = newProcessorOdom2D(problem_ptr);
+    Eigen::VectorXs data(2);
+    data << 0.01, 0.001;
+    Eigen::MatrixXs data_cov = Eigen::MatrixXs::Identity(2, 2) * 1e-4;
+    CaptureMotion* capture_ptr = new CaptureMotion(TimeStamp(0), processor_ptr->getSensorPtr(), data, data_cov, nullptr);
+    for (unsigned int i = 1; i <= 1050; i++)
+    {
+        capture_ptr->setTimeStamp(TimeStamp(i * 0.01));
+        processor_ptr->process(capture_ptr);
+    }
+    addKeyFrames(problem_ptr, 20, 100);
+    for (unsigned int i = 0; i < 5; i++)
+        problem_ptr->addLandmark(new LandmarkCorner2D(new StateBlock(Eigen::Vector2s::Zero()), new StateBlock(Eigen::Vector1s::Zero())));
+
+    // what a full visit of the tree finds
+    unsigned int n_frames = 0, n_captures = 0, n_features = 0, n_constraints = 0;
+    for (auto frame_ptr : *(problem_ptr->getTrajectoryPtr()->getFrameListPtr()))
+    {
+        n_frames++;
+        for (auto capture_ptr : *(frame_ptr->getCaptureListPtr()))
+        {
+            n_captures++;
+            for (auto feature_ptr : *(capture_ptr->getFeatureListPtr()))
+            {
+                n_features++;
+                ConstraintBaseList ctr_list;
+                feature_ptr->getConstraintList(ctr_list);
+                n_constraints += ctr_list.size();
+            }
+        }
+    }
+
+    ProblemStatistics statistics;
+    problem_ptr->getStatistics(statistics);
+
+    std::cout << "Counts of the nodes... ";
+    ok = statistics.frames_.count_ == n_frames && statistics.captures_.count_ == n_captures
+            && statistics.features_.count_ == n_features && statistics.constraints_.count_ == n_constraints
+            && statistics.landmarks_.count_ == 5 && statistics.state_blocks_.count_ == problem_ptr->getStateListPtr()->size();
+    ok = ok && problem_ptr->getTrajectoryPtr()->getKeyFramesCount() > 20 && n_constraints > 40;
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Memory of the nodes... ";
+    ok = statistics.frames_.bytes_ >= n_frames * sizeof(FrameBase) && statistics.captures_.bytes_ >= n_captures * sizeof(CaptureBase)
+            && statistics.features_.bytes_ >= n_features * (sizeof(FeatureBase) + 21 * sizeof(Scalar))
+            && statistics.constraints_.bytes_ >= n_constraints * sizeof(ConstraintBase)
+            && statistics.landmarks_.bytes_ >= 5 * sizeof(LandmarkBase)
+            && statistics.state_blocks_.bytes_ >= statistics.state_blocks_.count_ * (sizeof(StateBlock) + sizeof(Scalar))
+            && statistics.getTreeBytes() > statistics.frames_.bytes_ + statistics.captures_.bytes_;
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Motion buffer of the processor... ";
+    ok = statistics.motion_buffers_.size() == 1 && statistics.motion_buffers_.front().processor_ptr_ == processor_ptr
+            && statistics.motion_buffers_.front().name_ == "Main odometry"
+            && statistics.motion_buffers_.front().size_ == processor_ptr->getBufferPtr()->get().size()
+            && statistics.motion_buffers_.front().size_ > 1
+            && statistics.motion_buffers_.front().capacity_ >= statistics.motion_buffers_.front().size_
+            && statistics.motion_buffers_.front().bytes_ >= statistics.motion_buffers_.front().size_ * sizeof(ProcessorOdom2D::MotionType)
+            && statistics.motion_buffers_.front().captures_ > 10
+            && statistics.captures_.bytes_ > statistics.motion_buffers_.front().bytes_;
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Pending notifications... ";
+    ok = statistics.state_block_notifications_ == problem_ptr->getStateBlockNotificationList().size()
+            && statistics.constraint_notifications_ == problem_ptr->getConstraintNotificationList().size()
+            && statistics.constraint_notifications_ == n_constraints && statistics.solver_residual_blocks_ == 0;
+    std::list<StateBlockNotification> state_notification_list;
+    std::list<ConstraintNotification> ctr_notification_list;
+    problem_ptr->consumeStateBlockNotificationList(state_notification_list);
+    problem_ptr->consumeConstraintNotificationList(ctr_notification_list);
+    problem_ptr->getStatistics(statistics);
+    ok = ok && statistics.state_block_notifications_ == 0 && statistics.constraint_notifications_ == 0
+            && statistics.motion_buffers_.size() == 1;
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    // Polling a long run
+    unsigned int n_key_frames = 20000;
+    addKeyFrames(problem_ptr, n_key_frames, 1000);
+    unsigned int n_polls = 100;
+    clock_t begin = clock();
+    for (unsigned int i = 0; i < n_polls; i++)
+        problem_ptr->getStatistics(statistics);
+    double t_poll = double(clock() - begin) / CLOCKS_PER_SEC / n_polls;
+
+    std::cout << "Counts along a long run... ";
+    ok = statistics.constraints_.count_ == n_constraints + 2 * n_key_frames && statistics.frames_.count_ == n_frames + n_key_frames;
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Statistics of " << statistics.frames_.count_ << " frames, " << statistics.features_.count_ << " features and "
+            << statistics.constraints_.count_ << " constraints:" << std::endl;
+    std::cout << "    tree memory:  " << statistics.getTreeBytes() / 1024 << " KiB" << std::endl;
+    std::cout << "    poll:         " << t_poll * 1e3 << " ms" << std::endl;
+
+    problem_ptr->destruct();
+
+    std::cout << (all_ok ? "All tests passed" : "Some tests FAILED") << std::endl;
+
+    return all_ok ? 0 : 1;
+}
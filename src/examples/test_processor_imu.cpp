@@ -78,6 +78,7 @@ int main(int argc, char** argv)
     IMU_extrinsics << 0,0,0, 0,0,0,1; // IMU pose in the robot
     SensorBase* sensor_ptr = wolf_problem_ptr_->installSensor("IMU", "Main IMU", IMU_extrinsics, nullptr);
     wolf_problem_ptr_->installProcessor("IMU", "IMU pre-integrator", "Main IMU", "");
+    ProcessorIMU* processor_ptr = (ProcessorIMU*)(wolf_problem_ptr_->getProcessorMotionPtr());
 
     // Set the origin
     data_file_acc >> mti_clock >> data_[0] >> data_[1] >> data_[2];
@@ -110,20 +111,20 @@ int main(int argc, char** argv)
         TimeStamp ts;
 
         // std::cout << "Current    delta: " << std::fixed << std::setprecision(3) << std::setw(8) << std::right
-        // << wolf_problem_ptr_->getProcessorMotionPtr()->getMotion().delta_.transpose() << std::endl;
+        // << processor_ptr->getMotion().delta_.transpose() << std::endl;
 
         // std::cout << "Integrated delta: " << std::fixed << std::setprecision(3) << std::setw(8)
-        // << wolf_problem_ptr_->getProcessorMotionPtr()->getMotion().delta_integr_.transpose() << std::endl;
+        // << processor_ptr->getMotion().delta_integr_.transpose() << std::endl;
 
         // Eigen::VectorXs x = wolf_problem_ptr_->getProcessorMotionPtr()->getCurrentState();
         // std::cout << "Integrated state: " << std::fixed << std::setprecision(3) << std::setw(8)
         // << x.head(10).transpose() << std::endl;
 
         // std::cout << std::endl;
-        delta_debug = wolf_problem_ptr_->getProcessorMotionPtr()->getMotion().delta_;
-        delta_integr_debug = wolf_problem_ptr_->getProcessorMotionPtr()->getMotion().delta_integr_;
+        delta_debug = processor_ptr->getMotion().delta_;
+        delta_integr_debug = processor_ptr->getMotion().delta_integr_;
         x_debug = wolf_problem_ptr_->getProcessorMotionPtr()->getCurrentState();
-        ts = wolf_problem_ptr_->getProcessorMotionPtr()->getBufferPtr()->get().back().ts_;
+        ts = processor_ptr->getBufferPtr()->get().back().ts_;
 
         if(debug_results)
             debug_results << ts.get() << "\t" << delta_debug(0) << "\t" << delta_debug(1) << "\t" << delta_debug(2) << "\t" << delta_debug(3) << "\t" << delta_debug(4) << "\t"
@@ -143,7 +144,7 @@ int main(int argc, char** argv)
     std::cout << "Initial    state: " << std::fixed << std::setprecision(3) << std::setw(8)
     << x0.head(16).transpose() << std::endl;
     std::cout << "Integrated delta: " << std::fixed << std::setprecision(3) << std::setw(8)
-    << wolf_problem_ptr_->getProcessorMotionPtr()->getMotion().delta_integr_.transpose() << std::endl;
+    << processor_ptr->getMotion().delta_integr_.transpose() << std::endl;
     std::cout << "Integrated state: " << std::fixed << std::setprecision(3) << std::setw(8)
     << wolf_problem_ptr_->getProcessorMotionPtr()->getCurrentState().head(16).transpose() << std::endl;
 
@@ -158,9 +159,9 @@ int main(int argc, char** argv)
 #endif
 
     TimeStamp t0, tf;
-    t0 = wolf_problem_ptr_->getProcessorMotionPtr()->getBufferPtr()->get().front().ts_;
-    tf = wolf_problem_ptr_->getProcessorMotionPtr()->getBufferPtr()->get().back().ts_;
-    int N = wolf_problem_ptr_->getProcessorMotionPtr()->getBufferPtr()->get().size();
+    t0 = processor_ptr->getBufferPtr()->get().front().ts_;
+    tf = processor_ptr->getBufferPtr()->get().back().ts_;
+    int N = processor_ptr->getBufferPtr()->get().size();
     std::cout << "t0        : " << t0.get() << " s" << std::endl;
     std::cout << "tf        : " << tf.get() << " s" << std::endl;
     std::cout << "duration  : " << tf-t0 << " s" << std::endl;
@@ -0,0 +1,187 @@
+/**
+ * \file test_published_state.cpp
+ *
+ *  Created on: Jul 1, 2016
+ *      \author: jsola
+ */
+
+// Classes under test
+#include "published_state.h"
+#include "processor_odom_2D.h"
+#include "processor_imu.h"
+
+// Wolf includes
+#include "wolf.h"
+#include "problem.h"
+#include "sensor_base.h"
+#include "state_block.h"
+
+// STL includes
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+// General includes
+#include <iostream>
+
+using namespace wolf;
+
+ProcessorOdom2D* newProcessorOdom2D(Problem* _problem_ptr)
+{
+    SensorBase* sensor_ptr = new SensorBase(SEN_ODOM_2D, "ODOM 2D", new StateBlock(Eigen::Vector2s::Zero(), true),
+                                            new StateBlock(Eigen::Vector1s::Zero(), true),
+                                            new StateBlock(Eigen::VectorXs::Zero(0), true), 0);
+    ProcessorOdom2D* processor_ptr = new ProcessorOdom2D(1e9, 1e9, 1e9); // never vote for key-frames
+    sensor_ptr->addProcessor(processor_ptr);
+    _problem_ptr->addSensor(sensor_ptr);
+    _problem_ptr->setProcessorMotion(processor_ptr);
+    processor_ptr->setOrigin(Eigen::Vector3s::Zero(), TimeStamp(0));
+    return processor_ptr;
+}
+
+ProcessorIMU* newProcessorIMU(Problem* _problem_ptr)
+{
+    Eigen::VectorXs IMU_extrinsics(7);
+    IMU_extrinsics << 0,0,0, 0,0,0,1;
+    _problem_ptr->installSensor("IMU", "Main IMU", IMU_extrinsics, nullptr);
+    _problem_ptr->installProcessor("IMU", "IMU pre-integrator", "Main IMU", "");
+    ProcessorIMU* processor_ptr = (ProcessorIMU*)(_problem_ptr->getProcessorMotionPtr());
+    Eigen::VectorXs x0(16);
+    x0 << 0,0,0,  1,0,0,  0,0,0,1,  0,0,.001,  0,0,.002;
+    processor_ptr->setOrigin(x0, TimeStamp(0));
+    return processor_ptr;
+}
+
+int main()
+{
+    bool all_ok = true;
+    bool ok;
+
+    std::cout << std::endl << "==================== Published state test ======================" << std::endl;
+
+    // IMU: the published state is the current state
+    unsigned int N = 1000;
+    const Scalar dt_imu = 0.001;
+    std::vector<TimeStamp> time_stamps(N);
+    Eigen::MatrixXs data_imu(6, N);
+    for (unsigned int i = 0; i < N; i++)
+    {
+        time_stamps[i] = TimeStamp((i + 1) * dt_imu);
+        data_imu.col(i) << 0.1 * sin(i * dt_imu), 0.2, 9.8, 0.01, -0.02, 0.3 * cos(i * dt_imu);
+    }
+    Eigen::MatrixXs data_cov_imu = Eigen::MatrixXs::Identity(6, 6) * 1e-4;
+
+    Problem* problem_imu_ptr = new Problem(FRM_PVQBB_3D);
+    Eigen::VectorXs x(16), x_published(16);
+    TimeStamp ts, ts_published;
+    std::cout << "Nothing published before integrating... ";
+    ok = !problem_imu_ptr->getPublishedState(x_published, ts_published);
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    ProcessorIMU* processor_imu_ptr = newProcessorIMU(problem_imu_ptr);
+    problem_imu_ptr->getPublishedStatePtr()->setCovarianceSize(9);
+    processor_imu_ptr->setLazyCovariance(true);
+    processor_imu_ptr->processBatch(time_stamps, data_imu, data_cov_imu);
+
+    std::cout << "IMU: published state and covariance equal to the current ones... ";
+    Eigen::MatrixXs cov_published(9, 9);
+    problem_imu_ptr->getPublishedStatePtr()->read(ts_published, x_published, cov_published);
+    problem_imu_ptr->getCurrentState(x, ts);
+    ok = (problem_imu_ptr->getPublishedStatePtr()->getPublishedCount() == N) && (ts_published.get() == ts.get())
+            && (x_published - x).isZero(1e-12) && (cov_published - processor_imu_ptr->getMotion().delta_integr_cov_).isZero(1e-12);
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    // 2D odometry: a reader thread checks every snapshot against a reference trajectory while the Wolf thread integrates
+    N = 200000;
+    const Scalar dt = 0.001;
+    Eigen::VectorXs data(2);
+    data << 0.001, 0.0001;
+    Eigen::MatrixXs data_cov = Eigen::MatrixXs::Identity(2, 2) * 1e-4;
+
+    Problem* problem_ref_ptr = new Problem(FRM_PO_2D);
+    ProcessorOdom2D* processor_ref_ptr = newProcessorOdom2D(problem_ref_ptr);
+    CaptureMotion* capture_ref_ptr = new CaptureMotion(TimeStamp(0), processor_ref_ptr->getSensorPtr(), data, data_cov, nullptr);
+    Eigen::MatrixXs trajectory(3, N + 1);
+    trajectory.col(0).setZero();
+    for (unsigned int i = 1; i <= N; i++)
+    {
+        capture_ref_ptr->setTimeStamp(TimeStamp(i * dt));
+        processor_ref_ptr->process(capture_ref_ptr);
+        trajectory.col(i) = processor_ref_ptr->getCurrentState();
+    }
+
+    Problem* problem_ptr = new Problem(FRM_PO_2D);
+    ProcessorOdom2D* processor_ptr = newProcessorOdom2D(problem_ptr);
+    CaptureMotion* capture_ptr = new CaptureMotion(TimeStamp(0), processor_ptr->getSensorPtr(), data, data_cov, nullptr);
+
+    std::atomic<bool> done(false);
+    unsigned long int n_reads = 0, n_inconsistent = 0, n_backwards = 0;
+    Scalar reader_elapsed = 0;
+    std::thread reader([&]()
+    {
+        Eigen::VectorXs x_read(3);
+        TimeStamp ts_read;
+        Scalar ts_last = 0;
+        auto begin = std::chrono::steady_clock::now();
+        while (!done.load())
+        {
+            if (!problem_ptr->getPublishedState(x_read, ts_read))
+                continue;
+            unsigned int i = (unsigned int)(ts_read.get() / dt + 0.5);
+            if (i > N || x_read != trajectory.col(i))
+                n_inconsistent++;
+            if (ts_read.get() < ts_last)
+                n_backwards++;
+            ts_last = ts_read.get();
+            n_reads++;
+        }
+        reader_elapsed = std::chrono::duration<Scalar>(std::chrono::steady_clock::now() - begin).count();
+    });
+    for (unsigned int i = 1; i <= N; i++)
+    {
+        capture_ptr->setTimeStamp(TimeStamp(i * dt));
+        processor_ptr->process(capture_ptr);
+    }
+    done.store(true);
+    reader.join();
+
+    std::cout << "Odom 2D: " << n_reads << " concurrent reads, all consistent and in order... ";
+    ok = (n_reads > 0) && (n_inconsistent == 0) && (n_backwards == 0);
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Odom 2D: last published state is the current state... ";
+    problem_ptr->getPublishedState(x_published, ts_published);
+    ok = (ts_published.get() == N * dt) && (x_published == trajectory.col(N));
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    // Timing of the uncontended reads against the current state computed on the fly
+    unsigned int n_timing = 1000000;
+    Eigen::VectorXs x_2D(3);
+    Scalar sum = 0;
+    auto begin = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < n_timing; i++)
+    {
+        problem_ptr->getPublishedState(x_2D, ts);
+        sum += x_2D(0);
+    }
+    Scalar elapsed_published = std::chrono::duration<Scalar>(std::chrono::steady_clock::now() - begin).count();
+    begin = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < n_timing; i++)
+    {
+        problem_ptr->getCurrentState(x_2D, ts);
+        sum += x_2D(0);
+    }
+    Scalar elapsed_current = std::chrono::duration<Scalar>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << "Time per concurrent read:     " << reader_elapsed / n_reads * 1e9 << " ns" << std::endl;
+    std::cout << "Time per read:                " << elapsed_published / n_timing * 1e9 << " ns" << std::endl;
+    std::cout << "Time per getCurrentState():   " << elapsed_current / n_timing * 1e9 << " ns (" << sum << ")" << std::endl;
+
+    std::cout << (all_ok ? "All tests passed" : "Some tests FAILED") << std::endl;
+
+    return all_ok ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+/**
+ * \file test_sample_queue.cpp
+ *
+ *  Created on: Jun 29, 2016
+ *      \author: jsola
+ */
+
+// Classes under test
+#include "sample_queue.h"
+#include "processor_imu.h"
+
+// Wolf includes
+#include "wolf.h"
+#include "problem.h"
+#include "sensor_base.h"
+#include "state_block.h"
+
+// STL includes
+#include <thread>
+#include <vector>
+
+// General includes
+#include <iostream>
+
+using namespace wolf;
+
+ProcessorIMU* newProcessorIMU(Problem* _problem_ptr)
+{
+    Eigen::VectorXs IMU_extrinsics(7);
+    IMU_extrinsics << 0,0,0, 0,0,0,1;
+    _problem_ptr->installSensor("IMU", "Main IMU", IMU_extrinsics, nullptr);
+    _problem_ptr->installProcessor("IMU", "IMU pre-integrator", "Main IMU", "");
+    ProcessorIMU* processor_ptr = (ProcessorIMU*)(_problem_ptr->getProcessorMotionPtr());
+    Eigen::VectorXs x0(16);
+    x0 << 0,0,0,  1,0,0,  0,0,0,1,  0,0,.001,  0,0,.002;
+    processor_ptr->setOrigin(x0, TimeStamp(0));
+    return processor_ptr;
+}
+
+int main()
+{
+    bool all_ok = true;
+    unsigned int N = 100000;
+    const Scalar dt = 0.001;
+
+    std::cout << std::endl << "==================== Sample queue test ======================" << std::endl;
+
+    // Synthetic IMU data
+    std::vector<TimeStamp> time_stamps(N);
+    Eigen::MatrixXs data(6, N);
+    for (unsigned int i = 0; i < N; i++)
+    {
+        time_stamps[i] = TimeStamp((i + 1) * dt);
+        data.col(i) << 0.1 * sin(i * dt), 0.2, 9.8, 0.01, -0.02, 0.3 * cos(i * dt);
+    }
+    Eigen::MatrixXs data_cov = Eigen::MatrixXs::Identity(6, 6) * 1e-4;
+
+    // Reference: the whole block at once
+    Problem* problem_ref_ptr = new Problem(FRM_PVQBB_3D);
+    ProcessorIMU* processor_ref_ptr = newProcessorIMU(problem_ref_ptr);
+    processor_ref_ptr->processBatch(time_stamps, data, data_cov);
+
+    // Driver thread pushing into the queue, Wolf thread draining it
+    Problem* problem_ptr = new Problem(FRM_PVQBB_3D);
+    ProcessorIMU* processor_ptr = newProcessorIMU(problem_ptr);
+    SampleQueue* queue_ptr = processor_ptr->getSensorPtr()->attachSampleQueue(6, 256, data_cov, SMP_WAIT);
+
+    std::thread driver([&]()
+    {
+        for (unsigned int i = 0; i < N; i++)
+            queue_ptr->push(time_stamps[i], data.col(i));
+    });
+    unsigned int n_drained = 0;
+    unsigned int n_drains = 0;
+    while (n_drained < N)
+    {
+        n_drained += processor_ptr->drainSampleQueue();
+        n_drains++;
+    }
+    driver.join();
+
+    std::cout << "All samples integrated, in order... ";
+    bool ok = (n_drained == N) && (processor_ptr->getBufferPtr()->get().size() == processor_ref_ptr->getBufferPtr()->get().size())
+            && (processor_ptr->getMotion().ts_.get() == time_stamps.back().get());
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Same integrated delta... ";
+    ok = (processor_ptr->getMotion().delta_integr_ - processor_ref_ptr->getMotion().delta_integr_).isZero(1e-10);
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "No sample dropped when waiting... ";
+    ok = (queue_ptr->getDroppedCount() == 0) && (queue_ptr->getPushedCount() == N) && queue_ptr->getMaxSize() <= queue_ptr->capacity();
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+    std::cout << "    " << n_drains << " drains, up to " << queue_ptr->getMaxSize() << " samples waiting" << std::endl;
+
+    // Overflow: the newest samples are dropped and counted
+    std::cout << "Overflow counters... ";
+    SampleQueue queue(6, 100, data_cov, SMP_DROP_NEWEST);
+    unsigned int n_accepted = 0;
+    for (unsigned int i = 0; i < 150; i++)
+        n_accepted += queue.push(time_stamps[i], data.col(i));
+    TimeStamp ts;
+    Eigen::VectorXs sample(6);
+    queue.pop(ts, sample);
+    ok = (n_accepted == 100) && (queue.getDroppedCount() == 50) && (queue.getPushedCount() == 100) && (queue.getMaxSize() == 100)
+            && (ts.get() == time_stamps[0].get()) && (sample == data.col(0)) && (queue.size() == 99);
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << (all_ok ? "All tests passed" : "Some tests FAILED") << std::endl;
+
+    return all_ok ? 0 : 1;
+}
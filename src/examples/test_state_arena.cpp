@@ -0,0 +1,173 @@
+/**
+ * \file test_state_arena.cpp
+ *
+ *  Created on: Jul 11, 2016
+ *      \author: jsola
+ */
+
+// Classes under test
+#include "state_arena.h"
+#include "state_block.h"
+#include "problem.h"
+
+// Wolf includes
+#include "wolf.h"
+#include "sensor_base.h"
+#include "trajectory_base.h"
+#include "frame_base.h"
+#include "landmark_corner_2D.h"
+
+// STL includes
+#include <ctime>
+#include <list>
+#include <vector>
+
+// General includes
+#include <iostream>
+
+using namespace wolf;
+
+FrameBase* addKeyFrame(Problem* _problem_ptr, Scalar _x)
+{
+    return _problem_ptr->getTrajectoryPtr()->addFrame(new FrameBase(KEY_FRAME, TimeStamp(_x), new StateBlock(Eigen::Vector2s::Constant(_x)),
+                                                                     new StateBlock(Eigen::Vector1s::Constant(_x))));
+}
+
+int main()
+{
+    bool all_ok = true;
+    bool ok;
+
+    std::cout << std::endl << "==================== State arena test ======================" << std::endl;
+
+    Problem* problem_ptr = new Problem(FRM_PO_2D);
+    problem_ptr->enableStateArena(100000, 64);
+    StateArena* arena_ptr = problem_ptr->getStateArenaPtr();
+
+    SensorBase* sensor_ptr = new SensorBase(SEN_ODOM_2D, "ODOM 2D", new StateBlock(Eigen::Vector2s(1, 2), true),
+                                            new StateBlock(Eigen::Vector1s::Constant(3), true),
+                                            new StateBlock(Eigen::VectorXs::Zero(0), true), 0);
+    problem_ptr->addSensor(sensor_ptr);
+    std::vector<FrameBase*> frames;
+    for (unsigned int i = 0; i < 10; i++)
+        frames.push_back(addKeyFrame(problem_ptr, i));
+    LandmarkBase* landmark_ptr = problem_ptr->addLandmark(new LandmarkCorner2D(new StateBlock(Eigen::Vector2s(5, 6)),
+                                                                               new StateBlock(Eigen::Vector1s::Constant(7))));
+
+    std::cout << "State blocks moved to the arena, values kept... ";
+    ok = arena_ptr->getBlocksCount() == 2 + 2 * frames.size() + 2; // the empty intrinsics stay out
+    ok = ok && sensor_ptr->getPPtr()->getVector() == Eigen::Vector2s(1, 2) && landmark_ptr->getPPtr()->getVector() == Eigen::Vector2s(5, 6);
+    for (unsigned int i = 0; i < frames.size(); i++)
+        ok = ok && frames[i]->getPPtr()->getVector() == Eigen::Vector2s::Constant(i)
+                && frames[i]->getPPtr()->getPtr() == arena_ptr->getVector().data() + arena_ptr->getOffset(frames[i]->getPPtr());
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Frame states contiguous, apart from the others... ";
+    ok = true;
+    unsigned int offset = arena_ptr->getOffset(frames[0]->getPPtr());
+    for (auto frame_ptr : frames)
+    {
+        ok = ok && arena_ptr->getOffset(frame_ptr->getPPtr()) == offset && arena_ptr->getOffset(frame_ptr->getOPtr()) == offset + 2;
+        offset += 3;
+    }
+    ok = ok && arena_ptr->getOffset(sensor_ptr->getPPtr()) / 64 != arena_ptr->getOffset(frames[0]->getPPtr()) / 64
+            && arena_ptr->getOffset(landmark_ptr->getPPtr()) / 64 != arena_ptr->getOffset(frames[0]->getPPtr()) / 64;
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Writes through the block and through the arena... ";
+    frames[3]->getPPtr()->setVector(Eigen::Vector2s(30, 31));
+    ok = arena_ptr->getVector().segment<2>(arena_ptr->getOffset(frames[3]->getPPtr())) == Eigen::Vector2s(30, 31);
+    arena_ptr->getVector()(arena_ptr->getOffset(frames[4]->getOPtr())) = 40;
+    ok = ok && frames[4]->getOPtr()->getVector()(0) == 40;
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Snapshot and rollback... ";
+    Eigen::VectorXs snapshot;
+    arena_ptr->snapshot(snapshot);
+    for (auto frame_ptr : frames)
+        frame_ptr->getPPtr()->setVector(Eigen::Vector2s(-1, -1));
+    arena_ptr->restore(snapshot);
+    ok = frames[3]->getPPtr()->getVector() == Eigen::Vector2s(30, 31) && frames[5]->getPPtr()->getVector() == Eigen::Vector2s(5, 5);
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Removed blocks keep their values, their room is reused... ";
+    StateBlock* p_ptr = frames[2]->getPPtr();
+    Scalar* removed_ptr = p_ptr->getPtr();
+    std::list<StateBlockNotification> notifications;
+    problem_ptr->consumeStateBlockNotificationList(notifications); // as if the solver knew them all
+    problem_ptr->removeStateBlockPtr(p_ptr);
+    ok = !arena_ptr->contains(p_ptr) && p_ptr->getVector() == Eigen::Vector2s(2, 2) && p_ptr->getPtr() != removed_ptr;
+    ok = ok && problem_ptr->getStateBlockNotificationList().back().notification_ == REMOVE
+            && problem_ptr->getStateBlockNotificationList().back().scalar_ptr_ == removed_ptr;
+    problem_ptr->addStateBlockPtr(p_ptr, ST_FRAME);
+    ok = ok && p_ptr->getPtr() == removed_ptr && p_ptr->getVector() == Eigen::Vector2s(2, 2);
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Blocks out of the arena when full... ";
+    Problem* small_problem_ptr = new Problem(FRM_PO_2D);
+    small_problem_ptr->enableStateArena(64, 32);
+    FrameBase* frame_in_ptr = addKeyFrame(small_problem_ptr, 1);
+    small_problem_ptr->addLandmark(new LandmarkCorner2D(new StateBlock(Eigen::Vector2s(5, 6)), new StateBlock(Eigen::Vector1s::Constant(7))));
+    FrameBase* frame_out_ptr = nullptr;
+    for (unsigned int i = 0; i < 20; i++)
+        frame_out_ptr = addKeyFrame(small_problem_ptr, 2 + i);
+    ok = small_problem_ptr->getStateArenaPtr()->contains(frame_in_ptr->getPPtr())
+            && !small_problem_ptr->getStateArenaPtr()->contains(frame_out_ptr->getPPtr())
+            && frame_out_ptr->getPPtr()->getVector() == Eigen::Vector2s::Constant(21);
+    small_problem_ptr->destruct();
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    problem_ptr->destruct();
+
+    // Bulk copies of the state of 10000 key frames
+    unsigned int n_frames = 10000;
+    Problem* problem_arena_ptr = new Problem(FRM_PO_2D);
+    problem_arena_ptr->enableStateArena(3 * n_frames + 768, 768); // pages of 256 frames, without gaps
+    Problem* problem_blocks_ptr = new Problem(FRM_PO_2D);
+    for (unsigned int i = 0; i < n_frames; i++)
+    {
+        addKeyFrame(problem_arena_ptr, i);
+        addKeyFrame(problem_blocks_ptr, i);
+    }
+    unsigned int n_copies = 100;
+    clock_t begin = clock();
+    for (unsigned int n = 0; n < n_copies; n++)
+        problem_arena_ptr->getStateArenaPtr()->snapshot(snapshot);
+    Scalar time_arena = double(clock() - begin) / CLOCKS_PER_SEC / n_copies;
+    begin = clock();
+    for (unsigned int n = 0; n < n_copies; n++)
+    {
+        snapshot.resize(3 * n_frames);
+        unsigned int position = 0;
+        for (auto state_ptr : *(problem_blocks_ptr->getStateListPtr()))
+        {
+            snapshot.segment(position, state_ptr->getSize()) = state_ptr->getVector();
+            position += state_ptr->getSize();
+        }
+    }
+    Scalar time_blocks = double(clock() - begin) / CLOCKS_PER_SEC / n_copies;
+
+    std::cout << "Same state copied from the arena and from the blocks... ";
+    Eigen::VectorXs snapshot_arena;
+    problem_arena_ptr->getStateArenaPtr()->snapshot(snapshot_arena);
+    ok = snapshot_arena.head(3 * n_frames) == snapshot;
+    std::cout << (ok ? "OK" : "FAILED") << std::endl;
+    all_ok = all_ok && ok;
+
+    std::cout << "Copy of the state of " << n_frames << " key frames:" << std::endl;
+    std::cout << "    arena snapshot:   " << time_arena * 1e6 << " us" << std::endl;
+    std::cout << "    block by block:   " << time_blocks * 1e6 << " us" << std::endl;
+
+    problem_arena_ptr->destruct();
+    problem_blocks_ptr->destruct();
+
+    std::cout << (all_ok ? "All tests passed" : "Some tests FAILED") << std::endl;
+
+    return all_ok ? 0 : 1;
+}
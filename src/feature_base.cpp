@@ -4,7 +4,7 @@
 
 namespace wolf {
 
-unsigned int FeatureBase::feature_id_count_ = 0;
+std::atomic<unsigned int> FeatureBase::feature_id_count_(0);
 
 FeatureBase::FeatureBase(FeatureType _tp, const std::string& _type, unsigned int _dim_measurement) :
     NodeConstrained(MID, "FEATURE", _type),
@@ -42,6 +42,22 @@ FeatureBase::~FeatureBase()
     //std::cout << "constraints deleted" << std::endl;
 }
 
+void* FeatureBase::operator new(std::size_t _size)
+{
+    return getPool().allocate(_size);
+}
+
+void FeatureBase::operator delete(void* _ptr, std::size_t _size)
+{
+    getPool().deallocate(_ptr, _size);
+}
+
+NodePool& FeatureBase::getPool()
+{
+    static NodePool pool;
+    return pool;
+}
+
 ConstraintBase* FeatureBase::addConstraint(ConstraintBase* _co_ptr)
 {
     addDownNode(_co_ptr);
@@ -58,7 +74,7 @@ FrameBase* FeatureBase::getFramePtr() const
     return upperNodePtr()->upperNodePtr();
 }
 
-ConstraintBaseList* FeatureBase::getConstraintListPtr()
+DownNodeList<ConstraintBase>::Type* FeatureBase::getConstraintListPtr()
 {
     return getDownNodeListPtr();
 }
@@ -10,9 +10,11 @@ class ConstraintBase;
 //Wolf includes
 #include "wolf.h"
 #include "node_linked.h"
+#include "node_pool.h"
 #include "node_constrained.h"
 
 //std includes
+#include <atomic>
 
 
 namespace wolf {
@@ -21,7 +23,7 @@ namespace wolf {
 class FeatureBase : public NodeConstrained<CaptureBase,ConstraintBase>
 {
     private:
-        static unsigned int feature_id_count_;
+        static std::atomic<unsigned int> feature_id_count_;
     protected:
         unsigned int feature_id_;
         unsigned int track_id_; // ID of the feature track
@@ -51,6 +53,12 @@ class FeatureBase : public NodeConstrained<CaptureBase,ConstraintBase>
          */
         virtual ~FeatureBase();
 
+        /** \brief Allocation in the pool of features, see NodePool
+         */
+        static void* operator new(std::size_t _size);
+        static void operator delete(void* _ptr, std::size_t _size);
+        static NodePool& getPool();
+
         unsigned int id();
         unsigned int trackId(){return track_id_;}
         void setTrackId(unsigned int _tr_id){track_id_ = _tr_id;}
@@ -72,7 +80,7 @@ class FeatureBase : public NodeConstrained<CaptureBase,ConstraintBase>
 
         /** \brief Gets the constraint list (down nodes) pointer
          */
-        ConstraintBaseList* getConstraintListPtr();
+        DownNodeList<ConstraintBase>::Type* getConstraintListPtr();
         
         void getConstraintList(ConstraintBaseList & _ctr_list);
 
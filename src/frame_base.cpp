@@ -40,13 +40,17 @@ FrameBase::~FrameBase()
 	//std::cout << "deleting FrameBase " << id() << std::endl;
     is_deleting_ = true;
 
-	// Remove Frame State Blocks
-	if (p_ptr_ != nullptr)
-	{
+    // Remove it from the key frame index
+    if (type_id_ == KEY_FRAME && getTrajectoryPtr() != nullptr && !getTrajectoryPtr()->isDeleting())
+        getTrajectoryPtr()->unindexKeyFrame(this);
+
+    // Remove Frame State Blocks
+    if (p_ptr_ != nullptr)
+    {
         if (getProblem() != nullptr && type_id_ == KEY_FRAME)
             getProblem()->removeStateBlockPtr(p_ptr_);
-	    delete p_ptr_;
-	}
+        delete p_ptr_;
+    }
     if (o_ptr_ != nullptr)
     {
         if (getProblem() != nullptr && type_id_ == KEY_FRAME)
@@ -72,18 +76,34 @@ FrameBase::~FrameBase()
     //std::cout << "constraints deleted" << std::endl;
 }
 
+void* FrameBase::operator new(std::size_t _size)
+{
+    return getPool().allocate(_size);
+}
+
+void FrameBase::operator delete(void* _ptr, std::size_t _size)
+{
+    getPool().deallocate(_ptr, _size);
+}
+
+NodePool& FrameBase::getPool()
+{
+    static NodePool pool;
+    return pool;
+}
+
 void FrameBase::registerNewStateBlocks()
 {
     if (getProblem() != nullptr)
     {
         if (p_ptr_ != nullptr)
-            getProblem()->addStateBlockPtr(p_ptr_);
+            getProblem()->addStateBlockPtr(p_ptr_, ST_FRAME);
 
         if (o_ptr_ != nullptr)
-            getProblem()->addStateBlockPtr(o_ptr_);
+            getProblem()->addStateBlockPtr(o_ptr_, ST_FRAME);
 
         if (v_ptr_ != nullptr)
-            getProblem()->addStateBlockPtr(v_ptr_);
+            getProblem()->addStateBlockPtr(v_ptr_, ST_FRAME);
     }
 }
 
@@ -94,9 +114,6 @@ void FrameBase::setKey()
         type_id_ = KEY_FRAME;
         registerNewStateBlocks();
 
-        if (getTrajectoryPtr()->getLastKeyFramePtr() == nullptr || getTrajectoryPtr()->getLastKeyFramePtr()->getTimeStamp() < time_stamp_)
-            getTrajectoryPtr()->setLastKeyFramePtr(this);
-
         getTrajectoryPtr()->sortFrame(this);
     }
 }
@@ -162,12 +179,30 @@ void FrameBase::getState(Eigen::VectorXs& state) const
     }
 }
 
-CaptureBase* FrameBase::hasCaptureOf(const SensorBase* _sensor_ptr)
+std::vector<StateBlock*> FrameBase::getStateBlockVector() const
 {
-    for (auto capture_ptr : *getCaptureListPtr())
-        if (capture_ptr->getSensorPtr() == _sensor_ptr)
-            return capture_ptr;
-    return nullptr;
+    std::vector<StateBlock*> state_block_vector;
+    for (auto state_ptr : {p_ptr_, o_ptr_, v_ptr_})
+        if (state_ptr != nullptr)
+            state_block_vector.push_back(state_ptr);
+    return state_block_vector;
+}
+
+CaptureBase* FrameBase::addCapture(CaptureBase* _capt_ptr)
+{
+    addDownNode(_capt_ptr);
+    capture_index_.push_back(std::make_pair(_capt_ptr->getSensorPtr(), _capt_ptr));
+    return _capt_ptr;
+}
+
+void FrameBase::unindexCapture(CaptureBase* _capt_ptr)
+{
+    for (auto entry_it = capture_index_.begin(); entry_it != capture_index_.end(); entry_it++)
+        if (entry_it->second == _capt_ptr)
+        {
+            capture_index_.erase(entry_it);
+            return;
+        }
 }
 
 void FrameBase::getConstraintList(ConstraintBaseList & _ctr_list)
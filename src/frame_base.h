@@ -13,9 +13,12 @@ class StateBlock;
 #include "wolf.h"
 #include "time_stamp.h"
 #include "node_linked.h"
+#include "node_pool.h"
 #include "node_constrained.h"
 
 //std includes
+#include <utility>
+#include <vector>
 
 namespace wolf {
 
@@ -32,6 +35,7 @@ class FrameBase : public NodeConstrained<TrajectoryBase,CaptureBase>
         StateBlock* p_ptr_;      ///< Position state block pointer
         StateBlock* o_ptr_;      ///< Orientation state block pointer
         StateBlock* v_ptr_;      ///< Linear velocity state block pointer
+        std::vector<std::pair<const SensorBase*, CaptureBase*> > capture_index_; ///< sensor of each capture, in the order of the capture list
         
     public:
 
@@ -63,6 +67,12 @@ class FrameBase : public NodeConstrained<TrajectoryBase,CaptureBase>
          **/
         virtual ~FrameBase();
 
+        /** \brief Allocation in the pool of frames, see NodePool
+         */
+        static void* operator new(std::size_t _size);
+        static void operator delete(void* _ptr, std::size_t _size);
+        static NodePool& getPool();
+
         unsigned int id();
 
 
@@ -90,9 +100,13 @@ class FrameBase : public NodeConstrained<TrajectoryBase,CaptureBase>
         StateBlock* getOPtr() const;
         StateBlock* getVPtr() const;
 
+        /** \brief Gets the state blocks of the frame
+         **/
+        virtual std::vector<StateBlock*> getStateBlockVector() const;
+
         void setState(const Eigen::VectorXs& _st);
         virtual Eigen::VectorXs getState() const;
-        void getState(Eigen::VectorXs& state) const;
+        virtual void getState(Eigen::VectorXs& state) const;
 
 
         // Wolf tree access ---------------------------------------------------
@@ -106,7 +120,20 @@ class FrameBase : public NodeConstrained<TrajectoryBase,CaptureBase>
         CaptureBase* addCapture(CaptureBase* _capt_ptr);
         void removeCapture(CaptureBaseIter& _capt_iter);
         void removeCapture(CaptureBase* _capt_ptr);
-        CaptureBase* hasCaptureOf(const SensorBase* _sensor_ptr);
+
+        /** \brief Unlinks the capture from this frame without deleting it, e.g. to add it to another frame
+         */
+        void unlinkCapture(CaptureBase* _capt_ptr);
+
+        /** \brief First capture of the sensor in this frame, or nullptr
+         *
+         * It looks in a small index of the sensors of the captures, without visiting the captures themselves.
+         */
+        CaptureBase* hasCaptureOf(const SensorBase* _sensor_ptr) const;
+
+        /** \brief Removes a capture from the sensor index. The captures do it at destruction.
+         */
+        void unindexCapture(CaptureBase* _capt_ptr);
 
         void getConstraintList(ConstraintBaseList & _ctr_list);
 
@@ -194,12 +221,6 @@ inline CaptureBaseList* FrameBase::getCaptureListPtr()
     return getDownNodeListPtr();
 }
 
-inline CaptureBase* FrameBase::addCapture(CaptureBase* _capt_ptr)
-{
-    addDownNode(_capt_ptr);
-    return _capt_ptr;
-}
-
 inline void FrameBase::removeCapture(CaptureBaseIter& _capt_iter)
 {
     //std::cout << "removing capture " << (*_capt_iter)->nodeId() << " from Frame " << nodeId() << std::endl;
@@ -212,6 +233,20 @@ inline void FrameBase::removeCapture(CaptureBase* _capt_ptr)
     removeDownNode(_capt_ptr);
 }
 
+inline void FrameBase::unlinkCapture(CaptureBase* _capt_ptr)
+{
+    unindexCapture(_capt_ptr);
+    unlinkDownNode(_capt_ptr);
+}
+
+inline CaptureBase* FrameBase::hasCaptureOf(const SensorBase* _sensor_ptr) const
+{
+    for (auto& entry : capture_index_)
+        if (entry.first == _sensor_ptr)
+            return entry.second;
+    return nullptr;
+}
+
 inline StateStatus FrameBase::getStatus() const
 {
     return status_;
@@ -52,30 +52,35 @@ FrameIMU::FrameIMU(const FrameKeyType& _tp, const TimeStamp& _ts, const Eigen::V
           if (getProblem() != nullptr && type_id_ == KEY_FRAME)
               getProblem()->removeStateBlockPtr(p_ptr_);
   	    delete p_ptr_;
+  	    p_ptr_ = nullptr;
   	}
       if (v_ptr_ != nullptr)
       {
           if (getProblem() != nullptr && type_id_ == KEY_FRAME)
               getProblem()->removeStateBlockPtr(v_ptr_);
           delete v_ptr_;
+          v_ptr_ = nullptr;
       }
       if (o_ptr_ != nullptr)
       {
           if (getProblem() != nullptr && type_id_ == KEY_FRAME)
               getProblem()->removeStateBlockPtr(o_ptr_);
           delete o_ptr_;
+          o_ptr_ = nullptr;
       }
       if (acc_bias_ptr_ != nullptr)
       {
           if (getProblem() != nullptr && type_id_ == KEY_FRAME)
               getProblem()->removeStateBlockPtr(acc_bias_ptr_);
           delete acc_bias_ptr_;
+          acc_bias_ptr_ = nullptr;
       }
       if (gyro_bias_ptr_ != nullptr)
       {
           if (getProblem() != nullptr && type_id_ == KEY_FRAME)
               getProblem()->removeStateBlockPtr(gyro_bias_ptr_);
           delete gyro_bias_ptr_;
+          gyro_bias_ptr_ = nullptr;
       }
 
 
@@ -91,24 +96,33 @@ FrameIMU::FrameIMU(const FrameKeyType& _tp, const TimeStamp& _ts, const Eigen::V
       //std::cout << "constraints deleted" << std::endl;
   }
 
+  std::vector<StateBlock*> FrameIMU::getStateBlockVector() const
+  {
+      std::vector<StateBlock*> state_block_vector = FrameBase::getStateBlockVector();
+      for (auto state_ptr : {acc_bias_ptr_, gyro_bias_ptr_})
+          if (state_ptr != nullptr)
+              state_block_vector.push_back(state_ptr);
+      return state_block_vector;
+  }
+
   void FrameIMU::registerNewStateBlocks()
   {
       if (getProblem() != nullptr)
       {
           if (p_ptr_ != nullptr)
-              getProblem()->addStateBlockPtr(p_ptr_);
+              getProblem()->addStateBlockPtr(p_ptr_, ST_FRAME);
 
           if (v_ptr_ != nullptr)
-              getProblem()->addStateBlockPtr(v_ptr_);
+              getProblem()->addStateBlockPtr(v_ptr_, ST_FRAME);
 
           if (o_ptr_ != nullptr)
-              getProblem()->addStateBlockPtr(o_ptr_);
+              getProblem()->addStateBlockPtr(o_ptr_, ST_FRAME);
 
           if (acc_bias_ptr_ != nullptr)
-              getProblem()->addStateBlockPtr(acc_bias_ptr_);
+              getProblem()->addStateBlockPtr(acc_bias_ptr_, ST_BIAS);
 
           if (gyro_bias_ptr_ != nullptr)
-              getProblem()->addStateBlockPtr(gyro_bias_ptr_);
+              getProblem()->addStateBlockPtr(gyro_bias_ptr_, ST_BIAS);
       }
   }
 
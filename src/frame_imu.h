@@ -76,6 +76,10 @@ namespace wolf {
           Eigen::VectorXs getState() const;
           void getState(Eigen::VectorXs& state) const;
 
+          /** \brief Gets the state blocks of the frame, biases included
+           **/
+          virtual std::vector<StateBlock*> getStateBlockVector() const;
+
           // Wolf tree access ---------------------------------------------------
 
           /** \brief Adds all stateBlocks of the frame to the wolfProblem list of new stateBlocks
@@ -0,0 +1,199 @@
+/**
+ * \file graph_pruner.cpp
+ *
+ *  Created on: Jul 15, 2016
+ *      \author: jsola
+ */
+
+#include "graph_pruner.h"
+#include "problem.h"
+#include "trajectory_base.h"
+#include "frame_base.h"
+#include "constraint_marginalization.h"
+#include "covariance_store.h"
+#include "state_block.h"
+#include "rotations.h"
+
+// STL includes
+#include <limits>
+
+namespace wolf {
+
+GraphPruner::GraphPruner(Problem* _problem_ptr, const GraphPrunerParams& _params) :
+        problem_ptr_(_problem_ptr),
+        params_(_params),
+        metrics_({0, 0, 0, 0, 0, 0}),
+        last_pruning_ts_(0),
+        pruned_(false)
+{
+    //
+}
+
+bool GraphPruner::isDue() const
+{
+    if (!pruned_ || params_.period_ == 0)
+        return true;
+
+    // the key frames are sorted by time stamp, before the others
+    unsigned int n_new = 0;
+    FrameBaseList* frame_list_ptr = problem_ptr_->getTrajectoryPtr()->getFrameListPtr();
+    for (auto frame_it = frame_list_ptr->rbegin(); frame_it != frame_list_ptr->rend(); frame_it++)
+    {
+        if (!(*frame_it)->isKey())
+            continue;
+        if ((*frame_it)->getTimeStamp() <= last_pruning_ts_)
+            break;
+        if (++n_new >= params_.period_)
+            return true;
+    }
+    return false;
+}
+
+void GraphPruner::getCandidateKeyFrames(FrameBaseList& _frame_list)
+{
+    FrameBase* last_key_frame_ptr = problem_ptr_->getLastKeyFramePtr();
+    if (last_key_frame_ptr == nullptr)
+        return;
+
+    // the new key frames, after the last one at the previous pruning, or the first one
+    FrameBaseList new_frame_list;
+    problem_ptr_->getTrajectoryPtr()->getKeyFrameList(pruned_ ? last_pruning_ts_ : TimeStamp(0), last_key_frame_ptr->getTimeStamp(), new_frame_list);
+
+    metrics_.prunings_++;
+    pruned_ = true;
+    last_pruning_ts_ = last_key_frame_ptr->getTimeStamp();
+    spatially_redundant_.clear();
+
+    FrameBase* reference_ptr = nullptr;
+    for (auto frame_ptr : new_frame_list)
+    {
+        if (frame_ptr == last_key_frame_ptr)
+            break;
+        if (reference_ptr == nullptr)
+        {
+            // the last key frame at the previous pruning, or the first key frame
+            reference_ptr = frame_ptr;
+            continue;
+        }
+
+        bool spatially_redundant = false;
+        if (params_.min_distance_ > 0 && frame_ptr->getPPtr() != nullptr && reference_ptr->getPPtr() != nullptr)
+        {
+            spatially_redundant = (frame_ptr->getPPtr()->getVector() - reference_ptr->getPPtr()->getVector()).norm() < params_.min_distance_;
+            if (spatially_redundant && params_.min_angle_ > 0 && frame_ptr->getOPtr() != nullptr && reference_ptr->getOPtr() != nullptr)
+            {
+                Eigen::VectorXs o = frame_ptr->getOPtr()->getVector();
+                Eigen::VectorXs o_reference = reference_ptr->getOPtr()->getVector();
+                Scalar angle = 0;
+                if (o.size() == 1)
+                    angle = std::abs(pi2pi(o(0) - o_reference(0)));
+                else if (o.size() == 4) // quaternion
+                    angle = 2 * acos(std::min(Scalar(1), std::abs(o.dot(o_reference)) / (o.norm() * o_reference.norm())));
+                spatially_redundant = angle < params_.min_angle_;
+            }
+        }
+
+        if (spatially_redundant)
+        {
+            spatially_redundant_.insert(frame_ptr);
+            _frame_list.push_back(frame_ptr);
+        }
+        else
+        {
+            reference_ptr = frame_ptr;
+            if (params_.max_information_gain_ > 0)
+                _frame_list.push_back(frame_ptr);
+        }
+    }
+}
+
+bool GraphPruner::isRedundant(FrameBase* _frame_ptr, const std::list<LinearizedConstraint>& _linearized_constraints)
+{
+    if (spatially_redundant_.find(_frame_ptr) != spatially_redundant_.end())
+        return true;
+    return params_.max_information_gain_ > 0 && computeInformationGain(_linearized_constraints) < params_.max_information_gain_;
+}
+
+Scalar GraphPruner::computeInformationGain(const std::list<LinearizedConstraint>& _linearized_constraints)
+{
+    CovarianceStore* covariance_store_ptr = problem_ptr_->getCovarianceStorePtr();
+    Scalar max_gain = 0;
+    for (auto& linearized : _linearized_constraints)
+    {
+        // the jacobian and the covariance of the estimated states
+        std::vector<StateBlock*> constraint_state_ptrs = linearized.constraint_ptr_->getStatePtrVector();
+        std::vector<StateBlock*> state_ptrs;
+        std::vector<unsigned int> offsets;
+        unsigned int size = 0;
+        for (unsigned int i = 0; i < constraint_state_ptrs.size(); i++)
+            if (!constraint_state_ptrs[i]->isFixed())
+            {
+                if (stale_states_.find(constraint_state_ptrs[i]) != stale_states_.end())
+                    return std::numeric_limits<Scalar>::infinity();
+                state_ptrs.push_back(constraint_state_ptrs[i]);
+                offsets.push_back(size);
+                size += constraint_state_ptrs[i]->getSize();
+            }
+        if (size == 0)
+            continue;
+        Eigen::MatrixXs J(linearized.residual_.size(), size);
+        Eigen::MatrixXs S(size, size);
+        for (unsigned int i = 0, k = 0; i < constraint_state_ptrs.size(); i++)
+            if (!constraint_state_ptrs[i]->isFixed())
+                J.middleCols(offsets[k++], constraint_state_ptrs[i]->getSize()) = linearized.jacobians_[i];
+        for (unsigned int i = 0; i < state_ptrs.size(); i++)
+            for (unsigned int j = 0; j < state_ptrs.size(); j++)
+            {
+                CovarianceStore::ConstBlockMap block = covariance_store_ptr->getBlock(state_ptrs[i], state_ptrs[j]);
+                if (block.data() == nullptr)
+                    return std::numeric_limits<Scalar>::infinity();
+                S.block(offsets[i], offsets[j], state_ptrs[i]->getSize(), state_ptrs[j]->getSize()) = block;
+            }
+
+        Scalar determinant = (Eigen::MatrixXs::Identity(J.rows(), J.rows()) - J * S * J.transpose()).determinant();
+        if (determinant <= 0)
+            return std::numeric_limits<Scalar>::infinity();
+        max_gain = std::max(max_gain, -0.5 * log(determinant));
+    }
+    return max_gain;
+}
+
+void GraphPruner::pruneKeyFrame(FrameBase* _frame_ptr, const std::list<LinearizedConstraint>& _linearized_constraints)
+{
+    assert(!problem_ptr_->isSolverRunning() && "GraphPruner::pruneKeyFrame: the solver is running. Wait for its solution first");
+
+    std::list<ConstraintMarginalization*> prior_ptrs;
+    ConstraintMarginalization* prior_ptr = ConstraintMarginalization::marginalize(_frame_ptr, _linearized_constraints);
+    if (prior_ptr != nullptr)
+    {
+        if (params_.sparsify_)
+            prior_ptrs = ConstraintMarginalization::sparsify(prior_ptr);
+        else
+            prior_ptrs.push_back(prior_ptr);
+    }
+
+    metrics_.key_frames_removed_++;
+    metrics_.constraints_removed_ += _linearized_constraints.size();
+    metrics_.constraints_added_ += prior_ptrs.size();
+    spatially_redundant_.erase(_frame_ptr);
+
+    // the covariances of the states of the priors are stale until computed again,
+    // and so are the ones stored for the states of the key frame, should their memory be reused
+    for (auto state_ptr : _frame_ptr->getStateBlockVector())
+        if (state_ptr != nullptr)
+            stale_states_.insert(state_ptr);
+    for (auto prior_ptr : prior_ptrs)
+        for (auto state_ptr : prior_ptr->getStatePtrVector())
+            stale_states_.insert(state_ptr);
+
+    problem_ptr_->replaceKeyFrame(_frame_ptr, prior_ptrs);
+}
+
+void GraphPruner::notifySolve(Scalar _solve_time, unsigned int _n_constraints)
+{
+    metrics_.solve_time_ += _solve_time;
+    if (_n_constraints > 0 && metrics_.constraints_removed_ > metrics_.constraints_added_)
+        metrics_.solve_time_saved_ += _solve_time * (metrics_.constraints_removed_ - metrics_.constraints_added_) / _n_constraints;
+}
+
+} // namespace wolf
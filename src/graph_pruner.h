@@ -0,0 +1,182 @@
+/**
+ * \file graph_pruner.h
+ *
+ *  Created on: Jul 15, 2016
+ *      \author: jsola
+ */
+
+#ifndef GRAPH_PRUNER_H_
+#define GRAPH_PRUNER_H_
+
+// Fwd refs
+namespace wolf{
+class Problem;
+class FrameBase;
+class StateBlock;
+class ConstraintMarginalization;
+struct LinearizedConstraint;
+}
+
+//Wolf includes
+#include "wolf.h"
+#include "time_stamp.h"
+
+// STL includes
+#include <list>
+#include <unordered_set>
+
+namespace wolf {
+
+/** \brief Parameters of the pruning of redundant key frames. See GraphPruner.
+ */
+struct GraphPrunerParams
+{
+        unsigned int period_;           ///< new key frames between two prunings. 0: at each solve
+        Scalar min_distance_;           ///< spatial redundancy: key frames closer than this to the previous key frame kept. 0: disabled
+        Scalar min_angle_;              ///< spatial redundancy: ... and turned less than this from it. 0: any orientation
+        Scalar max_information_gain_;   ///< information redundancy: key frames whose constraints each gain less than this (nats). 0: disabled
+        bool sparsify_;                 ///< replace the dense prior of each key frame by a Chow-Liu tree of priors
+};
+
+/** \brief What the pruning did so far
+ */
+struct GraphPrunerMetrics
+{
+        unsigned int prunings_;             ///< pruning runs
+        unsigned int key_frames_removed_;   ///< key frames pruned, with all their captures and features
+        unsigned int constraints_removed_;  ///< constraints on the key frames pruned
+        unsigned int constraints_added_;    ///< priors added in their place
+        Scalar solve_time_;                 ///< solver time reported by notifySolve(), in seconds
+        Scalar solve_time_saved_;           ///< estimation of the solver time saved, in seconds. See notifySolve().
+};
+
+/** \brief Pruning of the redundant key frames of a problem
+ *
+ * A key frame is redundant when:
+ *   - spatially: it is close to the previous key frame kept, both in position and in orientation,
+ *   - or by its information: each of its constraints gains little information on the states, given the others.
+ *
+ * The information gain of a constraint with residual r (weighted by the square root information),
+ * jacobian J and posterior covariance S of its states is -0.5 * log(det(I - J * S * J^T)).
+ * It is computed from the covariance store of the problem, filled by the solver, so this criterion needs
+ * the covariances of the states of each constraint (e.g. CeresManager::computeCovariances(ALL)).
+ * A key frame whose covariances are not known is not redundant by its information.
+ * Neither is a key frame with states of a prior added by a pruning after the covariances were computed:
+ * their covariance blocks do not account for the new linearization. See notifyCovariances().
+ *
+ * The first and the last key frames are never redundant.
+ * Each pruning only considers the key frames newer than the last key frame at the previous pruning, so that
+ * the cost of a pruning depends on the new key frames only. A key frame added in the past of the previous pruning
+ * is never considered.
+ *
+ * A pruned key frame is marginalized: its constraints are replaced by the dense prior they leave on the other states,
+ * see ConstraintMarginalization::marginalize(). For a key frame on an odometry chain, this is the composition
+ * of its two odometry constraints. Optionally, the prior is sparsified into a Chow-Liu tree of smaller priors,
+ * see ConstraintMarginalization::sparsify().
+ *
+ * The problem owns the pruner, see Problem::enableGraphPruning(), and the solver runs it before solving when it is due,
+ * see CeresManager::prune(). The pruner itself does not depend on the solver:
+ *
+ *   if (pruner_ptr->isDue())
+ *   {
+ *       FrameBaseList candidates;
+ *       pruner_ptr->getCandidateKeyFrames(candidates);
+ *       for (auto frame_ptr : candidates)
+ *       {
+ *           // linearize the constraints given by Problem::getConstraintsOnKeyFrame()
+ *           if (pruner_ptr->isRedundant(frame_ptr, linearized_constraints))
+ *               pruner_ptr->pruneKeyFrame(frame_ptr, linearized_constraints);
+ *       }
+ *   }
+ */
+class GraphPruner
+{
+    protected:
+        Problem* problem_ptr_;
+        GraphPrunerParams params_;
+        GraphPrunerMetrics metrics_;
+        TimeStamp last_pruning_ts_;     ///< time stamp of the last key frame at the last pruning
+        bool pruned_;                   ///< whether it pruned once at least
+        std::unordered_set<FrameBase*> spatially_redundant_; ///< candidates redundant by their position
+        std::unordered_set<StateBlock*> stale_states_;        ///< states with covariance blocks older than the priors on them
+
+    public:
+        GraphPruner(Problem* _problem_ptr, const GraphPrunerParams& _params);
+        ~GraphPruner();
+
+        const GraphPrunerParams& getParams() const;
+        void setParams(const GraphPrunerParams& _params);
+        const GraphPrunerMetrics& getMetrics() const;
+
+        /** \brief Whether there are enough new key frames since the last pruning
+         */
+        bool isDue() const;
+
+        /** \brief Gets the key frames which may be redundant, oldest first, and starts a pruning
+         *
+         * Of the key frames newer than the last key frame at the previous pruning, but the last one:
+         * the ones spatially redundant, and all of them if the information gain criterion is enabled.
+         */
+        void getCandidateKeyFrames(FrameBaseList& _frame_list);
+
+        /** \brief Whether a candidate key frame is redundant
+         * \param _frame_ptr a key frame given by getCandidateKeyFrames()
+         * \param _linearized_constraints the constraints given by Problem::getConstraintsOnKeyFrame(), linearized at the current state
+         */
+        bool isRedundant(FrameBase* _frame_ptr, const std::list<LinearizedConstraint>& _linearized_constraints);
+
+        /** \brief The largest information gain of the constraints, see GraphPruner
+         * \return the gain, in nats, or infinity if some covariance is not known or stale
+         */
+        Scalar computeInformationGain(const std::list<LinearizedConstraint>& _linearized_constraints);
+
+        /** \brief Replaces a key frame by the priors its constraints leave on the other states
+         * \param _frame_ptr the key frame
+         * \param _linearized_constraints the constraints given by Problem::getConstraintsOnKeyFrame(), linearized at the current state
+         */
+        void pruneKeyFrame(FrameBase* _frame_ptr, const std::list<LinearizedConstraint>& _linearized_constraints);
+
+        /** \brief Tells that the covariances of the problem were cleared, to be computed again
+         *
+         * The priors added so far are then accounted for in the covariances. Problem::clearCovariance() calls it.
+         */
+        void notifyCovariances();
+
+        /** \brief Accounts for a solve in the metrics
+         * \param _solve_time the time of the solve, in seconds
+         * \param _n_constraints the number of constraints solved
+         *
+         * The time saved is estimated from a cost linear in the number of constraints:
+         * _solve_time times the constraints removed net, over _n_constraints.
+         */
+        void notifySolve(Scalar _solve_time, unsigned int _n_constraints);
+};
+
+inline GraphPruner::~GraphPruner()
+{
+    //
+}
+
+inline const GraphPrunerParams& GraphPruner::getParams() const
+{
+    return params_;
+}
+
+inline void GraphPruner::setParams(const GraphPrunerParams& _params)
+{
+    params_ = _params;
+}
+
+inline const GraphPrunerMetrics& GraphPruner::getMetrics() const
+{
+    return metrics_;
+}
+
+inline void GraphPruner::notifyCovariances()
+{
+    stale_states_.clear();
+}
+
+} // namespace wolf
+
+#endif /* GRAPH_PRUNER_H_ */
@@ -0,0 +1,140 @@
+/**
+ * \file imu_tools.h
+ *
+ *  Created on: Jul 2, 2016
+ *      \author: jsola
+ */
+
+#ifndef IMU_TOOLS_H_
+#define IMU_TOOLS_H_
+
+#include "wolf.h"
+#include "rotations.h"
+
+namespace wolf
+{
+
+/*/////////////////////////////////////////////////////////
+ * Kernels of the IMU pre-integration
+ *
+ * The IMU delta is Delta = [Dp, Dv, Dq], of size 10, with the quaternion Dq = [qx, qy, qz, qw].
+ * Its tangent space, for covariances and Jacobians, is [Dp, Dv, Df], of size 9, with Df the angle vector of Dq.
+ * See ProcessorIMU for the maths.
+ *
+ * These functions take any Eigen vector and matrix types of the right sizes.
+ * With the fixed-size types of ProcessorIMU (Eigen::Matrix<Scalar,10,1> and Eigen::Matrix<Scalar,9,9>)
+ * nothing is allocated and Eigen unrolls all the 3x3 block operations.
+ */
+
+/** \brief Composes the delta _delta2 on top of the delta _delta1
+ *
+ * _delta1_plus_delta2 may be the same object as _delta1.
+ */
+template<typename D1, typename D2, typename D3>
+inline void imuDeltaPlusDelta(const Eigen::MatrixBase<D1>& _delta1, const Eigen::MatrixBase<D2>& _delta2,
+                              const typename D1::Scalar _dt, Eigen::MatrixBase<D3>& _delta1_plus_delta2)
+{
+    MatrixSizeCheck<10, 1>::check(_delta1);
+    MatrixSizeCheck<10, 1>::check(_delta2);
+    MatrixSizeCheck<10, 1>::check(_delta1_plus_delta2);
+    typedef typename D1::Scalar T;
+
+    Eigen::Quaternion<T> q1(_delta1.template segment<4>(6));
+    Eigen::Quaternion<T> q2(_delta2.template segment<4>(6));
+
+    // in the order p -> v -> q, so that _delta1 and _delta1_plus_delta2 can be the same object
+    _delta1_plus_delta2.template head<3>()     = _delta1.template head<3>() + _delta1.template segment<3>(3) * _dt
+                                                 + q1 * _delta2.template head<3>();
+    _delta1_plus_delta2.template segment<3>(3) = _delta1.template segment<3>(3) + q1 * _delta2.template segment<3>(3);
+    _delta1_plus_delta2.template segment<4>(6) = (q1 * q2).coeffs();
+}
+
+/** \brief Jacobians of imuDeltaPlusDelta() wrt both deltas
+ *
+ * The Jacobians have this structure, with R = R(Dq) and dR = R(dq):
+ *
+ *   _jacobian_delta1 = [ I   I*dt  -R*skew(dp)*Jr(Df) ]     _jacobian_delta2 = [ R  0  0      ]
+ *                      [ 0   I     -R*skew(dv)*Jr(Df) ]                        [ 0  R  0      ]
+ *                      [ 0   0      dR*Jr(Df)         ]                        [ 0  0  Jr(df) ]
+ *
+ * which is the one assumed by imuDeltaCovPlusDeltaCov().
+ */
+template<typename D1, typename D2, typename D3, typename D4>
+inline void imuDeltaPlusDeltaJacobians(const Eigen::MatrixBase<D1>& _delta1, const Eigen::MatrixBase<D2>& _delta2,
+                                       const typename D1::Scalar _dt, Eigen::MatrixBase<D3>& _jacobian_delta1,
+                                       Eigen::MatrixBase<D4>& _jacobian_delta2)
+{
+    MatrixSizeCheck<10, 1>::check(_delta1);
+    MatrixSizeCheck<10, 1>::check(_delta2);
+    MatrixSizeCheck<9, 9>::check(_jacobian_delta1);
+    MatrixSizeCheck<9, 9>::check(_jacobian_delta2);
+    typedef typename D1::Scalar T;
+
+    Eigen::Quaternion<T> q1(_delta1.template segment<4>(6));
+    Eigen::Quaternion<T> q2(_delta2.template segment<4>(6));
+    Eigen::Matrix<T, 3, 3> DR_1 = q1.matrix();
+    Eigen::Matrix<T, 3, 3> Jr_1 = jac_SO3_right(q2v<T>(q1));
+
+    _jacobian_delta1.setIdentity();
+    _jacobian_delta1.template block<3, 3>(0, 3) = Eigen::Matrix<T, 3, 3>::Identity() * _dt;
+    _jacobian_delta1.template block<3, 3>(0, 6) = - DR_1 * skew(_delta2.template head<3>()) * Jr_1;
+    _jacobian_delta1.template block<3, 3>(3, 6) = - DR_1 * skew(_delta2.template segment<3>(3)) * Jr_1;
+    _jacobian_delta1.template block<3, 3>(6, 6) = q2.matrix() * Jr_1;
+
+    _jacobian_delta2.setZero();
+    _jacobian_delta2.template block<3, 3>(0, 0) = DR_1;
+    _jacobian_delta2.template block<3, 3>(3, 3) = DR_1;
+    _jacobian_delta2.template block<3, 3>(6, 6) = jac_SO3_right(q2v<T>(q2));
+}
+
+/** \brief Propagates the covariances of two deltas to the covariance of their composition
+ *
+ * Computes _jacobian1 * _cov1 * _jacobian1' + _jacobian2 * _cov2 * _jacobian2'
+ * for Jacobians with the structure given by imuDeltaPlusDeltaJacobians(),
+ * skipping the products by the identity and zero blocks: 1134 multiplications instead of the 2916 of the dense products.
+ *
+ * _cov1_plus_cov2 may be the same object as _cov1.
+ */
+template<typename D1, typename D2, typename D3, typename D4, typename D5>
+inline void imuDeltaCovPlusDeltaCov(const Eigen::MatrixBase<D1>& _cov1, const Eigen::MatrixBase<D2>& _cov2,
+                                    const Eigen::MatrixBase<D3>& _jacobian1, const Eigen::MatrixBase<D4>& _jacobian2,
+                                    Eigen::MatrixBase<D5>& _cov1_plus_cov2)
+{
+    MatrixSizeCheck<9, 9>::check(_cov1);
+    MatrixSizeCheck<9, 9>::check(_cov2);
+    MatrixSizeCheck<9, 9>::check(_jacobian1);
+    MatrixSizeCheck<9, 9>::check(_jacobian2);
+    MatrixSizeCheck<9, 9>::check(_cov1_plus_cov2);
+    typedef typename D1::Scalar T;
+
+    const Eigen::Matrix<T, 3, 3> J_pv = _jacobian1.template block<3, 3>(0, 3);
+    const Eigen::Matrix<T, 3, 3> J_pf = _jacobian1.template block<3, 3>(0, 6);
+    const Eigen::Matrix<T, 3, 3> J_vf = _jacobian1.template block<3, 3>(3, 6);
+    const Eigen::Matrix<T, 3, 3> J_ff = _jacobian1.template block<3, 3>(6, 6);
+
+    // J1 * cov1, by blocks of rows
+    Eigen::Matrix<T, 9, 9> JP;
+    JP.template topRows<3>()       = _cov1.template topRows<3>() + J_pv * _cov1.template middleRows<3>(3)
+                                     + J_pf * _cov1.template bottomRows<3>();
+    JP.template middleRows<3>(3)   = _cov1.template middleRows<3>(3) + J_vf * _cov1.template bottomRows<3>();
+    JP.template bottomRows<3>()    = J_ff * _cov1.template bottomRows<3>();
+
+    // (J1 * cov1) * J1', by blocks of columns
+    Eigen::Matrix<T, 9, 9> cov;
+    cov.template leftCols<3>()     = JP.template leftCols<3>() + JP.template middleCols<3>(3) * J_pv.transpose()
+                                     + JP.template rightCols<3>() * J_pf.transpose();
+    cov.template middleCols<3>(3)  = JP.template middleCols<3>(3) + JP.template rightCols<3>() * J_vf.transpose();
+    cov.template rightCols<3>()    = JP.template rightCols<3>() * J_ff.transpose();
+
+    // + J2 * cov2 * J2', with J2 block-diagonal
+    for (unsigned int i = 0; i < 3; i++)
+        for (unsigned int j = 0; j < 3; j++)
+            cov.template block<3, 3>(3 * i, 3 * j) += _jacobian2.template block<3, 3>(3 * i, 3 * i)
+                    * _cov2.template block<3, 3>(3 * i, 3 * j) * _jacobian2.template block<3, 3>(3 * j, 3 * j).transpose();
+
+    _cov1_plus_cov2 = cov;
+}
+
+} // namespace wolf
+
+#endif /* IMU_TOOLS_H_ */
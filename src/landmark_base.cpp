@@ -92,9 +92,9 @@ void LandmarkBase::registerNewStateBlocks()
     if (getProblem() != nullptr)
     {
         if (p_ptr_ != nullptr)
-            getProblem()->addStateBlockPtr(p_ptr_);
+            getProblem()->addStateBlockPtr(p_ptr_, ST_LANDMARK);
         if (o_ptr_ != nullptr)
-            getProblem()->addStateBlockPtr(o_ptr_);
+            getProblem()->addStateBlockPtr(o_ptr_, ST_LANDMARK);
     }
 }
 
@@ -102,15 +102,15 @@ YAML::Node LandmarkBase::saveToYaml() const
 {
     YAML::Node node;
     node["id"] = landmark_id_;
-    node["type"] = node_type_;
+    node["type"] = node_type_.str();
     if (p_ptr_ != nullptr)
     {
-        node["position"] = p_ptr_->getVector();
+        node["position"] = Eigen::VectorXs(p_ptr_->getVector());
         node["position fixed"] = p_ptr_->isFixed();
     }
     if (o_ptr_ != nullptr)
     {
-        node["orientation"] = o_ptr_->getVector();
+        node["orientation"] = Eigen::VectorXs(o_ptr_->getVector());
         node["orientation fixed"] = p_ptr_->isFixed();
     }
     return node;
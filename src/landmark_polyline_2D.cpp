@@ -67,7 +67,7 @@ void LandmarkPolyline2D::setLast(const Eigen::VectorXs& _point, bool _defined)
     	defineExtreme(true);
 }
 
-const Eigen::VectorXs& LandmarkPolyline2D::getPointVector(int _i) const
+Eigen::Map<const Eigen::VectorXs> LandmarkPolyline2D::getPointVector(int _i) const
 {
 	//std::cout << "LandmarkPolyline2D::getPointVector: " << _i << std::endl;
 	//std::cout << "First: " << first_id_ << " - size: " << point_state_ptr_vector_.size() << std::endl;
@@ -100,7 +100,7 @@ void LandmarkPolyline2D::addPoint(const Eigen::VectorXs& _point, const bool& _de
                                                                  new LocalParametrizationPolylineExtreme(point_state_ptr_vector_.back()) :
                                                                  nullptr)));
         if (getProblem() != nullptr)
-        	getProblem()->addStateBlockPtr(point_state_ptr_vector_.back());
+        	getProblem()->addStateBlockPtr(point_state_ptr_vector_.back(), ST_LANDMARK);
         last_defined_ = _defined;
 		assert(point_state_ptr_vector_.back()->hasLocalParametrization() ? !last_defined_ : last_defined_);
     }
@@ -111,7 +111,7 @@ void LandmarkPolyline2D::addPoint(const Eigen::VectorXs& _point, const bool& _de
                                                                   new LocalParametrizationPolylineExtreme(point_state_ptr_vector_.front()) :
                                                                   nullptr)));
         if (getProblem() != nullptr)
-        	getProblem()->addStateBlockPtr(point_state_ptr_vector_.front());
+        	getProblem()->addStateBlockPtr(point_state_ptr_vector_.front(), ST_LANDMARK);
         first_defined_ = _defined;
         first_id_--;
 		assert(point_state_ptr_vector_.front()->hasLocalParametrization() ? !first_defined_ : first_defined_);
@@ -142,7 +142,7 @@ void LandmarkPolyline2D::addPoints(const Eigen::MatrixXs& _points, const unsigne
         															 new LocalParametrizationPolylineExtreme(point_state_ptr_vector_.back()) :
         															 nullptr)));
         	if (getProblem() != nullptr)
-        		getProblem()->addStateBlockPtr(point_state_ptr_vector_.back());
+        		getProblem()->addStateBlockPtr(point_state_ptr_vector_.back(), ST_LANDMARK);
         }
         last_defined_ = _defined;
 		assert(point_state_ptr_vector_.back()->hasLocalParametrization() ? !last_defined_ : last_defined_);
@@ -157,7 +157,7 @@ void LandmarkPolyline2D::addPoints(const Eigen::MatrixXs& _points, const unsigne
         															  new LocalParametrizationPolylineExtreme(point_state_ptr_vector_.front()) :
         															  nullptr)));
         	if (getProblem() != nullptr)
-        		getProblem()->addStateBlockPtr(point_state_ptr_vector_.front());
+        		getProblem()->addStateBlockPtr(point_state_ptr_vector_.front(), ST_LANDMARK);
             first_id_--;
         }
 		first_defined_ = _defined;
@@ -182,7 +182,7 @@ void LandmarkPolyline2D::defineExtreme(const bool _back)
     state->removeLocalParametrization();
 
     if (getProblem() != nullptr)
-    	getProblem()->addStateBlockPtr(state);
+    	getProblem()->addStateBlockPtr(state, ST_LANDMARK);
 
     // remove and add all constraints to the point
     for (auto ctr_ptr : *getConstrainedByListPtr())
@@ -320,7 +320,7 @@ void LandmarkPolyline2D::registerNewStateBlocks()
     LandmarkBase::registerNewStateBlocks();
 	if (getProblem() != nullptr)
 		for (auto state : point_state_ptr_vector_)
-			getProblem()->addStateBlockPtr(state);
+			getProblem()->addStateBlockPtr(state, ST_LANDMARK);
 }
 
 // static
@@ -369,7 +369,7 @@ YAML::Node LandmarkPolyline2D::saveToYaml() const
 
     for (int i = 0; i < npoints; i++)
     {
-        node["points"].push_back(point_state_ptr_vector_[i]->getVector());
+        node["points"].push_back(Eigen::VectorXs(point_state_ptr_vector_[i]->getVector()));
     }
 
     return node;
@@ -68,7 +68,7 @@ class LandmarkPolyline2D : public LandmarkBase
 		int getFirstId() const;
 		int getLastId() const;
 
-        const Eigen::VectorXs& getPointVector(int _i) const;
+        Eigen::Map<const Eigen::VectorXs> getPointVector(int _i) const;
 
         StateBlock* getPointStateBlockPtr(int _i);
 
@@ -8,23 +8,114 @@
 #ifndef SRC_MOTIONBUFFER_H_
 #define SRC_MOTIONBUFFER_H_
 
-#include <list>
+#include <vector>
 #include <algorithm>
+#include <iterator>
 
 namespace wolf {
 
 
-struct Motion
+/** \brief One instance of the buffered data, corresponding to a particular time stamp.
+ *
+ * The sizes of the deltas and of their covariances are template parameters.
+ * When they are fixed at compile time, a Motion is a plain block of memory,
+ * and creating, copying or buffering it does not touch the heap.
+ * Use Eigen::Dynamic for sizes only known at run time (this is the Motion typedef below).
+ *
+ * Note: DeltaCovSize is the size of the tangent space of the delta, which may be smaller than DeltaSize (e.g. with quaternions).
+ */
+template <int DeltaSize, int DeltaCovSize>
+struct MotionT
 {
     public:
+        typedef Eigen::Matrix<Scalar, DeltaSize, 1> DeltaType;
+        typedef Eigen::Matrix<Scalar, DeltaCovSize, DeltaCovSize, Eigen::RowMajor> DeltaCovType;
+
         TimeStamp ts_;                  ///< Time stamp
-        Eigen::VectorXs delta_;         ///< instantaneous motion delta
-        Eigen::VectorXs delta_integr_;  ///< the integrated motion or delta-integral
-        Eigen::MatrixXs delta_cov_;     ///< covariance of the integrated delta
-        Eigen::MatrixXs delta_integr_cov_;///< covariance of the integrated delta
-        Eigen::MatrixXs jacobian_0;     ///< Jacobian of the integrated delta wrt the initial delta
-        Eigen::MatrixXs jacobian_ts;    ///< Jacobian of the integrated delta wrt the current delta
-}; ///< One instance of the buffered data, corresponding to a particular time stamp.
+        DeltaType delta_;               ///< instantaneous motion delta
+        DeltaType delta_integr_;        ///< the integrated motion or delta-integral
+        DeltaCovType delta_cov_;        ///< covariance of the integrated delta
+        DeltaCovType delta_integr_cov_; ///< covariance of the integrated delta
+        DeltaCovType jacobian_0;        ///< Jacobian of the integrated delta wrt the previous integrated delta
+        DeltaCovType jacobian_ts;       ///< Jacobian of the integrated delta wrt the current delta
+
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW; // to guarantee alignment (see http://eigen.tuxfamily.org/dox-devel/group__TopicStructHavingEigenMembers.html)
+};
+
+typedef MotionT<Eigen::Dynamic, Eigen::Dynamic> Motion; ///< Motion with run-time sizes
+
+
+/** \brief Parameters of the decimation of a motion buffer. See MotionBufferT::decimate().
+ */
+struct MotionDecimation
+{
+        MotionDecimationPolicy policy_; ///< the decimation policy
+        std::size_t max_size_;          ///< the buffer is decimated when it grows beyond this size, down to half of it
+        Scalar threshold_;              ///< DEC_TIME: minimum time between Motions. DEC_ERROR: maximum query error. Must be positive.
+};
+
+
+/** \brief Contiguous storage for Motions.
+ *
+ * This is a std::vector whose head is allowed to advance:
+ *   - Dropping Motions at the front is O(1), and so is pushing them back at the front while there are free slots there.
+ *   - The slots freed at the front are recycled before the vector is allowed to grow.
+ *   - Once enough capacity has been reserve()'d, pushing Motions at the back does not allocate.
+ */
+template <class MotionType>
+class MotionContainerT
+{
+    public:
+        typedef std::vector<MotionType, Eigen::aligned_allocator<MotionType> > Storage;
+        typedef MotionType value_type;
+        typedef typename Storage::iterator iterator;
+        typedef typename Storage::const_iterator const_iterator;
+        typedef std::reverse_iterator<iterator> reverse_iterator;
+        typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+        MotionContainerT();
+
+        iterator begin();
+        iterator end();
+        const_iterator begin() const;
+        const_iterator end() const;
+        reverse_iterator rbegin();
+        reverse_iterator rend();
+        const_reverse_iterator rbegin() const;
+        const_reverse_iterator rend() const;
+
+        std::size_t size() const;
+        bool empty() const;
+        MotionType& front();
+        MotionType& back();
+        const MotionType& front() const;
+        const MotionType& back() const;
+        MotionType& operator[](std::size_t _i);
+        const MotionType& operator[](std::size_t _i) const;
+
+        void push_back(const MotionType& _motion);
+        void push_back(MotionType&& _motion);
+        void push_front(const MotionType& _motion);
+        template <class InputIterator>
+        void insert(iterator _position, InputIterator _first, InputIterator _last);
+        iterator erase(iterator _first, iterator _last);
+        void clear();
+        void swap(MotionContainerT& _other);
+
+        /** \brief Allocates room for _capacity Motions, so that they can be pushed back without allocating
+         */
+        void reserve(std::size_t _capacity);
+        std::size_t capacity() const;
+
+    private:
+        /** \brief Moves the valid Motions to the beginning of the storage, freeing the slots at the end.
+         */
+        void recycle();
+
+    private:
+        Storage storage_;
+        std::size_t head_; ///< index in storage_ of the first valid Motion
+};
 
 
 /** \brief class for motion buffers.
@@ -42,88 +133,406 @@ struct Motion
  *   - The returned motion-integral or delta-integral is the one immediately before the query time stamp.
  *   - If the query time stamp is later than the last one in the buffer, the last motion-integral or delta-integral is returned.
  *   - It is an error if the query time stamp is earlier than the beginning of the buffer.
+ *
+ * The Motions are stored in a MotionContainerT, ordered by time stamp.
+ * Since the container has random access, queries are solved by binary search, in O(log n).
+ * Appending new Motions at the back is O(1).
+ * Splitting the buffer costs O(min(n_old, n_new)), that is, it only moves the smallest of the two resulting parts.
+ * Key-frames are usually created close to the most recent Motion, so in practice this is a handful of Motions.
+ *
+ * The buffer may be decimated to bound its memory when key-frames are far apart, see decimate().
  */
-class MotionBuffer{
+template <class MotionType>
+class MotionBufferT{
     public:
-        const Eigen::VectorXs& getDelta(const TimeStamp& _ts) const;
-        void getDelta(const TimeStamp& _ts, Eigen::VectorXs& _delta_integr) const;
-        const Motion& getMotion(const TimeStamp& _ts) const;
-        void getMotion(const TimeStamp& _ts, Motion& _motion) const;
-        void split(const TimeStamp& _ts, MotionBuffer& _oldest_buffer);
-        std::list<Motion>& get();
-        const std::list<Motion>& get() const;
+        typedef MotionContainerT<MotionType> Container;
+        typedef typename MotionType::DeltaType DeltaType;
+
+        const DeltaType& getDelta(const TimeStamp& _ts) const;
+        void getDelta(const TimeStamp& _ts, DeltaType& _delta_integr) const;
+        const MotionType& getMotion(const TimeStamp& _ts) const;
+        void getMotion(const TimeStamp& _ts, MotionType& _motion) const;
+        void split(const TimeStamp& _ts, MotionBufferT& _oldest_buffer);
+
+        /** \brief Decimates the buffer if it is larger than _max_size
+         * \param _policy the decimation policy
+         * \param _max_size the buffer is decimated down to _max_size / 2 Motions when it has more than _max_size
+         * \param _threshold the threshold of the policy. It is doubled whenever no more Motions can be merged and the size is not met yet.
+         * \param _merge functor merge(previous, first, second) merging the Motion first into the consecutive Motion second.
+         *        It must set second.delta_ and second.delta_cov_ to the composition of both deltas,
+         *        and second.jacobian_0 and second.jacobian_ts to the Jacobians of the integration from previous.
+         * \return the number of Motions removed
+         *
+         * The first and last Motions are never removed, and the integrated deltas and their covariances are not modified.
+         * Therefore, the queries at the time stamps of the remaining Motions return the same as before decimation,
+         * and the queries in between return the previous remaining Motion.
+         * With DEC_ERROR, the threshold bounds the difference of the integrated deltas returned by such queries.
+         */
+        template <class MergeFunctor>
+        std::size_t decimate(MotionDecimationPolicy _policy, std::size_t _max_size, Scalar& _threshold, MergeFunctor _merge);
+
+        Container& get();
+        const Container& get() const;
 
     private:
-        std::list<Motion> container_;
+        /** \brief Finds the first Motion strictly newer than the query time stamp
+         * \return an iterator to the first Motion with ts_ > _ts, or end() if there is none.
+         */
+        typename Container::const_iterator findNewer(const TimeStamp& _ts) const;
+        typename Container::iterator findNewer(const TimeStamp& _ts);
+
+    private:
+        Container container_;
 };
 
-inline const Eigen::VectorXs& MotionBuffer::getDelta(const TimeStamp& _ts) const
+typedef MotionBufferT<Motion> MotionBuffer;
+typedef MotionBuffer::Container MotionContainer;
+
+
+////////////////////////////////////////////////////////
+// IMPLEMENTATION MotionContainerT
+
+template <class MotionType>
+inline MotionContainerT<MotionType>::MotionContainerT() :
+        head_(0)
+{
+    //
+}
+
+template <class MotionType>
+inline typename MotionContainerT<MotionType>::iterator MotionContainerT<MotionType>::begin()
+{
+    return storage_.begin() + head_;
+}
+
+template <class MotionType>
+inline typename MotionContainerT<MotionType>::iterator MotionContainerT<MotionType>::end()
+{
+    return storage_.end();
+}
+
+template <class MotionType>
+inline typename MotionContainerT<MotionType>::const_iterator MotionContainerT<MotionType>::begin() const
+{
+    return storage_.begin() + head_;
+}
+
+template <class MotionType>
+inline typename MotionContainerT<MotionType>::const_iterator MotionContainerT<MotionType>::end() const
+{
+    return storage_.end();
+}
+
+template <class MotionType>
+inline typename MotionContainerT<MotionType>::reverse_iterator MotionContainerT<MotionType>::rbegin()
+{
+    return reverse_iterator(end());
+}
+
+template <class MotionType>
+inline typename MotionContainerT<MotionType>::reverse_iterator MotionContainerT<MotionType>::rend()
+{
+    return reverse_iterator(begin());
+}
+
+template <class MotionType>
+inline typename MotionContainerT<MotionType>::const_reverse_iterator MotionContainerT<MotionType>::rbegin() const
+{
+    return const_reverse_iterator(end());
+}
+
+template <class MotionType>
+inline typename MotionContainerT<MotionType>::const_reverse_iterator MotionContainerT<MotionType>::rend() const
+{
+    return const_reverse_iterator(begin());
+}
+
+template <class MotionType>
+inline std::size_t MotionContainerT<MotionType>::size() const
+{
+    return storage_.size() - head_;
+}
+
+template <class MotionType>
+inline bool MotionContainerT<MotionType>::empty() const
+{
+    return storage_.size() == head_;
+}
+
+template <class MotionType>
+inline MotionType& MotionContainerT<MotionType>::front()
+{
+    return storage_[head_];
+}
+
+template <class MotionType>
+inline MotionType& MotionContainerT<MotionType>::back()
+{
+    return storage_.back();
+}
+
+template <class MotionType>
+inline const MotionType& MotionContainerT<MotionType>::front() const
+{
+    return storage_[head_];
+}
+
+template <class MotionType>
+inline const MotionType& MotionContainerT<MotionType>::back() const
+{
+    return storage_.back();
+}
+
+template <class MotionType>
+inline MotionType& MotionContainerT<MotionType>::operator[](std::size_t _i)
+{
+    return storage_[head_ + _i];
+}
+
+template <class MotionType>
+inline const MotionType& MotionContainerT<MotionType>::operator[](std::size_t _i) const
+{
+    return storage_[head_ + _i];
+}
+
+template <class MotionType>
+inline void MotionContainerT<MotionType>::push_back(const MotionType& _motion)
+{
+    if (storage_.size() == storage_.capacity() && 2 * head_ >= storage_.size())
+        recycle();
+    storage_.push_back(_motion);
+}
+
+template <class MotionType>
+inline void MotionContainerT<MotionType>::push_back(MotionType&& _motion)
+{
+    if (storage_.size() == storage_.capacity() && 2 * head_ >= storage_.size())
+        recycle();
+    storage_.push_back(std::move(_motion));
+}
+
+template <class MotionType>
+inline void MotionContainerT<MotionType>::push_front(const MotionType& _motion)
+{
+    if (head_ > 0)
+        storage_[--head_] = _motion;
+    else
+        storage_.insert(storage_.begin(), _motion);
+}
+
+template <class MotionType>
+template <class InputIterator>
+inline void MotionContainerT<MotionType>::insert(iterator _position, InputIterator _first, InputIterator _last)
+{
+    storage_.insert(_position, _first, _last);
+}
+
+template <class MotionType>
+inline typename MotionContainerT<MotionType>::iterator MotionContainerT<MotionType>::erase(iterator _first, iterator _last)
+{
+    if (_first != begin())
+        return storage_.erase(_first, _last);
+
+    // Erasing at the front just advances the head
+    head_ += std::distance(_first, _last);
+    if (head_ == storage_.size())
+        clear();
+    return begin();
+}
+
+template <class MotionType>
+inline void MotionContainerT<MotionType>::clear()
+{
+    storage_.clear();
+    head_ = 0;
+}
+
+template <class MotionType>
+inline void MotionContainerT<MotionType>::swap(MotionContainerT& _other)
+{
+    storage_.swap(_other.storage_);
+    std::swap(head_, _other.head_);
+}
+
+template <class MotionType>
+inline void MotionContainerT<MotionType>::reserve(std::size_t _capacity)
+{
+    storage_.reserve(head_ + _capacity);
+}
+
+template <class MotionType>
+inline std::size_t MotionContainerT<MotionType>::capacity() const
+{
+    return storage_.capacity() - head_;
+}
+
+template <class MotionType>
+inline void MotionContainerT<MotionType>::recycle()
+{
+    std::move(storage_.begin() + head_, storage_.end(), storage_.begin());
+    storage_.erase(storage_.end() - head_, storage_.end());
+    head_ = 0;
+}
+
+
+////////////////////////////////////////////////////////
+// IMPLEMENTATION MotionBufferT
+
+template <class MotionType>
+inline const typename MotionBufferT<MotionType>::DeltaType& MotionBufferT<MotionType>::getDelta(const TimeStamp& _ts) const
 {
     return getMotion(_ts).delta_integr_;
 }
 
-inline void MotionBuffer::getDelta(const TimeStamp& _ts, Eigen::VectorXs& _delta_integr) const
+template <class MotionType>
+inline void MotionBufferT<MotionType>::getDelta(const TimeStamp& _ts, DeltaType& _delta_integr) const
 {
     _delta_integr = getMotion(_ts).delta_integr_;
 }
 
-inline const Motion& MotionBuffer::getMotion(const TimeStamp& _ts) const
+template <class MotionType>
+inline typename MotionBufferT<MotionType>::Container::const_iterator MotionBufferT<MotionType>::findNewer(const TimeStamp& _ts) const
 {
-    //assert((container_.front().ts_ <= _ts) && "Query time stamp out of buffer bounds");
-    auto previous = std::find_if(container_.rbegin(), container_.rend(), [&](const Motion& m)
+    return std::upper_bound(container_.begin(), container_.end(), _ts, [](const TimeStamp& ts, const MotionType& m)
     {
-        return m.ts_ <= _ts;
+        return ts < m.ts_;
     });
-    if (previous == container_.rend())
-        // The time stamp is older than the buffer's oldest data.
-        // We could do something here, and throw an error or something, but by now we'll return the first valid data
-        previous--;
-
-    return *previous;
 }
 
-inline void MotionBuffer::getMotion(const TimeStamp& _ts, Motion& _motion) const
+template <class MotionType>
+inline typename MotionBufferT<MotionType>::Container::iterator MotionBufferT<MotionType>::findNewer(const TimeStamp& _ts)
 {
-    //assert((container_.front().ts_ <= _ts) && "Query time stamp out of buffer bounds");
-    auto previous = std::find_if(container_.rbegin(), container_.rend(), [&](const Motion& m)
+    return std::upper_bound(container_.begin(), container_.end(), _ts, [](const TimeStamp& ts, const MotionType& m)
     {
-        return m.ts_ <= _ts;
+        return ts < m.ts_;
     });
-    if (previous == container_.rend())
+}
+
+template <class MotionType>
+inline const MotionType& MotionBufferT<MotionType>::getMotion(const TimeStamp& _ts) const
+{
+    //assert((container_.front().ts_ <= _ts) && "Query time stamp out of buffer bounds");
+    auto next = findNewer(_ts);
+    if (next == container_.begin())
         // The time stamp is older than the buffer's oldest data.
-        // We could do something here, but by now we'll return the last valid data
-        previous--;
+        // We could do something here, and throw an error or something, but by now we'll return the first valid data
+        return container_.front();
 
-    _motion = *previous;
+    return *(--next);
+}
+
+template <class MotionType>
+inline void MotionBufferT<MotionType>::getMotion(const TimeStamp& _ts, MotionType& _motion) const
+{
+    _motion = getMotion(_ts);
 }
 
 
-inline void MotionBuffer::split(const TimeStamp& _ts, MotionBuffer& _oldest_buffer)
+template <class MotionType>
+inline void MotionBufferT<MotionType>::split(const TimeStamp& _ts, MotionBufferT& _oldest_buffer)
 {
     assert((container_.front().ts_ <= _ts) && "Query time stamp out of buffer bounds");
-    auto previous = std::find_if(container_.rbegin(), container_.rend(), [&](const Motion& m)
-    {
-        return m.ts_ <= _ts;
-    });
-    if (previous == container_.rend())
+    auto next = findNewer(_ts);
+    if (next == container_.begin())
     {
-        // The time stamp is more recent than the buffer's most recent data:
+        // The time stamp is older than the buffer's oldest data:
         // return an empty buffer as the _oldest_buffer
         _oldest_buffer.get().clear();
+        return;
+    }
+
+    std::size_t n_old = std::distance(container_.begin(), next);
+    std::size_t n_new = container_.size() - n_old;
+
+    if (_oldest_buffer.container_.empty() && n_new < n_old)
+    {
+        // Hand the whole storage over to _oldest_buffer, and bring back only the newest part.
+        // We keep our former capacity, so that this buffer can go on growing without allocating.
+        container_.swap(_oldest_buffer.container_);
+        container_.reserve(_oldest_buffer.container_.capacity());
+        auto first_new = _oldest_buffer.container_.begin() + n_old;
+        container_.insert(container_.end(),
+                          std::make_move_iterator(first_new),
+                          std::make_move_iterator(_oldest_buffer.container_.end()));
+        _oldest_buffer.container_.erase(first_new, _oldest_buffer.container_.end());
     }
     else
     {
-        // Transfer part of the buffer
-        _oldest_buffer.container_.splice(_oldest_buffer.container_.begin(), container_, container_.begin(), (previous--).base());
+        // Transfer the oldest part of the buffer
+        _oldest_buffer.container_.insert(_oldest_buffer.container_.begin(),
+                                         std::make_move_iterator(container_.begin()),
+                                         std::make_move_iterator(next));
+        container_.erase(container_.begin(), next);
     }
 }
 
-inline std::list<Motion>& MotionBuffer::get()
+template <class MotionType>
+template <class MergeFunctor>
+inline std::size_t MotionBufferT<MotionType>::decimate(MotionDecimationPolicy _policy, std::size_t _max_size, Scalar& _threshold,
+                                                       MergeFunctor _merge)
+{
+    if (_policy == DEC_NONE || container_.size() <= _max_size)
+        return 0;
+
+    assert((_policy == DEC_COUNT || _threshold > 0) && "MotionBuffer::decimate: threshold must be positive");
+
+    std::size_t n_initial = container_.size();
+    while (container_.size() > _max_size / 2 && container_.size() > 2)
+    {
+        // One pass: consecutive Motions 'first' (at index r) and 'second' (r+1) are merged into 'second'.
+        // The remaining Motions are compacted towards the front; 'previous' (at index out) is the last one kept.
+        std::size_t n = container_.size();
+        std::size_t out = 0;
+        std::size_t r = 1;
+        while (r + 1 < n)
+        {
+            bool merge;
+            switch (_policy)
+            {
+                case DEC_TIME:
+                    merge = (container_[r + 1].ts_ - container_[out].ts_ <= _threshold);
+                    break;
+                case DEC_ERROR:
+                    merge = ((container_[r].delta_integr_ - container_[out].delta_integr_).norm() <= _threshold);
+                    break;
+                default:
+                    merge = true;
+                    break;
+            }
+            if (merge)
+            {
+                _merge(container_[out], container_[r], container_[r + 1]);
+                container_[++out] = std::move(container_[r + 1]);
+                r += 2;
+            }
+            else
+            {
+                if (++out != r)
+                    container_[out] = std::move(container_[r]);
+                r++;
+            }
+        }
+        for (; r < n; r++)
+            if (++out != r)
+                container_[out] = std::move(container_[r]);
+        container_.erase(container_.begin() + out + 1, container_.end());
+
+        // nothing left to merge at this threshold: relax it
+        if (out + 1 == n)
+            _threshold *= 2;
+    }
+
+    return n_initial - container_.size();
+}
+
+template <class MotionType>
+inline typename MotionBufferT<MotionType>::Container& MotionBufferT<MotionType>::get()
 {
     return container_;
 }
 
-inline const std::list<Motion>& MotionBuffer::get() const
+template <class MotionType>
+inline const typename MotionBufferT<MotionType>::Container& MotionBufferT<MotionType>::get() const
 {
     return container_;
 }
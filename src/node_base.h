@@ -3,7 +3,10 @@
 
 // Wolf includes
 #include "wolf.h"
+#include "node_tag.h"
 
+// std includes
+#include <atomic>
 
 namespace wolf {
 
@@ -50,17 +53,20 @@ namespace wolf {
  *
  *    Finally, all the other node names in the Wolf Tree are not required, and in fact they are not used for anything.
  *
+ * The class, type and name are interned in NodeTag's, so that nodes of the same type share their text.
+ * Check the type of a node by comparing tags, e.g. getTypeTag() == NodeTag("EPIPOLAR"), rather than texts.
+ *
  **/
 class NodeBase
 {
     private:
-        static unsigned int node_id_count_; ///< Object counter (acts as simple ID factory)
+        static std::atomic<unsigned int> node_id_count_; ///< Object counter (acts as simple ID factory). Atomic, for nodes created in the key frame callback preparations.
 
     protected:
         unsigned int node_id_;   ///< Node id. It is unique over the whole Wolf Tree
-        std::string node_class_; ///< Text label identifying the class of node ("SENSOR", "FEATURE", etc)
-        std::string node_type_;  ///< Text label identifying the type or subclass of node ("Pin Hole", "Point 2D", etc)
-        std::string node_name_;  ///< Text label identifying each specific object ("left camera", "LIDAR 1", "PointGrey", "Andrew", etc)
+        NodeTag node_class_;     ///< Text label identifying the class of node ("SENSOR", "FEATURE", etc)
+        NodeTag node_type_;      ///< Text label identifying the type or subclass of node ("Pin Hole", "Point 2D", etc)
+        NodeTag node_name_;      ///< Text label identifying each specific object ("left camera", "LIDAR 1", "PointGrey", "Andrew", etc)
 
     public: 
 
@@ -69,10 +75,13 @@ class NodeBase
 
         unsigned int nodeId() const;
         std::string getClass() const;
-        std::string getType() const {return node_type_;}
+        std::string getType() const {return node_type_.str();}
         std::string getName() const;
+        NodeTag getClassTag() const;
+        NodeTag getTypeTag() const {return node_type_;}
+        NodeTag getNameTag() const;
 
-        void setType(const std::string& _name){node_type_ = _name;};
+        void setType(const std::string& _name){node_type_ = NodeTag(_name);};
         void setName(const std::string& _name);
 };
 
@@ -100,17 +109,27 @@ inline unsigned int NodeBase::nodeId() const
 
 inline std::string NodeBase::getClass() const
 {
-    return node_class_;
+    return node_class_.str();
 }
 
 inline std::string NodeBase::getName() const
+{
+    return node_name_.str();
+}
+
+inline NodeTag NodeBase::getClassTag() const
+{
+    return node_class_;
+}
+
+inline NodeTag NodeBase::getNameTag() const
 {
     return node_name_;
 }
 
 inline void NodeBase::setName(const std::string& _name)
 {
-    node_name_ = _name;
+    node_name_ = NodeTag(_name);
 }
 
 } // namespace wolf
@@ -21,6 +21,7 @@
 
 //wolf includes
 #include "node_base.h"
+#include "node_list.h"
 #include "wolf.h"
 
 namespace wolf
@@ -38,6 +39,8 @@ class Problem;
  *  - An unique ID to identify it over the whole Wolf Tree (inherited from NodeBase)
  *  - An enum indicating the node location in the tree (see NodeLocation enum in wolf.h)
  *  - down_node_list_: A list of pointers to derived node objects, specified by the template parameter LowerType.
+ *    Its container is chosen for each LowerType by DownNodeList: a std::list by default, or the intrusive NodeList.
+ *    For the latter, the links are in each node, inherited from NodeListHook.
  *  - up_node_: A pointer to a derived node object, specified by the template parameter UpperType.
  *  - A unique class name, inherited from NodeBase, strictly within this range of possibilities:
  *    - "UNDEFINED"     : used for NodeTerminus
@@ -64,14 +67,14 @@ class Problem;
  *    - "Lidar 2D processor"
  */
 template<class UpperType, class LowerType>
-class NodeLinked : public NodeBase
+class NodeLinked : public NodeBase, public NodeListHook
 {
     public:
         typedef UpperType* UpperNodePtr;
         typedef LowerType* LowerNodePtr;
 
     protected:
-        typedef std::list<LowerNodePtr> LowerNodeList;
+        typedef typename DownNodeList<LowerType>::Type LowerNodeList;
         typedef typename LowerNodeList::iterator LowerNodeIter;
 
     protected:
@@ -251,8 +254,9 @@ NodeLinked<UpperType, LowerType>::~NodeLinked()
 
     while (!down_node_list_.empty())
     {
-        delete down_node_list_.front();
+        LowerNodePtr down_node_ptr = down_node_list_.front();
         down_node_list_.pop_front();
+        delete down_node_ptr;
     }
 }
 
@@ -393,8 +397,9 @@ template<class UpperType, class LowerType>
 inline void NodeLinked<UpperType, LowerType>::removeDownNode(const LowerNodeIter& _iter)
 {
     //(*_iter)->unlinkFromUpperNode();
+    LowerNodePtr down_node_ptr = *_iter;
     down_node_list_.erase(_iter);
-    delete *_iter;
+    delete down_node_ptr;
 }
 
 template<class UpperType, class LowerType>
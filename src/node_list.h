@@ -0,0 +1,295 @@
+/**
+ * \file node_list.h
+ *
+ *  Created on: Jul 9, 2016
+ *      \author: jsola
+ */
+
+#ifndef SRC_NODE_LIST_H_
+#define SRC_NODE_LIST_H_
+
+#include "wolf.h"
+
+// STL includes
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <list>
+
+namespace wolf {
+
+/** \brief Links of a node in the NodeList of its parent
+ */
+class NodeListHook
+{
+    public:
+        NodeListHook() : prev_(nullptr), next_(nullptr) { }
+        NodeListHook(const NodeListHook&) : prev_(nullptr), next_(nullptr) { } // a copy is in no list
+        NodeListHook& operator=(const NodeListHook&) { return *this; }
+
+        bool isLinked() const { return next_ != nullptr; }
+
+    private:
+        template<class T> friend class NodeList;
+
+        NodeListHook* prev_;
+        NodeListHook* next_;
+};
+
+/** \brief Intrusive doubly linked list of nodes
+ *
+ * The links are in the nodes themselves, which derive from NodeListHook, instead of in separately allocated list nodes.
+ * Thus, inserting allocates nothing, traversing reads only the nodes, and removing a node given its pointer is O(1).
+ *
+ * The interface is the subset of std::list<T*> used by NodeLinked for its down nodes, so that each level of the Wolf tree
+ * can choose its container (see DownNodeList).
+ *
+ * A node can only be in one NodeList at a time: the one of its parent in the Wolf tree.
+ * The list does not own the nodes.
+ */
+template<class T>
+class NodeList
+{
+    public:
+        typedef T* value_type;
+
+        class iterator : public std::iterator<std::bidirectional_iterator_tag, T*>
+        {
+            public:
+                iterator() : hook_ptr_(nullptr) { }
+                explicit iterator(NodeListHook* _hook_ptr) : hook_ptr_(_hook_ptr) { }
+
+                T* operator*() const { return NodeList::node(hook_ptr_); }
+                iterator& operator++() { hook_ptr_ = hook_ptr_->next_; return *this; }
+                iterator operator++(int) { iterator it(*this); hook_ptr_ = hook_ptr_->next_; return it; }
+                iterator& operator--() { hook_ptr_ = hook_ptr_->prev_; return *this; }
+                iterator operator--(int) { iterator it(*this); hook_ptr_ = hook_ptr_->prev_; return it; }
+                bool operator==(const iterator& _other) const { return hook_ptr_ == _other.hook_ptr_; }
+                bool operator!=(const iterator& _other) const { return hook_ptr_ != _other.hook_ptr_; }
+
+            private:
+                friend class NodeList;
+                NodeListHook* hook_ptr_;
+        };
+        typedef iterator const_iterator;
+
+        NodeList();
+        ~NodeList();
+
+        iterator begin() const;
+        iterator end() const;
+        bool empty() const;
+        std::size_t size() const;
+        T* front() const;
+        T* back() const;
+
+        void push_back(T* _ptr);
+        void push_front(T* _ptr);
+        void pop_front();
+        void pop_back();
+        iterator insert(iterator _place, T* _ptr);
+        iterator erase(iterator _it);
+
+        /** \brief Removes the node from this list, in O(1)
+         *
+         * _ptr must be in this list, or in none.
+         */
+        void remove(T* _ptr);
+
+        /** \brief Moves all nodes of _other to this list, before _place
+         */
+        void splice(iterator _place, NodeList& _other);
+
+        /** \brief Removes all nodes from this list
+         */
+        void clear();
+
+    private:
+        NodeList(const NodeList&);              // not copyable: the nodes link to one list only
+        NodeList& operator=(const NodeList&);
+
+        static NodeListHook* hook(T* _ptr) { return static_cast<NodeListHook*>(_ptr); }
+        static T* node(NodeListHook* _hook_ptr) { return static_cast<T*>(_hook_ptr); }
+        static void link(NodeListHook* _hook_ptr, NodeListHook* _next_ptr);
+        static void unlink(NodeListHook* _hook_ptr);
+
+        mutable NodeListHook head_; ///< prev_ is the back, next_ the front. It is the end().
+        std::size_t size_;
+};
+
+/** \brief Container of the down nodes of LowerType in their up node, for each level of the Wolf tree
+ *
+ * The default is a std::list of pointers.
+ * Specialize it for a type of node to change the container of the nodes of this type, e.g. to a NodeList.
+ */
+template<class LowerType>
+struct DownNodeList
+{
+        typedef std::list<LowerType*> Type;
+};
+
+/** \brief The constraints of a feature, the most numerous nodes, are in a NodeList
+ */
+template<>
+struct DownNodeList<ConstraintBase>
+{
+        typedef NodeList<ConstraintBase> Type;
+};
+
+template<class T>
+inline NodeList<T>::NodeList() :
+        size_(0)
+{
+    head_.prev_ = &head_;
+    head_.next_ = &head_;
+}
+
+template<class T>
+inline NodeList<T>::~NodeList()
+{
+    clear();
+}
+
+template<class T>
+inline typename NodeList<T>::iterator NodeList<T>::begin() const
+{
+    return iterator(head_.next_);
+}
+
+template<class T>
+inline typename NodeList<T>::iterator NodeList<T>::end() const
+{
+    return iterator(&head_);
+}
+
+template<class T>
+inline bool NodeList<T>::empty() const
+{
+    return size_ == 0;
+}
+
+template<class T>
+inline std::size_t NodeList<T>::size() const
+{
+    return size_;
+}
+
+template<class T>
+inline T* NodeList<T>::front() const
+{
+    assert(!empty() && "NodeList::front: empty list");
+    return node(head_.next_);
+}
+
+template<class T>
+inline T* NodeList<T>::back() const
+{
+    assert(!empty() && "NodeList::back: empty list");
+    return node(head_.prev_);
+}
+
+template<class T>
+inline void NodeList<T>::link(NodeListHook* _hook_ptr, NodeListHook* _next_ptr)
+{
+    assert(!_hook_ptr->isLinked() && "NodeList: the node is already in a list");
+    _hook_ptr->prev_ = _next_ptr->prev_;
+    _hook_ptr->next_ = _next_ptr;
+    _next_ptr->prev_->next_ = _hook_ptr;
+    _next_ptr->prev_ = _hook_ptr;
+}
+
+template<class T>
+inline void NodeList<T>::unlink(NodeListHook* _hook_ptr)
+{
+    _hook_ptr->prev_->next_ = _hook_ptr->next_;
+    _hook_ptr->next_->prev_ = _hook_ptr->prev_;
+    _hook_ptr->prev_ = nullptr;
+    _hook_ptr->next_ = nullptr;
+}
+
+template<class T>
+inline void NodeList<T>::push_back(T* _ptr)
+{
+    link(hook(_ptr), &head_);
+    size_++;
+}
+
+template<class T>
+inline void NodeList<T>::push_front(T* _ptr)
+{
+    link(hook(_ptr), head_.next_);
+    size_++;
+}
+
+template<class T>
+inline void NodeList<T>::pop_front()
+{
+    assert(!empty() && "NodeList::pop_front: empty list");
+    unlink(head_.next_);
+    size_--;
+}
+
+template<class T>
+inline void NodeList<T>::pop_back()
+{
+    assert(!empty() && "NodeList::pop_back: empty list");
+    unlink(head_.prev_);
+    size_--;
+}
+
+template<class T>
+inline typename NodeList<T>::iterator NodeList<T>::insert(iterator _place, T* _ptr)
+{
+    link(hook(_ptr), _place.hook_ptr_);
+    size_++;
+    return iterator(hook(_ptr));
+}
+
+template<class T>
+inline typename NodeList<T>::iterator NodeList<T>::erase(iterator _it)
+{
+    assert(_it != end() && "NodeList::erase: end() iterator");
+    iterator next(_it.hook_ptr_->next_);
+    unlink(_it.hook_ptr_);
+    size_--;
+    return next;
+}
+
+template<class T>
+inline void NodeList<T>::remove(T* _ptr)
+{
+    // like std::list::remove(), removing a node not in the list does nothing
+    if (!hook(_ptr)->isLinked())
+        return;
+    unlink(hook(_ptr));
+    size_--;
+}
+
+template<class T>
+inline void NodeList<T>::splice(iterator _place, NodeList& _other)
+{
+    if (&_other == this || _other.empty())
+        return;
+    NodeListHook* first = _other.head_.next_;
+    NodeListHook* last = _other.head_.prev_;
+    NodeListHook* next = _place.hook_ptr_;
+    first->prev_ = next->prev_;
+    next->prev_->next_ = first;
+    last->next_ = next;
+    next->prev_ = last;
+    size_ += _other.size_;
+    _other.head_.prev_ = &_other.head_;
+    _other.head_.next_ = &_other.head_;
+    _other.size_ = 0;
+}
+
+template<class T>
+inline void NodeList<T>::clear()
+{
+    while (!empty())
+        pop_front();
+}
+
+} // namespace wolf
+
+#endif /* SRC_NODE_LIST_H_ */
@@ -0,0 +1,177 @@
+/**
+ * \file node_pool.h
+ *
+ *  Created on: Jul 8, 2016
+ *      \author: jsola
+ */
+
+#ifndef SRC_NODE_POOL_H_
+#define SRC_NODE_POOL_H_
+
+// STL includes
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace wolf {
+
+/** \brief Recycling allocator for the nodes of the Wolf tree
+ *
+ * Frames, captures, features and constraints are created and destructed continuously by the processors.
+ * Their base classes take their memory from a NodePool each (see e.g. FrameBase::getPool()),
+ * so that a destructed node leaves its memory to the next node of the same size, instead of returning it to the system.
+ *
+ * The pool has one free list per size class, of 16 bytes each. The memory comes from the system in chunks of blocks of one size class.
+ * Nodes bigger than the largest size class go straight to the system.
+ *
+ * The pool is thread safe, since nodes may be created concurrently (see Problem::setKeyFrameCallbackThreads() and CaptureExecutor).
+ * Its memory is only returned to the system when the pool is destroyed.
+ */
+class NodePool
+{
+    public:
+        /** \brief Constructor
+         * \param _chunk_size the number of blocks asked to the system at once
+         */
+        NodePool(unsigned int _chunk_size = 64);
+        ~NodePool();
+
+        void* allocate(std::size_t _size);
+        void deallocate(void* _ptr, std::size_t _size);
+
+        unsigned long int getAllocationsCount() const;          ///< number of nodes allocated, ever
+        unsigned long int getSystemAllocationsCount() const;    ///< number of allocations asked to the system, ever
+        unsigned int getInUseCount() const;                     ///< number of nodes alive
+        std::size_t getInUseBytes() const;                      ///< memory of the nodes alive, in bytes
+        unsigned int getFreeCount() const;                      ///< number of free blocks, ready to be recycled
+
+    private:
+        static const std::size_t granularity_ = 16; ///< also the alignment of the blocks, for the Eigen fixed-size members
+        static const std::size_t max_size_ = 1024;  ///< largest size class
+
+        struct FreeBlock
+        {
+                FreeBlock* next_;
+        };
+
+        mutable std::mutex mutex_;
+        unsigned int chunk_size_;
+        std::vector<FreeBlock*> free_lists_; ///< one per size class
+        std::vector<void*> chunks_;
+        unsigned long int n_allocations_;
+        unsigned long int n_system_allocations_;
+        unsigned int n_in_use_;
+        unsigned int n_free_;
+        std::size_t n_bytes_in_use_;
+};
+
+inline NodePool::NodePool(unsigned int _chunk_size) :
+        chunk_size_(_chunk_size), free_lists_(max_size_ / granularity_ + 1, nullptr),
+        n_allocations_(0), n_system_allocations_(0), n_in_use_(0), n_free_(0), n_bytes_in_use_(0)
+{
+    //
+}
+
+inline NodePool::~NodePool()
+{
+    // the nodes still alive keep their memory
+    if (n_in_use_ > 0)
+        return;
+    for (auto chunk : chunks_)
+        ::operator delete(chunk);
+}
+
+inline void* NodePool::allocate(std::size_t _size)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    n_allocations_++;
+    n_in_use_++;
+
+    if (_size > max_size_)
+    {
+        n_system_allocations_++;
+        n_bytes_in_use_ += _size;
+        return ::operator new(_size);
+    }
+
+    std::size_t size_class = (_size + granularity_ - 1) / granularity_;
+    n_bytes_in_use_ += size_class * granularity_;
+    if (free_lists_[size_class] == nullptr)
+    {
+        // a new chunk, split into free blocks
+        std::size_t block_size = size_class * granularity_;
+        char* chunk = (char*)::operator new(chunk_size_ * block_size);
+        n_system_allocations_++;
+        chunks_.push_back(chunk);
+        for (unsigned int i = 0; i < chunk_size_; i++)
+        {
+            FreeBlock* block = (FreeBlock*)(chunk + i * block_size);
+            block->next_ = free_lists_[size_class];
+            free_lists_[size_class] = block;
+        }
+        n_free_ += chunk_size_;
+    }
+
+    FreeBlock* block = free_lists_[size_class];
+    free_lists_[size_class] = block->next_;
+    n_free_--;
+    return block;
+}
+
+inline void NodePool::deallocate(void* _ptr, std::size_t _size)
+{
+    if (_ptr == nullptr)
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    n_in_use_--;
+
+    if (_size > max_size_)
+    {
+        n_bytes_in_use_ -= _size;
+        ::operator delete(_ptr);
+        return;
+    }
+
+    std::size_t size_class = (_size + granularity_ - 1) / granularity_;
+    n_bytes_in_use_ -= size_class * granularity_;
+    FreeBlock* block = (FreeBlock*)_ptr;
+    block->next_ = free_lists_[size_class];
+    free_lists_[size_class] = block;
+    n_free_++;
+}
+
+inline unsigned long int NodePool::getAllocationsCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return n_allocations_;
+}
+
+inline unsigned long int NodePool::getSystemAllocationsCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return n_system_allocations_;
+}
+
+inline unsigned int NodePool::getInUseCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return n_in_use_;
+}
+
+inline std::size_t NodePool::getInUseBytes() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return n_bytes_in_use_;
+}
+
+inline unsigned int NodePool::getFreeCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return n_free_;
+}
+
+} // namespace wolf
+
+#endif /* SRC_NODE_POOL_H_ */
@@ -0,0 +1,69 @@
+/**
+ * \file node_tag.cpp
+ *
+ *  Created on: Jul 10, 2016
+ *      \author: jsola
+ */
+
+#include "node_tag.h"
+
+// STL includes
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+namespace wolf {
+
+namespace {
+
+/** The texts of the tags. A deque, so that adding texts does not move the previous ones.
+ */
+struct NodeTagTable
+{
+        NodeTagTable()
+        {
+            texts_.push_back(std::string()); // id 0 is the empty text
+        }
+
+        std::mutex mutex_;
+        std::deque<std::string> texts_;
+        std::unordered_map<std::string, unsigned int> ids_;
+};
+
+NodeTagTable& table()
+{
+    // constructed at first use, since nodes may be created during static initialization
+    static NodeTagTable* table_ptr = new NodeTagTable(); // never destroyed: the texts outlive all tags
+    return *table_ptr;
+}
+
+} // namespace
+
+unsigned int NodeTag::intern(const std::string& _text)
+{
+    NodeTagTable& tags = table();
+    std::lock_guard<std::mutex> lock(tags.mutex_);
+    auto id_it = tags.ids_.find(_text);
+    if (id_it != tags.ids_.end())
+        return id_it->second;
+    unsigned int id = tags.texts_.size();
+    tags.texts_.push_back(_text);
+    tags.ids_[_text] = id;
+    return id;
+}
+
+const std::string& NodeTag::str() const
+{
+    NodeTagTable& tags = table();
+    std::lock_guard<std::mutex> lock(tags.mutex_);
+    return tags.texts_[id_];
+}
+
+unsigned int NodeTag::getTableSize()
+{
+    NodeTagTable& tags = table();
+    std::lock_guard<std::mutex> lock(tags.mutex_);
+    return tags.texts_.size();
+}
+
+} // namespace wolf
@@ -0,0 +1,93 @@
+/**
+ * \file node_tag.h
+ *
+ *  Created on: Jul 10, 2016
+ *      \author: jsola
+ */
+
+#ifndef SRC_NODE_TAG_H_
+#define SRC_NODE_TAG_H_
+
+// STL includes
+#include <string>
+
+namespace wolf {
+
+/** \brief Interned text label of a node: its class, type or name
+ *
+ * A tag is the index of its text in a global table, where each different text is stored once.
+ * It takes 4 bytes in the node instead of a std::string, and comparing two tags compares two integers.
+ *
+ * Creating a tag from a text looks it up in the table, adding it if new. The table is thread safe, and never shrinks,
+ * so that the texts of all tags stay valid until the end of the program.
+ * Classes and types are a few tens of texts. Names should be given only to the objects that need one (see NodeBase).
+ *
+ * Keep the tags of the texts used in type checks, to avoid looking them up every time:
+ *
+ *     static const NodeTag epipolar_tag("EPIPOLAR");
+ *     if (constraint_ptr->getTypeTag() == epipolar_tag)
+ *         ...
+ */
+class NodeTag
+{
+    public:
+        NodeTag();                      ///< The empty text
+        NodeTag(const std::string& _text);
+        NodeTag(const char* _text);
+
+        unsigned int id() const;
+        const std::string& str() const;
+
+        bool operator==(const NodeTag& _other) const;
+        bool operator!=(const NodeTag& _other) const;
+        bool operator<(const NodeTag& _other) const;    ///< order of interning, not alphabetical
+
+        static unsigned int getTableSize();             ///< number of different texts interned, the empty one included
+
+    private:
+        static unsigned int intern(const std::string& _text);
+
+        unsigned int id_;
+};
+
+inline NodeTag::NodeTag() :
+        id_(0)
+{
+    //
+}
+
+inline NodeTag::NodeTag(const std::string& _text) :
+        id_(_text.empty() ? 0 : intern(_text))
+{
+    //
+}
+
+inline NodeTag::NodeTag(const char* _text) :
+        id_(*_text == '\0' ? 0 : intern(_text))
+{
+    //
+}
+
+inline unsigned int NodeTag::id() const
+{
+    return id_;
+}
+
+inline bool NodeTag::operator==(const NodeTag& _other) const
+{
+    return id_ == _other.id_;
+}
+
+inline bool NodeTag::operator!=(const NodeTag& _other) const
+{
+    return id_ != _other.id_;
+}
+
+inline bool NodeTag::operator<(const NodeTag& _other) const
+{
+    return id_ < _other.id_;
+}
+
+} // namespace wolf
+
+#endif /* SRC_NODE_TAG_H_ */
@@ -13,6 +13,21 @@
 #include "sensor_factory.h"
 #include "processor_factory.h"
 #include "frame_imu.h"
+#include "published_state.h"
+#include "covariance_store.h"
+#include "thread_pool.h"
+#include "state_arena.h"
+#include "capture_void.h"
+#include "constraint_marginalization.h"
+#include "graph_pruner.h"
+#include "feature_base.h"
+#include "landmark_base.h"
+#include "capture_motion.h"
+#include "node_pool.h"
+#include "problem_statistics.h"
+
+// std includes
+#include <unordered_set>
 
 namespace wolf
 {
@@ -27,11 +42,15 @@ std::string uppercase(std::string s) {for (auto & c: s) c = std::toupper(c); ret
 Problem::Problem(FrameStructure _frame_structure) :
         NodeBase("PROBLEM", ""), //
         location_(TOP), trajectory_ptr_(new TrajectoryBase(_frame_structure)), map_ptr_(new MapBase), hardware_ptr_(
-                new HardwareBase), processor_motion_ptr_(nullptr), origin_setted_(false)
+                new HardwareBase), processor_motion_ptr_(nullptr), origin_setted_(false), published_state_ptr_(nullptr),
+        covariance_store_ptr_(new CovarianceStore), key_frame_callback_pool_ptr_(nullptr),
+        state_arena_ptr_(nullptr), fixed_lag_key_frames_(0), fixed_lag_time_(0),
+        graph_pruner_ptr_(nullptr), solver_running_(false)
 {
     trajectory_ptr_->linkToUpperNode(this);
     map_ptr_->linkToUpperNode(this);
     hardware_ptr_->linkToUpperNode(this);
+    published_state_ptr_ = new PublishedState(getFrameStructureSize());
 }
 
 Problem::~Problem()
@@ -39,6 +58,11 @@ Problem::~Problem()
     hardware_ptr_->destruct();
     trajectory_ptr_->destruct();
     map_ptr_->destruct();
+    delete published_state_ptr_;
+    delete covariance_store_ptr_;
+    delete key_frame_callback_pool_ptr_;
+    delete state_arena_ptr_;
+    delete graph_pruner_ptr_;
 }
 
 void Problem::destruct()
@@ -210,6 +234,11 @@ void Problem::getStateAtTimeStamp(const TimeStamp& _ts, Eigen::VectorXs& state)
     }
 }
 
+bool Problem::getPublishedState(Eigen::VectorXs& _state, TimeStamp& _ts) const
+{
+    return published_state_ptr_->read(_ts, _state);
+}
+
 Eigen::VectorXs Problem::getStateAtTimeStamp(const TimeStamp& _ts)
 {
     Eigen::VectorXs state(getFrameStructureSize());
@@ -227,6 +256,8 @@ unsigned int Problem::getFrameStructureSize()
             return 7;
         case FRM_POV_3D:
             return 10;
+        case FRM_PVQBB_3D:
+            return 16;
         default:
             throw std::runtime_error(
                     "Problem::getFrameStructureSize(): Unknown frame structure. Add appropriate frame structure to the switch statement.");
@@ -238,6 +269,8 @@ Eigen::VectorXs Problem::zeroState()
     Eigen::VectorXs state = Eigen::VectorXs::Zero(getFrameStructureSize());
     if (trajectory_ptr_->getFrameStructure() == FRM_PO_3D || trajectory_ptr_->getFrameStructure() == FRM_POV_3D)
         state(6) = 1;
+    else if (trajectory_ptr_->getFrameStructure() == FRM_PVQBB_3D)
+        state(9) = 1;
     return state;
 }
 
@@ -249,10 +282,213 @@ bool Problem::permitKeyFrame(ProcessorBase* _processor_ptr)
 void Problem::keyFrameCallback(FrameBase* _keyframe_ptr, ProcessorBase* _processor_ptr, const Scalar& _time_tolerance)
 {
     //std::cout << "Problem::keyFrameCallback: processor " << _processor_ptr->getName() << std::endl;
+    std::vector<ProcessorBase*> processors;
     for (auto sensor : (*hardware_ptr_->getSensorListPtr()))
     	for (auto processor : (*sensor->getProcessorListPtr()))
     		if (processor->id() != _processor_ptr->id())
-                processor->keyFrameCallback(_keyframe_ptr, _time_tolerance);
+                processors.push_back(processor);
+
+    // work on the processors' own data, possibly in parallel
+    if (key_frame_callback_pool_ptr_ != nullptr && processors.size() > 1)
+        key_frame_callback_pool_ptr_->run(processors.size(), [&](unsigned int i)
+        {
+            processors[i]->keyFrameCallbackPrepare(_keyframe_ptr, _time_tolerance);
+        });
+    else
+        for (auto processor : processors)
+            processor->keyFrameCallbackPrepare(_keyframe_ptr, _time_tolerance);
+
+    // modify the tree, in order
+    for (auto processor : processors)
+        processor->keyFrameCallback(_keyframe_ptr, _time_tolerance);
+}
+
+void Problem::removeKeyFrameCallback(FrameBase* _keyframe_ptr)
+{
+    for (auto sensor : (*hardware_ptr_->getSensorListPtr()))
+        for (auto processor : (*sensor->getProcessorListPtr()))
+            processor->removeKeyFrameCallback(_keyframe_ptr);
+}
+
+void Problem::solveCallback()
+{
+    for (auto sensor : (*hardware_ptr_->getSensorListPtr()))
+        for (auto processor : (*sensor->getProcessorListPtr()))
+            processor->solveCallback();
+}
+
+void Problem::setKeyFrameCallbackThreads(unsigned int _n_threads)
+{
+    delete key_frame_callback_pool_ptr_;
+    key_frame_callback_pool_ptr_ = (_n_threads > 1 ? new ThreadPool(_n_threads) : nullptr);
+}
+
+void Problem::enableStateArena(unsigned int _capacity, unsigned int _page_size)
+{
+    assert(state_arena_ptr_ == nullptr && "Problem::enableStateArena: the problem has a state arena already");
+    state_arena_ptr_ = new StateArena(_capacity, _page_size);
+}
+
+void Problem::setFixedLagWindow(unsigned int _max_key_frames, Scalar _max_time)
+{
+    fixed_lag_key_frames_ = _max_key_frames;
+    fixed_lag_time_ = _max_time;
+}
+
+bool Problem::isFixedLag() const
+{
+    return fixed_lag_key_frames_ > 0 || fixed_lag_time_ > 0;
+}
+
+void Problem::getKeyFramesOutOfWindow(FrameBaseList& _frame_list)
+{
+    FrameBase* last_key_frame_ptr = getLastKeyFramePtr();
+    if (!isFixedLag() || last_key_frame_ptr == nullptr)
+        return;
+
+    // the key frames are sorted by time stamp, before the others
+    unsigned int n_key_frames = trajectory_ptr_->getKeyFramesCount();
+    for (auto frame_ptr : *(trajectory_ptr_->getFrameListPtr()))
+    {
+        if (frame_ptr == last_key_frame_ptr)
+            break;
+        if ((fixed_lag_key_frames_ == 0 || n_key_frames <= fixed_lag_key_frames_)
+                && (fixed_lag_time_ == 0 || last_key_frame_ptr->getTimeStamp() - frame_ptr->getTimeStamp() <= fixed_lag_time_))
+            break;
+        _frame_list.push_back(frame_ptr);
+        n_key_frames--;
+    }
+}
+
+void Problem::getConstraintsOnKeyFrame(FrameBase* _frame_ptr, ConstraintBaseList& _ctr_list)
+{
+    // its own constraints, the ones on it, and the ones on its features
+    ConstraintBaseList ctr_list;
+    _frame_ptr->getConstraintList(ctr_list);
+    ctr_list.insert(ctr_list.end(), _frame_ptr->getConstrainedByListPtr()->begin(), _frame_ptr->getConstrainedByListPtr()->end());
+    for (auto capture_ptr : *(_frame_ptr->getCaptureListPtr()))
+        for (auto feature_ptr : *(capture_ptr->getFeatureListPtr()))
+            ctr_list.insert(ctr_list.end(), feature_ptr->getConstrainedByListPtr()->begin(), feature_ptr->getConstrainedByListPtr()->end());
+
+    std::unordered_set<ConstraintBase*> visited;
+    for (auto ctr_ptr : ctr_list)
+        if (ctr_ptr->getStatus() == CTR_ACTIVE && visited.insert(ctr_ptr).second)
+            _ctr_list.push_back(ctr_ptr);
+}
+
+void Problem::marginalizeKeyFrame(FrameBase* _frame_ptr, const std::list<LinearizedConstraint>& _linearized_constraints)
+{
+    assert(_frame_ptr->isKey() && "Problem::marginalizeKeyFrame: not a key frame");
+    assert(!solver_running_ && "Problem::marginalizeKeyFrame: the solver is running. Wait for its solution first");
+
+    std::list<ConstraintMarginalization*> prior_ptrs;
+    ConstraintMarginalization* prior_ptr = ConstraintMarginalization::marginalize(_frame_ptr, _linearized_constraints);
+    if (prior_ptr != nullptr)
+        prior_ptrs.push_back(prior_ptr);
+    replaceKeyFrame(_frame_ptr, prior_ptrs);
+}
+
+void Problem::replaceKeyFrame(FrameBase* _frame_ptr, const std::list<ConstraintMarginalization*>& _prior_ptrs)
+{
+    assert(_frame_ptr->isKey() && "Problem::replaceKeyFrame: not a key frame");
+    assert(!solver_running_ && "Problem::replaceKeyFrame: the solver is running. Wait for its solution first");
+
+    if (!_prior_ptrs.empty())
+    {
+        // the oldest key frame left keeps the priors
+        FrameBase* host_ptr = nullptr;
+        for (auto frame_ptr : *(trajectory_ptr_->getFrameListPtr()))
+            if (frame_ptr != _frame_ptr && frame_ptr->isKey())
+            {
+                host_ptr = frame_ptr;
+                break;
+            }
+        if (host_ptr != nullptr)
+        {
+            CaptureBase* capture_ptr = host_ptr->addCapture(new CaptureVoid(host_ptr->getTimeStamp(), nullptr));
+            for (auto prior_ptr : _prior_ptrs)
+            {
+                FeatureBase* feature_ptr = capture_ptr->addFeature(new FeatureBase(FEATURE_MARGINALIZATION, "MARGINALIZATION",
+                                                                                   prior_ptr->getSize()));
+                feature_ptr->addConstraint(prior_ptr);
+            }
+        }
+        else
+            for (auto prior_ptr : _prior_ptrs)
+                delete prior_ptr;
+    }
+
+    // the processors drop their pointers into it
+    removeKeyFrameCallback(_frame_ptr);
+    _frame_ptr->destruct();
+}
+
+void Problem::getStatistics(ProblemStatistics& _statistics)
+{
+    static const NodeTag motion_tag("MOTION");
+
+    // the nodes
+    unsigned int n_frames = 0, n_captures = 0, n_features = 0, n_constraints = 0;
+    std::size_t capture_bytes = 0, feature_bytes = 0;
+    for (auto frame_ptr : *(trajectory_ptr_->getFrameListPtr()))
+    {
+        n_frames++;
+        for (auto capture_ptr : *(frame_ptr->getCaptureListPtr()))
+        {
+            n_captures++;
+            if (capture_ptr->getTypeTag() == motion_tag)
+                capture_bytes += ((CaptureMotion*)capture_ptr)->getBufferBytes();
+            for (auto feature_ptr : *(capture_ptr->getFeatureListPtr()))
+            {
+                n_features++;
+                n_constraints += feature_ptr->getConstraintListPtr()->size();
+                std::size_t measurement_size = feature_ptr->getMeasurement().size();
+                feature_bytes += (measurement_size + 2 * measurement_size * measurement_size) * sizeof(Scalar);
+            }
+        }
+    }
+    std::size_t landmark_bytes = 0;
+    for (auto landmark_ptr : *(map_ptr_->getLandmarkListPtr()))
+        landmark_bytes += sizeof(LandmarkBase) + landmark_ptr->getDescriptor().size() * sizeof(Scalar);
+
+    // the size of the nodes of a class: the average one in its pool
+    auto node_bytes = [](NodePool& _pool, unsigned int _count, std::size_t _base_size) -> std::size_t
+    {
+        unsigned int n_in_use = _pool.getInUseCount();
+        return _count * (n_in_use > 0 ? _pool.getInUseBytes() / n_in_use : _base_size);
+    };
+    _statistics.frames_ = {n_frames, node_bytes(FrameBase::getPool(), n_frames, sizeof(FrameBase))};
+    _statistics.captures_ = {n_captures, node_bytes(CaptureBase::getPool(), n_captures, sizeof(CaptureBase)) + capture_bytes};
+    _statistics.features_ = {n_features, node_bytes(FeatureBase::getPool(), n_features, sizeof(FeatureBase)) + feature_bytes};
+    _statistics.constraints_ = {n_constraints, node_bytes(ConstraintBase::getPool(), n_constraints, sizeof(ConstraintBase))};
+    _statistics.landmarks_ = {(unsigned int)(map_ptr_->getLandmarkListPtr()->size()), landmark_bytes};
+
+    // the state blocks, whose states may be in the arena
+    std::size_t state_bytes = 0;
+    for (auto state_ptr : state_block_ptr_list_)
+        state_bytes += sizeof(StateBlock) + state_ptr->getSize() * sizeof(Scalar);
+    _statistics.state_blocks_ = {(unsigned int)(state_block_ptr_list_.size()), state_bytes};
+
+    // the motion buffers being integrated
+    _statistics.motion_buffers_.clear();
+    for (auto sensor_ptr : *(hardware_ptr_->getSensorListPtr()))
+        for (auto processor_ptr : *(sensor_ptr->getProcessorListPtr()))
+            if (processor_ptr->isMotion())
+            {
+                _statistics.motion_buffers_.emplace_back();
+                ((ProcessorMotion*)processor_ptr)->getBufferStatistics(_statistics.motion_buffers_.back());
+            }
+
+    _statistics.state_block_notifications_ = state_block_notification_list_.size();
+    _statistics.constraint_notifications_ = constraint_notification_list_.size();
+}
+
+void Problem::enableGraphPruning(const GraphPrunerParams& _params)
+{
+    if (graph_pruner_ptr_ == nullptr)
+        graph_pruner_ptr_ = new GraphPruner(this, _params);
+    else
+        graph_pruner_ptr_->setParams(_params);
 }
 
 LandmarkBase* Problem::addLandmark(LandmarkBase* _lmk_ptr)
@@ -267,52 +503,67 @@ void Problem::addLandmarkList(LandmarkBaseList _lmk_list)
     getMapPtr()->addLandmarkList(_lmk_list);
 }
 
-StateBlock* Problem::addStateBlockPtr(StateBlock* _state_ptr)
+StateBlock* Problem::addStateBlockPtr(StateBlock* _state_ptr, StateKind _kind)
 {
     //std::cout << "addStateBlockPtr" << std::endl;
+    // move its state to the arena, before the solver takes its address
+    if (state_arena_ptr_ != nullptr)
+        state_arena_ptr_->insert(_state_ptr, _kind);
+
     // add the state unit to the list
-    state_block_ptr_list_.push_back(_state_ptr);
+    state_block_ptr_map_[_state_ptr] = state_block_ptr_list_.insert(state_block_ptr_list_.end(), _state_ptr);
     // queue for solver manager
-    state_block_notification_list_.push_back(StateBlockNotification({ADD,_state_ptr}));
+    state_block_notification_map_[_state_ptr] = state_block_notification_list_.insert(state_block_notification_list_.end(),
+                                                                                     StateBlockNotification({ADD, _state_ptr}));
 
     return _state_ptr;
 }
 
 void Problem::updateStateBlockPtr(StateBlock* _state_ptr)
 {
+    // already queued: the solver will read the current status anyway
+    if (state_block_notification_map_.find(_state_ptr) != state_block_notification_map_.end())
+        return;
+
     // queue for solver manager
-    state_block_notification_list_.push_back(StateBlockNotification({UPDATE,_state_ptr}));
+    state_block_notification_map_[_state_ptr] = state_block_notification_list_.insert(state_block_notification_list_.end(),
+                                                                                     StateBlockNotification({UPDATE, _state_ptr}));
 }
 
 void Problem::removeStateBlockPtr(StateBlock* _state_ptr)
 {
-    // add the state unit to the list
-    state_block_ptr_list_.remove(_state_ptr);
+    // remove the state unit from the list
+    auto state_it = state_block_ptr_map_.find(_state_ptr);
+    if (state_it != state_block_ptr_map_.end())
+    {
+        state_block_ptr_list_.erase(state_it->second);
+        state_block_ptr_map_.erase(state_it);
+    }
 
-    // Check if the state addition is still as a notification
-    auto state_found_it = state_block_notification_list_.end();
-    for (auto state_notif_it = state_block_notification_list_.begin(); state_notif_it != state_block_notification_list_.end(); state_notif_it++)
+    // Check if the state addition or update is still as a notification
+    bool known_by_solver = true;
+    auto notif_it = state_block_notification_map_.find(_state_ptr);
+    if (notif_it != state_block_notification_map_.end())
     {
-        if (state_notif_it->notification_ == ADD && state_notif_it->state_block_ptr_ == _state_ptr)
-        {
-            state_found_it = state_notif_it;
-            break;
-        }
+        known_by_solver = (notif_it->second->notification_ != ADD);
+        state_block_notification_list_.erase(notif_it->second);
+        state_block_notification_map_.erase(notif_it);
     }
-    // Remove addition notification
-    if (state_found_it != state_block_notification_list_.end())
-    	state_block_notification_list_.erase(state_found_it);
     // Add remove notification
-    else
-    	state_block_notification_list_.push_back(StateBlockNotification({REMOVE, nullptr, _state_ptr->getPtr()}));
+    if (known_by_solver)
+        state_block_notification_list_.push_back(StateBlockNotification({REMOVE, nullptr, _state_ptr->getPtr()}));
 
+    // the solver knows it by its address in the arena: move it out only now
+    if (state_arena_ptr_ != nullptr)
+        state_arena_ptr_->remove(_state_ptr);
 }
 
 ConstraintBase* Problem::addConstraintPtr(ConstraintBase* _constraint_ptr)
 {
     //std::cout << "addConstraintPtr" << std::endl;
     // queue for solver manager
-    constraint_notification_list_.push_back(ConstraintNotification({ADD, _constraint_ptr, _constraint_ptr->id()}));
+    constraint_notification_map_[_constraint_ptr->id()] = constraint_notification_list_.insert(
+            constraint_notification_list_.end(), ConstraintNotification({ADD, _constraint_ptr, _constraint_ptr->id()}));
 
     return _constraint_ptr;
 }
@@ -320,18 +571,13 @@ ConstraintBase* Problem::addConstraintPtr(ConstraintBase* _constraint_ptr)
 void Problem::removeConstraintPtr(ConstraintBase* _constraint_ptr)
 {
     // Check if the constraint addition is still as a notification
-    auto ctr_found_it = constraint_notification_list_.end();
-    for (auto ctr_notif_it = constraint_notification_list_.begin(); ctr_notif_it != constraint_notification_list_.end(); ctr_notif_it++)
+    auto notif_it = constraint_notification_map_.find(_constraint_ptr->id());
+    // Remove addition notification
+    if (notif_it != constraint_notification_map_.end())
     {
-        if (ctr_notif_it->notification_ == ADD && ctr_notif_it->constraint_ptr_ == _constraint_ptr)
-        {
-            ctr_found_it = ctr_notif_it;
-            break;
-        }
+        constraint_notification_list_.erase(notif_it->second);
+        constraint_notification_map_.erase(notif_it);
     }
-    // Remove addition notification
-    if (ctr_found_it != constraint_notification_list_.end())
-        constraint_notification_list_.erase(ctr_found_it);
     // Add remove notification
     else
         constraint_notification_list_.push_back(ConstraintNotification({REMOVE, nullptr, _constraint_ptr->id()}));
@@ -339,7 +585,9 @@ void Problem::removeConstraintPtr(ConstraintBase* _constraint_ptr)
 
 void Problem::clearCovariance()
 {
-    covariances_.clear();
+    covariance_store_ptr_->clear();
+    if (graph_pruner_ptr_ != nullptr)
+        graph_pruner_ptr_->notifyCovariances();
 }
 
 void Problem::addCovarianceBlock(StateBlock* _state1, StateBlock* _state2, const Eigen::MatrixXs& _cov)
@@ -347,43 +595,44 @@ void Problem::addCovarianceBlock(StateBlock* _state1, StateBlock* _state2, const
     assert(_state1->getSize() == (unsigned int ) _cov.rows() && "wrong covariance block size");
     assert(_state2->getSize() == (unsigned int ) _cov.cols() && "wrong covariance block size");
 
-    covariances_[std::pair<StateBlock*, StateBlock*>(_state1, _state2)] = _cov;
+    covariance_store_ptr_->addBlock(_state1, _state2, _cov);
 }
 
 bool Problem::getCovarianceBlock(StateBlock* _state1, StateBlock* _state2, Eigen::MatrixXs& _cov, const int _row,
                                  const int _col)
 {
-    //std::cout << "entire cov to be filled:" << std::endl << _cov << std::endl;
-    //std::cout << "_row " << _row << std::endl;
-    //std::cout << "_col " << _col << std::endl;
-    //std::cout << "_state1 size: " << _state1->getSize() << std::endl;
-    //std::cout << "_state2 size: " << _state2->getSize() << std::endl;
-    //std::cout << "part of cov to be filled:" << std::endl <<  _cov.block(_row, _col, _state1->getSize(), _state2->getSize()) << std::endl;
-    //if (covariances_.find(std::pair<StateBlock*, StateBlock*>(_state1, _state2)) != covariances_.end())
-    //    std::cout << "stored cov" << std::endl << covariances_[std::pair<StateBlock*, StateBlock*>(_state1, _state2)] << std::endl;
-    //else if (covariances_.find(std::pair<StateBlock*, StateBlock*>(_state2, _state1)) != covariances_.end())
-    //    std::cout << "stored cov" << std::endl << covariances_[std::pair<StateBlock*, StateBlock*>(_state2, _state1)].transpose() << std::endl;
-
     assert(_row + _state1->getSize() <= _cov.rows() && _col + _state2->getSize() <= _cov.cols() && "Problem::getCovarianceBlock: Bad matrix covariance size!");
 
-    if (covariances_.find(std::pair<StateBlock*, StateBlock*>(_state1, _state2)) != covariances_.end())
-        _cov.block(_row, _col, _state1->getSize(), _state2->getSize()) =
-                covariances_[std::pair<StateBlock*, StateBlock*>(_state1, _state2)];
-    else if (covariances_.find(std::pair<StateBlock*, StateBlock*>(_state2, _state1)) != covariances_.end())
-       _cov.block(_row, _col, _state1->getSize(), _state2->getSize()) =
-                covariances_[std::pair<StateBlock*, StateBlock*>(_state2, _state1)].transpose();
-    else
+    CovarianceStore::ConstBlockMap block = covariance_store_ptr_->getBlock(_state1, _state2);
+    if (block.data() == nullptr)
+        return false;
+
+    _cov.block(_row, _col, _state1->getSize(), _state2->getSize()) = block;
+    return true;
+}
+
+bool Problem::getJointCovariance(StateBlock* _state1, StateBlock* _state2, Eigen::MatrixXs& _covariance)
+{
+    unsigned int size1 = _state1->getSize();
+    unsigned int size2 = _state2->getSize();
+    assert(size1 + size2 <= _covariance.rows() && size1 + size2 <= _covariance.cols() && "Problem::getJointCovariance: Bad matrix covariance size!");
+
+    CovarianceStore::ConstBlockMap block_11 = covariance_store_ptr_->getBlock(_state1, _state1);
+    CovarianceStore::ConstBlockMap block_12 = covariance_store_ptr_->getBlock(_state1, _state2);
+    CovarianceStore::ConstBlockMap block_22 = covariance_store_ptr_->getBlock(_state2, _state2);
+    if (block_11.data() == nullptr || block_12.data() == nullptr || block_22.data() == nullptr)
         return false;
 
+    _covariance.topLeftCorner(size1, size1) = block_11;
+    _covariance.block(0, size1, size1, size2) = block_12;
+    _covariance.block(size1, 0, size2, size1) = block_12.transpose();
+    _covariance.block(size1, size1, size2, size2) = block_22;
     return true;
 }
 
 bool Problem::getFrameCovariance(FrameBase* _frame_ptr, Eigen::MatrixXs& _covariance)
 {
-    return getCovarianceBlock(_frame_ptr->getPPtr(), _frame_ptr->getPPtr(), _covariance, 0, 0) &&
-    getCovarianceBlock(_frame_ptr->getPPtr(), _frame_ptr->getOPtr(), _covariance, 0,_frame_ptr->getPPtr()->getSize()) &&
-    getCovarianceBlock(_frame_ptr->getOPtr(), _frame_ptr->getPPtr(), _covariance, _frame_ptr->getPPtr()->getSize(), 0) &&
-    getCovarianceBlock(_frame_ptr->getOPtr(), _frame_ptr->getOPtr(), _covariance, _frame_ptr->getPPtr()->getSize() ,_frame_ptr->getPPtr()->getSize());
+    return getJointCovariance(_frame_ptr->getPPtr(), _frame_ptr->getOPtr(), _covariance);
 }
 
 Eigen::MatrixXs Problem::getFrameCovariance(FrameBase* _frame_ptr)
@@ -395,10 +644,7 @@ Eigen::MatrixXs Problem::getFrameCovariance(FrameBase* _frame_ptr)
 
 bool Problem::getLandmarkCovariance(LandmarkBase* _landmark_ptr, Eigen::MatrixXs& _covariance)
 {
-    return getCovarianceBlock(_landmark_ptr->getPPtr(), _landmark_ptr->getPPtr(), _covariance, 0, 0) &&
-    getCovarianceBlock(_landmark_ptr->getPPtr(), _landmark_ptr->getOPtr(), _covariance, 0,_landmark_ptr->getPPtr()->getSize()) &&
-    getCovarianceBlock(_landmark_ptr->getOPtr(), _landmark_ptr->getPPtr(), _covariance, _landmark_ptr->getPPtr()->getSize(), 0) &&
-    getCovarianceBlock(_landmark_ptr->getOPtr(), _landmark_ptr->getOPtr(), _covariance, _landmark_ptr->getPPtr()->getSize() ,_landmark_ptr->getPPtr()->getSize());
+    return getJointCovariance(_landmark_ptr->getPPtr(), _landmark_ptr->getOPtr(), _covariance);
 }
 
 Eigen::MatrixXs Problem::getLandmarkCovariance(LandmarkBase* _landmark_ptr)
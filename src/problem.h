@@ -7,7 +7,16 @@ class HardwareBase;
 class TrajectoryBase;
 class MapBase;
 class ProcessorMotion;
+class PublishedState;
+class CovarianceStore;
+class ThreadPool;
+class StateArena;
 class TimeStamp;
+struct LinearizedConstraint;
+class ConstraintMarginalization;
+class GraphPruner;
+struct GraphPrunerParams;
+struct ProblemStatistics;
 struct IntrinsicsBase;
 struct ProcessorParamsBase;
 }
@@ -16,6 +25,8 @@ struct ProcessorParamsBase;
 #include "node_base.h"
 
 // std includes
+#include <list>
+#include <unordered_map>
 #include <utility> // pair
 
 
@@ -56,16 +67,26 @@ class Problem : public NodeBase
         typedef NodeBase* LowerNodePtr; // Necessatry for destruct() of node_linked
 
     protected:
-        std::map<std::pair<StateBlock*, StateBlock*>, Eigen::MatrixXs> covariances_;
         NodeLocation location_; // TODO: should it be in node_base?
         TrajectoryBase* trajectory_ptr_;
         MapBase* map_ptr_;
         HardwareBase* hardware_ptr_;
         ProcessorMotion* processor_motion_ptr_;
         StateBlockList state_block_ptr_list_;
+        std::unordered_map<StateBlock*, StateBlockIter> state_block_ptr_map_; ///< position of each state block in state_block_ptr_list_
         std::list<StateBlockNotification> state_block_notification_list_;
         std::list<ConstraintNotification> constraint_notification_list_;
+        std::unordered_map<StateBlock*, std::list<StateBlockNotification>::iterator> state_block_notification_map_; ///< pending ADD or UPDATE of each state block
+        std::unordered_map<unsigned int, std::list<ConstraintNotification>::iterator> constraint_notification_map_; ///< pending ADD of each constraint, by id
         bool origin_setted_;
+        PublishedState* published_state_ptr_;
+        CovarianceStore* covariance_store_ptr_; ///< the covariance blocks computed by the solver
+        ThreadPool* key_frame_callback_pool_ptr_; ///< threads preparing the key frame callbacks. nullptr: no threads
+        StateArena* state_arena_ptr_; ///< contiguous storage of the state blocks. nullptr: each block stores its own state
+        unsigned int fixed_lag_key_frames_; ///< maximum number of key frames in the fixed-lag window. 0: no maximum
+        Scalar fixed_lag_time_; ///< maximum time span of the key frames in the fixed-lag window. 0: no maximum
+        GraphPruner* graph_pruner_ptr_; ///< pruning of the redundant key frames. nullptr: no pruning
+        bool solver_running_; ///< a solver evaluates the constraints on a worker thread, see setSolverRunning()
 
     public:
 
@@ -185,6 +206,17 @@ class Problem : public NodeBase
         void getCurrentState(Eigen::VectorXs& state);
         void getCurrentState(Eigen::VectorXs& state, TimeStamp& _ts);
 
+        /** \brief Get the published state, from any thread
+         *
+         * The main ProcessorMotion publishes the current state after each integration, see PublishedState.
+         * Unlike getCurrentState(), this can be called from other threads while Wolf is processing,
+         * and it does not allocate if _state has the frame structure size.
+         *
+         * \return false if no state has been published yet
+         */
+        bool getPublishedState(Eigen::VectorXs& _state, TimeStamp& _ts) const;
+        PublishedState* getPublishedStatePtr();
+
         /** \brief Get the state at a given timestamp
          */
         Eigen::VectorXs getStateAtTimeStamp(const TimeStamp& _ts);
@@ -200,22 +232,48 @@ class Problem : public NodeBase
         /** \brief New key frame callback
          *
          * New key frame callback: It should be called by any processor that creates a new keyframe. It calls the keyFrameCallback of the rest of processors.
+         *
+         * It first calls keyFrameCallbackPrepare() on all of them, concurrently if setKeyFrameCallbackThreads() says so.
+         * Then it calls keyFrameCallback() on each of them, in the order of the tree,
+         * so that the tree is modified in the same order whatever the number of threads.
          */
         void keyFrameCallback(FrameBase* _keyframe_ptr, ProcessorBase* _processor_ptr, const Scalar& _time_tolerance);
 
+        /** \brief Removed key frame callback
+         *
+         * It should be called right before destructing a key frame. It calls the removeKeyFrameCallback of all processors,
+         * so that they drop their pointers into the key frame.
+         */
+        void removeKeyFrameCallback(FrameBase* _keyframe_ptr);
+
+        /** \brief Solve callback
+         *
+         * The solver calls it after writing a solution into the state blocks. It calls the solveCallback of all processors.
+         */
+        void solveCallback();
+
+        /** \brief Sets the number of threads preparing the key frame callbacks, see keyFrameCallback()
+         * \param _n_threads the number of threads, including the one calling keyFrameCallback(). 0 or 1 for no parallelism (default).
+         */
+        void setKeyFrameCallbackThreads(unsigned int _n_threads);
+
         LandmarkBase* addLandmark(LandmarkBase* _lmk_ptr);
 
         void addLandmarkList(LandmarkBaseList _lmk_list);
 
         /** \brief Adds a new state block to be added to solver manager
+         *
+         * With a state arena, the state of the block moves to it, among the others of kind _kind.
          */
-        StateBlock* addStateBlockPtr(StateBlock* _state_ptr);
+        StateBlock* addStateBlockPtr(StateBlock* _state_ptr, StateKind _kind = ST_OTHER);
 
         /** \brief Adds a new state block to be updated to solver manager
          */
         void updateStateBlockPtr(StateBlock* _state_ptr);
 
         /** \brief Adds a state block to be removed to solver manager
+         *
+         * With a state arena, the state of the block moves back to the block.
          */
         void removeStateBlockPtr(StateBlock* _state_ptr);
 
@@ -236,10 +294,98 @@ class Problem : public NodeBase
         void addCovarianceBlock(StateBlock* _state1, StateBlock* _state2, const Eigen::MatrixXs& _cov);
 
         /** \brief Gets a covariance block
+         *
+         * Copies the block (_state1, _state2) into _cov, starting at (_row, _col).
+         * The block (_state2, _state1) is read from the same stored block, transposed.
          */
         bool getCovarianceBlock(StateBlock* _state1, StateBlock* _state2, Eigen::MatrixXs& _cov, const int _row = 0,
                                 const int _col=0);
 
+        /** \brief Gets the covariance store, for bulk fills by the solver and for reads without copies
+         */
+        CovarianceStore* getCovarianceStorePtr();
+
+        /** \brief Stores the state blocks added from now on contiguously, in a StateArena
+         * \param _capacity the number of Scalars of the arena
+         * \param _page_size the number of Scalars of each page, which holds state blocks of one StateKind
+         *
+         * Call it before adding sensors, frames or landmarks: the state blocks added before keep their own storage,
+         * since the solver may already know them by their address.
+         */
+        void enableStateArena(unsigned int _capacity, unsigned int _page_size = 256);
+
+        /** \brief Gets the state arena, or nullptr if there is none
+         */
+        StateArena* getStateArenaPtr();
+
+        /** \brief Sets a fixed-lag window of key frames, for bounded solve times and memory
+         * \param _max_key_frames the maximum number of key frames in the window. 0: no maximum
+         * \param _max_time the maximum time from the oldest to the last key frame in the window. 0: no maximum
+         *
+         * The key frames out of the window are marginalized by the solver before solving, oldest first, see marginalizeKeyFrame().
+         * The last key frame is always in the window.
+         */
+        void setFixedLagWindow(unsigned int _max_key_frames, Scalar _max_time = 0);
+
+        /** \brief Whether there is a fixed-lag window, see setFixedLagWindow()
+         */
+        bool isFixedLag() const;
+
+        /** \brief Gets the key frames out of the fixed-lag window, oldest first
+         */
+        void getKeyFramesOutOfWindow(FrameBaseList& _frame_list);
+
+        /** \brief Gets the active constraints on the state of a key frame, each once: the ones to linearize for marginalizeKeyFrame()
+         */
+        void getConstraintsOnKeyFrame(FrameBase* _frame_ptr, ConstraintBaseList& _ctr_list);
+
+        /** \brief Tells whether a solver evaluates the constraints of the problem on a worker thread, see CeresManager::solveAsync()
+         *
+         * While it does, no key frame can be marginalized or replaced, since that destructs constraints the solver evaluates.
+         * The solver must finish first, see CeresManager::marginalize() and CeresManager::prune().
+         */
+        void setSolverRunning(bool _running);
+        bool isSolverRunning() const;
+
+        /** \brief Replaces a key frame by a prior on the states it was constrained with
+         * \param _frame_ptr the key frame
+         * \param _linearized_constraints the constraints given by getConstraintsOnKeyFrame(), linearized by the solver at the current state
+         *
+         * The prior, a ConstraintMarginalization, goes to a capture of its own in the oldest key frame left.
+         * Then the processors are told with removeKeyFrameCallback(), and the key frame is destructed, with its constraints,
+         * so that both leave the tree and the solver.
+         */
+        void marginalizeKeyFrame(FrameBase* _frame_ptr, const std::list<LinearizedConstraint>& _linearized_constraints);
+
+        /** \brief Replaces a key frame by priors on the states it was constrained with
+         * \param _frame_ptr the key frame
+         * \param _prior_ptrs the priors, not yet in the Wolf tree
+         *
+         * The priors go to a capture of their own in the oldest key frame left, one feature each.
+         * Then the processors are told with removeKeyFrameCallback(), and the key frame is destructed, with its constraints,
+         * so that both leave the tree and the solver.
+         */
+        void replaceKeyFrame(FrameBase* _frame_ptr, const std::list<ConstraintMarginalization*>& _prior_ptrs);
+
+        /** \brief Prunes the redundant key frames from now on, see GraphPruner
+         *
+         * The solver runs the pruning before solving, when it is due.
+         */
+        void enableGraphPruning(const GraphPrunerParams& _params);
+
+        /** \brief Gets the graph pruner, or nullptr if there is none
+         */
+        GraphPruner* getGraphPrunerPtr();
+
+        /** \brief Fills the counts and memory of the nodes, the motion buffers and the pending notifications. Wolf thread only.
+         * \param _statistics the statistics. Its buffers are reused, so that polling it does not allocate.
+         *
+         * It visits the frames, captures, features, landmarks and state blocks, but not the constraints,
+         * so that it can be polled periodically (e.g. once per second) on long runs.
+         * The solver fills its own statistics, see CeresManager::getStatistics().
+         */
+        void getStatistics(ProblemStatistics& _statistics);
+
         /** \brief Gets the covariance of a frame
          */
         bool getFrameCovariance(FrameBase* _frame_ptr, Eigen::MatrixXs& _covariance);
@@ -250,6 +396,13 @@ class Problem : public NodeBase
         bool getLandmarkCovariance(LandmarkBase* _landmark_ptr, Eigen::MatrixXs& _covariance);
         Eigen::MatrixXs getLandmarkCovariance(LandmarkBase* _landmark_ptr);
 
+    private:
+        /** \brief Gets the joint covariance of two state blocks, with three block reads
+         */
+        bool getJointCovariance(StateBlock* _state1, StateBlock* _state2, Eigen::MatrixXs& _covariance);
+
+    public:
+
         /** \brief Adds a map
          */
         MapBase* addMap(MapBase* _map_ptr);
@@ -282,13 +435,30 @@ class Problem : public NodeBase
          */
         StateBlockList* getStateListPtr();
 
-        /** \brief Gets a queue of state blocks notification to be handled by the solver
+        /** \brief Gets the queue of state blocks notifications pending to be handled by the solver
+         *
+         * The notifications are coalesced as they arrive, so that there is at most one ADD or UPDATE per state block:
+         *   - an UPDATE is dropped if the state block has a pending ADD or UPDATE,
+         *   - a REMOVE cancels the pending ADD of the state block, or replaces its pending UPDATE.
+         *
+         * The solver takes them with consumeStateBlockNotificationList().
+         */
+        const std::list<StateBlockNotification>& getStateBlockNotificationList() const;
+
+        /** \brief Moves the pending state block notifications, in order, to the end of _notification_list
+         */
+        void consumeStateBlockNotificationList(std::list<StateBlockNotification>& _notification_list);
+
+        /** \brief Gets the queue of constraint notifications pending to be handled by the solver
+         *
+         * A REMOVE cancels the pending ADD of the constraint.
+         * The solver takes them with consumeConstraintNotificationList().
          */
-        std::list<StateBlockNotification>& getStateBlockNotificationList();
+        const std::list<ConstraintNotification>& getConstraintNotificationList() const;
 
-        /** \brief Gets a queue of constraint notification to be handled by the solver
+        /** \brief Moves the pending constraint notifications, in order, to the end of _notification_list
          */
-        std::list<ConstraintNotification>& getConstraintNotificationList();
+        void consumeConstraintNotificationList(std::list<ConstraintNotification>& _notification_list);
 
         /** \brief get top node (this)
          */
@@ -320,6 +490,36 @@ inline ProcessorMotion* Problem::getProcessorMotionPtr()
     return processor_motion_ptr_;
 }
 
+inline PublishedState* Problem::getPublishedStatePtr()
+{
+    return published_state_ptr_;
+}
+
+inline CovarianceStore* Problem::getCovarianceStorePtr()
+{
+    return covariance_store_ptr_;
+}
+
+inline StateArena* Problem::getStateArenaPtr()
+{
+    return state_arena_ptr_;
+}
+
+inline GraphPruner* Problem::getGraphPrunerPtr()
+{
+    return graph_pruner_ptr_;
+}
+
+inline void Problem::setSolverRunning(bool _running)
+{
+    solver_running_ = _running;
+}
+
+inline bool Problem::isSolverRunning() const
+{
+    return solver_running_;
+}
+
 } // namespace wolf
 
 // IMPLEMENTATION
@@ -327,16 +527,28 @@ inline ProcessorMotion* Problem::getProcessorMotionPtr()
 namespace wolf
 {
 
-inline std::list<StateBlockNotification>& Problem::getStateBlockNotificationList()
+inline const std::list<StateBlockNotification>& Problem::getStateBlockNotificationList() const
 {
     return state_block_notification_list_;
 }
 
-inline std::list<ConstraintNotification>& Problem::getConstraintNotificationList()
+inline void Problem::consumeStateBlockNotificationList(std::list<StateBlockNotification>& _notification_list)
+{
+    _notification_list.splice(_notification_list.end(), state_block_notification_list_);
+    state_block_notification_map_.clear();
+}
+
+inline const std::list<ConstraintNotification>& Problem::getConstraintNotificationList() const
 {
     return constraint_notification_list_;
 }
 
+inline void Problem::consumeConstraintNotificationList(std::list<ConstraintNotification>& _notification_list)
+{
+    _notification_list.splice(_notification_list.end(), constraint_notification_list_);
+    constraint_notification_map_.clear();
+}
+
 inline Problem* Problem::getProblem()
 {
     return this;
@@ -0,0 +1,97 @@
+/**
+ * \file problem_statistics.h
+ *
+ *  Created on: Jul 16, 2016
+ *      \author: jsola
+ */
+
+#ifndef PROBLEM_STATISTICS_H_
+#define PROBLEM_STATISTICS_H_
+
+// Fwd refs
+namespace wolf{
+class ProcessorMotion;
+}
+
+// STL includes
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace wolf {
+
+/** \brief Number of nodes of one class, and an estimation of their memory
+ */
+struct NodeStatistics
+{
+        unsigned int count_;    ///< number of nodes
+        std::size_t bytes_;     ///< estimation of their memory, in bytes
+};
+
+/** \brief Size of the motion buffer being integrated by a ProcessorMotion
+ */
+struct MotionBufferStatistics
+{
+        const ProcessorMotion* processor_ptr_;
+        std::string name_;          ///< name of the processor
+        std::size_t size_;          ///< Motions in the buffer
+        std::size_t capacity_;      ///< Motions the buffer can hold without allocating
+        std::size_t bytes_;         ///< memory of the buffer, in bytes
+        unsigned int captures_;     ///< captures in the time index of the processor, the buffers of the key frames included
+};
+
+/** \brief Memory and sizes of a problem, by subsystem
+ *
+ * Problem::getStatistics() fills all but the solver ones, which CeresManager::getStatistics() fills.
+ *
+ * The bytes of each node class are the ones of the nodes themselves, plus the data they own on the heap:
+ *   - frames: the nodes, whose state blocks are in state_blocks_
+ *   - captures: the nodes and the motion buffers of the motion captures
+ *   - features: the nodes, the measurements and their covariances
+ *   - constraints: the nodes
+ *   - landmarks: the nodes and their descriptors
+ * The size of the nodes is the average size of the nodes of the class in their NodePool, so that derived classes count.
+ * It does not count the memory of the node lists, nor the memory kept by the pools for recycling.
+ */
+struct ProblemStatistics
+{
+        NodeStatistics frames_;
+        NodeStatistics captures_;
+        NodeStatistics features_;
+        NodeStatistics constraints_;
+        NodeStatistics landmarks_;
+        NodeStatistics state_blocks_;
+
+        std::vector<MotionBufferStatistics> motion_buffers_; ///< one per ProcessorMotion. Their captures are in captures_ as well.
+
+        unsigned int state_block_notifications_;    ///< pending for the solver
+        unsigned int constraint_notifications_;     ///< pending for the solver
+
+        unsigned int solver_residual_blocks_;       ///< residual blocks in the solver
+        unsigned int solver_parameter_blocks_;      ///< parameter blocks in the solver
+        std::size_t solver_bytes_;                  ///< estimation of the memory of the solver copies of the states, in bytes
+
+        ProblemStatistics();
+
+        /** \brief Memory of the nodes and state blocks of the Wolf tree, in bytes
+         */
+        std::size_t getTreeBytes() const;
+};
+
+inline ProblemStatistics::ProblemStatistics() :
+        frames_({0, 0}), captures_({0, 0}), features_({0, 0}), constraints_({0, 0}), landmarks_({0, 0}), state_blocks_({0, 0}),
+        state_block_notifications_(0), constraint_notifications_(0),
+        solver_residual_blocks_(0), solver_parameter_blocks_(0), solver_bytes_(0)
+{
+    //
+}
+
+inline std::size_t ProblemStatistics::getTreeBytes() const
+{
+    return frames_.bytes_ + captures_.bytes_ + features_.bytes_ + constraints_.bytes_ + landmarks_.bytes_
+            + state_blocks_.bytes_;
+}
+
+} // namespace wolf
+
+#endif /* PROBLEM_STATISTICS_H_ */
@@ -38,6 +38,15 @@ class ProcessorBase : public NodeLinked<SensorBase, NodeTerminus>
 
         unsigned int id();
 
+        /** \brief Extracts the data of a capture, without touching the Wolf tree
+         *
+         * CaptureExecutor calls this on the processors of different sensors concurrently,
+         * before calling process() on the same capture. process() must not rely on it being called.
+         * Overload it to do here the heavy work that only reads the capture's raw data and writes the processor's own data,
+         * e.g. extracting corners from a laser scan.
+         */
+        virtual void extract(CaptureBase* _capture_ptr) { };
+
         virtual void process(CaptureBase* _capture_ptr) = 0;
 
         /** \brief Vote for KeyFrame generation
@@ -55,8 +64,31 @@ class ProcessorBase : public NodeLinked<SensorBase, NodeTerminus>
          */
         virtual void makeFrame(CaptureBase* _capture_ptr, FrameKeyType _type = NON_KEY_FRAME);
 
+        /** \brief Prepares the key frame callback, without modifying the Wolf tree
+         *
+         * Problem::keyFrameCallback() calls this on all processors before calling their keyFrameCallback(),
+         * concurrently if so configured (see Problem::setKeyFrameCallbackThreads()).
+         * Overload it to do here the heavy work that only touches the processor's own data, e.g. detecting features.
+         * It must not add, remove or modify any node of the tree, and may only read it.
+         */
+        virtual void keyFrameCallbackPrepare(FrameBase* _keyframe_ptr, const Scalar& _time_tolerance) { };
+
         virtual bool keyFrameCallback(FrameBase* _keyframe_ptr, const Scalar& _time_tolerance) = 0;
 
+        /** \brief Removed key frame callback
+         *
+         * Problem::removeKeyFrameCallback() calls this on all processors right before a key frame is destructed,
+         * e.g. when it is marginalized. Overload it to drop any pointer of the processor into the key frame.
+         */
+        virtual void removeKeyFrameCallback(FrameBase* _keyframe_ptr) { };
+
+        /** \brief Solve callback
+         *
+         * Problem::solveCallback() calls this on all processors after the solver wrote a solution into the state blocks.
+         * Overload it to update what the processor derives from the estimated states, e.g. the IMU biases.
+         */
+        virtual void solveCallback() { };
+
         SensorBase* getSensorPtr();
         const SensorBase* getSensorPtr() const;
 
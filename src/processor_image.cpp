@@ -72,10 +72,13 @@ ProcessorImage::~ProcessorImage()
 
 }
 
-void ProcessorImage::preProcess()
+void ProcessorImage::extractIncoming(CaptureBase* _incoming_ptr)
 {
-    image_incoming_ = ((CaptureImage*)incoming_ptr_)->getImage();
+    image_incoming_ = ((CaptureImage*)_incoming_ptr)->getImage();
+}
 
+void ProcessorImage::preProcess()
+{
     if (last_ptr_ == nullptr) // do this just one time!
     {
         params_.image.width = image_incoming_.cols;
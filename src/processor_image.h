@@ -133,7 +133,12 @@ class ProcessorImage : public ProcessorTrackerFeature
     protected:
 
         /**
-         * \brief Does cast of the images and renews the active grid.
+         * \brief Does cast of the images.
+         */
+        void extractIncoming(CaptureBase* _incoming_ptr);
+
+        /**
+         * \brief Renews the active grid.
          */
         void preProcess();
 
@@ -82,10 +82,13 @@ ProcessorImageLandmark::~ProcessorImageLandmark()
     //
 }
 
-void ProcessorImageLandmark::preProcess()
+void ProcessorImageLandmark::extractIncoming(CaptureBase* _incoming_ptr)
 {
-    image_incoming_ = ((CaptureImage*)incoming_ptr_)->getImage();
+    image_incoming_ = ((CaptureImage*)_incoming_ptr)->getImage();
+}
 
+void ProcessorImageLandmark::preProcess()
+{
     if (last_ptr_ == nullptr) // do this just one time!
     {
         params_.image.width = image_incoming_.cols;
@@ -3,11 +3,12 @@
 namespace wolf {
 
 ProcessorIMU::ProcessorIMU() :
-        ProcessorMotion(PRC_IMU, "IMU", 16, 10, 9, 6),
+        ProcessorMotionT(PRC_IMU, "IMU", 16, 10, 9, 6),
         frame_imu_ptr_(nullptr),
         gravity_(wolf::gravity()),
-        bias_acc_(nullptr),
-        bias_gyro_(nullptr),
+        acc_bias_preint_(Eigen::Vector3s::Zero()),
+        gyro_bias_preint_(Eigen::Vector3s::Zero()),
+        bias_correction_threshold_(0.1),
         measured_acc_(nullptr),
         measured_gyro_(nullptr),
         position_preint_         (delta_integrated_.data() + 0),
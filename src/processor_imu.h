@@ -8,11 +8,56 @@
 
 namespace wolf {
 
-class ProcessorIMU : public ProcessorMotion{
+/** \brief IMU pre-integrator
+ *
+ * ### Bias updates
+ *
+ * The deltas are pre-integrated with the biases of the origin key-frame at the time the integration started.
+ * When the solver changes the estimate of these biases, correctBias() updates the pre-integration.
+ * The solver calls it through Problem::solveCallback() after each solve. It proceeds in one of two ways:
+ *   - If the bias change is small, the integrated delta is corrected to first order,
+ *     using the Jacobians of the delta wrt the biases, in constant time.
+ *     The next Motions are integrated with the new biases.
+ *     The Motions already in the buffer are corrected later, by a re-integration, only when they are needed:
+ *     at a key frame in the past of the buffer (keyFrameCallback()), or for a state in the buffer (getState()).
+ *     getMotion(const TimeStamp&) reads them as they were integrated.
+ *   - If the bias change exceeds the threshold set with setBiasCorrectionThreshold(),
+ *     all the deltas in the buffer are recomputed with the new biases, and the buffer is re-integrated.
+ *
+ * The re-integration accounts for each Motion with the biases it was integrated with,
+ * so that the first order corrections since the last re-integration are not lost.
+ */
+class ProcessorIMU : public ProcessorMotionT<10, 9>{
     public:
         ProcessorIMU();
         virtual ~ProcessorIMU();
 
+        /** \brief Updates the pre-integrated delta to the current biases of the origin key-frame
+         * \return true if the buffer has been fully re-integrated, false if the delta has been corrected to first order.
+         */
+        bool correctBias();
+
+        /** \brief Sets the maximum bias change handled by first-order correction
+         * \param _threshold norm of the change of the stacked acc and gyro biases above which correctBias() re-integrates the buffer.
+         *
+         * Set it to zero to always re-integrate.
+         */
+        void setBiasCorrectionThreshold(const Scalar _threshold);
+        Scalar getBiasCorrectionThreshold() const;
+
+        /** \brief Corrects the biases after a solve, see correctBias()
+         */
+        virtual void solveCallback();
+
+        /** \brief Re-integrates the buffer first if it has first order bias corrections, see correctBias()
+         */
+        virtual bool keyFrameCallback(FrameBase* _keyframe_ptr, const Scalar& _time_tol);
+
+        /** \brief Re-integrates the buffer first if _ts is in it and it has first order bias corrections, see correctBias()
+         */
+        virtual void getState(const TimeStamp& _ts, Eigen::VectorXs& _x);
+        using ProcessorMotionT::getState;
+
     protected:
 
         // Helper functions
@@ -37,15 +82,22 @@ class ProcessorIMU : public ProcessorMotion{
          *
          * See its definition for more comments about the inner maths.
          */
-        virtual void deltaPlusDelta(const Eigen::VectorXs& _delta_preint, const Eigen::VectorXs& _delta,
-                                    const Scalar _dt, Eigen::VectorXs& _delta_preint_plus_delta);
+        virtual void deltaPlusDelta(const DeltaType& _delta_preint, const DeltaType& _delta,
+                                    const Scalar _dt, DeltaType& _delta_preint_plus_delta);
+
+        virtual void deltaPlusDelta(const DeltaType& _delta_preint, const DeltaType& _delta,
+                                    const Scalar _dt, DeltaType& _delta_preint_plus_delta,
+                                    DeltaCovType& _jacobian_delta_preint, DeltaCovType& _jacobian_delta);
 
-        virtual void deltaPlusDelta(const Eigen::VectorXs& _delta_preint, const Eigen::VectorXs& _delta,
-                                    const Scalar _dt, Eigen::VectorXs& _delta_preint_plus_delta,
-                                    Eigen::MatrixXs& _jacobian_delta_preint, Eigen::MatrixXs& _jacobian_delta);
+        /** \brief propagates the covariances of a delta composition, see imuDeltaCovPlusDeltaCov()
+         */
+        virtual void deltaCovPlusDeltaCov(const DeltaCovType& _delta_cov1, const DeltaCovType& _delta_cov2,
+                                          const Scalar _Dt2,
+                                          const DeltaCovType& _jacobian1, const DeltaCovType& _jacobian2,
+                                          DeltaCovType& _delta_cov1_plus_delta_cov2) const;
 
-        virtual void deltaMinusDelta(const Eigen::VectorXs& _delta_1, const Eigen::VectorXs& _delta_2,
-                                     const Scalar _dt, Eigen::VectorXs& _delta_1_minus_delta_2);
+        virtual void deltaMinusDelta(const DeltaType& _delta_1, const DeltaType& _delta_2,
+                                     const Scalar _dt, DeltaType& _delta_1_minus_delta_2);
 
         /** \brief composes a delta-state on top of a state
          * \param _x the initial state
@@ -55,16 +107,22 @@ class ProcessorIMU : public ProcessorMotion{
          *
          * This function implements the composition (+) so that _x2 = _x1 (+) _delta.
          */
-        virtual void xPlusDelta(const Eigen::VectorXs& _x, const Eigen::VectorXs& _delta, const Scalar _Dt,
+        virtual void xPlusDelta(const Eigen::VectorXs& _x, const DeltaType& _delta, const Scalar _Dt,
                                 Eigen::VectorXs& _x_plus_delta );
 
 
 
         /** \brief Delta representing the null motion
          */
-        virtual Eigen::VectorXs deltaZero() const;
+        virtual DeltaType deltaZero() const;
 
-        virtual Motion interpolate(const Motion& _motion_ref, Motion& _motion, TimeStamp& _ts);
+        virtual MotionType interpolate(const MotionType& _motion_ref, MotionType& _motion, TimeStamp& _ts);
+
+        /** \brief Merges two consecutive Motions, keeping the Jacobians wrt the biases
+         *
+         * deltaPlusDelta() integrates the Jacobians wrt the biases, which must not happen when merging Motions of the buffer.
+         */
+        virtual void mergeMotions(const MotionType& _previous, const MotionType& _first, MotionType& _second);
 
         void resetDerived();
 
@@ -81,9 +139,25 @@ class ProcessorIMU : public ProcessorMotion{
         // gravity vector
         const Eigen::Vector3s gravity_;
 
-        // Maps to the biases in the keyframe's state
-        Eigen::Map<Eigen::Vector3s> bias_acc_;
-        Eigen::Map<Eigen::Vector3s> bias_gyro_;
+        // The biases in the origin keyframe's state. They are read each time, since the state moves, e.g. in and out of the StateArena
+        Eigen::Map<const Eigen::Vector3s> getAccBias() const;
+        Eigen::Map<const Eigen::Vector3s> getGyroBias() const;
+
+        // Biases used for the pre-integration
+        Eigen::Vector3s acc_bias_preint_;
+        Eigen::Vector3s gyro_bias_preint_;
+
+        // Biases used for the Motions of the buffer newer than ts_, up to the next ones. The last ones are the preint ones.
+        struct BiasEpoch
+        {
+                TimeStamp ts_;
+                Eigen::Vector3s acc_bias_;
+                Eigen::Vector3s gyro_bias_;
+        };
+        std::vector<BiasEpoch> bias_epochs_;
+
+        // Bias change above which the buffer is re-integrated
+        Scalar bias_correction_threshold_;
 
         // Maps to the received measurements
         Eigen::Map<Eigen::Vector3s> measured_acc_;
@@ -104,10 +178,14 @@ class ProcessorIMU : public ProcessorMotion{
 
 
         // Helper functions to remap several magnitudes
-        void remapPVQ(const Eigen::VectorXs& _delta1, const Eigen::VectorXs& _delta2, Eigen::VectorXs& _delta_out);
-        void remapDelta(Eigen::VectorXs& _delta_out);
+        template<typename D1, typename D2, typename D3>
+        void remapPVQ(const Eigen::PlainObjectBase<D1>& _delta1, const Eigen::PlainObjectBase<D2>& _delta2, Eigen::PlainObjectBase<D3>& _delta_out);
+        void remapDelta(DeltaType& _delta_out);
         void remapData(const Eigen::VectorXs& _data);
 
+        // Re-integrates the buffer with the current biases
+        void reintegrateBias();
+
         ///Jacobians of preintegrated delta wrt IMU biases
         Eigen::Matrix3s dDp_dab_;
         Eigen::Matrix3s dDv_dab_;
@@ -128,6 +206,7 @@ class ProcessorIMU : public ProcessorMotion{
 // Wolf
 #include "state_block.h"
 #include "rotations.h"
+#include "imu_tools.h"
 
 
 namespace wolf{
@@ -149,8 +228,8 @@ inline void ProcessorIMU::data2delta(const Eigen::VectorXs& _data, const Eigen::
 
     // create delta
     //Use SOLA-16 convention by default
-    Eigen::Vector3s a = measured_acc_ - bias_acc_;
-    Eigen::Vector3s w = measured_gyro_ - bias_gyro_;
+    Eigen::Vector3s a = measured_acc_ - acc_bias_preint_;
+    Eigen::Vector3s w = measured_gyro_ - gyro_bias_preint_;
     v_out_ = a * _dt;
     p_out_ = v_out_ * _dt / 2;
     q_out_ = v2q(w * _dt);
@@ -195,13 +274,10 @@ inline void ProcessorIMU::data2delta(const Eigen::VectorXs& _data, const Eigen::
 
 }
 
-inline void ProcessorIMU::deltaPlusDelta(const Eigen::VectorXs& _delta_preint, const Eigen::VectorXs& _delta,
-                                         const Scalar _dt, Eigen::VectorXs& _delta_preint_plus_delta,
-                                         Eigen::MatrixXs& _jacobian_delta_preint, Eigen::MatrixXs& _jacobian_delta)
+inline void ProcessorIMU::deltaPlusDelta(const DeltaType& _delta_preint, const DeltaType& _delta,
+                                         const Scalar _dt, DeltaType& _delta_preint_plus_delta,
+                                         DeltaCovType& _jacobian_delta_preint, DeltaCovType& _jacobian_delta)
 {
-
-    remapPVQ(_delta_preint, _delta, _delta_preint_plus_delta);
-
     //////////////////////////////////////////////////////////
     // 1. Start by computing the Jacobians before updating the deltas. This avoids aliasing.
 
@@ -265,25 +341,7 @@ inline void ProcessorIMU::deltaPlusDelta(const Eigen::VectorXs& _delta_preint, c
      *     0    0   Jr^-1 ] // log(exp(Df)exp(df)) = Df + Jr^-1*df --> dDf'/ddf = Jr^-1
      */
 
-    // Some useful temporaries
-    Eigen::Matrix3s DR_1      = q_in_1_.matrix();
-    Eigen::Matrix3s dR_2      = q_in_2_.matrix();
-    Eigen::Vector3s Dtheta_1  = q2v(q_in_1_);
-    Eigen::MatrixXs Jr_1      = jac_SO3_right(Dtheta_1);
-    Eigen::MatrixXs Jr_2      = jac_SO3_right(q2v(q_in_2_));
-
-    // Jac wrt preintegrated delta
-    _jacobian_delta_preint.setIdentity(9,9);                                    // dDp'/ddp, dDv'/ddv, dDf'/ddf
-    _jacobian_delta_preint.block<3,3>(0,3) = Eigen::Matrix3s::Identity() * _dt; // dDp'/ddv
-    _jacobian_delta_preint.block<3,3>(0,6) = - DR_1 * skew(p_in_2_) * Jr_1 ; // dDp'/ddf
-    _jacobian_delta_preint.block<3,3>(3,6) = - DR_1 * skew(v_in_2_) * Jr_1 ; // dDv'/ddf
-    _jacobian_delta_preint.block<3,3>(6,6) =   dR_2 * Jr_1;
-
-    // Jac wrt current delta
-    _jacobian_delta.setZero(9,9);
-    _jacobian_delta.block<3,3>(0,0) = DR_1;
-    _jacobian_delta.block<3,3>(3,3) = DR_1;
-    _jacobian_delta.block<3,3>(6,6) = Jr_2;
+    imuDeltaPlusDeltaJacobians(_delta_preint, _delta, _dt, _jacobian_delta_preint, _jacobian_delta);
 
     /////////////////////////////////////////////////////////
     // 2. Integrate the Jacobians wrt the biases
@@ -298,12 +356,20 @@ inline void ProcessorIMU::deltaPlusDelta(const Eigen::VectorXs& _delta_preint, c
     //
     // dDv/dwb -= DR * [a - ab]^ * dDf/dwb * dt                                 // Sola 16 -- OK Forster
     //
-    // dDf/dwb -= dR.t * Jr * dt      where Jr  == right Jacobian               // Sola 16 -- OK Forster
+    // dDf/dwb = dR.t * dDf/dwb - Jr * dt      where Jr  == right Jacobian      // Sola 16 -- OK Forster
     //                                     dR.t == exp(- (w - wb) * dt)
 
-    // acc and gyro measurements corrected with the estimated bias
-    Eigen::Matrix3s acc_skew =  skew(measured_acc_ - bias_acc_);
-    Eigen::Vector3s omega    =  measured_gyro_ - bias_gyro_;
+    // acc and gyro measurements corrected with the estimated bias.
+    // We recover them from the current delta, so that this also works when re-integrating the buffer.
+    Eigen::Vector3s acc      =  Eigen::Vector3s::Zero();
+    Eigen::Vector3s omega    =  Eigen::Vector3s::Zero();
+    if (_dt > 0)
+    {
+        acc   = _delta.segment<3>(3) / _dt;
+        omega = q2v<Scalar>(Eigen::Quaternions(_delta.segment<4>(6))) / _dt;
+    }
+    Eigen::Matrix3s acc_skew =  skew(acc);
+    Eigen::Matrix3s DR_1     =  _jacobian_delta.block<3,3>(0,0); // R(Dq), see imuDeltaPlusDeltaJacobians()
 
     // temporaries
     Scalar dt2_2      = 0.5 * _dt * _dt;
@@ -315,27 +381,17 @@ inline void ProcessorIMU::deltaPlusDelta(const Eigen::VectorXs& _delta_preint, c
     dDp_dwb_ += dDv_dwb_ * _dt - M * dt2_2;
     dDv_dwb_ -= M * _dt;
 
-    dDq_dwb_ -= v2R( - omega * _dt) * jac_SO3_right(omega * _dt) * _dt; // See SOLA-16
+    dDq_dwb_ = v2R( - omega * _dt) * dDq_dwb_ - jac_SO3_right(omega * _dt) * _dt; // See SOLA-16
 
     ///////////////////////////////////////////////////////////////////////////
     // 3. Update the deltas down here to avoid aliasing in the Jacobians section
-    deltaPlusDelta(_delta_preint, _delta, _dt, _delta_preint_plus_delta);
+    imuDeltaPlusDelta(_delta_preint, _delta, _dt, _delta_preint_plus_delta);
 
 }
 
-inline void ProcessorIMU::deltaPlusDelta(const Eigen::VectorXs& _delta_preint, const Eigen::VectorXs& _delta,
-                                         const Scalar _dt, Eigen::VectorXs& _delta_preint_plus_delta)
+inline void ProcessorIMU::deltaPlusDelta(const DeltaType& _delta_preint, const DeltaType& _delta,
+                                         const Scalar _dt, DeltaType& _delta_preint_plus_delta)
 {
-    assert(_delta_preint.size() == 10 && "Wrong _delta_preint vector size");
-    assert(_delta.size() == 10 && "Wrong _delta vector size");
-    assert(_delta_preint_plus_delta.size() == 10 && "Wrong _delta_preint_plus_delta vector size");
-
-    remapPVQ(_delta_preint, _delta, _delta_preint_plus_delta);
-    // _delta_preint             is _in_1_
-    // _delta                    is _in_2_
-    // _delta_preint_plus_delta  is _out_
-
-
     /* MATHS according to Sola-16
      * Dp' = Dp + Dv*dt + 1/2*Dq*(a-a_b)*dt^2    = Dp + Dv*dt + Dq*dp   if  dp = 1/2*(a-a_b)*dt^2
      * Dv' = Dv + Dq*(a-a_b)*dt                  = Dv + Dq*dv           if  dv = (a-a_b)*dt
@@ -346,26 +402,25 @@ inline void ProcessorIMU::deltaPlusDelta(const Eigen::VectorXs& _delta_preint, c
      * warning: All deltas (Dp, Dv, Dq) are physically interpretable:
      * they represent the position, velocity and orientation of a body with
      * respect to a reference frame that is non-rotating and free-falling at the acceleration of gravity.
+     *
+     * Note: we might be (and in fact we are) calling this fcn with the same input and output:
+     *     deltaPlusDelta(delta_integrated_, delta_, dt_, delta_integrated_);
+     * imuDeltaPlusDelta() takes care of the aliasing.
      */
-
-    // delta pre-integration
-    // For the math, use SOLA-16 convention by default
-    // Note: we might be (and in fact we are) calling this fcn with the same input and output:
-    //     deltaPlusDelta(delta_integrated_, delta_, dt_, delta_integrated_);
-    // that is, _delta1 and _delta1_plus_delta2 point to the same memory locations.
-    // Therefore, to avoid aliasing, we proceed in the order p -> v -> q
-    p_out_ = p_in_1_ + v_in_1_ * _dt + q_in_1_ * p_in_2_;
-    v_out_ = v_in_1_ + q_in_1_ * v_in_2_;
-    q_out_ = q_in_1_ * q_in_2_;
+    imuDeltaPlusDelta(_delta_preint, _delta, _dt, _delta_preint_plus_delta);
 }
 
-inline void ProcessorIMU::deltaMinusDelta(const Eigen::VectorXs& _delta_1, const Eigen::VectorXs& _delta_2,
-                                          const Scalar _dt, Eigen::VectorXs& _delta_1_minus_delta_2)
+inline void ProcessorIMU::deltaCovPlusDeltaCov(const DeltaCovType& _delta_cov1, const DeltaCovType& _delta_cov2,
+                                               const Scalar _Dt2, const DeltaCovType& _jacobian1,
+                                               const DeltaCovType& _jacobian2, DeltaCovType& _delta_cov1_plus_delta_cov2) const
 {
-    assert(_delta_1.size() == 10 && "Wrong _delta_1 vector size");
-    assert(_delta_2.size() == 10 && "Wrong _delta_2 vector size");
-    assert(_delta_1_minus_delta_2.size() == 10 && "Wrong _delta_1_minus_delta_2 vector size");
+    // The Jacobians always come from deltaPlusDelta(): skip their identity and zero blocks
+    imuDeltaCovPlusDeltaCov(_delta_cov1, _delta_cov2, _jacobian1, _jacobian2, _delta_cov1_plus_delta_cov2);
+}
 
+inline void ProcessorIMU::deltaMinusDelta(const DeltaType& _delta_1, const DeltaType& _delta_2,
+                                          const Scalar _dt, DeltaType& _delta_1_minus_delta_2)
+{
     remapPVQ(_delta_1, _delta_2, _delta_1_minus_delta_2);
     // _delta_1                 is _in_1_
     // _delta_2                 is _in_2_
@@ -378,11 +433,10 @@ inline void ProcessorIMU::deltaMinusDelta(const Eigen::VectorXs& _delta_1, const
     q_out_ = q_in_1_ * q_in_2_.conjugate();
 }
 
-inline void ProcessorIMU::xPlusDelta(const Eigen::VectorXs& _x, const Eigen::VectorXs& _delta, const Scalar _Dt,
+inline void ProcessorIMU::xPlusDelta(const Eigen::VectorXs& _x, const DeltaType& _delta, const Scalar _Dt,
                                      Eigen::VectorXs& _x_plus_delta)
 {
     assert(_x.size() == 16 && "Wrong _x vector size");
-    assert(_delta.size() == 10 && "Wrong _delta vector size");
     assert(_x_plus_delta.size() == 16 && "Wrong _x_plus_delta vector size");
     assert(_Dt >= 0 && "Time interval _Dt is negative!");
 
@@ -402,36 +456,181 @@ inline void ProcessorIMU::xPlusDelta(const Eigen::VectorXs& _x, const Eigen::Vec
     _x_plus_delta.tail(6) = _x.tail(6);
 }
 
-inline Eigen::VectorXs ProcessorIMU::deltaZero() const
+inline ProcessorIMU::DeltaType ProcessorIMU::deltaZero() const
 {
-    return (Eigen::VectorXs(10) << 0,0,0,  0,0,0,  0,0,0,1 ).finished(); // p, v, q
+    return (DeltaType() << 0,0,0,  0,0,0,  0,0,0,1 ).finished(); // p, v, q
 }
 
-inline Motion ProcessorIMU::interpolate(const Motion& _motion_ref, Motion& _motion, TimeStamp& _ts)
+inline ProcessorIMU::MotionType ProcessorIMU::interpolate(const MotionType& _motion_ref, MotionType& _motion, TimeStamp& _ts)
 {
-    Motion tmp(_motion_ref);
+    MotionType tmp(_motion_ref);
     tmp.ts_ = _ts;
     tmp.delta_ = deltaZero();
-    tmp.delta_cov_ = Eigen::MatrixXs::Zero(delta_size_, delta_size_);
+    tmp.delta_cov_.setZero();
     return tmp;
 }
 
 
+inline void ProcessorIMU::mergeMotions(const MotionType& _previous, const MotionType& _first, MotionType& _second)
+{
+    Eigen::Matrix3s dDp_dab(dDp_dab_), dDv_dab(dDv_dab_), dDp_dwb(dDp_dwb_), dDv_dwb(dDv_dwb_), dDq_dwb(dDq_dwb_);
+
+    ProcessorMotionT::mergeMotions(_previous, _first, _second);
+
+    dDp_dab_ = dDp_dab;
+    dDv_dab_ = dDv_dab;
+    dDp_dwb_ = dDp_dwb;
+    dDv_dwb_ = dDv_dwb;
+    dDq_dwb_ = dDq_dwb;
+}
+
 inline void ProcessorIMU::resetDerived()
 {
     // Remap biases for the integration at the origin frame's biases
     frame_imu_ptr_ = (FrameIMU*)((origin_ptr_->getFramePtr()));
-    new (&bias_acc_)  Eigen::Map<const Eigen::Vector3s>(frame_imu_ptr_->getBAPtr()->getVector().data()); // acc  bias
-    new (&bias_gyro_) Eigen::Map<const Eigen::Vector3s>(frame_imu_ptr_->getBGPtr()->getVector().data()); // gyro bias
+    acc_bias_preint_  = getAccBias();
+    gyro_bias_preint_ = getGyroBias();
+    bias_epochs_.assign(1, BiasEpoch({getBufferPtr()->get().front().ts_, acc_bias_preint_, gyro_bias_preint_}));
+
+    // reset jacobians wrt bias
+    dDp_dab_.setZero();
+    dDv_dab_.setZero();
+    dDp_dwb_.setZero();
+    dDv_dwb_.setZero();
+    dDq_dwb_.setZero();
+}
+
+
+inline Eigen::Map<const Eigen::Vector3s> ProcessorIMU::getAccBias() const
+{
+    return Eigen::Map<const Eigen::Vector3s>(frame_imu_ptr_->getBAPtr()->getPtr());
+}
 
+inline Eigen::Map<const Eigen::Vector3s> ProcessorIMU::getGyroBias() const
+{
+    return Eigen::Map<const Eigen::Vector3s>(frame_imu_ptr_->getBGPtr()->getPtr());
+}
+
+inline bool ProcessorIMU::correctBias()
+{
+    Eigen::Vector3s acc_bias_change  = getAccBias() - acc_bias_preint_;
+    Eigen::Vector3s gyro_bias_change = getGyroBias() - gyro_bias_preint_;
+
+    if (acc_bias_change.squaredNorm() + gyro_bias_change.squaredNorm() > bias_correction_threshold_ * bias_correction_threshold_)
+    {
+        reintegrateBias();
+        return true;
+    }
+    if (acc_bias_change.isZero(0) && gyro_bias_change.isZero(0))
+        return false;
+
+    // the next Motions are integrated with the new biases
+    acc_bias_preint_  = getAccBias();
+    gyro_bias_preint_ = getGyroBias();
+    const TimeStamp& ts = getBufferPtr()->get().back().ts_;
+    if (!(bias_epochs_.back().ts_ < ts))
+        bias_epochs_.pop_back();
+    bias_epochs_.push_back(BiasEpoch({ts, acc_bias_preint_, gyro_bias_preint_}));
+
+    /* MATHS of the first order correction -- Forster-16
+     * Dp' = Dp + dDp/dab * dab + dDp/dwb * dwb
+     * Dv' = Dv + dDv/dab * dab + dDv/dwb * dwb
+     * Dq' = Dq * exp(dDf/dwb * dwb)
+     *
+     * The Jacobians wrt the biases are not modified: they keep integrating from the new linearization point.
+     */
+    remapDelta(delta_integrated_);
+    p_out_ += dDp_dab_ * acc_bias_change + dDp_dwb_ * gyro_bias_change;
+    v_out_ += dDv_dab_ * acc_bias_change + dDv_dwb_ * gyro_bias_change;
+    q_out_ = q_out_ * v2q(dDq_dwb_ * gyro_bias_change);
+    q_out_.normalize();
+
+    getBufferPtr()->get().back().delta_integr_ = delta_integrated_;
+
+    return false;
+}
+
+inline void ProcessorIMU::reintegrateBias()
+{
     // reset jacobians wrt bias
     dDp_dab_.setZero();
     dDv_dab_.setZero();
     dDp_dwb_.setZero();
     dDv_dwb_.setZero();
     dDq_dwb_.setZero();
+
+    /* MATHS: the deltas of each IMU step are exactly updated to the new biases,
+     * from the ones they were integrated with:
+     * dp' = dp - 1/2 * dab * dt^2
+     * dv' = dv - dab * dt
+     * dq' = exp(log(dq) - dwb * dt)
+     */
+    auto& motions = getBufferPtr()->get();
+    auto epoch_it = bias_epochs_.begin();
+    Eigen::Vector3s acc_bias_change  = getAccBias() - epoch_it->acc_bias_;
+    Eigen::Vector3s gyro_bias_change = getGyroBias() - epoch_it->gyro_bias_;
+    for (auto motion_it = motions.begin() + 1; motion_it != motions.end(); motion_it++)
+    {
+        auto prev_motion_it = motion_it - 1;
+        const Scalar dt = motion_it->ts_ - prev_motion_it->ts_;
+
+        if (epoch_it + 1 != bias_epochs_.end() && (epoch_it + 1)->ts_ < motion_it->ts_)
+        {
+            epoch_it++;
+            acc_bias_change  = getAccBias() - epoch_it->acc_bias_;
+            gyro_bias_change = getGyroBias() - epoch_it->gyro_bias_;
+        }
+
+        remapDelta(motion_it->delta_);
+        p_out_ -= acc_bias_change * dt * dt / 2;
+        v_out_ -= acc_bias_change * dt;
+        q_out_ = v2q(q2v<Scalar>(q_out_) - gyro_bias_change * dt);
+
+        deltaPlusDelta(prev_motion_it->delta_integr_, motion_it->delta_, dt, motion_it->delta_integr_,
+                       motion_it->jacobian_0, motion_it->jacobian_ts);
+    }
+
+    delta_integrated_ = motions.back().delta_integr_;
+    acc_bias_preint_  = getAccBias();
+    gyro_bias_preint_ = getGyroBias();
+    bias_epochs_.assign(1, BiasEpoch({motions.front().ts_, acc_bias_preint_, gyro_bias_preint_}));
+
+    // covariances are propagated with the new Jacobians, now or when needed
+    n_cov_integrated_ = 0;
+    if (!lazy_covariance_)
+        integrateCovariance();
+}
+
+inline void ProcessorIMU::setBiasCorrectionThreshold(const Scalar _threshold)
+{
+    bias_correction_threshold_ = _threshold;
+}
+
+inline Scalar ProcessorIMU::getBiasCorrectionThreshold() const
+{
+    return bias_correction_threshold_;
 }
 
+inline void ProcessorIMU::solveCallback()
+{
+    if (frame_imu_ptr_ != nullptr)
+        correctBias();
+}
+
+inline bool ProcessorIMU::keyFrameCallback(FrameBase* _keyframe_ptr, const Scalar& _time_tol)
+{
+    // the buffer may be split and re-integrated from the key frame
+    if (bias_epochs_.size() > 1)
+        reintegrateBias();
+    return ProcessorMotionT::keyFrameCallback(_keyframe_ptr, _time_tol);
+}
+
+inline void ProcessorIMU::getState(const TimeStamp& _ts, Eigen::VectorXs& _x)
+{
+    if (bias_epochs_.size() > 1 && getBufferPtr()->get().front().ts_ < _ts && _ts < getBufferPtr()->get().back().ts_)
+        reintegrateBias();
+    ProcessorMotionT::getState(_ts, _x);
+}
 
 inline ConstraintBase* ProcessorIMU::createConstraint(FeatureBase* _feature_motion, FrameBase* _frame_origin)
 {
@@ -439,7 +638,8 @@ inline ConstraintBase* ProcessorIMU::createConstraint(FeatureBase* _feature_moti
     return nullptr;
 }
 
-inline void ProcessorIMU::remapPVQ(const Eigen::VectorXs& _delta1, const Eigen::VectorXs& _delta2, Eigen::VectorXs& _delta_out)
+template<typename D1, typename D2, typename D3>
+inline void ProcessorIMU::remapPVQ(const Eigen::PlainObjectBase<D1>& _delta1, const Eigen::PlainObjectBase<D2>& _delta2, Eigen::PlainObjectBase<D3>& _delta_out)
 {
     new (&p_in_1_) Eigen::Map<const Eigen::Vector3s>(_delta1.data());
     new (&v_in_1_) Eigen::Map<const Eigen::Vector3s>(_delta1.data() + 3);
@@ -454,7 +654,7 @@ inline void ProcessorIMU::remapPVQ(const Eigen::VectorXs& _delta1, const Eigen::
     new (&q_out_) Eigen::Map<Eigen::Quaternions>(_delta_out.data() + 6);
 }
 
-inline void ProcessorIMU::remapDelta(Eigen::VectorXs& _delta_out)
+inline void ProcessorIMU::remapDelta(DeltaType& _delta_out)
 {
     new (&p_out_) Eigen::Map<Eigen::Vector3s>(_delta_out.data());
     new (&v_out_) Eigen::Map<Eigen::Vector3s>(_delta_out.data() + 3);
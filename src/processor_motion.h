@@ -11,10 +11,17 @@
 // Wolf
 #include "capture_motion.h"
 #include "processor_base.h"
+#include "problem_statistics.h"
+#include "published_state.h"
+#include "sample_queue.h"
+#include "sensor_base.h"
 #include "time_stamp.h"
+#include "trajectory_base.h"
 
 // std
 #include <iomanip>
+#include <map>
+#include <vector>
 
 namespace wolf
 {
@@ -76,34 +83,35 @@ namespace wolf
  *   - In cases where this identification is not possible, or not desired,
  * classes deriving from this class will have to implement fromSensorFrame(),
  * and call it within data2delta(), or write the frame transformation code directly in data2delta().
+ *
+ * ### Delta sizes
+ *
+ * This class only declares the interface used by the rest of Wolf (e.g. by the Problem) to query the motion processors.
+ * The integration machinery is implemented by the derived class template ProcessorMotionT,
+ * which has the sizes of the deltas as template parameters.
+ * Derive your processor from ProcessorMotionT with the sizes fixed at compile time whenever you know them:
+ * this way the integration of each new motion datum does not perform any heap allocation.
  */
 class ProcessorMotion : public ProcessorBase
 {
 
         // This is the main public interface
     public:
-        ProcessorMotion(ProcessorType _tp, const std::string& _type, Size _state_size, Size _delta_size, Size _delta_cov_size, Size _data_size, Size _delta_jac_size = 0, const Scalar& _time_tolerance = 0.1);
+        ProcessorMotion(ProcessorType _tp, const std::string& _type, Size _state_size, Size _data_size, const Scalar& _time_tolerance = 0.1);
         virtual ~ProcessorMotion();
 
-        // Instructions to the processor:
-
-        virtual void process(CaptureBase* _incoming_ptr);
-        virtual void resetDerived();
-
         // Queries to the processor:
 
-        virtual bool voteForKeyFrame();
-
         /** \brief Fills a reference to the state integrated so far
          * \param _x the returned state vector
          */
-        const void getCurrentState(Eigen::VectorXs& _x);
+        virtual const void getCurrentState(Eigen::VectorXs& _x) = 0;
 
         /** \brief Fills a reference to the state integrated so far and its stamp
          * \param _x the returned state vector
          * \param _ts the returned stamp
          */
-        const void getCurrentState(Eigen::VectorXs& _x, TimeStamp& _ts);
+        virtual const void getCurrentState(Eigen::VectorXs& _x, TimeStamp& _ts) = 0;
 
         /** \brief Gets a constant reference to the state integrated so far
          * \return the state vector
@@ -120,7 +128,7 @@ class ProcessorMotion : public ProcessorBase
          * \param _ts the time stamp
          * \param _x the returned state
          */
-        void getState(const TimeStamp& _ts, Eigen::VectorXs& _x);
+        virtual void getState(const TimeStamp& _ts, Eigen::VectorXs& _x) = 0;
 
         /** \brief Gets the state corresponding to the provided time-stamp
          * \param _ts the time stamp
@@ -128,29 +136,186 @@ class ProcessorMotion : public ProcessorBase
          */
         Eigen::VectorXs& getState(const TimeStamp& _ts);
 
+        /** \brief Integrates a block of motion data in one go
+         * \param _time_stamps the time stamps of the samples, in increasing order
+         * \param _data the samples, one per column, in the format of the data of the incoming Captures
+         * \param _data_cov the covariance of each one of the samples
+         * \param _samples_per_vote number of samples integrated between consecutive votes for key-frame.
+         *        With the default 0, the vote is only taken once, at the end of the block.
+         *
+         * This is equivalent to processing one CaptureMotion per sample,
+         * but no Capture is created, and the samples are integrated in one tight loop.
+         * Use this with high-rate sensors whose drivers deliver the data in blocks.
+         *
+         * Note: preProcess() and postProcess() are not called, since there is no incoming Capture.
+         */
+        virtual void processBatch(const std::vector<TimeStamp>& _time_stamps, const Eigen::MatrixXs& _data,
+                                  const Eigen::MatrixXs& _data_cov, unsigned int _samples_per_vote = 0) = 0;
+
+        /** \brief Integrates the samples waiting in the SampleQueue of the sensor, if it has one
+         * \return the number of samples integrated
+         *
+         * Only the samples present when the call starts are integrated, so that a fast producer cannot hold the consumer here.
+         * The vote for key-frame is taken once, at the end.
+         * This is called at the start of process(), and may be called from the Wolf thread at any other time.
+         */
+        virtual unsigned int drainSampleQueue() = 0;
+
+        /** Set the origin of all motion for this processor
+         * \param _origin_frame the key frame to be the origin
+         */
+        virtual void setOrigin(FrameBase* _origin_frame) = 0;
+
+        /** Set the origin of all motion for this processor
+         * \param _x_origin the state at the origin
+         * \param _ts_origin origin timestamp.
+         */
+        void setOrigin(const Eigen::VectorXs& _x_origin, const TimeStamp& _ts_origin);
+
+        /** \brief Fills the sizes of the buffer being integrated, see Problem::getStatistics()
+         */
+        virtual void getBufferStatistics(MotionBufferStatistics& _statistics) const = 0;
+
+        // Helper functions:
+    public:
+
+        FrameBase* makeFrame(CaptureBase* _capture_ptr, const Eigen::VectorXs& _state, FrameKeyType _type);
+
+        virtual bool isMotion();
+
+    protected:
+        // Attributes
+        Size x_size_;           ///< The size of the state vector
+        Size data_size_;        ///< the size of the incoming data
+
+    protected:
+        // helpers to avoid allocation
+        Eigen::VectorXs x_;         ///< current state
+        Eigen::VectorXs x_origin_;  ///< state at the origin
+};
+
+
+/** \brief Implementation of the Motion processors for deltas of a given size.
+ *
+ * See the documentation of ProcessorMotion for the maths and conventions.
+ *
+ * The template parameters are the sizes of the deltas:
+ *   - DeltaSize: the size of the delta vectors
+ *   - DeltaCovSize: the size of the delta covariances and of the Jacobians of the delta compositions.
+ *     This is the size of the tangent space of the delta, which is smaller than DeltaSize when the delta contains a quaternion.
+ *
+ * Examples of the sizes used by the Wolf processors:
+ *   - 2D odometry: ProcessorMotionT<3, 3>
+ *   - 3D odometry: ProcessorMotionT<7, 6> // position and quaternion
+ *   - IMU: ProcessorMotionT<10, 9> // position, velocity and quaternion
+ *
+ * With sizes fixed at compile time, all the integration helpers and the buffered Motions are fixed-size Eigen objects,
+ * and integrating a new motion datum does not perform any heap allocation,
+ * provided that the buffer has enough capacity (see MotionContainerT::reserve()).
+ * The processor takes care of reserving, for each new buffer, as much room as the previous buffer needed.
+ *
+ * Set the sizes to Eigen::Dynamic to have them defined at run time instead.
+ *
+ * ### Lazy covariance propagation
+ *
+ * The covariance of the integrated delta is only needed when a key-frame is created, or when a Motion is queried.
+ * In lazy mode (see setLazyCovariance()), integrating a new motion datum only stores the Jacobians of the delta composition,
+ * and the covariances are propagated through the pending Motions when they are needed:
+ * at key-frame creation, and in getMotion() and integrateCovariance().
+ * The operations performed are exactly the same as in the eager mode, and so are the results.
+ * Note that the Motions accessed directly through getBufferPtr() may have pending covariances.
+ *
+ * ### Buffer decimation
+ *
+ * When key-frames are far apart (e.g. the robot is stationary) the buffer can be decimated to bound its memory,
+ * by merging consecutive Motions. See setMotionDecimation() and MotionBufferT::decimate().
+ */
+template <int DeltaSize, int DeltaCovSize>
+class ProcessorMotionT : public ProcessorMotion
+{
+    public:
+        typedef MotionT<DeltaSize, DeltaCovSize> MotionType;
+        typedef typename MotionType::DeltaType DeltaType;
+        typedef typename MotionType::DeltaCovType DeltaCovType;
+        typedef MotionBufferT<MotionType> BufferType;
+        typedef CaptureMotionT<MotionType> CaptureType;
+
+        // This is the main public interface
+    public:
+        ProcessorMotionT(ProcessorType _tp, const std::string& _type, Size _state_size, Size _delta_size, Size _delta_cov_size, Size _data_size, Size _delta_jac_size = 0, const Scalar& _time_tolerance = 0.1);
+        virtual ~ProcessorMotionT();
+
+        // Instructions to the processor:
+
+        virtual void process(CaptureBase* _incoming_ptr);
+        virtual void processBatch(const std::vector<TimeStamp>& _time_stamps, const Eigen::MatrixXs& _data,
+                                  const Eigen::MatrixXs& _data_cov, unsigned int _samples_per_vote = 0);
+        virtual unsigned int drainSampleQueue();
+        virtual void resetDerived();
+
+        // Queries to the processor:
+
+        virtual bool voteForKeyFrame();
+
+        using ProcessorMotion::getCurrentState;
+        using ProcessorMotion::getState;
+        using ProcessorMotion::setOrigin;
+
+        virtual const void getCurrentState(Eigen::VectorXs& _x);
+        virtual const void getCurrentState(Eigen::VectorXs& _x, TimeStamp& _ts);
+        virtual void getState(const TimeStamp& _ts, Eigen::VectorXs& _x);
+
         /** \brief Provides the motion integrated so far
          * \return a const reference to the integrated delta state
          */
-        const Motion& getMotion() const;
-        void getMotion(Motion& _motion) const;
+        const MotionType& getMotion() const;
+        void getMotion(MotionType& _motion) const;
 
         /** \brief Provides the motion integrated until a given timestamp
          * \return a reference to the integrated delta state
          */
-        const Motion& getMotion(const TimeStamp& _ts) const;
-        void getMotion(const TimeStamp& _ts, Motion& _motion) const;
+        const MotionType& getMotion(const TimeStamp& _ts) const;
+        void getMotion(const TimeStamp& _ts, MotionType& _motion) const;
+
+        /** \brief Enables or disables the lazy propagation of the covariances
+         */
+        void setLazyCovariance(bool _lazy);
+        bool isLazyCovariance() const;
+
+        /** \brief Propagates the covariances of the Motions that have been integrated lazily
+         */
+        void integrateCovariance() const;
+
+        /** \brief Sets the decimation of the buffer, see MotionBufferT::decimate()
+         *
+         * The buffer is decimated right after integrating, when it grows beyond _decimation.max_size_.
+         * The threshold relaxed by the decimation is restored at each new key-frame.
+         */
+        void setMotionDecimation(const MotionDecimation& _decimation);
+        const MotionDecimation& getMotionDecimation() const;
+
+        virtual void getBufferStatistics(MotionBufferStatistics& _statistics) const;
 
         /** \brief Finds the capture that contains the closest previous motion of _ts
          * \return a pointer to the capture (if it exist) or a nullptr (otherwise)
+         *
+         * The lookup is logarithmic in the number of key-frames, see capture_index_.
+         * It returns nullptr as well if _ts falls in the motion of a removed key-frame, see removeKeyFrameCallback().
+         */
+        CaptureType* findCaptureContainingTimeStamp(const TimeStamp& _ts) const;
+
+        /** \brief Removes a capture of this processor from the time index
+         *
+         * removeKeyFrameCallback() calls it for the captures of the key-frame being removed.
          */
-        CaptureMotion* findCaptureContainingTimeStamp(const TimeStamp& _ts) const;
+        void removeCaptureFromIndex(const CaptureType* _capture_ptr);
 
         /** Composes the deltas in two pre-integrated Captures
          * \param _cap1_ptr pointer to the first Capture
          * \param _cap2_ptr pointer to the second Capture. This is local wrt. the first Capture.
          * \param _delta1_plus_delta2 the concatenation of the deltas of Captures 1 and 2.
          */
-        void sumDeltas(CaptureMotion* _cap1_ptr, CaptureMotion* _cap2_ptr, Eigen::VectorXs& _delta1_plus_delta2);
+        void sumDeltas(CaptureType* _cap1_ptr, CaptureType* _cap2_ptr, DeltaType& _delta1_plus_delta2);
 
         /** Composes two delta covariances
          * \param _delta_cov1 covariance of the first delta
@@ -160,43 +325,65 @@ class ProcessorMotion : public ProcessorBase
          * \param _jacobian2 jacobian of the composition w.r.t. _delta2
          * \param _delta_cov1_plus_delta_cov2 the covariance of the composition.
          */
-        void deltaCovPlusDeltaCov(const Eigen::MatrixXs& _delta_cov1, const Eigen::MatrixXs& _delta_cov2,
-                                  const Scalar _Dt2,
-                                  const Eigen::MatrixXs& _jacobian1, const Eigen::MatrixXs& _jacobian2,
-                                  Eigen::MatrixXs& _delta_cov1_plus_delta_cov2);
-        /** Set the origin of all motion for this processor
-         * \param _origin_frame the key frame to be the origin
-         */
-        void setOrigin(FrameBase* _origin_frame);
+        virtual void deltaCovPlusDeltaCov(const DeltaCovType& _delta_cov1, const DeltaCovType& _delta_cov2,
+                                          const Scalar _Dt2,
+                                          const DeltaCovType& _jacobian1, const DeltaCovType& _jacobian2,
+                                          DeltaCovType& _delta_cov1_plus_delta_cov2) const;
 
-        /** Set the origin of all motion for this processor
-         * \param _x_origin the state at the origin
-         * \param _ts_origin origin timestamp.
+        virtual void setOrigin(FrameBase* _origin_frame);
+
+        /** \brief Integrates the pending covariances of the buffer, which keyFrameCallback() needs to split it
          */
-        void setOrigin(const Eigen::VectorXs& _x_origin, const TimeStamp& _ts_origin);
+        virtual void keyFrameCallbackPrepare(FrameBase* _keyframe_ptr, const Scalar& _time_tol);
 
         virtual bool keyFrameCallback(FrameBase* _keyframe_ptr, const Scalar& _time_tol);
 
+        /** \brief Drops from the time index the motion to and from a key-frame about to be destructed
+         *
+         * The motion from the key-frame is expressed with respect to it, so it cannot be queried any longer either.
+         * The origin key-frame of the processor cannot be removed.
+         */
+        virtual void removeKeyFrameCallback(FrameBase* _keyframe_ptr);
+
         // Helper functions:
     public:
         // TODO change to protected
 
-        void splitBuffer(const TimeStamp& _t_split, MotionBuffer& _oldest_part);
+        void splitBuffer(const TimeStamp& _t_split, BufferType& _oldest_part);
 
         //        void reset(CaptureMotion2* _capture_ptr);
 
-        FrameBase* makeFrame(CaptureBase* _capture_ptr, const Eigen::VectorXs& _state, FrameKeyType _type);
+        BufferType* getBufferPtr();
 
-        MotionBuffer* getBufferPtr();
-
-        const MotionBuffer* getBufferPtr() const;
-
-        virtual bool isMotion();
+        const BufferType* getBufferPtr() const;
 
     protected:
-        void updateDt();
+        void updateDt(const TimeStamp& _ts);
         void integrate();
-        void reintegrate(CaptureMotion* _capture_ptr);
+        void integrate(const TimeStamp& _ts, const Eigen::VectorXs& _data, const Eigen::MatrixXs& _data_cov);
+        void reintegrate(CaptureType* _capture_ptr);
+
+        /** \brief Publishes the current state in the Problem, see Problem::getPublishedState().
+         *
+         * Only the main ProcessorMotion of the Problem publishes.
+         * The covariance of the integrated delta is published along if the PublishedState has its size,
+         * which defeats the lazy covariance propagation.
+         */
+        void publishState();
+
+        /** \brief Merges the Motion _first into the consecutive Motion _second. See MotionBufferT::decimate().
+         * \param _previous the Motion before _first
+         *
+         * Overload it if deltaPlusDelta() has side effects on the derived class.
+         */
+        virtual void mergeMotions(const MotionType& _previous, const MotionType& _first, MotionType& _second);
+
+        /** \brief Makes a key-frame at the last integrated Motion
+         *
+         * The motion constraint to the origin key-frame is created, a new last Capture is started,
+         * and the other processors are notified through the Problem.
+         */
+        void makeKeyFrame();
 
         /** Pre-process incoming Capture
          *
@@ -272,8 +459,8 @@ class ProcessorMotion : public ProcessorBase
          *
          * This function implements the composition (+) so that _delta1_plus_delta2 = _delta1 (+) _delta2.
          */
-        virtual void deltaPlusDelta(const Eigen::VectorXs& _delta1, const Eigen::VectorXs& _delta2,
-                                    const Scalar _Dt2, Eigen::VectorXs& _delta1_plus_delta2) = 0;
+        virtual void deltaPlusDelta(const DeltaType& _delta1, const DeltaType& _delta2,
+                                    const Scalar _Dt2, DeltaType& _delta1_plus_delta2) = 0;
 
         /** \brief composes a delta-state on top of another delta-state, and computes the Jacobians
          * \param _delta1 the first delta-state
@@ -285,9 +472,9 @@ class ProcessorMotion : public ProcessorBase
          *
          * This function implements the composition (+) so that _delta1_plus_delta2 = _delta1 (+) _delta2 and its jacobians.
          */
-        virtual void deltaPlusDelta(const Eigen::VectorXs& _delta1, const Eigen::VectorXs& _delta2,
-                                    const Scalar _Dt2, Eigen::VectorXs& _delta1_plus_delta2,
-                                    Eigen::MatrixXs& _jacobian1, Eigen::MatrixXs& _jacobian2) = 0;
+        virtual void deltaPlusDelta(const DeltaType& _delta1, const DeltaType& _delta2,
+                                    const Scalar _Dt2, DeltaType& _delta1_plus_delta2,
+                                    DeltaCovType& _jacobian1, DeltaCovType& _jacobian2) = 0;
 
         /** \brief composes a delta-state on top of a state
          * \param _x the initial state
@@ -297,7 +484,7 @@ class ProcessorMotion : public ProcessorBase
          *
          * This function implements the composition (+) so that _x2 = _x1 (+) _delta.
          */
-        virtual void xPlusDelta(const Eigen::VectorXs& _x, const Eigen::VectorXs& _delta, const Scalar _Dt,
+        virtual void xPlusDelta(const Eigen::VectorXs& _x, const DeltaType& _delta, const Scalar _Dt,
                                 Eigen::VectorXs& _x_plus_delta) = 0;
 
 
@@ -309,59 +496,128 @@ class ProcessorMotion : public ProcessorBase
          *   - 3D odometry: delta type is a PQ vector: 7-vector with [0,0,0, 0,0,0,1]
          *   - IMU: PQVBB 10-vector with [0,0,0, 0,0,0,1, 0,0,0] // No biases in the delta !!
          */
-        virtual Eigen::VectorXs deltaZero() const = 0;
+        virtual DeltaType deltaZero() const = 0;
 
-        virtual Motion interpolate(const Motion& _motion_ref, Motion& _motion, TimeStamp& _ts) = 0;
+        virtual MotionType interpolate(const MotionType& _motion_ref, MotionType& _motion, TimeStamp& _ts) = 0;
 
         virtual ConstraintBase* createConstraint(FeatureBase* _feature_motion, FrameBase* _frame_origin) = 0;
 
-        Motion motionZero(const TimeStamp& _ts);
+        MotionType motionZero(const TimeStamp& _ts);
 
     protected:
         // Attributes
-        Size x_size_;           ///< The size of the state vector
         Size delta_size_;       ///< the size of the deltas
         Size delta_cov_size_;   ///< the size of the delta covariances matrix
-        Size data_size_;        ///< the size of the incoming data
         CaptureBase* origin_ptr_;
-        CaptureMotion* last_ptr_;
+        CaptureType* last_ptr_;
         CaptureMotion* incoming_ptr_;
+        std::map<TimeStamp, CaptureType*> capture_index_; ///< the captures of this processor, by the time stamp of their first Motion
 
     protected:
         // helpers to avoid allocation
         Scalar dt_;                             ///< Time step
-        Eigen::VectorXs x_;                     ///< current state
-        Eigen::VectorXs delta_;                 ///< current delta
-        Eigen::MatrixXs delta_cov_;             ///< current delta covariance
-        Eigen::VectorXs delta_integrated_;      ///< integrated delta
-        Eigen::MatrixXs delta_integrated_cov_;  ///< integrated delta covariance
+        DeltaType delta_;                       ///< current delta
+        DeltaCovType delta_cov_;                ///< current delta covariance
+        DeltaType delta_integrated_;            ///< integrated delta
+        DeltaCovType delta_integrated_cov_;     ///< integrated delta covariance
         Eigen::VectorXs data_;                  ///< current data
-        Eigen::MatrixXs jacobian_delta_preint_; ///< jacobian of delta composition w.r.t previous delta integrated
-        Eigen::MatrixXs jacobian_delta_;        ///< jacobian of delta composition w.r.t current delta
+        DeltaCovType jacobian_delta_preint_;    ///< jacobian of delta composition w.r.t previous delta integrated
+        DeltaCovType jacobian_delta_;           ///< jacobian of delta composition w.r.t current delta
+
+        bool lazy_covariance_;                  ///< Lazy covariance propagation mode
+        mutable std::size_t n_cov_integrated_;  ///< Index in the last buffer of the newest Motion with a propagated covariance
+        MotionDecimation decimation_;           ///< Decimation of the buffer
+        Scalar decimation_threshold_;           ///< Current decimation threshold, relaxed by the decimation if needed
 
+    public:
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW; // to guarantee alignment (see http://eigen.tuxfamily.org/dox-devel/group__TopicStructHavingEigenMembers.html)
 };
 
-inline ProcessorMotion::ProcessorMotion(ProcessorType _tp, const std::string& _type, Size _state_size, Size _delta_size, Size _delta_cov_size, Size _data_size, Size _delta_jac_size, const Scalar& _time_tolerance) :
-        ProcessorBase(_tp, _type, _time_tolerance), x_size_(_state_size), delta_size_(_delta_size), delta_cov_size_(_delta_cov_size), data_size_(_data_size), origin_ptr_(
-                nullptr), last_ptr_(nullptr), incoming_ptr_(nullptr), dt_(0.0), x_(_state_size), delta_(_delta_size), delta_cov_(
-                _delta_cov_size, _delta_cov_size), delta_integrated_(_delta_size), delta_integrated_cov_(_delta_cov_size, _delta_cov_size), data_(
-                _data_size), jacobian_delta_preint_(delta_cov_size_, delta_cov_size_), jacobian_delta_(delta_cov_size_, delta_cov_size_)
+
+////////////////////////////////////////////////////////
+// IMPLEMENTATION ProcessorMotion
+
+inline ProcessorMotion::ProcessorMotion(ProcessorType _tp, const std::string& _type, Size _state_size, Size _data_size, const Scalar& _time_tolerance) :
+        ProcessorBase(_tp, _type, _time_tolerance), x_size_(_state_size), data_size_(_data_size), x_(_state_size), x_origin_(_state_size)
 {
     //
 }
 
 inline ProcessorMotion::~ProcessorMotion()
+{
+    //
+}
+
+inline void ProcessorMotion::setOrigin(const Eigen::VectorXs& _x_origin, const TimeStamp& _ts_origin)
+{
+    // make a new key frame
+    FrameBase* key_frame_ptr = getProblem()->createFrame(KEY_FRAME, _x_origin, _ts_origin);
+    // set the key frame as origin
+    setOrigin(key_frame_ptr);
+}
+
+inline FrameBase* ProcessorMotion::makeFrame(CaptureBase* _capture_ptr, const Eigen::VectorXs& _state, FrameKeyType _type)
+{
+    // We need to create the new free Frame to hold what will become the last Capture
+    FrameBase* new_frame_ptr = getProblem()->createFrame(_type, _state, _capture_ptr->getTimeStamp());
+    new_frame_ptr->addCapture(_capture_ptr); // Add incoming Capture to the new Frame
+    return new_frame_ptr;
+}
+
+inline Eigen::VectorXs& ProcessorMotion::getState(const TimeStamp& _ts)
+{
+    getState(_ts, x_);
+    return x_;
+}
+
+inline const Eigen::VectorXs& ProcessorMotion::getCurrentState()
+{
+    getCurrentState(x_);
+    return x_;
+}
+
+inline const Eigen::VectorXs& ProcessorMotion::getCurrentState(TimeStamp& _ts)
+{
+    getCurrentState(x_, _ts);
+    return x_;
+}
+
+inline bool ProcessorMotion::isMotion()
+{
+    return true;
+}
+
+
+////////////////////////////////////////////////////////
+// IMPLEMENTATION ProcessorMotionT
+
+template <int DeltaSize, int DeltaCovSize>
+inline ProcessorMotionT<DeltaSize, DeltaCovSize>::ProcessorMotionT(ProcessorType _tp, const std::string& _type, Size _state_size, Size _delta_size, Size _delta_cov_size, Size _data_size, Size _delta_jac_size, const Scalar& _time_tolerance) :
+        ProcessorMotion(_tp, _type, _state_size, _data_size, _time_tolerance), delta_size_(_delta_size), delta_cov_size_(_delta_cov_size), origin_ptr_(
+                nullptr), last_ptr_(nullptr), incoming_ptr_(nullptr), dt_(0.0), delta_(_delta_size), delta_cov_(
+                _delta_cov_size, _delta_cov_size), delta_integrated_(_delta_size), delta_integrated_cov_(_delta_cov_size, _delta_cov_size), data_(
+                _data_size), jacobian_delta_preint_(delta_cov_size_, delta_cov_size_), jacobian_delta_(delta_cov_size_, delta_cov_size_), lazy_covariance_(
+                false), n_cov_integrated_(0), decimation_({DEC_NONE, 0, 0}), decimation_threshold_(0)
+{
+    assert((DeltaSize == Eigen::Dynamic || DeltaSize == (int)_delta_size) && "ProcessorMotionT: wrong delta size");
+    assert((DeltaCovSize == Eigen::Dynamic || DeltaCovSize == (int)_delta_cov_size) && "ProcessorMotionT: wrong delta covariance size");
+    delta_cov_.setZero();
+}
+
+template <int DeltaSize, int DeltaCovSize>
+inline ProcessorMotionT<DeltaSize, DeltaCovSize>::~ProcessorMotionT()
 {
     if (incoming_ptr_!= nullptr)
         incoming_ptr_->destruct();
 }
 
-inline void ProcessorMotion::deltaCovPlusDeltaCov(const Eigen::MatrixXs& _delta_cov1,
-                                                  const Eigen::MatrixXs& _delta_cov2,
-                                                  const Scalar _Dt2,
-                                                  const Eigen::MatrixXs& _jacobian1,
-                                                  const Eigen::MatrixXs& _jacobian2,
-                                                  Eigen::MatrixXs& _delta_cov1_plus_delta_cov2)
+template <int DeltaSize, int DeltaCovSize>
+inline void ProcessorMotionT<DeltaSize, DeltaCovSize>::deltaCovPlusDeltaCov(const DeltaCovType& _delta_cov1,
+                                                                           const DeltaCovType& _delta_cov2,
+                                                                           const Scalar _Dt2,
+                                                                           const DeltaCovType& _jacobian1,
+                                                                           const DeltaCovType& _jacobian2,
+                                                                           DeltaCovType& _delta_cov1_plus_delta_cov2) const
 {
 
     _delta_cov1_plus_delta_cov2 = _jacobian1 * _delta_cov1 * _jacobian1.transpose()
@@ -369,28 +625,21 @@ inline void ProcessorMotion::deltaCovPlusDeltaCov(const Eigen::MatrixXs& _delta_
 
 }
 
-inline void ProcessorMotion::setOrigin(const Eigen::VectorXs& _x_origin, const TimeStamp& _ts_origin)
-{
-    // make a new key frame
-    FrameBase* key_frame_ptr = getProblem()->createFrame(KEY_FRAME, _x_origin, _ts_origin);
-    // set the key frame as origin
-    setOrigin(key_frame_ptr);
-}
-
-inline void ProcessorMotion::setOrigin(FrameBase* _origin_frame)
+template <int DeltaSize, int DeltaCovSize>
+inline void ProcessorMotionT<DeltaSize, DeltaCovSize>::setOrigin(FrameBase* _origin_frame)
 {
     assert(_origin_frame->getTrajectoryPtr() != nullptr && "ProcessorMotion::setOrigin: origin frame must be in the trajectory.");
     assert(_origin_frame->isKey() && "ProcessorMotion::setOrigin: origin frame must be KEY FRAME.");
 
     // make (empty) origin Capture
-    origin_ptr_ = new CaptureMotion(_origin_frame->getTimeStamp(), this->getSensorPtr(), Eigen::VectorXs::Zero(data_size_),
-                                     Eigen::MatrixXs::Zero(data_size_, data_size_), nullptr);
+    origin_ptr_ = new CaptureType(_origin_frame->getTimeStamp(), this->getSensorPtr(), Eigen::VectorXs::Zero(data_size_),
+                                  Eigen::MatrixXs::Zero(data_size_, data_size_), nullptr);
     // Add origin capture to origin frame
     _origin_frame->addCapture(origin_ptr_);
 
     // make (emtpy) last Capture
-    last_ptr_ = new CaptureMotion(_origin_frame->getTimeStamp(), this->getSensorPtr(), Eigen::VectorXs::Zero(data_size_),
-                                   Eigen::MatrixXs::Zero(data_size_, data_size_), _origin_frame);
+    last_ptr_ = new CaptureType(_origin_frame->getTimeStamp(), this->getSensorPtr(), Eigen::VectorXs::Zero(data_size_),
+                                Eigen::MatrixXs::Zero(data_size_, data_size_), _origin_frame);
 
     // Make frame at last Capture
     makeFrame(last_ptr_, _origin_frame->getState(), NON_KEY_FRAME);
@@ -402,95 +651,184 @@ inline void ProcessorMotion::setOrigin(FrameBase* _origin_frame)
     // clear and reset buffer
     getBufferPtr()->get().clear();
     getBufferPtr()->get().push_back(motionZero(_origin_frame->getTimeStamp()));
+    n_cov_integrated_ = 0;
+
+    // restart the time index
+    capture_index_.clear();
+    capture_index_[_origin_frame->getTimeStamp()] = last_ptr_;
+    decimation_threshold_ = decimation_.threshold_;
 
     // Reset derived things
     resetDerived();
 }
 
-inline void ProcessorMotion::process(CaptureBase* _incoming_ptr)
+template <int DeltaSize, int DeltaCovSize>
+inline void ProcessorMotionT<DeltaSize, DeltaCovSize>::process(CaptureBase* _incoming_ptr)
 {
+    drainSampleQueue();
+
     incoming_ptr_ = (CaptureMotion*)(_incoming_ptr);
     preProcess();
     integrate();
 
     if (voteForKeyFrame() && permittedKeyFrame())
-    {
-        // key_capture
-        CaptureMotion* key_capture_ptr = last_ptr_;
-        FrameBase* key_frame_ptr = key_capture_ptr->getFramePtr();
+        makeKeyFrame();
 
-        // Set the frame as key
-        key_frame_ptr->setState(getCurrentState());
-        key_frame_ptr->setTimeStamp(getBufferPtr()->get().back().ts_);
-        key_frame_ptr->setKey();
+    postProcess();
+}
 
-        // create motion constraint and add it to the new keyframe
-        FeatureBase* key_feature_ptr = new FeatureBase(FEATURE_MOTION, "MOTION",
-                                                       key_capture_ptr->getBufferPtr()->get().back().delta_integr_,
-                                                       key_capture_ptr->getBufferPtr()->get().back().delta_integr_cov_.determinant() > 0 ?
-                                                       key_capture_ptr->getBufferPtr()->get().back().delta_integr_cov_ :
-                                                       Eigen::MatrixXs::Identity(delta_cov_size_, delta_cov_size_)*1e-8);
+template <int DeltaSize, int DeltaCovSize>
+inline void ProcessorMotionT<DeltaSize, DeltaCovSize>::processBatch(const std::vector<TimeStamp>& _time_stamps,
+                                                                   const Eigen::MatrixXs& _data,
+                                                                   const Eigen::MatrixXs& _data_cov,
+                                                                   unsigned int _samples_per_vote)
+{
+    assert(_data.rows() == (int)data_size_ && "ProcessorMotion::processBatch: wrong data size");
+    assert(_data.cols() == (int)_time_stamps.size() && "ProcessorMotion::processBatch: one time stamp per sample is required");
 
+    unsigned int samples_since_vote = 0;
+    for (std::size_t i = 0; i < _time_stamps.size(); i++)
+    {
+        data_ = _data.col(i); // no allocation: data_ has already the right size
+        integrate(_time_stamps[i], data_, _data_cov);
 
-        key_capture_ptr->addFeature(key_feature_ptr);
-        key_feature_ptr->addConstraint(createConstraint(key_feature_ptr, origin_ptr_->getFramePtr()));
+        if (++samples_since_vote == _samples_per_vote || i + 1 == _time_stamps.size())
+        {
+            samples_since_vote = 0;
+            if (voteForKeyFrame() && permittedKeyFrame())
+                makeKeyFrame();
+        }
+    }
+}
 
-        // new last capture
-        last_ptr_ = new CaptureMotion(key_frame_ptr->getTimeStamp(), this->getSensorPtr(), Eigen::VectorXs::Zero(data_size_),
-                                       Eigen::MatrixXs::Zero(data_size_, data_size_), key_frame_ptr);
+template <int DeltaSize, int DeltaCovSize>
+inline unsigned int ProcessorMotionT<DeltaSize, DeltaCovSize>::drainSampleQueue()
+{
+    SampleQueue* queue_ptr = getSensorPtr()->getSampleQueuePtr();
+    if (queue_ptr == nullptr)
+        return 0;
 
-        // create a new last frame
-        makeFrame(last_ptr_, key_frame_ptr->getState(), NON_KEY_FRAME);
+    assert(queue_ptr->getDataSize() == data_size_ && "ProcessorMotion::drainSampleQueue: wrong data size");
 
-        // reset processor origin
-        origin_ptr_ = key_capture_ptr;
-        getBufferPtr()->get().push_back(Motion( {key_frame_ptr->getTimeStamp(),
-                                                 deltaZero(),
-                                                 deltaZero(),
-                                                 Eigen::MatrixXs::Zero(delta_cov_size_, delta_cov_size_),
-                                                 Eigen::MatrixXs::Zero(delta_cov_size_, delta_cov_size_)}));
-        // reset derived things
-        resetDerived();
-
-        getProblem()->keyFrameCallback(key_frame_ptr, this, time_tolerance_);
-
-            //// debug cout
-            //Eigen::VectorXs interpolated_state(3);
-            //xPlusDelta(origin_ptr_->getFramePtr()->getState(), key_capture_ptr->getBufferPtr()->get().back().delta_integr_, interpolated_state);
-            //std::cout << "\tinterpolated state: " << interpolated_state.transpose() << std::endl;
+    unsigned int n_samples = queue_ptr->size();
+    TimeStamp ts;
+    for (unsigned int i = 0; i < n_samples; i++)
+    {
+        queue_ptr->pop(ts, data_); // no allocation: data_ has already the right size
+        integrate(ts, data_, queue_ptr->getDataCovariance());
     }
-    postProcess();
+
+    if (n_samples > 0 && voteForKeyFrame() && permittedKeyFrame())
+        makeKeyFrame();
+
+    return n_samples;
+}
+
+template <int DeltaSize, int DeltaCovSize>
+inline void ProcessorMotionT<DeltaSize, DeltaCovSize>::makeKeyFrame()
+{
+    integrateCovariance();
+
+    // key_capture
+    CaptureType* key_capture_ptr = last_ptr_;
+    FrameBase* key_frame_ptr = key_capture_ptr->getFramePtr();
+
+    // Set the frame as key
+    key_frame_ptr->setState(getCurrentState());
+    key_frame_ptr->setTimeStamp(getBufferPtr()->get().back().ts_);
+    key_frame_ptr->setKey();
+
+    // create motion constraint and add it to the new keyframe
+    FeatureBase* key_feature_ptr = new FeatureBase(FEATURE_MOTION, "MOTION",
+                                                   key_capture_ptr->getBufferPtr()->get().back().delta_integr_,
+                                                   key_capture_ptr->getBufferPtr()->get().back().delta_integr_cov_.determinant() > 0 ?
+                                                   key_capture_ptr->getBufferPtr()->get().back().delta_integr_cov_ :
+                                                   DeltaCovType::Identity(delta_cov_size_, delta_cov_size_)*1e-8);
+
+
+    key_capture_ptr->addFeature(key_feature_ptr);
+    key_feature_ptr->addConstraint(createConstraint(key_feature_ptr, origin_ptr_->getFramePtr()));
+
+    // new last capture
+    last_ptr_ = new CaptureType(key_frame_ptr->getTimeStamp(), this->getSensorPtr(), Eigen::VectorXs::Zero(data_size_),
+                                Eigen::MatrixXs::Zero(data_size_, data_size_), key_frame_ptr);
+
+    // create a new last frame
+    makeFrame(last_ptr_, key_frame_ptr->getState(), NON_KEY_FRAME);
+
+    // reset processor origin
+    origin_ptr_ = key_capture_ptr;
+
+    // make room for as many Motions as the previous buffer, so that integrating does not allocate
+    getBufferPtr()->get().reserve(key_capture_ptr->getBufferPtr()->get().size());
+    getBufferPtr()->get().push_back(motionZero(key_frame_ptr->getTimeStamp()));
+    n_cov_integrated_ = 0;
+    capture_index_[key_frame_ptr->getTimeStamp()] = last_ptr_;
+    decimation_threshold_ = decimation_.threshold_;
+
+    // reset derived things
+    resetDerived();
+
+    getProblem()->keyFrameCallback(key_frame_ptr, this, time_tolerance_);
+
+    //// debug cout
+    //Eigen::VectorXs interpolated_state(3);
+    //xPlusDelta(origin_ptr_->getFramePtr()->getState(), key_capture_ptr->getBufferPtr()->get().back().delta_integr_, interpolated_state);
+    //std::cout << "\tinterpolated state: " << interpolated_state.transpose() << std::endl;
 }
 
-inline void ProcessorMotion::integrate()
+template <int DeltaSize, int DeltaCovSize>
+inline void ProcessorMotionT<DeltaSize, DeltaCovSize>::integrate()
 {
+    integrate(incoming_ptr_->getTimeStamp(), incoming_ptr_->getData(), incoming_ptr_->getDataCovariance());
+}
 
+template <int DeltaSize, int DeltaCovSize>
+inline void ProcessorMotionT<DeltaSize, DeltaCovSize>::integrate(const TimeStamp& _ts, const Eigen::VectorXs& _data,
+                                                                const Eigen::MatrixXs& _data_cov)
+{
     // Set dt
-    updateDt();
+    updateDt(_ts);
 
     // get data and convert it to delta, and obtain also the delta covariance
-    data2delta(incoming_ptr_->getData(), incoming_ptr_->getDataCovariance(), dt_);
+    data2delta(_data, _data_cov, dt_);
 
     // then integrate the current delta to pre-integrated measurements
     deltaPlusDelta(delta_integrated_, delta_ , dt_, delta_integrated_,jacobian_delta_preint_,jacobian_delta_);
 
-    // and covariance
-    deltaCovPlusDeltaCov(getBufferPtr()->get().back().delta_integr_cov_,
-                         delta_cov_,
-                         dt_,
-                         jacobian_delta_preint_,
-                         jacobian_delta_,
-                         delta_integrated_cov_);
+    // and covariance, unless it is left for later
+    if (!lazy_covariance_)
+        deltaCovPlusDeltaCov(getBufferPtr()->get().back().delta_integr_cov_,
+                             delta_cov_,
+                             dt_,
+                             jacobian_delta_preint_,
+                             jacobian_delta_,
+                             delta_integrated_cov_);
 
     // then push it into buffer
-    getBufferPtr()->get().push_back(Motion( {incoming_ptr_->getTimeStamp(),
-                                             delta_,
-                                             delta_integrated_,
-                                             delta_cov_,
-                                             delta_integrated_cov_,
-                                             Eigen::MatrixXs::Zero(delta_cov_size_, delta_cov_size_),
-                                             Eigen::MatrixXs::Zero(delta_cov_size_, delta_cov_size_)}));
+    getBufferPtr()->get().push_back(MotionType( {_ts,
+                                                 delta_,
+                                                 delta_integrated_,
+                                                 delta_cov_,
+                                                 delta_integrated_cov_,
+                                                 jacobian_delta_preint_,
+                                                 jacobian_delta_}));
+    if (!lazy_covariance_)
+        n_cov_integrated_ = getBufferPtr()->get().size() - 1;
+
+    // bound the size of the buffer
+    if (decimation_.policy_ != DEC_NONE && getBufferPtr()->get().size() > decimation_.max_size_)
+    {
+        integrateCovariance();
+        getBufferPtr()->decimate(decimation_.policy_, decimation_.max_size_, decimation_threshold_,
+                                 [this](const MotionType& _previous, const MotionType& _first, MotionType& _second)
+                                 {
+                                     mergeMotions(_previous, _first, _second);
+                                 });
+        n_cov_integrated_ = getBufferPtr()->get().size() - 1;
+    }
 
+    publishState();
 
     //    std::cout << "motion integrated: " << getBufferPtr()->get().size()-1 << std::endl;
     //    std::cout << "\tts: " << getBufferPtr()->get().back().ts_.getSeconds() << "." << getBufferPtr()->get().back().ts_.getNanoSeconds() << std::endl;
@@ -500,7 +838,29 @@ inline void ProcessorMotion::integrate()
     //std::cout << delta_integrated_cov_ << std::endl;
 }
 
-inline void ProcessorMotion::reintegrate(CaptureMotion* _capture_ptr)
+template <int DeltaSize, int DeltaCovSize>
+inline void ProcessorMotionT<DeltaSize, DeltaCovSize>::publishState()
+{
+    Problem* problem_ptr = getProblem();
+    if (problem_ptr == nullptr || problem_ptr->getProcessorMotionPtr() != this)
+        return;
+    PublishedState* published_state_ptr = problem_ptr->getPublishedStatePtr();
+    if (published_state_ptr->getStateSize() != x_size_)
+        return;
+
+    const MotionType& motion = getBufferPtr()->get().back();
+    getCurrentState(x_);
+    if (published_state_ptr->getCovarianceSize() == delta_cov_size_)
+    {
+        integrateCovariance();
+        published_state_ptr->publish(motion.ts_, x_, motion.delta_integr_cov_);
+    }
+    else
+        published_state_ptr->publish(motion.ts_, x_);
+}
+
+template <int DeltaSize, int DeltaCovSize>
+inline void ProcessorMotionT<DeltaSize, DeltaCovSize>::reintegrate(CaptureType* _capture_ptr)
 {
     //std::cout << "ProcessorMotion::reintegrate" << std::endl;
     _capture_ptr->getBufferPtr()->get().push_front(motionZero(_capture_ptr->getOriginFramePtr()->getTimeStamp()));
@@ -509,7 +869,6 @@ inline void ProcessorMotion::reintegrate(CaptureMotion* _capture_ptr)
     auto prev_motion_it = motion_it;
     motion_it++;
 
-    Eigen::MatrixXs jacobian_prev(delta_size_, delta_size_), jacobian_curr(delta_size_, delta_size_);
     while (motion_it != _capture_ptr->getBufferPtr()->get().end())
     {
         const Scalar dt = motion_it->ts_ - prev_motion_it->ts_;
@@ -517,14 +876,14 @@ inline void ProcessorMotion::reintegrate(CaptureMotion* _capture_ptr)
                        motion_it->delta_,
                        dt,
                        motion_it->delta_integr_,
-                       jacobian_prev,
-                       jacobian_curr);
+                       motion_it->jacobian_0,
+                       motion_it->jacobian_ts);
 
         deltaCovPlusDeltaCov(prev_motion_it->delta_integr_cov_,
                              motion_it->delta_cov_,
                              dt,
-                             jacobian_prev,
-                             jacobian_curr,
+                             motion_it->jacobian_0,
+                             motion_it->jacobian_ts,
                              motion_it->delta_integr_cov_);
 
         //std::cout << "\tmotion reintegrated: " << std::distance(_capture_ptr->getBufferPtr()->get().begin(), motion_it) << std::endl;
@@ -537,7 +896,14 @@ inline void ProcessorMotion::reintegrate(CaptureMotion* _capture_ptr)
     }
 }
 
-inline bool ProcessorMotion::keyFrameCallback(FrameBase* _keyframe_ptr, const Scalar& _time_tol)
+template <int DeltaSize, int DeltaCovSize>
+inline void ProcessorMotionT<DeltaSize, DeltaCovSize>::keyFrameCallbackPrepare(FrameBase* _keyframe_ptr, const Scalar& _time_tol)
+{
+    integrateCovariance();
+}
+
+template <int DeltaSize, int DeltaCovSize>
+inline bool ProcessorMotionT<DeltaSize, DeltaCovSize>::keyFrameCallback(FrameBase* _keyframe_ptr, const Scalar& _time_tol)
 {
     assert(_keyframe_ptr->getTrajectoryPtr() != nullptr && "ProcessorMotion::keyFrameCallback: key frame must be in the trajectory.");
     //std::cout << "ProcessorMotion::keyFrameCallback: ts = " << _keyframe_ptr->getTimeStamp().getSeconds() << "." << _keyframe_ptr->getTimeStamp().getNanoSeconds() << std::endl;
@@ -547,27 +913,31 @@ inline bool ProcessorMotion::keyFrameCallback(FrameBase* _keyframe_ptr, const Sc
     // get time stamp
     TimeStamp ts = _keyframe_ptr->getTimeStamp();
 
+    // the buffer to split needs all its covariances
+    integrateCovariance();
+
     // find capture in which the new keyframe is interpolated
-    CaptureMotion* capture_ptr = findCaptureContainingTimeStamp(ts);
+    CaptureType* capture_ptr = findCaptureContainingTimeStamp(ts);
     assert(capture_ptr != nullptr && "ProcessorMotion::keyFrameCallback: no motion capture containing the required TimeStamp found");
 
     FrameBase* key_capture_origin = capture_ptr->getOriginFramePtr();
 
     // create motion capture
-    CaptureMotion* key_capture_ptr = new CaptureMotion(ts, this->getSensorPtr(), Eigen::VectorXs::Zero(data_size_),
-                                                         Eigen::MatrixXs::Zero(data_size_, data_size_), key_capture_origin);
+    CaptureType* key_capture_ptr = new CaptureType(ts, this->getSensorPtr(), Eigen::VectorXs::Zero(data_size_),
+                                                   Eigen::MatrixXs::Zero(data_size_, data_size_), key_capture_origin);
 
     // add motion capture to keyframe
     _keyframe_ptr->addCapture(key_capture_ptr);
 
     // split the buffer
     // and give old buffer to new key capture
+    capture_index_[capture_ptr->getBufferPtr()->get().front().ts_] = key_capture_ptr;
     capture_ptr->getBufferPtr()->split(ts, *(key_capture_ptr->getBufferPtr()));
 
     // interpolate individual delta
-    Motion mot = interpolate(key_capture_ptr->getBufferPtr()->get().back(), // last Motion of old buffer
-                             capture_ptr->getBufferPtr()->get().front(), // first motion of new buffer
-                             ts);
+    MotionType mot = interpolate(key_capture_ptr->getBufferPtr()->get().back(), // last Motion of old buffer
+                                 capture_ptr->getBufferPtr()->get().front(), // first motion of new buffer
+                                 ts);
 
     // add to old buffer
     key_capture_ptr->getBufferPtr()->get().push_back(mot);
@@ -582,7 +952,7 @@ inline bool ProcessorMotion::keyFrameCallback(FrameBase* _keyframe_ptr, const Sc
                                                    key_capture_ptr->getBufferPtr()->get().back().delta_integr_,
                                                    key_capture_ptr->getBufferPtr()->get().back().delta_integr_cov_.determinant() > 0 ?
                                                    key_capture_ptr->getBufferPtr()->get().back().delta_integr_cov_ :
-                                                   Eigen::MatrixXs::Identity(delta_size_, delta_size_)*1e-8);
+                                                   DeltaCovType::Identity(delta_cov_size_, delta_cov_size_)*1e-8);
     key_capture_ptr->addFeature(key_feature_ptr);
     key_feature_ptr->addConstraint(createConstraint(key_feature_ptr, key_capture_origin));
 
@@ -595,6 +965,9 @@ inline bool ProcessorMotion::keyFrameCallback(FrameBase* _keyframe_ptr, const Sc
 
     // reintegrate own buffer
     reintegrate(capture_ptr);
+    if (capture_ptr == last_ptr_)
+        n_cov_integrated_ = getBufferPtr()->get().size() - 1;
+    capture_index_[ts] = capture_ptr;
 
     // modify feature and constraint (if they exist)
     if (!capture_ptr->getFeatureListPtr()->empty())
@@ -604,7 +977,7 @@ inline bool ProcessorMotion::keyFrameCallback(FrameBase* _keyframe_ptr, const Sc
         feature_ptr->setMeasurement(capture_ptr->getBufferPtr()->get().back().delta_integr_);
         feature_ptr->setMeasurementCovariance(capture_ptr->getBufferPtr()->get().back().delta_integr_cov_.determinant() > 0 ?
                                               capture_ptr->getBufferPtr()->get().back().delta_integr_cov_ :
-                                              Eigen::MatrixXs::Identity(delta_size_, delta_size_)*1e-8);
+                                              DeltaCovType::Identity(delta_cov_size_, delta_cov_size_)*1e-8);
         // modify constraint
         if (!feature_ptr->getConstraintListPtr()->empty())
         {
@@ -616,149 +989,239 @@ inline bool ProcessorMotion::keyFrameCallback(FrameBase* _keyframe_ptr, const Sc
     return true;
 }
 
-inline void ProcessorMotion::splitBuffer(const TimeStamp& _t_split, MotionBuffer& _oldest_part)
+template <int DeltaSize, int DeltaCovSize>
+inline void ProcessorMotionT<DeltaSize, DeltaCovSize>::removeKeyFrameCallback(FrameBase* _keyframe_ptr)
 {
-    last_ptr_->getBufferPtr()->split(_t_split, _oldest_part);
-}
+    static const NodeTag motion_tag("MOTION");
 
-inline FrameBase* ProcessorMotion::makeFrame(CaptureBase* _capture_ptr, const Eigen::VectorXs& _state, FrameKeyType _type)
-{
-    // We need to create the new free Frame to hold what will become the last Capture
-    FrameBase* new_frame_ptr = getProblem()->createFrame(_type, _state, _capture_ptr->getTimeStamp());
-    new_frame_ptr->addCapture(_capture_ptr); // Add incoming Capture to the new Frame
-    return new_frame_ptr;
-}
+    assert(origin_ptr_->getFramePtr() != _keyframe_ptr && "ProcessorMotion::removeKeyFrameCallback: cannot remove the origin key frame");
 
-inline void ProcessorMotion::resetDerived()
-{
-    // Blank function, to be implemented in derived classes
-}
+    // the motion to the key frame, in its own captures
+    for (auto capture_ptr : *(_keyframe_ptr->getCaptureListPtr()))
+        if (capture_ptr->getSensorPtr() == getSensorPtr() && capture_ptr->getTypeTag() == motion_tag)
+            removeCaptureFromIndex((CaptureType*)capture_ptr);
 
-inline bool ProcessorMotion::voteForKeyFrame()
-{
-    return false;
+    // the motion from the key frame
+    auto capture_it = capture_index_.find(_keyframe_ptr->getTimeStamp());
+    if (capture_it != capture_index_.end() && capture_it->second->getOriginFramePtr() == _keyframe_ptr)
+    {
+        capture_it->second->setOriginFramePtr(nullptr);
+        capture_index_.erase(capture_it);
+    }
 }
 
-inline Eigen::VectorXs& ProcessorMotion::getState(const TimeStamp& _ts)
+template <int DeltaSize, int DeltaCovSize>
+inline void ProcessorMotionT<DeltaSize, DeltaCovSize>::splitBuffer(const TimeStamp& _t_split, BufferType& _oldest_part)
 {
-    getState(_ts, x_);
-    return x_;
+    last_ptr_->getBufferPtr()->split(_t_split, _oldest_part);
 }
 
-inline void ProcessorMotion::getState(const TimeStamp& _ts, Eigen::VectorXs& _x)
+template <int DeltaSize, int DeltaCovSize>
+inline void ProcessorMotionT<DeltaSize, DeltaCovSize>::resetDerived()
 {
-    xPlusDelta(origin_ptr_->getFramePtr()->getState(), getBufferPtr()->getDelta(_ts), _ts - origin_ptr_->getTimeStamp(), _x);
+    // Blank function, to be implemented in derived classes
 }
 
-inline const Eigen::VectorXs& ProcessorMotion::getCurrentState()
+template <int DeltaSize, int DeltaCovSize>
+inline bool ProcessorMotionT<DeltaSize, DeltaCovSize>::voteForKeyFrame()
 {
-    getCurrentState(x_);
-    return x_;
+    return false;
 }
 
-inline const Eigen::VectorXs& ProcessorMotion::getCurrentState(TimeStamp& _ts)
+template <int DeltaSize, int DeltaCovSize>
+inline void ProcessorMotionT<DeltaSize, DeltaCovSize>::getState(const TimeStamp& _ts, Eigen::VectorXs& _x)
 {
-    getCurrentState(x_, _ts);
-    return x_;
+    CaptureType* capture_ptr = findCaptureContainingTimeStamp(_ts);
+    if (capture_ptr == nullptr)
+    {
+        // no motion integrated there (before the origin, or removed): the closest key frame
+        FrameBase* key_frame_ptr = getProblem()->getTrajectoryPtr()->closestKeyFrameToTimeStamp(_ts);
+        key_frame_ptr->getState(_x);
+        return;
+    }
+
+    FrameBase* origin_frame_ptr = capture_ptr->getOriginFramePtr();
+    origin_frame_ptr->getState(x_origin_);
+    xPlusDelta(x_origin_, capture_ptr->getBufferPtr()->getDelta(_ts), _ts - origin_frame_ptr->getTimeStamp(), _x);
 }
 
-inline const void ProcessorMotion::getCurrentState(Eigen::VectorXs& _x)
+template <int DeltaSize, int DeltaCovSize>
+inline const void ProcessorMotionT<DeltaSize, DeltaCovSize>::getCurrentState(Eigen::VectorXs& _x)
 {
     Scalar Dt = getBufferPtr()->get().back().ts_ - origin_ptr_->getTimeStamp();
-    xPlusDelta(origin_ptr_->getFramePtr()->getState(), getBufferPtr()->get().back().delta_integr_, Dt, _x);
+    origin_ptr_->getFramePtr()->getState(x_origin_);
+    xPlusDelta(x_origin_, getBufferPtr()->get().back().delta_integr_, Dt, _x);
 }
 
-inline const void ProcessorMotion::getCurrentState(Eigen::VectorXs& _x, TimeStamp& _ts)
+template <int DeltaSize, int DeltaCovSize>
+inline const void ProcessorMotionT<DeltaSize, DeltaCovSize>::getCurrentState(Eigen::VectorXs& _x, TimeStamp& _ts)
 {
     getCurrentState(_x);
     _ts = getBufferPtr()->get().back().ts_;
 }
 
-inline const Motion& ProcessorMotion::getMotion() const
+template <int DeltaSize, int DeltaCovSize>
+inline const typename ProcessorMotionT<DeltaSize, DeltaCovSize>::MotionType& ProcessorMotionT<DeltaSize, DeltaCovSize>::getMotion() const
 {
+    integrateCovariance();
     return getBufferPtr()->get().back();
 }
 
-inline const Motion& ProcessorMotion::getMotion(const TimeStamp& _ts) const
+template <int DeltaSize, int DeltaCovSize>
+inline const typename ProcessorMotionT<DeltaSize, DeltaCovSize>::MotionType& ProcessorMotionT<DeltaSize, DeltaCovSize>::getMotion(const TimeStamp& _ts) const
 {
     auto capture_ptr = findCaptureContainingTimeStamp(_ts);
     assert(capture_ptr != nullptr && "ProcessorMotion::getMotion: timestamp older than first motion");
 
+    integrateCovariance();
     return capture_ptr->getBufferPtr()->getMotion(_ts);
 }
 
-inline void ProcessorMotion::getMotion(Motion& _motion) const
+template <int DeltaSize, int DeltaCovSize>
+inline void ProcessorMotionT<DeltaSize, DeltaCovSize>::getMotion(MotionType& _motion) const
 {
+    integrateCovariance();
     _motion = getBufferPtr()->get().back();
 }
 
-inline void ProcessorMotion::getMotion(const TimeStamp& _ts, Motion& _motion) const
+template <int DeltaSize, int DeltaCovSize>
+inline void ProcessorMotionT<DeltaSize, DeltaCovSize>::getMotion(const TimeStamp& _ts, MotionType& _motion) const
 {
     auto capture_ptr = findCaptureContainingTimeStamp(_ts);
     assert(capture_ptr != nullptr && "ProcessorMotion::getMotion: timestamp older than first motion");
 
+    integrateCovariance();
     capture_ptr->getBufferPtr()->getMotion(_ts, _motion);
 }
 
-inline CaptureMotion* ProcessorMotion::findCaptureContainingTimeStamp(const TimeStamp& _ts) const
+template <int DeltaSize, int DeltaCovSize>
+inline void ProcessorMotionT<DeltaSize, DeltaCovSize>::setLazyCovariance(bool _lazy)
+{
+    if (!_lazy && last_ptr_ != nullptr)
+        integrateCovariance();
+    lazy_covariance_ = _lazy;
+}
+
+template <int DeltaSize, int DeltaCovSize>
+inline bool ProcessorMotionT<DeltaSize, DeltaCovSize>::isLazyCovariance() const
+{
+    return lazy_covariance_;
+}
+
+template <int DeltaSize, int DeltaCovSize>
+inline void ProcessorMotionT<DeltaSize, DeltaCovSize>::setMotionDecimation(const MotionDecimation& _decimation)
+{
+    decimation_ = _decimation;
+    decimation_threshold_ = _decimation.threshold_;
+}
+
+template <int DeltaSize, int DeltaCovSize>
+inline const MotionDecimation& ProcessorMotionT<DeltaSize, DeltaCovSize>::getMotionDecimation() const
+{
+    return decimation_;
+}
+
+template <int DeltaSize, int DeltaCovSize>
+inline void ProcessorMotionT<DeltaSize, DeltaCovSize>::getBufferStatistics(MotionBufferStatistics& _statistics) const
+{
+    _statistics.processor_ptr_ = this;
+    _statistics.name_ = getName();
+    _statistics.size_ = (last_ptr_ != nullptr ? getBufferPtr()->get().size() : 0);
+    _statistics.capacity_ = (last_ptr_ != nullptr ? getBufferPtr()->get().capacity() : 0);
+    _statistics.bytes_ = (last_ptr_ != nullptr ? last_ptr_->getBufferBytes() : 0);
+    _statistics.captures_ = capture_index_.size();
+}
+
+template <int DeltaSize, int DeltaCovSize>
+inline void ProcessorMotionT<DeltaSize, DeltaCovSize>::mergeMotions(const MotionType& _previous, const MotionType& _first,
+                                                                   MotionType& _second)
+{
+    DeltaType delta(delta_size_);
+    DeltaCovType delta_cov(delta_cov_size_, delta_cov_size_);
+
+    // compose both deltas and their covariances
+    const Scalar dt = _second.ts_ - _first.ts_;
+    deltaPlusDelta(_first.delta_, _second.delta_, dt, delta, jacobian_delta_preint_, jacobian_delta_);
+    deltaCovPlusDeltaCov(_first.delta_cov_, _second.delta_cov_, dt, jacobian_delta_preint_, jacobian_delta_, delta_cov);
+    _second.delta_ = delta;
+    _second.delta_cov_ = delta_cov;
+
+    // Jacobians of the integration of the merged delta from the previous Motion
+    deltaPlusDelta(_previous.delta_integr_, _second.delta_, _second.ts_ - _previous.ts_, delta, _second.jacobian_0,
+                   _second.jacobian_ts);
+}
+
+template <int DeltaSize, int DeltaCovSize>
+inline void ProcessorMotionT<DeltaSize, DeltaCovSize>::integrateCovariance() const
+{
+    auto& motions = last_ptr_->getBufferPtr()->get();
+    for (std::size_t i = n_cov_integrated_ + 1; i < motions.size(); i++)
+        deltaCovPlusDeltaCov(motions[i - 1].delta_integr_cov_,
+                             motions[i].delta_cov_,
+                             motions[i].ts_ - motions[i - 1].ts_,
+                             motions[i].jacobian_0,
+                             motions[i].jacobian_ts,
+                             motions[i].delta_integr_cov_);
+    n_cov_integrated_ = motions.size() - 1;
+}
+
+template <int DeltaSize, int DeltaCovSize>
+inline typename ProcessorMotionT<DeltaSize, DeltaCovSize>::CaptureType* ProcessorMotionT<DeltaSize, DeltaCovSize>::findCaptureContainingTimeStamp(const TimeStamp& _ts) const
 {
     //std::cout << "ProcessorMotion::findCaptureContainingTimeStamp: ts = " << _ts.getSeconds() << "." << _ts.getNanoSeconds() << std::endl;
-    auto capture_ptr = last_ptr_;
-    while (capture_ptr != nullptr)
-    {
-        // capture containing motion previous than the ts found:
-        if (capture_ptr->getBufferPtr()->get().front().ts_ < _ts)
-            return capture_ptr;
-
-        // go to the previous motion capture
-        else if (capture_ptr == last_ptr_)
-            capture_ptr = (CaptureMotion*)origin_ptr_;
-        else if (capture_ptr->getOriginFramePtr() == nullptr)
-            return nullptr;
-        else
-        {
-            CaptureBase* capture_base_ptr = capture_ptr->getOriginFramePtr()->hasCaptureOf(getSensorPtr());
-            if (capture_base_ptr == nullptr)
-                return nullptr;
-            else
-                capture_ptr = (CaptureMotion*)capture_base_ptr;
-        }
-    }
+    // the newest capture starting strictly before _ts
+    auto capture_it = capture_index_.lower_bound(_ts);
+    if (capture_it == capture_index_.begin())
+        return nullptr;
+    CaptureType* capture_ptr = (--capture_it)->second;
+
+    // it ends before _ts if the capture after it has been removed
+    if (capture_ptr != last_ptr_ && capture_ptr->getBufferPtr()->get().back().ts_ < _ts)
+        return nullptr;
     return capture_ptr;
 }
 
-
-inline bool ProcessorMotion::isMotion()
+template <int DeltaSize, int DeltaCovSize>
+inline void ProcessorMotionT<DeltaSize, DeltaCovSize>::removeCaptureFromIndex(const CaptureType* _capture_ptr)
 {
-    return true;
+    // indexed by the time stamp of its first Motion
+    if (_capture_ptr->getBufferPtr()->get().empty())
+        return;
+    auto capture_it = capture_index_.find(_capture_ptr->getBufferPtr()->get().front().ts_);
+    if (capture_it != capture_index_.end() && capture_it->second == _capture_ptr)
+        capture_index_.erase(capture_it);
 }
 
-inline void ProcessorMotion::updateDt()
+template <int DeltaSize, int DeltaCovSize>
+inline void ProcessorMotionT<DeltaSize, DeltaCovSize>::updateDt(const TimeStamp& _ts)
 {
-    dt_ = incoming_ptr_->getTimeStamp() - getBufferPtr()->get().back().ts_;
+    dt_ = _ts - getBufferPtr()->get().back().ts_;
 
 }
 
-inline const MotionBuffer* ProcessorMotion::getBufferPtr() const
+template <int DeltaSize, int DeltaCovSize>
+inline const typename ProcessorMotionT<DeltaSize, DeltaCovSize>::BufferType* ProcessorMotionT<DeltaSize, DeltaCovSize>::getBufferPtr() const
 {
     return last_ptr_->getBufferPtr();
 }
 
-inline MotionBuffer* ProcessorMotion::getBufferPtr()
+template <int DeltaSize, int DeltaCovSize>
+inline typename ProcessorMotionT<DeltaSize, DeltaCovSize>::BufferType* ProcessorMotionT<DeltaSize, DeltaCovSize>::getBufferPtr()
 {
     return last_ptr_->getBufferPtr();
 }
 
-inline Motion ProcessorMotion::motionZero(const TimeStamp& _ts)
+template <int DeltaSize, int DeltaCovSize>
+inline typename ProcessorMotionT<DeltaSize, DeltaCovSize>::MotionType ProcessorMotionT<DeltaSize, DeltaCovSize>::motionZero(const TimeStamp& _ts)
 {
-    return Motion(
+    return MotionType(
             {_ts,
              deltaZero(),
              deltaZero(),
-             Eigen::MatrixXs::Zero(delta_cov_size_, delta_cov_size_),
-             Eigen::MatrixXs::Zero(delta_cov_size_, delta_cov_size_),
-             Eigen::MatrixXs::Identity(delta_cov_size_, delta_cov_size_),
-             Eigen::MatrixXs::Identity(delta_cov_size_, delta_cov_size_)});
+             DeltaCovType::Zero(delta_cov_size_, delta_cov_size_),
+             DeltaCovType::Zero(delta_cov_size_, delta_cov_size_),
+             DeltaCovType::Identity(delta_cov_size_, delta_cov_size_),
+             DeltaCovType::Identity(delta_cov_size_, delta_cov_size_)});
 }
 
 } // namespace wolf
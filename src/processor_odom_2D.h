@@ -21,7 +21,7 @@ struct ProcessorParamsOdom2D : public ProcessorParamsBase
     Scalar elapsed_time_th_;
 };
 
-class ProcessorOdom2D : public ProcessorMotion
+class ProcessorOdom2D : public ProcessorMotionT<3, 3>
 {
     public:
         ProcessorOdom2D(const Scalar& _traveled_dist_th, const Scalar& _cov_det_th, const Scalar& _elapsed_time_th);
@@ -36,9 +36,9 @@ class ProcessorOdom2D : public ProcessorMotion
                 std::cout << "ProcessorOdom2D:: " << this->id() << "VOTE FOR KEY FRAME traveled distance " << getBufferPtr()->get().back().delta_integr_.norm() << std::endl;
                 return true;
             }
-            if (getBufferPtr()->get().back().delta_integr_cov_.determinant() > cov_det_th_)
+            if (getMotion().delta_integr_cov_.determinant() > cov_det_th_)
             {
-                std::cout << "ProcessorOdom2D::  " << this->id() << "VOTE FOR KEY FRAME covariance det " << getBufferPtr()->get().back().delta_integr_cov_.determinant() << std::endl;
+                std::cout << "ProcessorOdom2D::  " << this->id() << "VOTE FOR KEY FRAME covariance det " << getMotion().delta_integr_cov_.determinant() << std::endl;
                 return true;
             }
             if (getBufferPtr()->get().back().ts_.get() - origin_ptr_->getFramePtr()->getTimeStamp().get() > elapsed_time_th_)
@@ -57,15 +57,15 @@ class ProcessorOdom2D : public ProcessorMotion
         Scalar elapsed_time_th_;
 
     private:
-        void xPlusDelta(const Eigen::VectorXs& _x, const Eigen::VectorXs& _delta, const Scalar _Dt, Eigen::VectorXs& _x_plus_delta);
-        void deltaPlusDelta(const Eigen::VectorXs& _delta1, const Eigen::VectorXs& _delta2, const Scalar _Dt2, Eigen::VectorXs& _delta1_plus_delta2);
-        void deltaPlusDelta(const Eigen::VectorXs& _delta1, const Eigen::VectorXs& _delta2,
-                            const Scalar _Dt2, Eigen::VectorXs& _delta1_plus_delta2, Eigen::MatrixXs& _jacobian1,
-                            Eigen::MatrixXs& _jacobian2);
-        virtual void deltaMinusDelta(const Eigen::VectorXs& _delta1, const Eigen::VectorXs& _delta2,
-                                     Eigen::VectorXs& _delta2_minus_delta1);
-        Eigen::VectorXs deltaZero() const;
-        Motion interpolate(const Motion& _motion_ref, Motion& _motion, TimeStamp& _ts);
+        void xPlusDelta(const Eigen::VectorXs& _x, const DeltaType& _delta, const Scalar _Dt, Eigen::VectorXs& _x_plus_delta);
+        void deltaPlusDelta(const DeltaType& _delta1, const DeltaType& _delta2, const Scalar _Dt2, DeltaType& _delta1_plus_delta2);
+        void deltaPlusDelta(const DeltaType& _delta1, const DeltaType& _delta2,
+                            const Scalar _Dt2, DeltaType& _delta1_plus_delta2, DeltaCovType& _jacobian1,
+                            DeltaCovType& _jacobian2);
+        virtual void deltaMinusDelta(const DeltaType& _delta1, const DeltaType& _delta2,
+                                     DeltaType& _delta2_minus_delta1);
+        DeltaType deltaZero() const;
+        MotionType interpolate(const MotionType& _motion_ref, MotionType& _motion, TimeStamp& _ts);
 
         virtual ConstraintBase* createConstraint(FeatureBase* _feature_motion, FrameBase* _frame_origin);
 
@@ -75,7 +75,7 @@ class ProcessorOdom2D : public ProcessorMotion
 };
 
 inline ProcessorOdom2D::ProcessorOdom2D(const Scalar& _traveled_dist_th, const Scalar& _cov_det_th, const Scalar& _elapsed_time_th) :
-        ProcessorMotion(PRC_ODOM_2D, "ODOM 2D", 3, 3, 3, 2),
+        ProcessorMotionT(PRC_ODOM_2D, "ODOM 2D", 3, 3, 3, 2),
         dist_traveled_th_(_traveled_dist_th),
         cov_det_th_(_cov_det_th),
         elapsed_time_th_(_elapsed_time_th)
@@ -100,7 +100,7 @@ inline void ProcessorOdom2D::data2delta(const Eigen::VectorXs& _data, const Eige
     delta_(2) = _data(1);
 
     // Fill delta covariance
-    Eigen::MatrixXs J(3,2);
+    Eigen::Matrix<Scalar, 3, 2> J;
     J(0,0) = cos(_data(1) / 2);
     J(1,0) = sin(_data(1) / 2);
     J(2,0) = 0;
@@ -108,13 +108,13 @@ inline void ProcessorOdom2D::data2delta(const Eigen::VectorXs& _data, const Eige
     J(1,1) = _data(0) / 2 * cos(_data(1) / 2);
     J(2,1) = 1;
 
-    delta_cov_ = J * _data_cov * J.transpose();
+    delta_cov_ = J * _data_cov.topLeftCorner<2,2>() * J.transpose();
 
     //std::cout << "data cov:" << std::endl << _data_cov << std::endl;
     //std::cout << "delta cov:" << std::endl << _delta_cov << std::endl;
 }
 
-inline void ProcessorOdom2D::xPlusDelta(const Eigen::VectorXs& _x, const Eigen::VectorXs& _delta, const Scalar _Dt, Eigen::VectorXs& _x_plus_delta)
+inline void ProcessorOdom2D::xPlusDelta(const Eigen::VectorXs& _x, const DeltaType& _delta, const Scalar _Dt, Eigen::VectorXs& _x_plus_delta)
 {
     //std::cout << "ProcessorOdom2d::xPlusDelta" << std::endl;
 
@@ -133,7 +133,7 @@ inline void ProcessorOdom2D::xPlusDelta(const Eigen::VectorXs& _x, const Eigen::
 //    std::cout << "_x_plus_delta: " << _x_plus_delta.transpose() << std::endl;
 }
 
-inline void ProcessorOdom2D::deltaPlusDelta(const Eigen::VectorXs& _delta1, const Eigen::VectorXs& _delta2, const Scalar _Dt2, Eigen::VectorXs& _delta1_plus_delta2)
+inline void ProcessorOdom2D::deltaPlusDelta(const DeltaType& _delta1, const DeltaType& _delta2, const Scalar _Dt2, DeltaType& _delta1_plus_delta2)
 {
     //std::cout << "ProcessorOdom2d::deltaPlusDelta" << std::endl;
     assert(_delta1.size() == delta_size_ && "Wrong _delta1 vector size");
@@ -152,10 +152,10 @@ inline void ProcessorOdom2D::deltaPlusDelta(const Eigen::VectorXs& _delta1, cons
 //    std::cout << "_delta1_plus_delta2: " << _delta1_plus_delta2.transpose() << std::endl;
 }
 
-inline void ProcessorOdom2D::deltaPlusDelta(const Eigen::VectorXs& _delta1, const Eigen::VectorXs& _delta2,
+inline void ProcessorOdom2D::deltaPlusDelta(const DeltaType& _delta1, const DeltaType& _delta2,
                                             const Scalar _Dt2,
-                                            Eigen::VectorXs& _delta1_plus_delta2, Eigen::MatrixXs& _jacobian1,
-                                            Eigen::MatrixXs& _jacobian2)
+                                            DeltaType& _delta1_plus_delta2, DeltaCovType& _jacobian1,
+                                            DeltaCovType& _jacobian2)
 {
     //std::cout << "ProcessorOdom2d::deltaPlusDelta jacobians" << std::endl;
     assert(_delta1.size() == delta_size_ && "Wrong _delta1 vector size");
@@ -175,18 +175,18 @@ inline void ProcessorOdom2D::deltaPlusDelta(const Eigen::VectorXs& _delta1, cons
     _delta1_plus_delta2(2) = _delta1(2) + _delta2(2);
 
     // TODO: fill the jacobians
-    _jacobian1 = Eigen::MatrixXs::Identity(delta_size_,delta_size_);
+    _jacobian1.setIdentity();
     _jacobian1(0,2) = -sin(_delta1(2))*_delta2(0) - cos(_delta1(2))*_delta2(1);
     _jacobian1(1,2) =  cos(_delta1(2))*_delta2(0) - sin(_delta1(2))*_delta2(1);
-    _jacobian2 = Eigen::MatrixXs::Identity(delta_size_,delta_size_);
+    _jacobian2.setIdentity();
     _jacobian2.topLeftCorner<2,2>() = Eigen::Rotation2Ds(_delta1(2)).matrix();
 
     //std::cout << "-----------------------------------------------" << std::endl;
     //std::cout << "_delta1_plus_delta2: " << _delta1_plus_delta2.transpose() << std::endl;
 }
 
-inline void ProcessorOdom2D::deltaMinusDelta(const Eigen::VectorXs& _delta1, const Eigen::VectorXs& _delta2,
-                                             Eigen::VectorXs& _delta2_minus_delta1)
+inline void ProcessorOdom2D::deltaMinusDelta(const DeltaType& _delta1, const DeltaType& _delta2,
+                                             DeltaType& _delta2_minus_delta1)
 {
     //std::cout << "ProcessorOdom2d::deltaMinusDelta" << std::endl;
     assert(_delta1.size() == 3 && "Wrong _delta1 vector size");
@@ -205,9 +205,9 @@ inline void ProcessorOdom2D::deltaMinusDelta(const Eigen::VectorXs& _delta1, con
 //    std::cout << "_delta2_minus_delta1: " << _delta2_minus_delta1.transpose() << std::endl;
 }
 
-inline Eigen::VectorXs ProcessorOdom2D::deltaZero() const
+inline ProcessorOdom2D::DeltaType ProcessorOdom2D::deltaZero() const
 {
-    return Eigen::VectorXs::Zero(delta_size_);
+    return DeltaType::Zero();
 }
 
 inline ConstraintBase* ProcessorOdom2D::createConstraint(FeatureBase* _feature_motion, FrameBase* _frame_origin)
@@ -215,15 +215,14 @@ inline ConstraintBase* ProcessorOdom2D::createConstraint(FeatureBase* _feature_m
     return new ConstraintOdom2D(_feature_motion, _frame_origin);
 }
 
-inline Motion ProcessorOdom2D::interpolate(const Motion& _motion_ref, Motion& _motion, TimeStamp& _ts)
+inline ProcessorOdom2D::MotionType ProcessorOdom2D::interpolate(const MotionType& _motion_ref, MotionType& _motion, TimeStamp& _ts)
 {
     // TODO: Implement actual interpolation
     // Implementation: motion ref keeps the same
-    Motion tmp(_motion_ref);
+    MotionType tmp(_motion_ref);
     tmp.ts_ = _ts;
     tmp.delta_ = deltaZero();
-    tmp.delta_cov_ = Eigen::MatrixXs::Zero(delta_size_, delta_size_);
-    tmp.delta_integr_cov_ += Eigen::MatrixXs::Zero(delta_size_, delta_size_);
+    tmp.delta_cov_.setZero();
     return tmp;
 }
 
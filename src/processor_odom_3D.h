@@ -37,7 +37,7 @@ namespace wolf {
  *
  * All frames are assumed FLU (front, left, up).
  */
-class ProcessorOdom3D : public ProcessorMotion
+class ProcessorOdom3D : public ProcessorMotionT<7, 6>
 {
     public:
         ProcessorOdom3D();
@@ -46,16 +46,16 @@ class ProcessorOdom3D : public ProcessorMotion
 
 
     private:
-        void xPlusDelta(const Eigen::VectorXs& _x, const Eigen::VectorXs& _delta, const Scalar _Dt, Eigen::VectorXs& _x_plus_delta);
-        void deltaPlusDelta(const Eigen::VectorXs& _delta1, const Eigen::VectorXs& _delta2, const Scalar _Dt2, Eigen::VectorXs& _delta1_plus_delta2);
-        void deltaPlusDelta(const Eigen::VectorXs& _delta1, const Eigen::VectorXs& _delta2,
+        void xPlusDelta(const Eigen::VectorXs& _x, const DeltaType& _delta, const Scalar _Dt, Eigen::VectorXs& _x_plus_delta);
+        void deltaPlusDelta(const DeltaType& _delta1, const DeltaType& _delta2, const Scalar _Dt2, DeltaType& _delta1_plus_delta2);
+        void deltaPlusDelta(const DeltaType& _delta1, const DeltaType& _delta2,
                             const Scalar _Dt2,
-                            Eigen::VectorXs& _delta1_plus_delta2, Eigen::MatrixXs& _jacobian1,
-                            Eigen::MatrixXs& _jacobian2);
-        virtual void deltaMinusDelta(const Eigen::VectorXs& _delta1, const Eigen::VectorXs& _delta2,
-                                     Eigen::VectorXs& _delta2_minus_delta1);
-        Eigen::VectorXs deltaZero() const;
-        Motion interpolate(const Motion& _motion_ref, Motion& _motion, TimeStamp& _ts);
+                            DeltaType& _delta1_plus_delta2, DeltaCovType& _jacobian1,
+                            DeltaCovType& _jacobian2);
+        virtual void deltaMinusDelta(const DeltaType& _delta1, const DeltaType& _delta2,
+                                     DeltaType& _delta2_minus_delta1);
+        DeltaType deltaZero() const;
+        MotionType interpolate(const MotionType& _motion_ref, MotionType& _motion, TimeStamp& _ts);
 
         virtual ConstraintBase* createConstraint(FeatureBase* _feature_motion, FrameBase* _frame_origin);
 
@@ -64,7 +64,7 @@ class ProcessorOdom3D : public ProcessorMotion
         Eigen::Map<Eigen::Vector3s> p_out_;
         Eigen::Map<const Eigen::Quaternions> q1_, q2_;
         Eigen::Map<Eigen::Quaternions> q_out_;
-        void remap(const Eigen::VectorXs& _x1, const Eigen::VectorXs& _x2, Eigen::VectorXs& _x_out);
+        void remap(const Scalar* _x1, const Scalar* _x2, Scalar* _x_out);
 
     // Factory method
     public:
@@ -73,7 +73,7 @@ class ProcessorOdom3D : public ProcessorMotion
 
 
 inline ProcessorOdom3D::ProcessorOdom3D() :
-        ProcessorMotion(PRC_ODOM_3D, "ODOM 3D", 7, 7, 7, 6),
+        ProcessorMotionT(PRC_ODOM_3D, "ODOM 3D", 7, 7, 6, 6),
         p1_(nullptr),
         p2_(nullptr),
         p_out_(nullptr),
@@ -95,74 +95,60 @@ inline void ProcessorOdom3D::data2delta(const Eigen::VectorXs& _data, const Eige
 
     q_out_ = v2q(_data.tail<3>());
     // TODO: fill delta covariance
-    delta_cov_ = Eigen::MatrixXs::Identity(delta_size_, delta_size_) * 0.01;
+    delta_cov_ = DeltaCovType::Identity() * 0.01;
 }
 
-inline void ProcessorOdom3D::xPlusDelta(const Eigen::VectorXs& _x, const Eigen::VectorXs& _delta, const Scalar _Dt, Eigen::VectorXs& _x_plus_delta)
+inline void ProcessorOdom3D::xPlusDelta(const Eigen::VectorXs& _x, const DeltaType& _delta, const Scalar _Dt, Eigen::VectorXs& _x_plus_delta)
 {
     assert(_x.size() == 7 && "Wrong _x vector size");
-    assert(_delta.size() == 7 && "Wrong _delta vector size");
     assert(_x_plus_delta.size() == 7 && "Wrong _x_plus_delta vector size");
 
-    remap(_x, _delta, _x_plus_delta);
+    remap(_x.data(), _delta.data(), _x_plus_delta.data());
 
     p_out_ = p1_ + q1_ * p2_;
     q_out_ = q1_ * q2_;
 }
 
-inline void ProcessorOdom3D::deltaPlusDelta(const Eigen::VectorXs& _delta1, const Eigen::VectorXs& _delta2, const Scalar _Dt2, Eigen::VectorXs& _delta1_plus_delta2)
+inline void ProcessorOdom3D::deltaPlusDelta(const DeltaType& _delta1, const DeltaType& _delta2, const Scalar _Dt2, DeltaType& _delta1_plus_delta2)
 {
-    assert(_delta1.size() == 7 && "Wrong _delta1 vector size");
-    assert(_delta2.size() == 7 && "Wrong _delta2 vector size");
-    assert(_delta1_plus_delta2.size() == 7 && "Wrong _delta1_plus_delta2 vector size");
-
-    remap(_delta1, _delta2, _delta1_plus_delta2);
+    remap(_delta1.data(), _delta2.data(), _delta1_plus_delta2.data());
     p_out_ = p1_ + q1_ * p2_;
     q_out_ = q1_ * q2_;
 }
 
-inline void ProcessorOdom3D::deltaPlusDelta(const Eigen::VectorXs& _delta1, const Eigen::VectorXs& _delta2,
+inline void ProcessorOdom3D::deltaPlusDelta(const DeltaType& _delta1, const DeltaType& _delta2,
                                             const Scalar _Dt2,
-                                            Eigen::VectorXs& _delta1_plus_delta2, Eigen::MatrixXs& _jacobian1,
-                                            Eigen::MatrixXs& _jacobian2)
+                                            DeltaType& _delta1_plus_delta2, DeltaCovType& _jacobian1,
+                                            DeltaCovType& _jacobian2)
 {
-    assert(_delta1.size() == 7 && "Wrong _delta1 vector size");
-    assert(_delta2.size() == 7 && "Wrong _delta2 vector size");
-    assert(_delta1_plus_delta2.size() == 7 && "Wrong _delta1_plus_delta2 vector size");
-    // TODO: assert sizes of jacobians
-
-    remap(_delta1, _delta2, _delta1_plus_delta2);
+    remap(_delta1.data(), _delta2.data(), _delta1_plus_delta2.data());
     p_out_ = p1_ + q1_ * p2_;
     q_out_ = q1_ * q2_;
 
     // TODO: fill the jacobians
-    _jacobian1 = Eigen::MatrixXs::Identity(delta_size_,delta_size_);
-    _jacobian2 = Eigen::MatrixXs::Identity(delta_size_,delta_size_);
+    _jacobian1.setIdentity();
+    _jacobian2.setIdentity();
 }
 
-inline void ProcessorOdom3D::deltaMinusDelta(const Eigen::VectorXs& _delta1, const Eigen::VectorXs& _delta2,
-                                             Eigen::VectorXs& _delta2_minus_delta1)
+inline void ProcessorOdom3D::deltaMinusDelta(const DeltaType& _delta1, const DeltaType& _delta2,
+                                             DeltaType& _delta2_minus_delta1)
 {
-    assert(_delta1.size() == 7 && "Wrong _delta1 vector size");
-    assert(_delta2.size() == 7 && "Wrong _delta2 vector size");
-    assert(_delta2_minus_delta1.size() == 7 && "Wrong _delta2_minus_delta1 vector size");
-
-    remap(_delta1, _delta2, _delta2_minus_delta1);
+    remap(_delta1.data(), _delta2.data(), _delta2_minus_delta1.data());
     p_out_ = q1_.conjugate() * (p2_ - p1_);
     q_out_ = q1_.conjugate() * q2_;
 }
 
-inline Eigen::VectorXs ProcessorOdom3D::deltaZero() const
+inline ProcessorOdom3D::DeltaType ProcessorOdom3D::deltaZero() const
 {
-    return (Eigen::VectorXs(7) << 0,0,0, 0,0,0,1).finished(); // p, q
+    return (DeltaType() << 0,0,0, 0,0,0,1).finished(); // p, q
 }
 
-inline Motion ProcessorOdom3D::interpolate(const Motion& _motion_ref, Motion& _motion, TimeStamp& _ts)
+inline ProcessorOdom3D::MotionType ProcessorOdom3D::interpolate(const MotionType& _motion_ref, MotionType& _motion, TimeStamp& _ts)
 {
-    Motion tmp(_motion_ref);
+    MotionType tmp(_motion_ref);
     tmp.ts_ = _ts;
     tmp.delta_ = deltaZero();
-    tmp.delta_cov_ = Eigen::MatrixXs::Zero(delta_size_, delta_size_);
+    tmp.delta_cov_.setZero();
     return tmp;
 }
 
@@ -171,14 +157,14 @@ inline ConstraintBase* ProcessorOdom3D::createConstraint(FeatureBase* _feature_m
     return new ConstraintOdom2D(_feature_motion, _frame_origin);
 }
 
-inline void ProcessorOdom3D::remap(const Eigen::VectorXs& _x1, const Eigen::VectorXs& _x2, Eigen::VectorXs& _x_out)
+inline void ProcessorOdom3D::remap(const Scalar* _x1, const Scalar* _x2, Scalar* _x_out)
 {
-    new (&p1_) Eigen::Map<const Eigen::Vector3s>(_x1.data());
-    new (&q1_) Eigen::Map<const Eigen::Quaternions>(_x1.data() + 3);
-    new (&p2_) Eigen::Map<const Eigen::Vector3s>(_x2.data());
-    new (&q2_) Eigen::Map<const Eigen::Quaternions>(_x2.data() + 3);
-    new (&p_out_) Eigen::Map<Eigen::Vector3s>(_x_out.data());
-    new (&q_out_) Eigen::Map<Eigen::Quaternions>(_x_out.data() + 3);
+    new (&p1_) Eigen::Map<const Eigen::Vector3s>(_x1);
+    new (&q1_) Eigen::Map<const Eigen::Quaternions>(_x1 + 3);
+    new (&p2_) Eigen::Map<const Eigen::Vector3s>(_x2);
+    new (&q2_) Eigen::Map<const Eigen::Quaternions>(_x2 + 3);
+    new (&p_out_) Eigen::Map<Eigen::Vector3s>(_x_out);
+    new (&q_out_) Eigen::Map<Eigen::Quaternions>(_x_out + 3);
 }
 
 } // namespace wolf
@@ -12,7 +12,8 @@ namespace wolf
 
 ProcessorTracker::ProcessorTracker(ProcessorType _tp, const std::string& _type, const unsigned int _max_new_features, const Scalar& _time_tolerance) :
         ProcessorBase(_tp, _type, _time_tolerance), origin_ptr_(nullptr), last_ptr_(nullptr), incoming_ptr_(nullptr),
-        max_new_features_(_max_new_features)
+        max_new_features_(_max_new_features), new_features_prepared_(false),
+        extracted_ptr_(nullptr)
 {
     //
 }
@@ -47,6 +48,11 @@ void ProcessorTracker::process(CaptureBase* const _incoming_ptr)
 
     incoming_ptr_ = _incoming_ptr;
 
+    // extract the raw data, unless extract() already did
+    if (extracted_ptr_ != incoming_ptr_)
+        extractIncoming(incoming_ptr_);
+    extracted_ptr_ = nullptr;
+
     preProcess();
     // FIRST TIME
     if (origin_ptr_ == nullptr && last_ptr_ == nullptr)
@@ -153,7 +159,13 @@ void ProcessorTracker::process(CaptureBase* const _incoming_ptr)
     //std::cout << "\tincoming new features: " << new_features_incoming_.size() << std::endl;
 }
 
-bool ProcessorTracker::keyFrameCallback(FrameBase* _keyframe_ptr, const Scalar& _time_tol)
+void ProcessorTracker::extract(CaptureBase* _capture_ptr)
+{
+    extractIncoming(_capture_ptr);
+    extracted_ptr_ = _capture_ptr;
+}
+
+bool ProcessorTracker::acceptsKeyFrame(FrameBase* _keyframe_ptr, const Scalar& _time_tol)
 {
     assert((last_ptr_ == nullptr || last_ptr_->getFramePtr() != nullptr) && "ProcessorTracker::keyFrameCallback: last_ptr_ must have a frame allways");
     Scalar time_tol = std::max(time_tolerance_, _time_tol);
@@ -162,14 +174,50 @@ bool ProcessorTracker::keyFrameCallback(FrameBase* _keyframe_ptr, const Scalar&
     //   - there is no last
     //   - last frame is already a key frame
     //   - last frame is too far in time from keyframe
-    if (last_ptr_ == nullptr || last_ptr_->getFramePtr()->isKey() || std::abs(last_ptr_->getTimeStamp() - _keyframe_ptr->getTimeStamp()) > time_tol)
+    return !(last_ptr_ == nullptr || last_ptr_->getFramePtr()->isKey() || std::abs(last_ptr_->getTimeStamp() - _keyframe_ptr->getTimeStamp()) > time_tol);
+}
+
+void ProcessorTracker::keyFrameCallbackPrepare(FrameBase* _keyframe_ptr, const Scalar& _time_tol)
+{
+    // Detect new Features in last. They stay in new_features_last_, out of the tree, until processNew().
+    if (!new_features_prepared_ && acceptsKeyFrame(_keyframe_ptr, _time_tol))
+    {
+        detectNewFeatures(max_new_features_);
+        new_features_prepared_ = true;
+    }
+}
+
+unsigned int ProcessorTracker::takeNewFeatures(const unsigned int& _max_features)
+{
+    if (!new_features_prepared_)
+        return detectNewFeatures(_max_features);
+
+    new_features_prepared_ = false;
+    return new_features_last_.size();
+}
+
+bool ProcessorTracker::keyFrameCallback(FrameBase* _keyframe_ptr, const Scalar& _time_tol)
+{
+    if (!acceptsKeyFrame(_keyframe_ptr, _time_tol))
+    {
+        // drop the features prepared for this key frame, if any
+        if (new_features_prepared_)
+        {
+            while (!new_features_last_.empty())
+            {
+                new_features_last_.front()->destruct();
+                new_features_last_.pop_front();
+            }
+            new_features_prepared_ = false;
+        }
         return false;
+    }
 
     //std::cout << "ProcessorTracker::keyFrameCallback in sensor " << getSensorPtr()->id() << std::endl;
 
     // Capture last_ is added to the new keyframe
     FrameBase* last_old_frame = last_ptr_->getFramePtr();
-    last_old_frame->unlinkDownNode(last_ptr_);
+    last_old_frame->unlinkCapture(last_ptr_);
     last_old_frame->destruct();
     _keyframe_ptr->addCapture(last_ptr_);
 
@@ -185,6 +233,15 @@ bool ProcessorTracker::keyFrameCallback(FrameBase* _keyframe_ptr, const Scalar&
     return true;
 }
 
+void ProcessorTracker::removeKeyFrameCallback(FrameBase* _keyframe_ptr)
+{
+    assert((last_ptr_ == nullptr || last_ptr_->getFramePtr() != _keyframe_ptr) && "ProcessorTracker::removeKeyFrameCallback: cannot remove the frame of last");
+
+    // Set ready to go to 2nd case in process(), as after a key frame callback
+    if (origin_ptr_ != nullptr && origin_ptr_->getFramePtr() == _keyframe_ptr)
+        origin_ptr_ = nullptr;
+}
+
 void ProcessorTracker::setKeyFrame(CaptureBase* _capture_ptr)
 {
     assert(_capture_ptr != nullptr && _capture_ptr->getFramePtr() != nullptr && "ProcessorTracker::setKeyFrame: null capture or capture without frame");
@@ -72,11 +72,17 @@ class ProcessorTracker : public ProcessorBase
         FeatureBaseList new_features_last_; ///< List of new features in \b last for landmark initialization and new key-frame creation.
         FeatureBaseList new_features_incoming_; ///< list of the new features of \b last successfully tracked in \b incoming
         unsigned int max_new_features_; ///< max features allowed to detect in one iteration. 0 = no limit
+        bool new_features_prepared_; ///< new features of \b last already detected by keyFrameCallbackPrepare()
+        CaptureBase* extracted_ptr_; ///< capture already extracted by extract(), to be processed next
 
     public:
         ProcessorTracker(ProcessorType _tp, const std::string& _type, const unsigned int _max_new_features = 0, const Scalar& _time_tolerance = 0.1);
         virtual ~ProcessorTracker();
 
+        /** \brief Extracts the features of a Capture to be processed next, see extractIncoming()
+         */
+        virtual void extract(CaptureBase* _capture_ptr);
+
         /** \brief Full processing of an incoming Capture.
          *
          * Usually you do not need to overload this method in derived classes.
@@ -87,11 +93,27 @@ class ProcessorTracker : public ProcessorBase
         void setMaxNewFeatures(const unsigned int& _max_new_features);
         const unsigned int getMaxNewFeatures();
 
+        /** \brief Detects the new features of \b last, if the key frame is to take it
+         */
+        virtual void keyFrameCallbackPrepare(FrameBase* _keyframe_ptr, const Scalar& _dt);
+
         virtual bool keyFrameCallback(FrameBase* _keyframe_ptr, const Scalar& _dt);
 
+        /** \brief Restarts the tracks from \b last if \b origin is in the key frame being removed
+         */
+        virtual void removeKeyFrameCallback(FrameBase* _keyframe_ptr);
+
         virtual CaptureBase* getLastPtr();
 
     protected:
+        /** Extract the raw data of the incoming Capture
+         *
+         * This is called by process() before preProcess(), or earlier by extract().
+         * It may run concurrently with other processors, so it must only read the Capture's raw data and write
+         * the derived tracker's own data, e.g. extracting the corners of a laser scan. It must not read the Wolf tree.
+         */
+        virtual void extractIncoming(CaptureBase* _incoming_ptr) { };
+
         /** Pre-process incoming Capture
          *
          * This is called by process() just after assigning incoming_ptr_ to a valid Capture.
@@ -162,6 +184,22 @@ class ProcessorTracker : public ProcessorBase
          */
         virtual unsigned int processNew(const unsigned int& _max_features) = 0;
 
+        /** \brief Detect new Features in \b last
+         *
+         * Puts the detected Features in new_features_last_. See the derived trackers.
+         */
+        virtual unsigned int detectNewFeatures(const unsigned int& _max_features) = 0;
+
+        /**\brief Detect new Features in \b last, unless keyFrameCallbackPrepare() already did
+         *
+         * This is the way for processNew() to call detectNewFeatures().
+         */
+        unsigned int takeNewFeatures(const unsigned int& _max_features);
+
+        /**\brief Whether the key frame callback takes \b last into _keyframe_ptr
+         */
+        bool acceptsKeyFrame(FrameBase* _keyframe_ptr, const Scalar& _dt);
+
         /**\brief Creates and adds constraints from last_ to origin_
          *
          */
@@ -74,7 +74,7 @@ unsigned int ProcessorTrackerFeature::processNew(const unsigned int& _max_new_fe
      */
 
     // Populate the last Capture with new Features. The result is in new_features_last_.
-    unsigned int n = detectNewFeatures(_max_new_features);
+    unsigned int n = takeNewFeatures(_max_new_features);
 
     //  std::cout << "detected " << n << " new features!" << std::endl;
 
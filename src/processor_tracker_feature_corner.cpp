@@ -11,11 +11,14 @@
 namespace wolf
 {
 
-void ProcessorTrackerFeatureCorner::preProcess()
+void ProcessorTrackerFeatureCorner::extractIncoming(CaptureBase* _incoming_ptr)
 {
     // extract corners of incoming
-    extractCorners((CaptureLaser2D*)((incoming_ptr_)), corners_incoming_);
+    extractCorners((CaptureLaser2D*)((_incoming_ptr)), corners_incoming_);
+}
 
+void ProcessorTrackerFeatureCorner::preProcess()
+{
     // store previous transformations
     R_world_sensor_prev_ = R_world_sensor_;
     t_world_sensor_prev_ = t_world_sensor_;
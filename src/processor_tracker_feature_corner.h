@@ -67,6 +67,7 @@ class ProcessorTrackerFeatureCorner : public ProcessorTrackerFeature
 
     protected:
 
+        virtual void extractIncoming(CaptureBase* _incoming_ptr);
         virtual void preProcess();
         virtual void postProcess();
 
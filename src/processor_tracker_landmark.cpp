@@ -48,7 +48,7 @@ unsigned int ProcessorTrackerLandmark::processNew(const unsigned int& _max_featu
      * the last and incoming Captures.
      */
     // We first need to populate the \b last Capture with new Features
-    unsigned int n = detectNewFeatures(_max_features);
+    unsigned int n = takeNewFeatures(_max_features);
     //std::cout << "\tlast new features: " << new_features_last_.size() << std::endl;
 
     LandmarkBaseList new_landmarks;
@@ -37,7 +37,7 @@ unsigned int ProcessorTrackerLandmark2::processNew(const unsigned int& _max_feat
      * the last and incoming Captures.
      */
     // We first need to populate the \b last Capture with new Features
-    unsigned int n = detectNewFeatures(_max_features);
+    unsigned int n = takeNewFeatures(_max_features);
     LandmarkBaseList new_landmarks;
     for (auto new_feature_ptr : new_features_last_)
     {
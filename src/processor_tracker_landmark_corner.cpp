@@ -4,11 +4,14 @@
 namespace wolf
 {
 
-void ProcessorTrackerLandmarkCorner::preProcess()
+void ProcessorTrackerLandmarkCorner::extractIncoming(CaptureBase* _incoming_ptr)
 {
     // extract corners of incoming
-    extractCorners((CaptureLaser2D*)((incoming_ptr_)), corners_incoming_);
+    extractCorners((CaptureLaser2D*)((_incoming_ptr)), corners_incoming_);
+}
 
+void ProcessorTrackerLandmarkCorner::preProcess()
+{
     // compute transformations
     t_world_robot_ = getProblem()->getStateAtTimeStamp(incoming_ptr_->getTimeStamp());
 
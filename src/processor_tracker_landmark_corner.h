@@ -86,6 +86,7 @@ class ProcessorTrackerLandmarkCorner : public ProcessorTrackerLandmark
 
     protected:
 
+        virtual void extractIncoming(CaptureBase* _incoming_ptr);
         virtual void preProcess();
 //        virtual void postProcess() { }
 
@@ -3,13 +3,16 @@
 namespace wolf
 {
 
+void ProcessorTrackerLandmarkPolyline::extractIncoming(CaptureBase* _incoming_ptr)
+{
+    // extract polylines of incoming
+    extractPolylines((CaptureLaser2D*)((_incoming_ptr)), polylines_incoming_);
+}
+
 void ProcessorTrackerLandmarkPolyline::preProcess()
 {
     //std::cout << "PreProcess: " << std::endl;
 
-    // extract corners of incoming
-    extractPolylines((CaptureLaser2D*)((incoming_ptr_)), polylines_incoming_);
-
     // compute transformations
     computeTransformations(incoming_ptr_->getTimeStamp());
 
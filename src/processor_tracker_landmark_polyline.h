@@ -89,6 +89,7 @@ class ProcessorTrackerLandmarkPolyline : public ProcessorTrackerLandmark
 
     protected:
 
+        virtual void extractIncoming(CaptureBase* _incoming_ptr);
         virtual void preProcess();
         void computeTransformations(const TimeStamp& _ts);
         virtual void postProcess();
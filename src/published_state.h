@@ -0,0 +1,211 @@
+/**
+ * \file published_state.h
+ *
+ *  Created on: Jul 1, 2016
+ *      \author: jsola
+ */
+
+#ifndef SRC_PUBLISHED_STATE_H_
+#define SRC_PUBLISHED_STATE_H_
+
+#include "wolf.h"
+#include "time_stamp.h"
+
+// STL includes
+#include <atomic>
+#include <memory>
+
+namespace wolf {
+
+/** \brief Snapshot of the current state, for readers in other threads
+ *
+ * This is a sequence lock over a time stamp, a state vector and optionally a covariance matrix.
+ * There is one writer, the Wolf thread (normally the main ProcessorMotion, after each integration, see publish()),
+ * and any number of readers in any thread (see read()).
+ *
+ * The writer never waits. The readers do not take any lock: they copy the snapshot
+ * and retry in the rare case that the writer published a new one in the meantime.
+ * Neither of them allocates memory once the sizes are set.
+ *
+ * The covariance is not published unless its size is set with setCovarianceSize(), at setup time.
+ */
+class PublishedState
+{
+    public:
+        PublishedState(unsigned int _state_size, unsigned int _cov_size = 0);
+        ~PublishedState();
+
+        /** \brief Sets the size of the published covariance. Not thread safe: call it before any publish() or read().
+         * \param _cov_size the covariance size. Zero to publish no covariance.
+         */
+        void setCovarianceSize(unsigned int _cov_size);
+
+        unsigned int getStateSize() const;
+        unsigned int getCovarianceSize() const;
+
+        /** \brief Publishes a new snapshot. Writer thread only.
+         * \param _ts the time stamp of the state
+         * \param _x the state
+         */
+        template<typename DerivedX>
+        void publish(const TimeStamp& _ts, const Eigen::MatrixBase<DerivedX>& _x);
+
+        /** \brief Publishes a new snapshot with covariance. Writer thread only.
+         * \param _ts the time stamp of the state
+         * \param _x the state
+         * \param _cov the covariance. It must have the size given by setCovarianceSize().
+         */
+        template<typename DerivedX, typename DerivedC>
+        void publish(const TimeStamp& _ts, const Eigen::MatrixBase<DerivedX>& _x, const Eigen::MatrixBase<DerivedC>& _cov);
+
+        /** \brief Reads the last snapshot. Any thread.
+         * \param _ts the time stamp of the state
+         * \param _x the state. It must have the right size for this not to allocate.
+         * \return false if nothing has been published yet
+         */
+        bool read(TimeStamp& _ts, Eigen::VectorXs& _x) const;
+
+        /** \brief Reads the last snapshot with covariance. Any thread.
+         * \param _ts the time stamp of the state
+         * \param _x the state. It must have the right size for this not to allocate.
+         * \param _cov the covariance. It must have the right size for this not to allocate.
+         * \return false if nothing has been published yet
+         */
+        bool read(TimeStamp& _ts, Eigen::VectorXs& _x, Eigen::MatrixXs& _cov) const;
+
+        unsigned long int getPublishedCount() const; ///< number of snapshots published so far
+
+    private:
+        bool read(TimeStamp& _ts, Eigen::VectorXs& _x, Eigen::MatrixXs* _cov_ptr) const;
+        void beginWrite();
+        void endWrite();
+
+        unsigned int state_size_;
+        unsigned int cov_size_;
+
+        // the snapshot. Every item is atomic so that a reader copying it while it is written does not make a data race:
+        // the torn copy is then detected with the sequence number and discarded.
+        std::atomic<Scalar> ts_;
+        std::unique_ptr<std::atomic<Scalar>[]> x_;
+        std::unique_ptr<std::atomic<Scalar>[]> cov_;    ///< column major
+
+        std::atomic<unsigned long int> seq_;            ///< twice the number of snapshots. Odd while a snapshot is being written.
+};
+
+inline PublishedState::PublishedState(unsigned int _state_size, unsigned int _cov_size) :
+        state_size_(_state_size),
+        cov_size_(0),
+        ts_(0),
+        x_(new std::atomic<Scalar>[_state_size]()),
+        seq_(0)
+{
+    setCovarianceSize(_cov_size);
+}
+
+inline PublishedState::~PublishedState()
+{
+    //
+}
+
+inline void PublishedState::setCovarianceSize(unsigned int _cov_size)
+{
+    cov_size_ = _cov_size;
+    cov_.reset(_cov_size > 0 ? new std::atomic<Scalar>[_cov_size * _cov_size]() : nullptr);
+}
+
+inline unsigned int PublishedState::getStateSize() const
+{
+    return state_size_;
+}
+
+inline unsigned int PublishedState::getCovarianceSize() const
+{
+    return cov_size_;
+}
+
+inline void PublishedState::beginWrite()
+{
+    seq_.store(seq_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+inline void PublishedState::endWrite()
+{
+    seq_.store(seq_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+template<typename DerivedX>
+inline void PublishedState::publish(const TimeStamp& _ts, const Eigen::MatrixBase<DerivedX>& _x)
+{
+    assert(_x.size() == (int)state_size_ && "PublishedState::publish: wrong state size");
+
+    beginWrite();
+    ts_.store(_ts.get(), std::memory_order_relaxed);
+    for (unsigned int i = 0; i < state_size_; i++)
+        x_[i].store(_x(i), std::memory_order_relaxed);
+    endWrite();
+}
+
+template<typename DerivedX, typename DerivedC>
+inline void PublishedState::publish(const TimeStamp& _ts, const Eigen::MatrixBase<DerivedX>& _x,
+                                    const Eigen::MatrixBase<DerivedC>& _cov)
+{
+    assert(_x.size() == (int)state_size_ && "PublishedState::publish: wrong state size");
+    assert(_cov.rows() == (int)cov_size_ && _cov.cols() == (int)cov_size_ && "PublishedState::publish: wrong covariance size");
+
+    beginWrite();
+    ts_.store(_ts.get(), std::memory_order_relaxed);
+    for (unsigned int i = 0; i < state_size_; i++)
+        x_[i].store(_x(i), std::memory_order_relaxed);
+    for (unsigned int j = 0; j < cov_size_; j++)
+        for (unsigned int i = 0; i < cov_size_; i++)
+            cov_[j * cov_size_ + i].store(_cov(i, j), std::memory_order_relaxed);
+    endWrite();
+}
+
+inline bool PublishedState::read(TimeStamp& _ts, Eigen::VectorXs& _x) const
+{
+    return read(_ts, _x, nullptr);
+}
+
+inline bool PublishedState::read(TimeStamp& _ts, Eigen::VectorXs& _x, Eigen::MatrixXs& _cov) const
+{
+    return read(_ts, _x, &_cov);
+}
+
+inline bool PublishedState::read(TimeStamp& _ts, Eigen::VectorXs& _x, Eigen::MatrixXs* _cov_ptr) const
+{
+    _x.resize(state_size_);
+    if (_cov_ptr != nullptr)
+        _cov_ptr->resize(cov_size_, cov_size_);
+
+    while (true)
+    {
+        unsigned long int seq = seq_.load(std::memory_order_acquire);
+        if (seq == 0)
+            return false;
+        if (seq & 1)
+            continue; // the writer is at it
+
+        _ts.set(ts_.load(std::memory_order_relaxed));
+        for (unsigned int i = 0; i < state_size_; i++)
+            _x(i) = x_[i].load(std::memory_order_relaxed);
+        if (_cov_ptr != nullptr)
+            for (unsigned int j = 0; j < cov_size_; j++)
+                for (unsigned int i = 0; i < cov_size_; i++)
+                    (*_cov_ptr)(i, j) = cov_[j * cov_size_ + i].load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (seq_.load(std::memory_order_relaxed) == seq)
+            return true;
+    }
+}
+
+inline unsigned long int PublishedState::getPublishedCount() const
+{
+    return seq_.load(std::memory_order_acquire) / 2;
+}
+
+} // namespace wolf
+
+#endif /* SRC_PUBLISHED_STATE_H_ */
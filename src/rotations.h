@@ -133,13 +133,13 @@ inline Eigen::Matrix<T, 3, 1> q2v(const Eigen::Quaternion<T>& _q)
     T vecnorm = vec.norm();
     if (vecnorm > wolf::Constants::EPS)
     { // regular angle-axis conversion
-        T angle = atan2(vecnorm, _q.w());
+        T angle = (T)2.0 * atan2(vecnorm, _q.w());
         return vec * angle / vecnorm;
     }
     else
-    { // small-angle approximation using truncated Taylor series
+    { // small-angle approximation using truncated Taylor series of atan(r)/r ~ 1 - r^2/3
         T r = vecnorm / _q.w();
-        return vec * ((T)1.0 - r * r) / _q.w();
+        return vec * (T)2.0 * ((T)1.0 - r * r / (T)3.0) / _q.w();
     }
 }
 
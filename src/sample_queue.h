@@ -0,0 +1,210 @@
+/**
+ * \file sample_queue.h
+ *
+ *  Created on: Jun 29, 2016
+ *      \author: jsola
+ */
+
+#ifndef SRC_SAMPLE_QUEUE_H_
+#define SRC_SAMPLE_QUEUE_H_
+
+#include "wolf.h"
+#include "time_stamp.h"
+
+// STL includes
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace wolf {
+
+/** \brief Lock-free queue of raw time-stamped sensor samples
+ *
+ * This is a ring buffer for exactly one producer thread (typically the sensor driver, calling push())
+ * and one consumer thread (the Wolf thread, calling pop(), normally through ProcessorMotion::drainSampleQueue()).
+ * Neither of them takes a lock, and none of them allocates memory once the queue is constructed.
+ *
+ * All the samples have the same data size and share the data covariance given at construction.
+ *
+ * When the queue is full, push() behaves according to the drop policy (see SampleDropPolicy in wolf.h).
+ * The samples rejected this way are counted, see getDroppedCount().
+ */
+class SampleQueue
+{
+    public:
+        SampleQueue(unsigned int _data_size, unsigned int _capacity, const Eigen::MatrixXs& _data_cov,
+                    SampleDropPolicy _drop_policy = SMP_DROP_NEWEST);
+        ~SampleQueue();
+
+        /** \brief Pushes a sample. Producer thread only.
+         * \param _ts the time stamp of the sample
+         * \param _data the data of the sample: any Eigen vector expression, e.g. a column of a block of samples.
+         * \return false if the sample has been dropped
+         */
+        template<typename Derived>
+        bool push(const TimeStamp& _ts, const Eigen::MatrixBase<Derived>& _data);
+
+        /** \brief Pops the oldest sample. Consumer thread only.
+         * \param _ts the time stamp of the sample
+         * \param _data the data of the sample. It must have the right size for this not to allocate.
+         * \return false if the queue was empty
+         */
+        bool pop(TimeStamp& _ts, Eigen::VectorXs& _data);
+
+        /** \brief Number of samples in the queue
+         *
+         * Exact for the consumer (it can only grow under its feet), and a lower bound for the producer.
+         */
+        unsigned int size() const;
+        bool empty() const;
+        unsigned int capacity() const;
+        unsigned int getDataSize() const;
+        const Eigen::MatrixXs& getDataCovariance() const;
+
+        SampleDropPolicy getDropPolicy() const;
+        void setDropPolicy(SampleDropPolicy _drop_policy);
+
+        unsigned long int getPushedCount() const;   ///< samples accepted by push()
+        unsigned long int getDroppedCount() const;  ///< samples rejected by push() because the queue was full
+        unsigned int getMaxSize() const;            ///< the largest number of samples found in the queue by push()
+
+    private:
+        unsigned int data_size_;
+        unsigned int capacity_;
+        Eigen::MatrixXs data_cov_;
+        std::atomic<int> drop_policy_;
+
+        // storage: one column and one time stamp per slot
+        Eigen::MatrixXs data_;
+        std::vector<TimeStamp> time_stamps_;
+
+        // indices: they only grow, the slot is the index modulo the capacity. Each one is written by one thread only.
+        std::atomic<unsigned long int> head_; ///< next sample to pop. Written by the consumer.
+        std::atomic<unsigned long int> tail_; ///< next slot to push. Written by the producer.
+
+        // statistics, written by the producer
+        std::atomic<unsigned long int> n_pushed_;
+        std::atomic<unsigned long int> n_dropped_;
+        std::atomic<unsigned int> max_size_;
+};
+
+inline SampleQueue::SampleQueue(unsigned int _data_size, unsigned int _capacity, const Eigen::MatrixXs& _data_cov,
+                                SampleDropPolicy _drop_policy) :
+        data_size_(_data_size),
+        capacity_(_capacity),
+        data_cov_(_data_cov),
+        drop_policy_(_drop_policy),
+        data_(_data_size, _capacity),
+        time_stamps_(_capacity),
+        head_(0),
+        tail_(0),
+        n_pushed_(0),
+        n_dropped_(0),
+        max_size_(0)
+{
+    assert(_capacity > 0 && "SampleQueue: capacity must be positive");
+    assert(_data_cov.rows() == (int)_data_size && _data_cov.cols() == (int)_data_size && "SampleQueue: wrong data covariance size");
+}
+
+inline SampleQueue::~SampleQueue()
+{
+    //
+}
+
+template<typename Derived>
+inline bool SampleQueue::push(const TimeStamp& _ts, const Eigen::MatrixBase<Derived>& _data)
+{
+    assert(_data.size() == (int)data_size_ && "SampleQueue::push: wrong data size");
+
+    unsigned long int tail = tail_.load(std::memory_order_relaxed);
+    unsigned long int head = head_.load(std::memory_order_acquire);
+    while (tail - head == capacity_)
+    {
+        if (drop_policy_.load(std::memory_order_relaxed) == SMP_DROP_NEWEST)
+        {
+            n_dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        // SMP_WAIT: let the consumer make room
+        std::this_thread::yield();
+        head = head_.load(std::memory_order_acquire);
+    }
+
+    unsigned int slot = tail % capacity_;
+    time_stamps_[slot] = _ts;
+    data_.col(slot) = _data;
+    tail_.store(tail + 1, std::memory_order_release);
+
+    n_pushed_.fetch_add(1, std::memory_order_relaxed);
+    if (tail + 1 - head > max_size_.load(std::memory_order_relaxed))
+        max_size_.store(tail + 1 - head, std::memory_order_relaxed);
+    return true;
+}
+
+inline bool SampleQueue::pop(TimeStamp& _ts, Eigen::VectorXs& _data)
+{
+    unsigned long int head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire))
+        return false;
+
+    unsigned int slot = head % capacity_;
+    _ts = time_stamps_[slot];
+    _data = data_.col(slot);
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+inline unsigned int SampleQueue::size() const
+{
+    unsigned long int head = head_.load(std::memory_order_acquire);
+    return tail_.load(std::memory_order_acquire) - head;
+}
+
+inline bool SampleQueue::empty() const
+{
+    return size() == 0;
+}
+
+inline unsigned int SampleQueue::capacity() const
+{
+    return capacity_;
+}
+
+inline unsigned int SampleQueue::getDataSize() const
+{
+    return data_size_;
+}
+
+inline const Eigen::MatrixXs& SampleQueue::getDataCovariance() const
+{
+    return data_cov_;
+}
+
+inline SampleDropPolicy SampleQueue::getDropPolicy() const
+{
+    return (SampleDropPolicy)drop_policy_.load(std::memory_order_relaxed);
+}
+
+inline void SampleQueue::setDropPolicy(SampleDropPolicy _drop_policy)
+{
+    drop_policy_.store(_drop_policy, std::memory_order_relaxed);
+}
+
+inline unsigned long int SampleQueue::getPushedCount() const
+{
+    return n_pushed_.load(std::memory_order_relaxed);
+}
+
+inline unsigned long int SampleQueue::getDroppedCount() const
+{
+    return n_dropped_.load(std::memory_order_relaxed);
+}
+
+inline unsigned int SampleQueue::getMaxSize() const
+{
+    return max_size_.load(std::memory_order_relaxed);
+}
+
+} // namespace wolf
+
+#endif /* SRC_SAMPLE_QUEUE_H_ */
@@ -1,4 +1,5 @@
 #include "sensor_base.h"
+#include "sample_queue.h"
 #include "state_block.h"
 
 
@@ -16,7 +17,8 @@ SensorBase::SensorBase(const SensorType& _tp, const std::string& _type, StateBlo
         intrinsic_ptr_(_intr_ptr),
         extrinsic_dynamic_(_extr_dyn),
         noise_std_(_noise_size),
-        noise_cov_(_noise_size, _noise_size)
+        noise_cov_(_noise_size, _noise_size),
+        sample_queue_ptr_(nullptr)
 {
     //
 }
@@ -31,7 +33,8 @@ SensorBase::SensorBase(const SensorType & _tp, const std::string& _type, StateBl
         intrinsic_ptr_(_intr_ptr),
         extrinsic_dynamic_(_extr_dyn),
         noise_std_(_noise_std),
-        noise_cov_(_noise_std.size(), _noise_std.size())
+        noise_cov_(_noise_std.size(), _noise_std.size()),
+        sample_queue_ptr_(nullptr)
 {
     noise_cov_.setZero();
     for (unsigned int i = 0; i < _noise_std.size(); i++)
@@ -62,6 +65,15 @@ SensorBase::~SensorBase()
         delete intrinsic_ptr_;
     }
 
+    delete sample_queue_ptr_;
+}
+
+SampleQueue* SensorBase::attachSampleQueue(unsigned int _data_size, unsigned int _capacity, const Eigen::MatrixXs& _data_cov,
+                                           SampleDropPolicy _drop_policy)
+{
+    delete sample_queue_ptr_;
+    sample_queue_ptr_ = new SampleQueue(_data_size, _capacity, _data_cov, _drop_policy);
+    return sample_queue_ptr_;
 }
 
 void SensorBase::fix()
@@ -103,13 +115,13 @@ void SensorBase::registerNewStateBlocks()
     if (getProblem() != nullptr)
     {
         if (p_ptr_ != nullptr)
-            getProblem()->addStateBlockPtr(p_ptr_);
+            getProblem()->addStateBlockPtr(p_ptr_, ST_SENSOR);
 
         if (o_ptr_ != nullptr)
-            getProblem()->addStateBlockPtr(o_ptr_);
+            getProblem()->addStateBlockPtr(o_ptr_, ST_SENSOR);
 
         if (intrinsic_ptr_ != nullptr)
-            getProblem()->addStateBlockPtr(intrinsic_ptr_);
+            getProblem()->addStateBlockPtr(intrinsic_ptr_, ST_SENSOR);
     }
 }
 
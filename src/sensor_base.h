@@ -5,6 +5,7 @@
 namespace wolf{
 class HardwareBase;
 class ProcessorBase;
+class SampleQueue;
 class StateBlock;
 }
 
@@ -50,6 +51,8 @@ class SensorBase : public NodeLinked<HardwareBase, ProcessorBase>
         Eigen::VectorXs noise_std_; // std of sensor noise
         Eigen::MatrixXs noise_cov_; // cov matrix of noise
 
+        SampleQueue* sample_queue_ptr_; // queue of raw samples pushed by the sensor driver, if any
+
     public:
 
         /** \brief Constructor with noise size
@@ -119,6 +122,24 @@ class SensorBase : public NodeLinked<HardwareBase, ProcessorBase>
 
         Eigen::MatrixXs getNoiseCov();
 
+        /** \brief Attaches a queue of raw samples to the sensor
+         *
+         * The sensor driver pushes time-stamped data into the queue from its own thread,
+         * and the motion processor of this sensor drains it from the Wolf thread. See SampleQueue.
+         * Any previous queue is destroyed.
+         *
+         * \param _data_size size of each sample
+         * \param _capacity maximum number of samples in the queue
+         * \param _data_cov covariance of the data of each sample
+         * \param _drop_policy behavior of the queue when full
+         **/
+        SampleQueue* attachSampleQueue(unsigned int _data_size, unsigned int _capacity, const Eigen::MatrixXs& _data_cov,
+                                       SampleDropPolicy _drop_policy = SMP_DROP_NEWEST);
+
+        /** \brief The queue of raw samples of the sensor, or nullptr if the sensor has none
+         **/
+        SampleQueue* getSampleQueuePtr() const;
+
 };
 
 inline unsigned int SensorBase::id()
@@ -137,6 +158,11 @@ inline ProcessorBase* SensorBase::addProcessor(ProcessorBase* _proc_ptr)
     return _proc_ptr;
 }
 
+inline SampleQueue* SensorBase::getSampleQueuePtr() const
+{
+    return sample_queue_ptr_;
+}
+
 inline ProcessorBaseList* SensorBase::getProcessorListPtr()
 {
     return getDownNodeListPtr();
@@ -38,19 +38,19 @@ void SensorGPS::registerNewStateBlocks()
     if (getProblem() != nullptr)
     {
         if (p_ptr_ != nullptr)
-            getProblem()->addStateBlockPtr(p_ptr_);
+            getProblem()->addStateBlockPtr(p_ptr_, ST_SENSOR);
 
         if (o_ptr_ != nullptr)
-            getProblem()->addStateBlockPtr(o_ptr_);
+            getProblem()->addStateBlockPtr(o_ptr_, ST_SENSOR);
 
         if (intrinsic_ptr_ != nullptr)
-            getProblem()->addStateBlockPtr(intrinsic_ptr_);
+            getProblem()->addStateBlockPtr(intrinsic_ptr_, ST_SENSOR);
 
         if (map_p_ptr_ != nullptr)
-            getProblem()->addStateBlockPtr(map_p_ptr_);
+            getProblem()->addStateBlockPtr(map_p_ptr_, ST_SENSOR);
 
         if (map_o_ptr_ != nullptr)
-            getProblem()->addStateBlockPtr(map_o_ptr_);
+            getProblem()->addStateBlockPtr(map_o_ptr_, ST_SENSOR);
     }
 }
 
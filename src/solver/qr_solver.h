@@ -76,50 +76,53 @@ class SolverQR
 
         void update()
         {
+            std::list<StateBlockNotification> state_notification_list;
+            std::list<ConstraintNotification> ctr_notification_list;
+            problem_ptr_->consumeStateBlockNotificationList(state_notification_list);
+            problem_ptr_->consumeConstraintNotificationList(ctr_notification_list);
+
             // UPDATE STATE BLOCKS
-            while (!problem_ptr_->getStateBlockNotificationList().empty())
+            for (auto state_notification : state_notification_list)
             {
-                switch (problem_ptr_->getStateBlockNotificationList().front().notification_)
+                switch (state_notification.notification_)
                 {
                     case ADD:
                     {
-                        addStateBlock(problem_ptr_->getStateBlockNotificationList().front().state_block_ptr_);
+                        addStateBlock(state_notification.state_block_ptr_);
                         break;
                     }
                     case UPDATE:
                     {
-                        updateStateBlockStatus(problem_ptr_->getStateBlockNotificationList().front().state_block_ptr_);
+                        updateStateBlockStatus(state_notification.state_block_ptr_);
                         break;
                     }
                     case REMOVE:
                     {
-                        // TODO removeStateBlock((double *)(problem_ptr_->getStateBlockNotificationList().front().scalar_ptr_));
+                        // TODO removeStateBlock((double *)(state_notification.scalar_ptr_));
                         break;
                     }
                     default:
                         throw std::runtime_error("SolverQR::update: State Block notification must be ADD, UPATE or REMOVE.");
                 }
-                problem_ptr_->getStateBlockNotificationList().pop_front();
             }
             // UPDATE CONSTRAINTS
-            while (!problem_ptr_->getConstraintNotificationList().empty())
+            for (auto ctr_notification : ctr_notification_list)
             {
-                switch (problem_ptr_->getConstraintNotificationList().front().notification_)
+                switch (ctr_notification.notification_)
                 {
                     case ADD:
                     {
-                        addConstraint(problem_ptr_->getConstraintNotificationList().front().constraint_ptr_);
+                        addConstraint(ctr_notification.constraint_ptr_);
                         break;
                     }
                     case REMOVE:
                     {
-                        // TODO: removeConstraint(problem_ptr_->getConstraintNotificationList().front().id_);
+                        // TODO: removeConstraint(ctr_notification.id_);
                         break;
                     }
                     default:
                         throw std::runtime_error("SolverQR::update: Constraint notification must be ADD or REMOVE.");
                 }
-                problem_ptr_->getConstraintNotificationList().pop_front();
             }
         }
 
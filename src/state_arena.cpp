@@ -0,0 +1,95 @@
+/**
+ * \file state_arena.cpp
+ *
+ *  Created on: Jul 11, 2016
+ *      \author: jsola
+ */
+
+#include "state_arena.h"
+#include "state_block.h"
+
+// STL includes
+#include <algorithm>
+#include <cstring>
+
+namespace wolf {
+
+StateArena::StateArena(unsigned int _capacity, unsigned int _page_size) :
+        data_(new Scalar[_capacity]), capacity_(_capacity), page_size_(_page_size), size_(0),
+        page_offset_(ST_OTHER + 1, _capacity), page_used_(ST_OTHER + 1, _page_size), free_slots_(ST_OTHER + 1)
+{
+    // no kind has a page yet: they are all full
+}
+
+StateArena::~StateArena()
+{
+    // the blocks are not touched, since they may be destructed already
+    delete[] data_;
+}
+
+unsigned int StateArena::allocate(unsigned int _size, StateKind _kind)
+{
+    // the room of a removed block
+    auto free_it = free_slots_[_kind].find(_size);
+    if (free_it != free_slots_[_kind].end() && !free_it->second.empty())
+    {
+        unsigned int offset = free_it->second.back();
+        free_it->second.pop_back();
+        return offset;
+    }
+
+    // a new page
+    if (page_used_[_kind] + _size > page_size_)
+    {
+        if (_size > page_size_ || size_ + page_size_ > capacity_)
+            return capacity_;
+        page_offset_[_kind] = size_;
+        page_used_[_kind] = 0;
+        size_ += page_size_;
+    }
+
+    unsigned int offset = page_offset_[_kind] + page_used_[_kind];
+    page_used_[_kind] += _size;
+    return offset;
+}
+
+bool StateArena::insert(StateBlock* _state_ptr, StateKind _kind)
+{
+    assert(!contains(_state_ptr) && "StateArena::insert: state block already in the arena");
+    unsigned int size = _state_ptr->getSize();
+    if (size == 0)
+        return false;
+
+    unsigned int offset = allocate(size, _kind);
+    if (offset == capacity_)
+        return false;
+
+    _state_ptr->moveState(data_ + offset);
+    slots_[_state_ptr] = Slot({offset, size, _kind});
+    return true;
+}
+
+void StateArena::remove(StateBlock* _state_ptr)
+{
+    auto slot_it = slots_.find(_state_ptr);
+    if (slot_it == slots_.end())
+        return;
+
+    _state_ptr->moveState(nullptr);
+    free_slots_[slot_it->second.kind_][slot_it->second.size_].push_back(slot_it->second.offset_);
+    slots_.erase(slot_it);
+}
+
+void StateArena::snapshot(Eigen::VectorXs& _snapshot) const
+{
+    _snapshot.resize(size_);
+    std::memcpy(_snapshot.data(), data_, size_ * sizeof(Scalar));
+}
+
+void StateArena::restore(const Eigen::VectorXs& _snapshot)
+{
+    unsigned int size = std::min(size_, (unsigned int)(_snapshot.size()));
+    std::memcpy(data_, _snapshot.data(), size * sizeof(Scalar));
+}
+
+} // namespace wolf
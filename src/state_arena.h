@@ -0,0 +1,136 @@
+/**
+ * \file state_arena.h
+ *
+ *  Created on: Jul 11, 2016
+ *      \author: jsola
+ */
+
+#ifndef SRC_STATE_ARENA_H_
+#define SRC_STATE_ARENA_H_
+
+#include "wolf.h"
+
+// STL includes
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace wolf {
+
+/** \brief Contiguous storage of the state blocks of a problem
+ *
+ * All state values live in one vector of Scalars, allocated once, so that the whole state of the problem is one parameter vector.
+ * The vector is divided in pages, and each page holds the state blocks of one StateKind.
+ * Thus, e.g., the positions and orientations of consecutive frames are next to each other, and the landmarks are apart.
+ *
+ * Inserting a state block moves its values to the arena, and makes it point to them: its getPtr() does not change afterwards,
+ * so that the solvers can keep it. Removing the block moves its values back to the block.
+ * The room of a removed block is reused by the next block of the same kind and size.
+ * When the arena is full, or a block is bigger than a page, the block stays in its own storage, outside the arena.
+ *
+ * The state of all blocks in the arena can be saved with one copy, and restored with another, e.g. to roll back a solve.
+ *
+ * The arena must outlive its blocks: the Problem owning it destroys it after the Wolf tree.
+ */
+class StateArena
+{
+    public:
+        /** \brief Constructor
+         * \param _capacity the number of Scalars of the arena
+         * \param _page_size the number of Scalars of each page
+         */
+        StateArena(unsigned int _capacity, unsigned int _page_size = 256);
+        ~StateArena();
+
+        /** \brief Moves the state of the block to the arena
+         * \return false if there is no room: the block keeps its own storage
+         */
+        bool insert(StateBlock* _state_ptr, StateKind _kind);
+
+        /** \brief Moves the state of the block back to the block, and leaves its room to others. Does nothing if the block is not in the arena.
+         */
+        void remove(StateBlock* _state_ptr);
+
+        bool contains(StateBlock* _state_ptr) const;
+
+        /** \brief Position of the state of the block in getVector(). The block must be in the arena.
+         */
+        unsigned int getOffset(StateBlock* _state_ptr) const;
+
+        /** \brief All the states in the arena, one after the other, gaps included
+         *
+         * The block of a given offset is only meaningful if there is one (see getOffset()). The other values are unspecified.
+         */
+        Eigen::Map<Eigen::VectorXs> getVector();
+
+        unsigned int getCapacity() const;
+        unsigned int getSize() const;           ///< number of Scalars of the pages in use, i.e. the size of getVector()
+        unsigned int getBlocksCount() const;    ///< number of state blocks in the arena
+
+        /** \brief Copies all the states in the arena to _snapshot, at once
+         */
+        void snapshot(Eigen::VectorXs& _snapshot) const;
+
+        /** \brief Copies back a snapshot, at once
+         *
+         * The blocks in the arena must be the same as at the snapshot, e.g. when rolling back a solve.
+         */
+        void restore(const Eigen::VectorXs& _snapshot);
+
+    private:
+        struct Slot
+        {
+                unsigned int offset_;
+                unsigned int size_;
+                StateKind kind_;
+        };
+
+        /** \brief Finds room for _size Scalars of kind _kind
+         * \return the offset of the room, or getCapacity() if there is none
+         */
+        unsigned int allocate(unsigned int _size, StateKind _kind);
+
+        Scalar* data_;
+        unsigned int capacity_;
+        unsigned int page_size_;
+        unsigned int size_;                                 ///< end of the last page in use
+        std::vector<unsigned int> page_offset_;             ///< current page of each kind, filled up to page_used_
+        std::vector<unsigned int> page_used_;
+        std::vector<std::map<unsigned int, std::vector<unsigned int> > > free_slots_; ///< offsets of the room left by removed blocks, per kind and size
+        std::unordered_map<StateBlock*, Slot> slots_;
+};
+
+inline bool StateArena::contains(StateBlock* _state_ptr) const
+{
+    return slots_.find(_state_ptr) != slots_.end();
+}
+
+inline unsigned int StateArena::getOffset(StateBlock* _state_ptr) const
+{
+    assert(contains(_state_ptr) && "StateArena::getOffset: state block not in the arena");
+    return slots_.at(_state_ptr).offset_;
+}
+
+inline Eigen::Map<Eigen::VectorXs> StateArena::getVector()
+{
+    return Eigen::Map<Eigen::VectorXs>(data_, size_);
+}
+
+inline unsigned int StateArena::getCapacity() const
+{
+    return capacity_;
+}
+
+inline unsigned int StateArena::getSize() const
+{
+    return size_;
+}
+
+inline unsigned int StateArena::getBlocksCount() const
+{
+    return slots_.size();
+}
+
+} // namespace wolf
+
+#endif /* SRC_STATE_ARENA_H_ */
@@ -12,6 +12,7 @@ class LocalParametrizationBase;
 
 //std includes
 #include <iostream>
+#include <new>
 
 
 namespace wolf {
@@ -24,11 +25,17 @@ namespace wolf {
  *     - Fixed state blocks are not estimated and treated by the estimator as fixed parameters.
  *     - Non-fixed state blocks are estimated.
  *  - A local parametrization useful for optimizing in the tangent space to the manifold.
+ *
+ * The state values are stored in the block itself, or in the StateArena of the problem if it has one (see Problem::enableStateArena()).
+ * In the latter case, the block is in the arena while it is registered in the problem, and getPtr() points into the arena.
  */
 class StateBlock
 {
+    friend class StateArena;
+
     protected:
-        Eigen::VectorXs state_; ///< State vector storing the state values
+        Eigen::VectorXs own_state_; ///< Storage of the state values, when they are not in a StateArena
+        Eigen::Map<Eigen::VectorXs> state_; ///< State vector storing the state values, in own_state_ or in a StateArena
         bool fixed_; ///< Key to indicate whether the state is fixed or not
         LocalParametrizationBase* local_param_ptr_; ///< Local parametrization useful for optimizing in the tangent space to the manifold
         
@@ -59,7 +66,7 @@ class StateBlock
         
         /** \brief Returns the state vector
          **/
-        const Eigen::VectorXs& getVector() const;
+        Eigen::Map<const Eigen::VectorXs> getVector() const;
 
         /** \brief Sets the state vector
          **/
@@ -89,6 +96,13 @@ class StateBlock
 
         void removeLocalParametrization();
 
+    private:
+        StateBlock(const StateBlock&);              // not copyable: the state may be in a StateArena
+        StateBlock& operator=(const StateBlock&);
+
+        /** \brief Moves the state values to _storage_ptr, of getSize() scalars, or back to own_state_ if nullptr
+         **/
+        void moveState(Scalar* _storage_ptr);
 };
 
 } // namespace wolf
@@ -98,12 +112,13 @@ class StateBlock
 namespace wolf {
 
 inline StateBlock::StateBlock(const Eigen::VectorXs _state, bool _fixed, LocalParametrizationBase* _local_param_ptr) :
-        state_(_state), fixed_(_fixed), local_param_ptr_(_local_param_ptr)
+        own_state_(_state), state_(own_state_.data(), own_state_.size()), fixed_(_fixed), local_param_ptr_(_local_param_ptr)
 {
 }
 
 inline StateBlock::StateBlock(const unsigned int _size, bool _fixed, LocalParametrizationBase* _local_param_ptr) :
-        state_(Eigen::VectorXs::Zero(_size)), fixed_(_fixed), local_param_ptr_(_local_param_ptr)
+        own_state_(Eigen::VectorXs::Zero(_size)), state_(own_state_.data(), own_state_.size()), fixed_(_fixed),
+        local_param_ptr_(_local_param_ptr)
 {
     //
 }
@@ -122,9 +137,9 @@ inline Scalar* StateBlock::getPtr()
     return state_.data();
 }
 
-inline const Eigen::VectorXs& StateBlock::getVector() const
+inline Eigen::Map<const Eigen::VectorXs> StateBlock::getVector() const
 {
-    return state_;
+    return Eigen::Map<const Eigen::VectorXs>(state_.data(), state_.size());
 }
 
 inline void StateBlock::setVector(const Eigen::VectorXs& _state)
@@ -170,6 +185,21 @@ inline void StateBlock::removeLocalParametrization()
     local_param_ptr_ = nullptr;
 }
 
+inline void StateBlock::moveState(Scalar* _storage_ptr)
+{
+    if (_storage_ptr == nullptr)
+    {
+        own_state_ = state_;
+        new (&state_) Eigen::Map<Eigen::VectorXs>(own_state_.data(), own_state_.size());
+    }
+    else
+    {
+        Eigen::Map<Eigen::VectorXs>(_storage_ptr, state_.size()) = state_;
+        new (&state_) Eigen::Map<Eigen::VectorXs>(_storage_ptr, state_.size());
+        own_state_.resize(0);
+    }
+}
+
 inline void StateBlock::setLocalParametrizationPtr(LocalParametrizationBase* _local_param)
 {
 	assert(_local_param != nullptr && "setting a null local parametrization");
@@ -0,0 +1,126 @@
+/**
+ * \file thread_pool.h
+ *
+ *  Created on: Jul 6, 2016
+ *      \author: jsola
+ */
+
+#ifndef SRC_THREAD_POOL_H_
+#define SRC_THREAD_POOL_H_
+
+// STL includes
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace wolf {
+
+/** \brief Fixed set of worker threads running batches of tasks
+ *
+ * run() hands a batch of tasks, indexed 0 to n-1, to the workers and to the calling thread, and returns when all are done.
+ * The threads are created once, at construction, so that a batch costs no thread creation.
+ *
+ * Only one thread may call run() at a time, and the tasks may not call run() themselves.
+ */
+class ThreadPool
+{
+    public:
+        /** \brief Constructor
+         * \param _n_threads the number of threads running the tasks, including the one calling run().
+         */
+        ThreadPool(unsigned int _n_threads);
+        ~ThreadPool();
+
+        unsigned int size() const; ///< number of threads running the tasks, including the one calling run()
+
+        /** \brief Runs _task(i) for i = 0 to _n_tasks-1, and waits for all of them
+         */
+        void run(unsigned int _n_tasks, const std::function<void(unsigned int)>& _task);
+
+    private:
+        /** \brief Takes and runs tasks of the current batch until there are none left
+         * \param _lock a lock on mutex_, released while running each task
+         */
+        void runTasks(std::unique_lock<std::mutex>& _lock);
+        void work();
+
+        std::vector<std::thread> workers_;
+        std::mutex mutex_;
+        std::condition_variable work_cv_;   ///< a batch is ready, or the pool is stopping
+        std::condition_variable done_cv_;   ///< the batch is done
+        const std::function<void(unsigned int)>* task_ptr_;
+        unsigned int n_tasks_;
+        unsigned int next_task_;
+        unsigned int n_done_;
+        bool stop_;
+};
+
+inline ThreadPool::ThreadPool(unsigned int _n_threads) :
+        task_ptr_(nullptr), n_tasks_(0), next_task_(0), n_done_(0), stop_(false)
+{
+    for (unsigned int i = 1; i < _n_threads; i++)
+        workers_.emplace_back(&ThreadPool::work, this);
+}
+
+inline ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    work_cv_.notify_all();
+    for (auto& worker : workers_)
+        worker.join();
+}
+
+inline unsigned int ThreadPool::size() const
+{
+    return workers_.size() + 1;
+}
+
+inline void ThreadPool::run(unsigned int _n_tasks, const std::function<void(unsigned int)>& _task)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    task_ptr_ = &_task;
+    n_tasks_ = _n_tasks;
+    next_task_ = 0;
+    n_done_ = 0;
+    work_cv_.notify_all();
+
+    // the calling thread works too
+    runTasks(lock);
+    done_cv_.wait(lock, [this]{ return n_done_ == n_tasks_; });
+    task_ptr_ = nullptr;
+}
+
+inline void ThreadPool::runTasks(std::unique_lock<std::mutex>& _lock)
+{
+    while (next_task_ < n_tasks_)
+    {
+        unsigned int task = next_task_++;
+        const std::function<void(unsigned int)>& task_function = *task_ptr_;
+        _lock.unlock();
+        task_function(task);
+        _lock.lock();
+        if (++n_done_ == n_tasks_)
+            done_cv_.notify_one();
+    }
+}
+
+inline void ThreadPool::work()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+        work_cv_.wait(lock, [this]{ return stop_ || next_task_ < n_tasks_; });
+        if (stop_)
+            return;
+        runTasks(lock);
+    }
+}
+
+} // namespace wolf
+
+#endif /* SRC_THREAD_POOL_H_ */
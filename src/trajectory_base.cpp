@@ -1,10 +1,15 @@
 #include "trajectory_base.h"
+#include "frame_base.h"
+
+//std includes
+#include <cmath>
+#include <iterator>
 
 namespace wolf {
 
 TrajectoryBase::TrajectoryBase(FrameStructure _frame_structure) :
     NodeLinked(MID, "TRAJECTORY"),
-    frame_structure_(_frame_structure), last_key_frame_ptr_(nullptr)
+    frame_structure_(_frame_structure)
 {
     //
 }
@@ -12,17 +17,21 @@ TrajectoryBase::TrajectoryBase(FrameStructure _frame_structure) :
 TrajectoryBase::~TrajectoryBase()
 {
     //std::cout << "deleting TrajectoryBase " << nodeId() << std::endl;
+
+    // the key frames, deleted after the index, must not update it
+    is_deleting_ = true;
 }
 
 FrameBase* TrajectoryBase::addFrame(FrameBase* _frame_ptr)
 {
     if (_frame_ptr->isKey())
     {
-        _frame_ptr->registerNewStateBlocks();
-        if (last_key_frame_ptr_ == nullptr || last_key_frame_ptr_->getTimeStamp() < _frame_ptr->getTimeStamp())
-            last_key_frame_ptr_ = _frame_ptr;
+        FrameBaseIter place = computeFrameOrder(_frame_ptr);
+        insertDownNode(_frame_ptr, place);
+        indexKeyFrame(std::prev(place));
 
-        insertDownNode(_frame_ptr, computeFrameOrder(_frame_ptr));
+        // once linked, the frame can reach the problem
+        _frame_ptr->registerNewStateBlocks();
     }
     else
         addDownNode(_frame_ptr);
@@ -38,34 +47,86 @@ void TrajectoryBase::getConstraintList(ConstraintBaseList & _ctr_list)
 
 void TrajectoryBase::sortFrame(FrameBase* _frame_ptr)
 {
-    moveDownNode(_frame_ptr, computeFrameOrder(_frame_ptr));
+    assert(_frame_ptr->isKey() && "TrajectoryBase::sortFrame: not a key frame");
+
+    // it is not indexed yet: search it among the non-key frames, after the key frames
+    auto frame_rit = getFrameListPtr()->rbegin();
+    while (*frame_rit != _frame_ptr)
+    {
+        assert(!(*frame_rit)->isKey() && "TrajectoryBase::sortFrame: frame not among the non-key frames of the trajectory");
+        frame_rit++;
+    }
+    FrameBaseIter frame_it = std::prev(frame_rit.base());
+
+    getFrameListPtr()->splice(computeFrameOrder(_frame_ptr), *getFrameListPtr(), frame_it);
+    indexKeyFrame(frame_it);
+}
+
+void TrajectoryBase::sortFrame(FrameBase* _frame_ptr, const TimeStamp& _ts_indexed)
+{
+    auto range = key_frame_index_.equal_range(_ts_indexed);
+    auto index_it = range.first;
+    while (index_it != range.second && index_it->second.first != _frame_ptr)
+        index_it++;
+    assert(index_it != range.second && "TrajectoryBase::sortFrame: key frame not indexed at this time stamp");
+    FrameBaseIter frame_it = index_it->second.second;
+
+    key_frame_index_.erase(index_it);
+    getFrameListPtr()->splice(computeFrameOrder(_frame_ptr), *getFrameListPtr(), frame_it);
+    indexKeyFrame(frame_it);
 }
 
 FrameBaseIter TrajectoryBase::computeFrameOrder(FrameBase* _frame_ptr)
 {
-    for (auto frm_rit = getFrameListPtr()->rbegin(); frm_rit != getFrameListPtr()->rend(); frm_rit++)
-        if ((*frm_rit)!= _frame_ptr && (*frm_rit)->isKey() && (*frm_rit)->getTimeStamp() < _frame_ptr->getTimeStamp())
-            return frm_rit.base();
-    return getFrameListPtr()->begin();
+    // after the last key frame older than the frame
+    auto older_it = key_frame_index_.lower_bound(_frame_ptr->getTimeStamp());
+    if (older_it == key_frame_index_.begin())
+        return getFrameListPtr()->begin();
+    older_it--;
+    return std::next(older_it->second.second);
 }
 
 FrameBase* TrajectoryBase::closestKeyFrameToTimeStamp(const TimeStamp& _ts)
 {
-    FrameBase* closest_kf = nullptr;
-    Scalar min_dt = 1e9;
+    if (key_frame_index_.empty())
+        return nullptr;
+
+    // the first key frame not older than _ts, and the one before
+    auto next_it = key_frame_index_.lower_bound(_ts);
+    if (next_it == key_frame_index_.end())
+        return key_frame_index_.rbegin()->second.first;
+    if (next_it == key_frame_index_.begin())
+        return next_it->second.first;
+    auto prev_it = std::prev(next_it);
+    if (std::abs(next_it->first.get() - _ts.get()) <= std::abs(prev_it->first.get() - _ts.get()))
+        return next_it->second.first;
+    return prev_it->second.first;
+}
+
+void TrajectoryBase::getKeyFrameList(const TimeStamp& _ts_from, const TimeStamp& _ts_to, FrameBaseList& _frame_list)
+{
+    for (auto index_it = key_frame_index_.lower_bound(_ts_from);
+            index_it != key_frame_index_.end() && index_it->first <= _ts_to; index_it++)
+        _frame_list.push_back(index_it->second.first);
+}
 
-    for (auto frm_rit = getFrameListPtr()->rbegin(); frm_rit != getFrameListPtr()->rend(); frm_rit++)
-        if ((*frm_rit)->isKey())
+void TrajectoryBase::indexKeyFrame(const FrameBaseIter& _frame_iter)
+{
+    // before the key frames of the same time stamp, as in the frame list
+    const TimeStamp& ts = (*_frame_iter)->getTimeStamp();
+    key_frame_index_.insert(key_frame_index_.lower_bound(ts), std::make_pair(ts, std::make_pair(*_frame_iter, _frame_iter)));
+}
+
+void TrajectoryBase::unindexKeyFrame(FrameBase* _frame_ptr)
+{
+    auto range = key_frame_index_.equal_range(_frame_ptr->getTimeStamp());
+    for (auto index_it = range.first; index_it != range.second; index_it++)
+        if (index_it->second.first == _frame_ptr)
         {
-            if (std::abs((*frm_rit)->getTimeStamp().get() - _ts.get()) < min_dt)
-            {
-                min_dt = std::abs((*frm_rit)->getTimeStamp().get() - _ts.get());
-                closest_kf = *frm_rit;
-            }
-            else
-                break;
+            key_frame_index_.erase(index_it);
+            return;
         }
-    return closest_kf;
+    assert(false && "TrajectoryBase::unindexKeyFrame: key frame not indexed at its time stamp. Use sortFrame() when it changes");
 }
 
 } // namespace wolf
@@ -11,18 +11,29 @@ class FrameBase;
 //Wolf includes
 #include "wolf.h"
 #include "node_linked.h"
+#include "time_stamp.h"
 
 //std includes
+#include <map>
+#include <utility> // pair
 
 
 namespace wolf {
 
-//class TrajectoryBase
+/** \brief Trajectory node of the Wolf tree
+ *
+ * The frames are in the frame list: first the key frames, sorted by time stamp, then the other frames, in order of arrival.
+ *
+ * The key frames are also indexed by time stamp, so that inserting a key frame and searching key frames by time are logarithmic.
+ * Hence the time stamp of a key frame must not change. Use sortFrame(FrameBase*, const TimeStamp&) if it does.
+ */
 class TrajectoryBase : public NodeLinked<Problem,FrameBase>
 {
     protected:
+        typedef std::multimap<TimeStamp, std::pair<FrameBase*, FrameBaseIter> > KeyFrameIndex;
+
         FrameStructure frame_structure_; // Defines the structure of the Frames in the Trajectory.
-        FrameBase* last_key_frame_ptr_;  // keeps pointer to the last key frame
+        KeyFrameIndex key_frame_index_;  // the key frames by time stamp, and their position in the frame list
         
     public:
         TrajectoryBase(FrameStructure _frame_sturcture);
@@ -54,9 +65,9 @@ class TrajectoryBase : public NodeLinked<Problem,FrameBase>
          */
         FrameBase* getLastKeyFramePtr();
 
-        /** \brief Sets the pointer to last key frame
+        /** \brief Returns the number of key frames
          */
-        void setLastKeyFramePtr(FrameBase* _key_frame_ptr);
+        unsigned int getKeyFramesCount() const;
 
         /** \brief Returns a list of all constraints in the trajectory thru reference
          **/
@@ -66,17 +77,42 @@ class TrajectoryBase : public NodeLinked<Problem,FrameBase>
          **/
         FrameStructure getFrameStructure() const;
 
-        /** \brief Sorts the frame by timestamp
+        /** \brief Sorts a frame that just became key by timestamp
+         *
+         * FrameBase::setKey() calls it. The frame is searched among the non-key frames, at the end of the frame list.
+         **/
+        void sortFrame(FrameBase* _frame_ptr);
+
+        /** \brief Sorts a key frame by timestamp, after its time stamp changed
+         * \param _frame_ptr the key frame
+         * \param _ts_indexed the time stamp it had before
+         *
+         * In logarithmic time.
          **/
-        void sortFrame(FrameBase* _frame_iter);
+        void sortFrame(FrameBase* _frame_ptr, const TimeStamp& _ts_indexed);
 
         /** \brief Compute the position where the frame should be
+         *
+         * It is after the last key frame older than the frame, in logarithmic time.
          **/
         FrameBaseIter computeFrameOrder(FrameBase* _frame_ptr);
 
         /** \brief Finds the closes key frame to a given timestamp
+         *
+         * In logarithmic time. Of two key frames equally close, it is the newest. nullptr if there are no key frames.
          **/
         FrameBase* closestKeyFrameToTimeStamp(const TimeStamp& _ts);
+
+        /** \brief Appends to _frame_list the key frames with time stamp in [_ts_from, _ts_to], sorted by time stamp
+         **/
+        void getKeyFrameList(const TimeStamp& _ts_from, const TimeStamp& _ts_to, FrameBaseList& _frame_list);
+
+        /** \brief Removes a key frame from the index. The key frames do it at destruction.
+         */
+        void unindexKeyFrame(FrameBase* _frame_ptr);
+
+    private:
+        void indexKeyFrame(const FrameBaseIter& _frame_iter);
 };
 
 inline void TrajectoryBase::removeFrame(const FrameBaseIter& _frame_iter)
@@ -96,12 +132,12 @@ inline FrameBase* TrajectoryBase::getLastFramePtr()
 
 inline FrameBase* TrajectoryBase::getLastKeyFramePtr()
 {
-    return last_key_frame_ptr_;
+    return key_frame_index_.empty() ? nullptr : key_frame_index_.rbegin()->second.first;
 }
 
-inline void TrajectoryBase::setLastKeyFramePtr(FrameBase* _key_frame_ptr)
+inline unsigned int TrajectoryBase::getKeyFramesCount() const
 {
-    last_key_frame_ptr_ = _key_frame_ptr;
+    return key_frame_index_.size();
 }
 
 inline FrameStructure TrajectoryBase::getFrameStructure() const
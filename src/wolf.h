@@ -154,7 +154,8 @@ typedef enum
     CTR_EPIPOLAR,               ///< Epipolar constraint
     CTR_AHP,                    ///< Anchored Homogeneous Point constraint
     CTR_AHP_NL,                 ///< Anchored Homogeneous Point constraint (temporal, to be removed)
-    CTR_IMU                     ///< IMU constraint
+    CTR_IMU,                    ///< IMU constraint
+    CTR_MARGINALIZATION         ///< Dense Gaussian prior left by the marginalized key frames
 
 } ConstraintType;
 
@@ -202,6 +203,41 @@ typedef enum
     ST_FIXED = 1,       ///< State fixed, estimated enough or fixed infrastructure.
 } StateStatus;
 
+/** \brief Enumeration of the kinds of state blocks, grouped together in the StateArena
+ *
+ * You may add items to this list as needed. Be concise with names, and document your entries.
+ */
+typedef enum
+{
+    ST_FRAME = 0,   ///< Position, orientation or velocity of a frame.
+    ST_BIAS,        ///< Bias of a frame, e.g. of the IMU.
+    ST_LANDMARK,    ///< State of a landmark.
+    ST_SENSOR,      ///< Extrinsics or intrinsics of a sensor.
+    ST_OTHER        ///< Any other state. Keep it the last one: it gives the number of kinds.
+} StateKind;
+
+/** \brief Enumeration of the behaviors of a full SampleQueue
+ *
+ * You may add items to this list as needed. Be concise with names, and document your entries.
+ */
+typedef enum
+{
+    SMP_DROP_NEWEST = 1,    ///< The incoming sample is dropped and counted. The producer never waits.
+    SMP_WAIT                ///< The producer waits until the consumer makes room. No sample is lost.
+} SampleDropPolicy;
+
+/** \brief Enumeration of the decimation policies of the motion buffers
+ *
+ * You may add items to this list as needed. Be concise with names, and document your entries.
+ */
+typedef enum
+{
+    DEC_NONE = 0,   ///< No decimation: the buffer keeps all Motions until the next key-frame.
+    DEC_TIME,       ///< Consecutive Motions closer in time than a threshold are merged.
+    DEC_COUNT,      ///< Every other Motion is merged into the next one.
+    DEC_ERROR       ///< Motions are merged if querying the buffer at their time stamp would err less than a threshold.
+} MotionDecimationPolicy;
+
 /** \brief Enumeration of all possible sensor types
  *
  * You may add items to this list as needed. Be concise with names, and document your entries.
@@ -252,7 +288,8 @@ typedef enum
     FEATURE_MOTION,
     FEATURE_POINT_IMAGE,
     FEATURE_LINE_2D,
-    FEATURE_POLYLINE_2D
+    FEATURE_POLYLINE_2D,
+    FEATURE_MARGINALIZATION
 }FeatureType;
 
 /** \brief Enumeration of all possible landmark types